@@ -0,0 +1,284 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "clowncommon/clowncommon.h"
+
+#include "engines.h"
+#include "interpreter.h"
+
+/* The default amount of work done by each workload, in Z80 cycles. */
+#define DEFAULT_TOTAL_CYCLES 200000000UL
+/* Workloads are run in slices, as an emulator would run one frame at a time. This is an NTSC frame. */
+#define SLICE_CYCLES (3579545UL / 60)
+
+typedef struct Workload
+{
+	const char *name;
+	const unsigned char *program; /* Loaded at 0x0000. */
+	size_t program_size;
+	const unsigned char *interrupt_handler; /* Loaded at 0x0038. May be NULL. */
+	size_t interrupt_handler_size;
+	unsigned long interrupt_interval; /* If not 0, then an interrupt is raised this often, in cycles. */
+} Workload;
+
+/* Arithmetic and logic on registers. */
+static const unsigned char program_alu[] = {
+	0x06, 0x00,       /* 0000: LD B,0 */
+	0x81,             /* 0002: ADD A,C */
+	0x8A,             /* 0003: ADC A,D */
+	0x93,             /* 0004: SUB E */
+	0xAC,             /* 0005: XOR H */
+	0xA5,             /* 0006: AND L */
+	0xB0,             /* 0007: OR B */
+	0xFE, 0x12,       /* 0008: CP 12h */
+	0x0C,             /* 000A: INC C */
+	0x15,             /* 000B: DEC D */
+	0x10, 0xF4,       /* 000C: DJNZ 0002h */
+	0x18, 0xF0        /* 000E: JR 0000h */
+};
+
+/* Copying 4KiB over and over. */
+static const unsigned char program_ldir[] = {
+	0x21, 0x00, 0x40, /* 0000: LD HL,4000h */
+	0x11, 0x00, 0x80, /* 0003: LD DE,8000h */
+	0x01, 0x00, 0x10, /* 0006: LD BC,1000h */
+	0xED, 0xB0,       /* 0009: LDIR */
+	0x18, 0xF3        /* 000B: JR 0000h */
+};
+
+/* Walking through two arrays with the index registers. */
+static const unsigned char program_indexed[] = {
+	0xDD, 0x21, 0x00, 0x40, /* 0000: LD IX,4000h */
+	0xFD, 0x21, 0x00, 0x50, /* 0004: LD IY,5000h */
+	0x06, 0x00,             /* 0008: LD B,0 */
+	0xDD, 0x7E, 0x01,       /* 000A: LD A,(IX+1) */
+	0xFD, 0x86, 0x02,       /* 000D: ADD A,(IY+2) */
+	0xDD, 0x77, 0x03,       /* 0010: LD (IX+3),A */
+	0xFD, 0x35, 0x04,       /* 0013: DEC (IY+4) */
+	0xDD, 0x23,             /* 0016: INC IX */
+	0xFD, 0x23,             /* 0018: INC IY */
+	0x10, 0xEE,             /* 001A: DJNZ 000Ah */
+	0x18, 0xE2              /* 001C: JR 0000h */
+};
+
+/* A recursive subroutine. */
+static const unsigned char program_recursion[] = {
+	0x31, 0x00, 0xF0, /* 0000: LD SP,F000h */
+	0x3E, 0x0C,       /* 0003: LD A,12 */
+	0xCD, 0x0A, 0x00, /* 0005: CALL 000Ah */
+	0x18, 0xF9,       /* 0008: JR 0003h */
+	0x3D,             /* 000A: DEC A */
+	0xC8,             /* 000B: RET Z */
+	0xF5,             /* 000C: PUSH AF */
+	0xCD, 0x0A, 0x00, /* 000D: CALL 000Ah */
+	0xF1,             /* 0010: POP AF */
+	0xC9              /* 0011: RET */
+};
+
+/* Shifts, rotates, and bit manipulation. */
+static const unsigned char program_bits[] = {
+	0xCB, 0x00, /* 0000: RLC B */
+	0xCB, 0x1A, /* 0002: RR D */
+	0xCB, 0x23, /* 0004: SLA E */
+	0xCB, 0x3C, /* 0006: SRL H */
+	0xCB, 0x5F, /* 0008: BIT 3,A */
+	0xCB, 0xCD, /* 000A: SET 1,L */
+	0xCB, 0x97, /* 000C: RES 2,A */
+	0xCB, 0x2F, /* 000E: SRA A */
+	0x0D,       /* 0010: DEC C */
+	0x20, 0xED, /* 0011: JR NZ,0000h */
+	0x18, 0xEB  /* 0013: JR 0000h */
+};
+
+/* A busy loop which is interrupted every scanline. */
+static const unsigned char program_interrupts[] = {
+	0x31, 0x00, 0xF0, /* 0000: LD SP,F000h */
+	0xFB,             /* 0003: EI */
+	0x23,             /* 0004: INC HL */
+	0x18, 0xFD        /* 0005: JR 0004h */
+};
+
+static const unsigned char interrupt_handler_interrupts[] = {
+	0xF5,             /* 0038: PUSH AF */
+	0xC5,             /* 0039: PUSH BC */
+	0x3A, 0x00, 0x80, /* 003A: LD A,(8000h) */
+	0x3C,             /* 003D: INC A */
+	0x32, 0x00, 0x80, /* 003E: LD (8000h),A */
+	0x06, 0x04,       /* 0041: LD B,4 */
+	0x10, 0xFE,       /* 0043: DJNZ 0043h */
+	0xC1,             /* 0045: POP BC */
+	0xF1,             /* 0046: POP AF */
+	0xFB,             /* 0047: EI */
+	0xC9              /* 0048: RET */
+};
+
+static const Workload workloads[] = {
+	{"alu",        program_alu,        sizeof(program_alu),        NULL,                         0,                                    0},
+	{"ldir",       program_ldir,       sizeof(program_ldir),       NULL,                         0,                                    0},
+	{"indexed",    program_indexed,    sizeof(program_indexed),    NULL,                         0,                                    0},
+	{"recursion",  program_recursion,  sizeof(program_recursion),  NULL,                         0,                                    0},
+	{"bits",       program_bits,       sizeof(program_bits),       NULL,                         0,                                    0},
+	{"interrupts", program_interrupts, sizeof(program_interrupts), interrupt_handler_interrupts, sizeof(interrupt_handler_interrupts), 228}
+};
+
+static cc_u8l ram[0x10000];
+
+static cc_u16f ReadCallback(void* const user_data, const cc_u16f address)
+{
+	(void)user_data;
+
+	return ram[address];
+}
+
+static void WriteCallback(void* const user_data, const cc_u16f address, const cc_u16f value)
+{
+	(void)user_data;
+
+	ram[address] = value;
+}
+
+static void LogCallback(void* const user_data, const char* const format, ...)
+{
+	(void)user_data;
+	(void)format;
+}
+
+static void LoadWorkload(const Workload* const workload)
+{
+	unsigned long seed = 1;
+	size_t i;
+
+	/* Fill the rest of memory with the same data every time, so that the results are reproducible. */
+	for (i = 0; i < sizeof(ram); ++i)
+	{
+		seed = seed * 1103515245 + 12345;
+		ram[i] = (seed >> 16) & 0xFF;
+	}
+
+	memcpy(ram, workload->program, workload->program_size);
+
+	if (workload->interrupt_handler != NULL)
+		memcpy(&ram[0x38], workload->interrupt_handler, workload->interrupt_handler_size);
+}
+
+/* Returns the number of cycles that were executed. The number of instructions is only counted for 'CLOWNZ80_ENGINE_STEP'. */
+static unsigned long RunWorkload(const Workload* const workload, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const ClownZ80_Engine engine, const unsigned long total_cycles, unsigned long* const instructions_done)
+{
+	const unsigned long slice_cycles = workload->interrupt_interval != 0 ? workload->interrupt_interval : SLICE_CYCLES;
+	ClownZ80_State state;
+	unsigned long cycles_done;
+
+	LoadWorkload(workload);
+
+	ClownZ80_State_Initialise(&state);
+	ClownZ80_Reset(&state);
+
+	cycles_done = 0;
+	*instructions_done = 0;
+
+	while (cycles_done < total_cycles)
+	{
+		/* The excess from the previous slice is deducted from this one. */
+		const unsigned long slice_end = (cycles_done / slice_cycles + 1) * slice_cycles;
+
+		if (workload->interrupt_interval != 0)
+			ClownZ80_Interrupt(&state, cc_true);
+
+		if (engine == CLOWNZ80_ENGINE_STEP)
+		{
+			while (cycles_done < slice_end)
+			{
+				cycles_done += ClownZ80_DoInstruction(&state, callbacks);
+				++*instructions_done;
+			}
+		}
+		else
+		{
+			cycles_done += ClownZ80_Run(&state, callbacks, slice_end - cycles_done);
+		}
+	}
+
+	return cycles_done;
+}
+
+int main(const int argc, char** const argv)
+{
+	static ClownZ80_EngineResources engine_resources;
+
+	cc_bool csv = cc_false;
+	unsigned long total_cycles = DEFAULT_TOTAL_CYCLES;
+	size_t i;
+	int argument;
+
+	for (argument = 1; argument < argc; ++argument)
+	{
+		if (strcmp(argv[argument], "--csv") == 0)
+		{
+			csv = cc_true;
+		}
+		else if (sscanf(argv[argument], "%lu", &total_cycles) != 1 || total_cycles == 0)
+		{
+			fputs("Usage: clownz80-bench [--csv] [total cycles per workload]\n", stderr);
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (csv)
+		fputs("workload,engine,instructions,cycles,seconds,instructions_per_second,cycles_per_second,nanoseconds_per_instruction\n", stdout);
+	else
+		fprintf(stdout, "%-12s%-8s%14s%14s%12s\n", "Workload", "Engine", "Minstr/s", "Mcycles/s", "ns/instr");
+
+	for (i = 0; i < CC_COUNT_OF(workloads); ++i)
+	{
+		const Workload* const workload = &workloads[i];
+		unsigned long instructions = 0;
+		unsigned int engine;
+
+		for (engine = 0; engine < CLOWNZ80_TOTAL_ENGINES; ++engine)
+		{
+			ClownZ80_ReadAndWriteCallbacks callbacks;
+			clock_t start_time;
+			unsigned long cycles, instructions_done;
+			double seconds, instructions_per_second, cycles_per_second, nanoseconds_per_instruction;
+
+			ClownZ80_ReadAndWriteCallbacks_Initialise(&callbacks);
+			callbacks.read = ReadCallback;
+			callbacks.write = WriteCallback;
+			callbacks.log = LogCallback;
+
+			/* Each run gets fresh caches and a fresh JIT, so that it does not benefit from code compiled by an earlier one. */
+			if (!ClownZ80_EngineResources_Initialise(&engine_resources, (ClownZ80_Engine)engine, &callbacks, ram, sizeof(ram)))
+			{
+				fputs("The JIT is not available on this platform, so it will be skipped.\n", stderr);
+				continue;
+			}
+
+			start_time = clock();
+			cycles = RunWorkload(workload, &callbacks, (ClownZ80_Engine)engine, total_cycles, &instructions_done);
+			seconds = (double)(clock() - start_time) / CLOCKS_PER_SEC;
+
+			ClownZ80_EngineResources_Deinitialise(&engine_resources);
+
+			/* Every engine produces exactly the same results, so the instruction count of the first one applies to all of them. */
+			if (engine == CLOWNZ80_ENGINE_STEP)
+				instructions = instructions_done;
+
+			/* Avoid dividing by zero if the clock is too coarse. */
+			if (seconds <= 0.0)
+				seconds = 1.0 / CLOCKS_PER_SEC;
+
+			instructions_per_second = instructions / seconds;
+			cycles_per_second = cycles / seconds;
+			nanoseconds_per_instruction = seconds * 1000000000.0 / instructions;
+
+			if (csv)
+				fprintf(stdout, "%s,%s,%lu,%lu,%f,%.0f,%.0f,%f\n", workload->name, ClownZ80_Engine_GetName((ClownZ80_Engine)engine), instructions, cycles, seconds, instructions_per_second, cycles_per_second, nanoseconds_per_instruction);
+			else
+				fprintf(stdout, "%-12s%-8s%14.2f%14.2f%12.2f\n", workload->name, ClownZ80_Engine_GetName((ClownZ80_Engine)engine), instructions_per_second / 1000000.0, cycles_per_second / 1000000.0, nanoseconds_per_instruction);
+		}
+	}
+
+	return EXIT_SUCCESS;
+}
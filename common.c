@@ -23,6 +23,8 @@ void ClownZ80_DecodeInstructionMetadata(ClownZ80_InstructionMetadata* const meta
 	cc_u16f i;
 
 	metadata->has_displacement = cc_false;
+	metadata->condition = 0;
+	metadata->embedded_literal = 0;
 
 	metadata->operands[0] = CLOWNZ80_OPERAND_NONE;
 	metadata->operands[1] = CLOWNZ80_OPERAND_NONE;
@@ -349,17 +351,27 @@ void ClownZ80_DecodeInstructionMetadata(ClownZ80_InstructionMetadata* const meta
 					{
 						case 0:
 							if (y != 6)
+							{
 								metadata->opcode = CLOWNZ80_OPCODE_IN_REGISTER;
+								metadata->operands[1] = registers[y];
+							}
 							else
+							{
 								metadata->opcode = CLOWNZ80_OPCODE_IN_NO_REGISTER;
+							}
 
 							break;
 
 						case 1:
 							if (y != 6)
+							{
 								metadata->opcode = CLOWNZ80_OPCODE_OUT_REGISTER;
+								metadata->operands[0] = registers[y];
+							}
 							else
+							{
 								metadata->opcode = CLOWNZ80_OPCODE_OUT_NO_REGISTER;
+							}
 
 							break;
 
@@ -0,0 +1,1363 @@
+/* Generates a CP/M instruction exerciser, for 'cpm-test.c' to run when 'zexdoc' and 'zexall' are not to hand.
+
+   Like 'zexdoc', each group of test cases runs every combination of a handful of opcodes and register values, and
+   sums up the registers and memory that they leave behind with a CRC, which is then checked against the CRC that was
+   made when the exerciser was generated. Those CRCs come from running the exerciser with 'ClownZ80_DoInstruction', so
+   they catch the other engines disagreeing with it, rather than it disagreeing with a real Z80: that is what the
+   groups of known results, which were worked out by hand, are for. Each test case is run enough times in a row for the
+   block cache to compile it with the JIT, so every engine gets to run it. The results are printed in the same format
+   as 'zexdoc', with each group ending in either "OK" or "ERROR". */
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "clowncommon/clowncommon.h"
+
+#include "interpreter.h"
+
+/* CP/M programs are loaded here. */
+#define PROGRAM_ADDRESS 0x100
+/* The test case that is being run, as it is put together from its variant and dimensions. */
+#define CASE_ADDRESS 0xF000
+/* Where the test case leaves its registers and memory. */
+#define RESULTS_ADDRESS 0xF020
+/* Where the runner writes the CRC of each group, for the generator to read back. */
+#define CRC_LOG_ADDRESS 0xF100
+#define STACK_ADDRESS 0xF400
+/* The instruction that is being tested is copied into the runner here, and its branches go to TAKEN_ADDRESS. */
+#define SLOT_ADDRESS 0x01F0
+#define TAKEN_ADDRESS (SLOT_ADDRESS + 7)
+/* The 4 bytes of memory that the instructions being tested read and write. The stack starts in the middle of them. */
+#define MEMORY_ADDRESS (RESULTS_ADDRESS + OFFSET_MEMORY - OFFSET_F)
+/* The displacement that the instructions which use 'IX' and 'IY' are given. */
+#define DISPLACEMENT 1
+/* How many times each test case is run in a row: more than the block cache needs before it compiles a block with the JIT. */
+#define ITERATIONS_PER_CASE 20
+/* The flags which the known results are checked against: everything except bits 3 and 5. */
+#define DOCUMENTED_FLAGS 0xD7
+/* The names of the groups are padded with dots to this length, as 'zexdoc' does. */
+#define NAME_WIDTH 36
+/* The runner keeps the indices and descriptors of this many dimensions. */
+#define MAXIMUM_DIMENSIONS 8
+/* As many as fit between the CRC log and the runner's stack. */
+#define MAXIMUM_GROUPS 0x100
+/* Far more than the exerciser takes, in case it gets stuck. */
+#define MAXIMUM_CYCLES 10000000000.0
+/* The program must stay clear of the runner's variables. */
+#define MAXIMUM_PROGRAM_SIZE (CASE_ADDRESS - PROGRAM_ADDRESS)
+
+/* Where each byte of a test case is. The results are laid out the same way, but without the instruction. */
+enum
+{
+	OFFSET_INSTRUCTION = 0, /* 4 bytes, padded with NOPs. */
+	OFFSET_F = 4,
+	OFFSET_A,
+	OFFSET_C,
+	OFFSET_B,
+	OFFSET_E,
+	OFFSET_D,
+	OFFSET_L,
+	OFFSET_H,
+	OFFSET_IXL,
+	OFFSET_IXH,
+	OFFSET_IYL,
+	OFFSET_IYH,
+	OFFSET_F_,
+	OFFSET_A_,
+	OFFSET_C_,
+	OFFSET_B_,
+	OFFSET_E_,
+	OFFSET_D_,
+	OFFSET_L_,
+	OFFSET_H_,
+	OFFSET_SPL,
+	OFFSET_SPH,
+	OFFSET_MEMORY, /* 4 bytes. */
+	OFFSET_MARKER = OFFSET_MEMORY + 4, /* Written by the instruction after the one being tested, unless it branched. */
+	CASE_SIZE
+};
+
+/* Dimensions are given the bytes that they set as a mask of these. */
+#define AT(offset) (1UL << (offset))
+
+/* Instructions are packed into a number, with their first byte at the top, so that this puts an address in one. */
+#define WORD_AT(position, value) ((((unsigned long)(value) & 0xFF) << (8 * (3 - (position)))) | ((((unsigned long)(value) >> 8) & 0xFF) << (8 * (2 - (position)))))
+
+typedef struct Registers
+{
+	unsigned int af, bc, de, hl, ix, iy;
+	unsigned int af_, bc_, de_, hl_; /* Backup registers. */
+	unsigned int sp;
+	unsigned char memory[4];
+} Registers;
+
+/* A test case whose results were worked out by hand. Only the main registers and the first byte of memory are checked. */
+typedef struct TestCaseRegisters
+{
+	unsigned int af, bc, de, hl;
+	unsigned char memory;
+} TestCaseRegisters;
+
+typedef struct TestCase
+{
+	unsigned char instruction[4]; /* Padded with NOPs. */
+	TestCaseRegisters input, expected;
+} TestCase;
+
+typedef struct KnownResultGroup
+{
+	const char *name;
+	const TestCase *test_cases;
+	size_t total_test_cases;
+} KnownResultGroup;
+
+typedef struct Exerciser
+{
+	unsigned char program[MAXIMUM_PROGRAM_SIZE];
+	size_t program_size;
+	cc_bool too_large;
+	/* Where each group's CRC goes, so that it can be filled in once it is known. */
+	size_t crc_positions[MAXIMUM_GROUPS];
+	size_t total_groups;
+	/* Where the counts of the group and variant that are being written go. */
+	size_t total_variants_position, total_dimensions_position, total_checks_position;
+	cc_bool variant_open, checks_open;
+	/* The memory of the machine that the exerciser is run on to get its CRCs. */
+	cc_u8l ram[0x10000];
+} Exerciser;
+
+/* Runs every test case of every group, which follow it. Each test case is built in CASE_ADDRESS from its variant's
+   registers, with each of its variant's dimensions setting some of those bytes to one of its values, before its
+   instruction is copied into the runner at 01F0h and run. The dimensions are stepped through like the digits of a
+   counter, so that every combination of their values is run. */
+static const unsigned char runner[] = {
+	0x31, 0x00, 0xF4,        /* 0100: LD SP,STACK */
+	0x21, 0x00, 0xF1,        /* 0103: LD HL,CRC_LOG */
+	0x22, 0x42, 0xF0,        /* 0106: LD (CRC_LOG_POINTER),HL */
+	0x21, 0xDD, 0x02,        /* 0109: LD HL,GROUPS */
+	0x7E,                    /* 010C: LD A,(HL) */
+	0xB7,                    /* 010D: OR A */
+	0xCA, 0x00, 0x00,        /* 010E: JP Z,0000h */
+	0xEB,                    /* 0111: EX DE,HL */
+	0xD5,                    /* 0112: PUSH DE */
+	0x0E, 0x09,              /* 0113: LD C,9 */
+	0xCD, 0x05, 0x00,        /* 0115: CALL 0005h */
+	0xE1,                    /* 0118: POP HL */
+	0x7E,                    /* 0119: LD A,(HL) */
+	0x23,                    /* 011A: INC HL */
+	0xFE, 0x24,              /* 011B: CP '$' */
+	0x20, 0xFA,              /* 011D: JR NZ,0119h */
+	0x22, 0x70, 0xF0,        /* 011F: LD (EXPECTED),HL */
+	0x23,                    /* 0122: INC HL */
+	0x23,                    /* 0123: INC HL */
+	0x7E,                    /* 0124: LD A,(HL) */
+	0x32, 0x46, 0xF0,        /* 0125: LD (VARIANTS),A */
+	0x23,                    /* 0128: INC HL */
+	0xAF,                    /* 0129: XOR A */
+	0x32, 0x44, 0xF0,        /* 012A: LD (FAILED),A */
+	0x32, 0x40, 0xF0,        /* 012D: LD (CRC),A */
+	0x32, 0x41, 0xF0,        /* 0130: LD (CRC+1),A */
+	0x22, 0x48, 0xF0,        /* 0133: LD (VARIANT),HL */
+	0x11, 0x1F, 0x00,        /* 0136: LD DE,31 */
+	0x19,                    /* 0139: ADD HL,DE */
+	0x7E,                    /* 013A: LD A,(HL) */
+	0x32, 0x4A, 0xF0,        /* 013B: LD (DIMENSIONS),A */
+	0x23,                    /* 013E: INC HL */
+	0x11, 0x60, 0xF0,        /* 013F: LD DE,DESCRIPTORS */
+	0xDD, 0x21, 0x50, 0xF0,  /* 0142: LD IX,INDICES */
+	0xB7,                    /* 0146: OR A */
+	0x28, 0x1D,              /* 0147: JR Z,0166h */
+	0x47,                    /* 0149: LD B,A */
+	0xDD, 0x36, 0x00, 0x00,  /* 014A: LD (IX+0),0 */
+	0xDD, 0x23,              /* 014E: INC IX */
+	0xEB,                    /* 0150: EX DE,HL */
+	0x73,                    /* 0151: LD (HL),E */
+	0x23,                    /* 0152: INC HL */
+	0x72,                    /* 0153: LD (HL),D */
+	0x23,                    /* 0154: INC HL */
+	0xEB,                    /* 0155: EX DE,HL */
+	0x7E,                    /* 0156: LD A,(HL) */
+	0x3C,                    /* 0157: INC A */
+	0x85,                    /* 0158: ADD A,L */
+	0x6F,                    /* 0159: LD L,A */
+	0x30, 0x01,              /* 015A: JR NC,015Dh */
+	0x24,                    /* 015C: INC H */
+	0x7E,                    /* 015D: LD A,(HL) */
+	0x3C,                    /* 015E: INC A */
+	0x85,                    /* 015F: ADD A,L */
+	0x6F,                    /* 0160: LD L,A */
+	0x30, 0x01,              /* 0161: JR NC,0164h */
+	0x24,                    /* 0163: INC H */
+	0x10, 0xE4,              /* 0164: DJNZ 014Ah */
+	0x22, 0x4C, 0xF0,        /* 0166: LD (CHECKS),HL */
+	0x7E,                    /* 0169: LD A,(HL) */
+	0x87,                    /* 016A: ADD A,A */
+	0x86,                    /* 016B: ADD A,(HL) */
+	0x3C,                    /* 016C: INC A */
+	0x85,                    /* 016D: ADD A,L */
+	0x6F,                    /* 016E: LD L,A */
+	0x30, 0x01,              /* 016F: JR NC,0172h */
+	0x24,                    /* 0171: INC H */
+	0x22, 0x4E, 0xF0,        /* 0172: LD (NEXT),HL */
+	0x2A, 0x48, 0xF0,        /* 0175: LD HL,(VARIANT) */
+	0x11, 0x00, 0xF0,        /* 0178: LD DE,CASE */
+	0x01, 0x1F, 0x00,        /* 017B: LD BC,31 */
+	0xED, 0xB0,              /* 017E: LDIR */
+	0x3A, 0x4A, 0xF0,        /* 0180: LD A,(DIMENSIONS) */
+	0xB7,                    /* 0183: OR A */
+	0x28, 0x34,              /* 0184: JR Z,01BAh */
+	0x47,                    /* 0186: LD B,A */
+	0xDD, 0x21, 0x50, 0xF0,  /* 0187: LD IX,INDICES */
+	0xFD, 0x21, 0x60, 0xF0,  /* 018B: LD IY,DESCRIPTORS */
+	0xFD, 0x6E, 0x00,        /* 018F: LD L,(IY+0) */
+	0xFD, 0x66, 0x01,        /* 0192: LD H,(IY+1) */
+	0x4E,                    /* 0195: LD C,(HL) */
+	0x5D,                    /* 0196: LD E,L */
+	0x54,                    /* 0197: LD D,H */
+	0x79,                    /* 0198: LD A,C */
+	0x3C,                    /* 0199: INC A */
+	0x85,                    /* 019A: ADD A,L */
+	0x6F,                    /* 019B: LD L,A */
+	0x30, 0x01,              /* 019C: JR NC,019Fh */
+	0x24,                    /* 019E: INC H */
+	0x23,                    /* 019F: INC HL */
+	0xDD, 0x7E, 0x00,        /* 01A0: LD A,(IX+0) */
+	0x85,                    /* 01A3: ADD A,L */
+	0x6F,                    /* 01A4: LD L,A */
+	0x30, 0x01,              /* 01A5: JR NC,01A8h */
+	0x24,                    /* 01A7: INC H */
+	0x7E,                    /* 01A8: LD A,(HL) */
+	0xEB,                    /* 01A9: EX DE,HL */
+	0x16, 0xF0,              /* 01AA: LD D,CASE >> 8 */
+	0x23,                    /* 01AC: INC HL */
+	0x5E,                    /* 01AD: LD E,(HL) */
+	0x12,                    /* 01AE: LD (DE),A */
+	0x0D,                    /* 01AF: DEC C */
+	0x20, 0xFA,              /* 01B0: JR NZ,01ACh */
+	0xDD, 0x23,              /* 01B2: INC IX */
+	0xFD, 0x23,              /* 01B4: INC IY */
+	0xFD, 0x23,              /* 01B6: INC IY */
+	0x10, 0xD5,              /* 01B8: DJNZ 018Fh */
+	0x21, 0x00, 0xF0,        /* 01BA: LD HL,CASE */
+	0x11, 0xF0, 0x01,        /* 01BD: LD DE,01F0h */
+	0x01, 0x04, 0x00,        /* 01C0: LD BC,4 */
+	0xED, 0xB0,              /* 01C3: LDIR */
+	0x3E, ITERATIONS_PER_CASE, /* 01C5: LD A,ITERATIONS_PER_CASE */
+	0x32, 0x45, 0xF0,        /* 01C7: LD (ITERATIONS),A */
+	0x21, 0x1A, 0xF0,        /* 01CA: LD HL,INPUT+22 */
+	0x11, 0x36, 0xF0,        /* 01CD: LD DE,RESULTS+22 */
+	0x01, 0x05, 0x00,        /* 01D0: LD BC,5 */
+	0xED, 0xB0,              /* 01D3: LDIR */
+	0x31, 0x10, 0xF0,        /* 01D5: LD SP,INPUT+12 */
+	0xF1,                    /* 01D8: POP AF */
+	0xC1,                    /* 01D9: POP BC */
+	0xD1,                    /* 01DA: POP DE */
+	0xE1,                    /* 01DB: POP HL */
+	0xD9,                    /* 01DC: EXX */
+	0x08,                    /* 01DD: EX AF,AF' */
+	0x31, 0x04, 0xF0,        /* 01DE: LD SP,INPUT */
+	0xF1,                    /* 01E1: POP AF */
+	0xC1,                    /* 01E2: POP BC */
+	0xD1,                    /* 01E3: POP DE */
+	0xE1,                    /* 01E4: POP HL */
+	0xDD, 0xE1,              /* 01E5: POP IX */
+	0xFD, 0xE1,              /* 01E7: POP IY */
+	0xED, 0x7B, 0x18, 0xF0,  /* 01E9: LD SP,(INPUT+20) */
+	0xC3, 0xF0, 0x01,        /* 01ED: JP 01F0h */
+	0x00, 0x00, 0x00, 0x00,  /* 01F0: The instruction. */
+	0x32, 0x3A, 0xF0,        /* 01F4: LD (RESULTS+26),A */
+	0xED, 0x73, 0x34, 0xF0,  /* 01F7: LD (RESULTS+20),SP */
+	0x31, 0x2C, 0xF0,        /* 01FB: LD SP,RESULTS+12 */
+	0xFD, 0xE5,              /* 01FE: PUSH IY */
+	0xDD, 0xE5,              /* 0200: PUSH IX */
+	0xE5,                    /* 0202: PUSH HL */
+	0xD5,                    /* 0203: PUSH DE */
+	0xC5,                    /* 0204: PUSH BC */
+	0xF5,                    /* 0205: PUSH AF */
+	0xD9,                    /* 0206: EXX */
+	0x08,                    /* 0207: EX AF,AF' */
+	0x31, 0x34, 0xF0,        /* 0208: LD SP,RESULTS+20 */
+	0xE5,                    /* 020B: PUSH HL */
+	0xD5,                    /* 020C: PUSH DE */
+	0xC5,                    /* 020D: PUSH BC */
+	0xF5,                    /* 020E: PUSH AF */
+	0x31, 0x00, 0xF4,        /* 020F: LD SP,STACK */
+	0x21, 0x45, 0xF0,        /* 0212: LD HL,ITERATIONS */
+	0x35,                    /* 0215: DEC (HL) */
+	0xC2, 0xCA, 0x01,        /* 0216: JP NZ,01CAh */
+	0x21, 0x20, 0xF0,        /* 0219: LD HL,RESULTS */
+	0x06, 0x1B,              /* 021C: LD B,27 */
+	0xED, 0x5B, 0x40, 0xF0,  /* 021E: LD DE,(CRC) */
+	0x7E,                    /* 0222: LD A,(HL) */
+	0xAA,                    /* 0223: XOR D */
+	0x57,                    /* 0224: LD D,A */
+	0x0E, 0x08,              /* 0225: LD C,8 */
+	0xCB, 0x23,              /* 0227: SLA E */
+	0xCB, 0x12,              /* 0229: RL D */
+	0x30, 0x08,              /* 022B: JR NC,0235h */
+	0x7A,                    /* 022D: LD A,D */
+	0xEE, 0x10,              /* 022E: XOR 10h */
+	0x57,                    /* 0230: LD D,A */
+	0x7B,                    /* 0231: LD A,E */
+	0xEE, 0x21,              /* 0232: XOR 21h */
+	0x5F,                    /* 0234: LD E,A */
+	0x0D,                    /* 0235: DEC C */
+	0x20, 0xEF,              /* 0236: JR NZ,0227h */
+	0x23,                    /* 0238: INC HL */
+	0x10, 0xE7,              /* 0239: DJNZ 0222h */
+	0xED, 0x53, 0x40, 0xF0,  /* 023B: LD (CRC),DE */
+	0x2A, 0x4C, 0xF0,        /* 023F: LD HL,(CHECKS) */
+	0x46,                    /* 0242: LD B,(HL) */
+	0x04,                    /* 0243: INC B */
+	0x05,                    /* 0244: DEC B */
+	0x28, 0x0E,              /* 0245: JR Z,0255h */
+	0x23,                    /* 0247: INC HL */
+	0x5E,                    /* 0248: LD E,(HL) */
+	0x16, 0xF0,              /* 0249: LD D,RESULTS >> 8 */
+	0x23,                    /* 024B: INC HL */
+	0x1A,                    /* 024C: LD A,(DE) */
+	0xA6,                    /* 024D: AND (HL) */
+	0x23,                    /* 024E: INC HL */
+	0xBE,                    /* 024F: CP (HL) */
+	0xC4, 0xC6, 0x02,        /* 0250: CALL NZ,02C6h */
+	0x10, 0xF2,              /* 0253: DJNZ 0247h */
+	0x3A, 0x4A, 0xF0,        /* 0255: LD A,(DIMENSIONS) */
+	0xB7,                    /* 0258: OR A */
+	0x28, 0x2C,              /* 0259: JR Z,0287h */
+	0x47,                    /* 025B: LD B,A */
+	0xDD, 0x21, 0x50, 0xF0,  /* 025C: LD IX,INDICES */
+	0xFD, 0x21, 0x60, 0xF0,  /* 0260: LD IY,DESCRIPTORS */
+	0xFD, 0x6E, 0x00,        /* 0264: LD L,(IY+0) */
+	0xFD, 0x66, 0x01,        /* 0267: LD H,(IY+1) */
+	0x7E,                    /* 026A: LD A,(HL) */
+	0x3C,                    /* 026B: INC A */
+	0x85,                    /* 026C: ADD A,L */
+	0x6F,                    /* 026D: LD L,A */
+	0x30, 0x01,              /* 026E: JR NC,0271h */
+	0x24,                    /* 0270: INC H */
+	0xDD, 0x34, 0x00,        /* 0271: INC (IX+0) */
+	0xDD, 0x7E, 0x00,        /* 0274: LD A,(IX+0) */
+	0xBE,                    /* 0277: CP (HL) */
+	0xDA, 0x75, 0x01,        /* 0278: JP C,0175h */
+	0xDD, 0x36, 0x00, 0x00,  /* 027B: LD (IX+0),0 */
+	0xDD, 0x23,              /* 027F: INC IX */
+	0xFD, 0x23,              /* 0281: INC IY */
+	0xFD, 0x23,              /* 0283: INC IY */
+	0x10, 0xDD,              /* 0285: DJNZ 0264h */
+	0x2A, 0x4E, 0xF0,        /* 0287: LD HL,(NEXT) */
+	0x3A, 0x46, 0xF0,        /* 028A: LD A,(VARIANTS) */
+	0x3D,                    /* 028D: DEC A */
+	0x32, 0x46, 0xF0,        /* 028E: LD (VARIANTS),A */
+	0xC2, 0x33, 0x01,        /* 0291: JP NZ,0133h */
+	0xE5,                    /* 0294: PUSH HL */
+	0xED, 0x5B, 0x40, 0xF0,  /* 0295: LD DE,(CRC) */
+	0x2A, 0x42, 0xF0,        /* 0299: LD HL,(CRC_LOG_POINTER) */
+	0x73,                    /* 029C: LD (HL),E */
+	0x23,                    /* 029D: INC HL */
+	0x72,                    /* 029E: LD (HL),D */
+	0x23,                    /* 029F: INC HL */
+	0x22, 0x42, 0xF0,        /* 02A0: LD (CRC_LOG_POINTER),HL */
+	0x2A, 0x70, 0xF0,        /* 02A3: LD HL,(EXPECTED) */
+	0x7E,                    /* 02A6: LD A,(HL) */
+	0xBB,                    /* 02A7: CP E */
+	0xC4, 0xC6, 0x02,        /* 02A8: CALL NZ,02C6h */
+	0x23,                    /* 02AB: INC HL */
+	0x7E,                    /* 02AC: LD A,(HL) */
+	0xBA,                    /* 02AD: CP D */
+	0xC4, 0xC6, 0x02,        /* 02AE: CALL NZ,02C6h */
+	0x3A, 0x44, 0xF0,        /* 02B1: LD A,(FAILED) */
+	0xB7,                    /* 02B4: OR A */
+	0x11, 0xCC, 0x02,        /* 02B5: LD DE,02CCh */
+	0x28, 0x03,              /* 02B8: JR Z,02BDh */
+	0x11, 0xD3, 0x02,        /* 02BA: LD DE,02D3h */
+	0x0E, 0x09,              /* 02BD: LD C,9 */
+	0xCD, 0x05, 0x00,        /* 02BF: CALL 0005h */
+	0xE1,                    /* 02C2: POP HL */
+	0xC3, 0x0C, 0x01,        /* 02C3: JP 010Ch */
+	0x3E, 0x01,              /* 02C6: LD A,1 */
+	0x32, 0x44, 0xF0,        /* 02C8: LD (FAILED),A */
+	0xC9,                    /* 02CB: RET */
+	' ', ' ', 'O', 'K', '\r', '\n', '$',                     /* 02CC */
+	' ', ' ', 'E', 'R', 'R', 'O', 'R', '\r', '\n', '$'       /* 02D3 */
+	                                                         /* 02DD: GROUPS */
+};
+
+/* Each register holds something different, so that it is obvious when one is copied to another. 'HL', 'IX', and
+   'IY' point to the memory, and the stack holds the address that returns go to. */
+static const Registers default_registers = {
+	0xA500, 0x1234, 0x5678, MEMORY_ADDRESS, MEMORY_ADDRESS - DISPLACEMENT, MEMORY_ADDRESS - DISPLACEMENT,
+	0x3CC3, 0x9ABC, 0xDEF0, 0x1357,
+	MEMORY_ADDRESS + 2,
+	{0x5A, 0xC3, TAKEN_ADDRESS & 0xFF, TAKEN_ADDRESS >> 8}
+};
+
+/* Values either side of where the carries and overflows happen. */
+static const unsigned char bytes[] = {0x00, 0x01, 0x0F, 0x7F, 0x80, 0xFF};
+/* The same, for the halves of 16-bit values. */
+static const unsigned char low_bytes[] = {0x00, 0xFF};
+static const unsigned char high_bytes[] = {0x00, 0x7F, 0x80, 0xFF};
+/* For the bit operations, which do not need as many. */
+static const unsigned char bit_bytes[] = {0x00, 0x81, 0xFF};
+/* No flags, and every flag, including the undocumented ones. */
+static const unsigned char flags[] = {0x00, 0xFF};
+/* Every condition both true and false. */
+static const unsigned char conditions[] = {0x00, 0x01, 0x04, 0x40, 0x80, 0xFF};
+/* Every combination of the flags that 'DAA' uses. */
+static const unsigned char daa_flags[] = {0x00, 0x01, 0x02, 0x03, 0x10, 0x11, 0x12, 0x13};
+
+/* The flags. */
+#define S 0x80
+#define Z 0x40
+#define H 0x10
+#define V 0x04
+#define N 0x02
+#define C 0x01
+
+static const TestCase add[] = {
+	{{0xC6, 0x01}, {0x7F00, 0, 0, 0, 0}, {0x8000 | S | H | V, 0, 0, 0, 0}}, /* ADD A,01h */
+	{{0xC6, 0x01}, {0xFF00, 0, 0, 0, 0}, {0x0000 | Z | H | C, 0, 0, 0, 0}},
+	{{0xC6, 0x80}, {0x8000, 0, 0, 0, 0}, {0x0000 | Z | V | C, 0, 0, 0, 0}}  /* ADD A,80h */
+};
+
+static const TestCase sub[] = {
+	{{0xD6, 0x01}, {0x0000, 0, 0, 0, 0}, {0xFF00 | S | H | N | C, 0, 0, 0, 0}}, /* SUB 01h */
+	{{0xD6, 0x01}, {0x8000, 0, 0, 0, 0}, {0x7F00 | H | V | N, 0, 0, 0, 0}},
+	{{0xD6, 0x42}, {0x4200, 0, 0, 0, 0}, {0x0000 | Z | N, 0, 0, 0, 0}}          /* SUB 42h */
+};
+
+static const TestCase logic[] = {
+	{{0xE6, 0x0F}, {0x3C00, 0, 0, 0, 0}, {0x0C00 | H | V, 0, 0, 0, 0}}, /* AND 0Fh */
+	{{0xF6, 0x80}, {0x0100, 0, 0, 0, 0}, {0x8100 | S | V, 0, 0, 0, 0}}, /* OR 80h */
+	{{0xEE, 0xFF}, {0xFF00, 0, 0, 0, 0}, {0x0000 | Z | V, 0, 0, 0, 0}}  /* XOR 0FFh */
+};
+
+static const TestCase compare[] = {
+	{{0xFE, 0x20}, {0x1000, 0, 0, 0, 0}, {0x1000 | S | N | C, 0, 0, 0, 0}}, /* CP 20h */
+	{{0xFE, 0x20}, {0x2000, 0, 0, 0, 0}, {0x2000 | Z | N, 0, 0, 0, 0}}
+};
+
+static const TestCase increment[] = {
+	{{0x3C}, {0x7F00 | C, 0, 0, 0, 0}, {0x8000 | S | H | V | C, 0, 0, 0, 0}},                 /* INC A */
+	{{0x05}, {0x0000, 0x0100, 0, 0, 0}, {0x0000 | Z | N, 0x0000, 0, 0, 0}},                  /* DEC B */
+	{{0x0D}, {0x0000, 0x0000, 0, 0, 0}, {0x0000 | S | H | N, 0x00FF, 0, 0, 0}},              /* DEC C */
+	{{0x34}, {0x0000, 0, 0, MEMORY_ADDRESS, 0xFF}, {0x0000 | Z | H, 0, 0, MEMORY_ADDRESS, 0x00}} /* INC (HL) */
+};
+
+static const TestCase add16[] = {
+	{{0x19}, {0x0000, 0, 0x0001, 0x0FFF, 0}, {0x0000 | H, 0, 0x0001, 0x1000, 0}},                       /* ADD HL,DE */
+	{{0x09}, {0x0000 | S | Z | V, 0x8000, 0, 0x8000, 0}, {0x0000 | S | Z | V | C, 0x8000, 0, 0x0000, 0}}, /* ADD HL,BC */
+	{{0xED, 0x4A}, {0x0000 | C, 0x0000, 0, 0x7FFF, 0}, {0x0000 | S | H | V, 0x0000, 0, 0x8000, 0}},      /* ADC HL,BC */
+	{{0xED, 0x52}, {0x0000, 0, 0x1000, 0x1000, 0}, {0x0000 | Z | N, 0, 0x1000, 0x0000, 0}},              /* SBC HL,DE */
+	{{0xED, 0x52}, {0x0000, 0, 0x0001, 0x0000, 0}, {0x0000 | S | H | N | C, 0, 0x0001, 0xFFFF, 0}}
+};
+
+static const TestCase rotate[] = {
+	{{0x07}, {0x8100, 0, 0, 0, 0}, {0x0300 | C, 0, 0, 0, 0}},                                                  /* RLCA */
+	{{0x1F}, {0x0100, 0, 0, 0, 0}, {0x0000 | C, 0, 0, 0, 0}},                                                  /* RRA */
+	{{0xCB, 0x10}, {0x0000, 0x8000, 0, 0, 0}, {0x0000 | Z | V | C, 0x0000, 0, 0, 0}},                          /* RL B */
+	{{0xCB, 0x3E}, {0x0000, 0, 0, MEMORY_ADDRESS, 0x01}, {0x0000 | Z | V | C, 0, 0, MEMORY_ADDRESS, 0x00}},    /* SRL (HL) */
+	{{0xED, 0x6F}, {0x1200 | C, 0, 0, MEMORY_ADDRESS, 0x34}, {0x1300 | C, 0, 0, MEMORY_ADDRESS, 0x42}},        /* RLD */
+	{{0xED, 0x67}, {0x1200, 0, 0, MEMORY_ADDRESS, 0x34}, {0x1400 | V, 0, 0, MEMORY_ADDRESS, 0x23}}             /* RRD */
+};
+
+static const TestCase accumulator[] = {
+	{{0x27}, {0x3C00, 0, 0, 0, 0}, {0x4200 | H | V, 0, 0, 0, 0}},               /* DAA */
+	{{0x2F}, {0x5A00, 0, 0, 0, 0}, {0xA500 | H | N, 0, 0, 0, 0}},               /* CPL */
+	{{0xED, 0x44}, {0x0100, 0, 0, 0, 0}, {0xFF00 | S | H | N | C, 0, 0, 0, 0}}, /* NEG */
+	{{0xED, 0x44}, {0x8000, 0, 0, 0, 0}, {0x8000 | S | V | N | C, 0, 0, 0, 0}},
+	{{0x37}, {0x0000 | H | N, 0, 0, 0, 0}, {0x0000 | C, 0, 0, 0, 0}},           /* SCF */
+	{{0x3F}, {0x0000 | C, 0, 0, 0, 0}, {0x0000 | H, 0, 0, 0, 0}}                /* CCF */
+};
+
+static const TestCase bits[] = {
+	{{0xCB, 0x47}, {0x0000 | C, 0, 0, 0, 0}, {0x0000 | Z | H | V | C, 0, 0, 0, 0}},                 /* BIT 0,A */
+	{{0xCB, 0xD8}, {0x0000, 0x0000, 0, 0, 0}, {0x0000, 0x0800, 0, 0, 0}},                            /* SET 3,B */
+	{{0xCB, 0x86}, {0x0000, 0, 0, MEMORY_ADDRESS, 0xFF}, {0x0000, 0, 0, MEMORY_ADDRESS, 0xFE}}      /* RES 0,(HL) */
+};
+
+static const TestCase load[] = {
+	{{0x77}, {0x5A00, 0, 0, MEMORY_ADDRESS, 0x00}, {0x5A00, 0, 0, MEMORY_ADDRESS, 0x5A}},             /* LD (HL),A */
+	{{0x46}, {0x0000, 0x0000, 0, MEMORY_ADDRESS, 0xA5}, {0x0000, 0xA500, 0, MEMORY_ADDRESS, 0xA5}},   /* LD B,(HL) */
+	{{0xEB}, {0x0000, 0, 0x1234, 0x5678, 0}, {0x0000, 0, 0x5678, 0x1234, 0}}                          /* EX DE,HL */
+};
+
+static const TestCase block[] = {
+	{{0xED, 0xA0}, {0x0000, 0x0002, MEMORY_ADDRESS, MEMORY_ADDRESS, 0x77}, {0x0000 | V, 0x0001, MEMORY_ADDRESS + 1, MEMORY_ADDRESS + 1, 0x77}},             /* LDI */
+	{{0xED, 0xA8}, {0x0000 | S | Z | C, 0x0001, MEMORY_ADDRESS, MEMORY_ADDRESS, 0x77}, {0x0000 | S | Z | C, 0x0000, MEMORY_ADDRESS - 1, MEMORY_ADDRESS - 1, 0x77}}, /* LDD */
+	{{0xED, 0xA1}, {0x7700 | C, 0x0001, 0, MEMORY_ADDRESS, 0x77}, {0x7700 | Z | N | C, 0x0000, 0, MEMORY_ADDRESS + 1, 0x77}}                             /* CPI */
+};
+
+#undef S
+#undef Z
+#undef H
+#undef V
+#undef N
+#undef C
+
+#define GROUP(name, test_cases) {name, test_cases, CC_COUNT_OF(test_cases)}
+
+static const KnownResultGroup known_result_groups[] = {
+	GROUP("add a,n (known results)", add),
+	GROUP("sub n (known results)", sub),
+	GROUP("and,or,xor n (known results)", logic),
+	GROUP("cp n (known results)", compare),
+	GROUP("inc,dec r (known results)", increment),
+	GROUP("add,adc,sbc hl,rr (known results)", add16),
+	GROUP("rotates,shifts (known results)", rotate),
+	GROUP("daa,cpl,neg,scf,ccf (known results)", accumulator),
+	GROUP("bit,set,res (known results)", bits),
+	GROUP("ld,ex (known results)", load),
+	GROUP("ldi,ldd,cpi (known results)", block)
+};
+
+static Exerciser exerciser;
+
+static void EmitByte(Exerciser* const exerciser, const unsigned int value)
+{
+	if (exerciser->program_size == sizeof(exerciser->program))
+		exerciser->too_large = cc_true;
+	else
+		exerciser->program[exerciser->program_size++] = value & 0xFF;
+}
+
+static void EmitWord(Exerciser* const exerciser, const unsigned int value)
+{
+	EmitByte(exerciser, value & 0xFF);
+	EmitByte(exerciser, (value >> 8) & 0xFF);
+}
+
+/* Bumps one of the counts at the start of a group, variant, or list of checks. */
+static void IncrementCount(Exerciser* const exerciser, const size_t position, const unsigned int maximum)
+{
+	if (exerciser->program[position] == maximum)
+		exerciser->too_large = cc_true;
+	else
+		++exerciser->program[position];
+}
+
+static void FinishVariant(Exerciser* const exerciser)
+{
+	if (exerciser->variant_open && !exerciser->checks_open)
+		EmitByte(exerciser, 0);
+
+	exerciser->variant_open = exerciser->checks_open = cc_false;
+}
+
+static void BeginGroup(Exerciser* const exerciser, const char* const name)
+{
+	size_t i;
+
+	for (i = 0; name[i] != '\0'; ++i)
+		EmitByte(exerciser, name[i]);
+
+	for (; i < NAME_WIDTH; ++i)
+		EmitByte(exerciser, '.');
+
+	EmitByte(exerciser, '$');
+
+	if (exerciser->total_groups == CC_COUNT_OF(exerciser->crc_positions))
+		exerciser->too_large = cc_true;
+	else
+		exerciser->crc_positions[exerciser->total_groups++] = exerciser->program_size;
+
+	/* Filled in after the exerciser has been run. */
+	EmitWord(exerciser, 0);
+
+	exerciser->total_variants_position = exerciser->program_size;
+	EmitByte(exerciser, 0);
+}
+
+static void EndGroup(Exerciser* const exerciser)
+{
+	FinishVariant(exerciser);
+}
+
+/* 'instruction' holds the instruction's bytes, with the first at the top, padded with NOPs. */
+static void BeginVariant(Exerciser* const exerciser, const unsigned long instruction, const Registers* const registers)
+{
+	FinishVariant(exerciser);
+	IncrementCount(exerciser, exerciser->total_variants_position, 0xFF);
+
+	EmitByte(exerciser, (instruction >> 24) & 0xFF);
+	EmitByte(exerciser, (instruction >> 16) & 0xFF);
+	EmitByte(exerciser, (instruction >> 8) & 0xFF);
+	EmitByte(exerciser, (instruction >> 0) & 0xFF);
+	/* In the order that the runner pops them. */
+	EmitWord(exerciser, registers->af);
+	EmitWord(exerciser, registers->bc);
+	EmitWord(exerciser, registers->de);
+	EmitWord(exerciser, registers->hl);
+	EmitWord(exerciser, registers->ix);
+	EmitWord(exerciser, registers->iy);
+	EmitWord(exerciser, registers->af_);
+	EmitWord(exerciser, registers->bc_);
+	EmitWord(exerciser, registers->de_);
+	EmitWord(exerciser, registers->hl_);
+	EmitWord(exerciser, registers->sp);
+	EmitByte(exerciser, registers->memory[0]);
+	EmitByte(exerciser, registers->memory[1]);
+	EmitByte(exerciser, registers->memory[2]);
+	EmitByte(exerciser, registers->memory[3]);
+	/* The marker. */
+	EmitByte(exerciser, 0);
+
+	exerciser->total_dimensions_position = exerciser->program_size;
+	EmitByte(exerciser, 0);
+
+	exerciser->variant_open = cc_true;
+}
+
+/* Makes the variant run once for each value, with every byte in 'offsets' being set to it. */
+static void AddDimension(Exerciser* const exerciser, const unsigned long offsets, const unsigned char* const values, const size_t total_values)
+{
+	unsigned int total_offsets = 0;
+	unsigned int offset;
+	size_t i;
+
+	IncrementCount(exerciser, exerciser->total_dimensions_position, MAXIMUM_DIMENSIONS);
+
+	for (offset = 0; offset < CASE_SIZE; ++offset)
+		if ((offsets & AT(offset)) != 0)
+			++total_offsets;
+
+	/* The runner cannot handle a dimension that does nothing, or has too many values to count in a byte. */
+	if (total_offsets == 0 || total_values == 0 || total_values > 0xFF)
+		exerciser->too_large = cc_true;
+
+	EmitByte(exerciser, total_offsets);
+
+	for (offset = 0; offset < CASE_SIZE; ++offset)
+		if ((offsets & AT(offset)) != 0)
+			EmitByte(exerciser, (CASE_ADDRESS & 0xFF) + offset);
+
+	EmitByte(exerciser, total_values);
+
+	for (i = 0; i < total_values; ++i)
+		EmitByte(exerciser, values[i]);
+}
+
+#define ADD_DIMENSION(exerciser, offsets, values) AddDimension(exerciser, offsets, values, CC_COUNT_OF(values))
+
+/* A dimension of consecutive values, such as a range of opcodes. */
+static void AddRange(Exerciser* const exerciser, const unsigned long offsets, const unsigned int first, const unsigned int total)
+{
+	unsigned char values[0xFF];
+	unsigned int i;
+
+	for (i = 0; i < total && i < CC_COUNT_OF(values); ++i)
+		values[i] = (first + i) & 0xFF;
+
+	AddDimension(exerciser, offsets, values, total);
+}
+
+/* Makes every test case of the variant check that one of its results, masked, holds a value. */
+static void AddCheck(Exerciser* const exerciser, const unsigned int offset, const unsigned int mask, const unsigned int value)
+{
+	if (!exerciser->checks_open)
+	{
+		exerciser->total_checks_position = exerciser->program_size;
+		EmitByte(exerciser, 0);
+		exerciser->checks_open = cc_true;
+	}
+
+	IncrementCount(exerciser, exerciser->total_checks_position, 0xFF);
+
+	EmitByte(exerciser, (RESULTS_ADDRESS & 0xFF) + offset - OFFSET_F);
+	EmitByte(exerciser, mask);
+	EmitByte(exerciser, value);
+}
+
+static void AddArithmeticGroups(Exerciser* const exerciser)
+{
+	static const unsigned char immediate_opcodes[] = {0xC6, 0xCE, 0xD6, 0xDE, 0xE6, 0xEE, 0xF6, 0xFE};
+	static const unsigned char index_register_opcodes[] = {0x84, 0x85, 0x8C, 0x8D, 0x94, 0x95, 0x9C, 0x9D, 0xA4, 0xA5, 0xAC, 0xAD, 0xB4, 0xB5, 0xBC, 0xBD};
+	static const unsigned char index_memory_opcodes[] = {0x86, 0x8E, 0x96, 0x9E, 0xA6, 0xAE, 0xB6, 0xBE};
+	static const unsigned char increment_opcodes[] = {0x04, 0x05, 0x0C, 0x0D, 0x14, 0x15, 0x1C, 0x1D, 0x24, 0x25, 0x2C, 0x2D, 0x34, 0x35, 0x3C, 0x3D};
+	static const unsigned char index_increment_opcodes[] = {0x24, 0x25, 0x2C, 0x2D};
+	static const unsigned char index_memory_increment_opcodes[] = {0x34, 0x35};
+	static const unsigned char increment_16_opcodes[] = {0x03, 0x0B, 0x13, 0x1B, 0x23, 0x2B, 0x33, 0x3B};
+	static const unsigned char index_increment_16_opcodes[] = {0x23, 0x2B};
+	static const unsigned char add_16_opcodes[] = {0x09, 0x19, 0x29, 0x39};
+	static const unsigned char carry_16_opcodes[] = {0x42, 0x4A, 0x52, 0x5A, 0x62, 0x6A, 0x72, 0x7A};
+	static const unsigned char accumulator_opcodes[] = {0x2F, 0x37, 0x3F};
+	static const unsigned char negate_opcodes[] = {0x44, 0x4C, 0x54, 0x5C, 0x64, 0x6C, 0x74, 0x7C};
+	static const unsigned char rotate_opcodes[] = {0x07, 0x0F, 0x17, 0x1F};
+
+	const unsigned long pair_low_bytes = AT(OFFSET_C) | AT(OFFSET_E) | AT(OFFSET_SPL);
+	const unsigned long pair_high_bytes = AT(OFFSET_B) | AT(OFFSET_D) | AT(OFFSET_SPH);
+	unsigned int i;
+
+	BeginGroup(exerciser, "aluop a,<b,c,d,e,h,l,(hl),a>");
+	BeginVariant(exerciser, 0x80000000, &default_registers);
+	AddRange(exerciser, AT(OFFSET_INSTRUCTION), 0x80, 0x40);
+	ADD_DIMENSION(exerciser, AT(OFFSET_A), bytes);
+	ADD_DIMENSION(exerciser, AT(OFFSET_B) | AT(OFFSET_C) | AT(OFFSET_D) | AT(OFFSET_E) | AT(OFFSET_MEMORY), bytes);
+	ADD_DIMENSION(exerciser, AT(OFFSET_F), flags);
+	EndGroup(exerciser);
+
+	BeginGroup(exerciser, "aluop a,nn");
+	BeginVariant(exerciser, 0xC6000000, &default_registers);
+	ADD_DIMENSION(exerciser, AT(OFFSET_INSTRUCTION), immediate_opcodes);
+	ADD_DIMENSION(exerciser, AT(OFFSET_INSTRUCTION + 1), bytes);
+	ADD_DIMENSION(exerciser, AT(OFFSET_A), bytes);
+	ADD_DIMENSION(exerciser, AT(OFFSET_F), flags);
+	EndGroup(exerciser);
+
+	BeginGroup(exerciser, "aluop a,<ixh,ixl,iyh,iyl>");
+
+	for (i = 0; i < 2; ++i)
+	{
+		BeginVariant(exerciser, (i == 0 ? 0xDD000000 : 0xFD000000) | 0x840000, &default_registers);
+		ADD_DIMENSION(exerciser, AT(OFFSET_INSTRUCTION + 1), index_register_opcodes);
+		ADD_DIMENSION(exerciser, AT(OFFSET_A), bytes);
+		ADD_DIMENSION(exerciser, i == 0 ? AT(OFFSET_IXL) | AT(OFFSET_IXH) : AT(OFFSET_IYL) | AT(OFFSET_IYH), bytes);
+		ADD_DIMENSION(exerciser, AT(OFFSET_F), flags);
+	}
+
+	EndGroup(exerciser);
+
+	BeginGroup(exerciser, "aluop a,(<ix,iy>+1)");
+
+	for (i = 0; i < 2; ++i)
+	{
+		BeginVariant(exerciser, (i == 0 ? 0xDD000000 : 0xFD000000) | 0x860000 | DISPLACEMENT << 8, &default_registers);
+		ADD_DIMENSION(exerciser, AT(OFFSET_INSTRUCTION + 1), index_memory_opcodes);
+		ADD_DIMENSION(exerciser, AT(OFFSET_A), bytes);
+		ADD_DIMENSION(exerciser, AT(OFFSET_MEMORY), bytes);
+		ADD_DIMENSION(exerciser, AT(OFFSET_F), flags);
+	}
+
+	EndGroup(exerciser);
+
+	BeginGroup(exerciser, "<inc,dec> <b,c,d,e,h,l,(hl),a>");
+	BeginVariant(exerciser, 0x04000000, &default_registers);
+	ADD_DIMENSION(exerciser, AT(OFFSET_INSTRUCTION), increment_opcodes);
+	ADD_DIMENSION(exerciser, AT(OFFSET_A) | AT(OFFSET_B) | AT(OFFSET_C) | AT(OFFSET_D) | AT(OFFSET_E) | AT(OFFSET_MEMORY), bytes);
+	ADD_DIMENSION(exerciser, AT(OFFSET_F), flags);
+	EndGroup(exerciser);
+
+	BeginGroup(exerciser, "<inc,dec> <ixh,ixl,iyh,iyl>");
+
+	for (i = 0; i < 2; ++i)
+	{
+		BeginVariant(exerciser, (i == 0 ? 0xDD000000 : 0xFD000000) | 0x240000, &default_registers);
+		ADD_DIMENSION(exerciser, AT(OFFSET_INSTRUCTION + 1), index_increment_opcodes);
+		ADD_DIMENSION(exerciser, i == 0 ? AT(OFFSET_IXL) | AT(OFFSET_IXH) : AT(OFFSET_IYL) | AT(OFFSET_IYH), bytes);
+		ADD_DIMENSION(exerciser, AT(OFFSET_F), flags);
+	}
+
+	EndGroup(exerciser);
+
+	BeginGroup(exerciser, "<inc,dec> (<ix,iy>+1)");
+
+	for (i = 0; i < 2; ++i)
+	{
+		BeginVariant(exerciser, (i == 0 ? 0xDD000000 : 0xFD000000) | 0x340000 | DISPLACEMENT << 8, &default_registers);
+		ADD_DIMENSION(exerciser, AT(OFFSET_INSTRUCTION + 1), index_memory_increment_opcodes);
+		ADD_DIMENSION(exerciser, AT(OFFSET_MEMORY), bytes);
+		ADD_DIMENSION(exerciser, AT(OFFSET_F), flags);
+	}
+
+	EndGroup(exerciser);
+
+	BeginGroup(exerciser, "<inc,dec> <bc,de,hl,sp,ix,iy>");
+	BeginVariant(exerciser, 0x03000000, &default_registers);
+	ADD_DIMENSION(exerciser, AT(OFFSET_INSTRUCTION), increment_16_opcodes);
+	ADD_DIMENSION(exerciser, AT(OFFSET_C) | AT(OFFSET_E) | AT(OFFSET_L) | AT(OFFSET_SPL), low_bytes);
+	ADD_DIMENSION(exerciser, AT(OFFSET_B) | AT(OFFSET_D) | AT(OFFSET_H) | AT(OFFSET_SPH), high_bytes);
+
+	for (i = 0; i < 2; ++i)
+	{
+		BeginVariant(exerciser, (i == 0 ? 0xDD000000 : 0xFD000000) | 0x230000, &default_registers);
+		ADD_DIMENSION(exerciser, AT(OFFSET_INSTRUCTION + 1), index_increment_16_opcodes);
+		ADD_DIMENSION(exerciser, AT(i == 0 ? OFFSET_IXL : OFFSET_IYL), low_bytes);
+		ADD_DIMENSION(exerciser, AT(i == 0 ? OFFSET_IXH : OFFSET_IYH), high_bytes);
+	}
+
+	EndGroup(exerciser);
+
+	BeginGroup(exerciser, "add hl,<bc,de,hl,sp>");
+	BeginVariant(exerciser, 0x09000000, &default_registers);
+	ADD_DIMENSION(exerciser, AT(OFFSET_INSTRUCTION), add_16_opcodes);
+	ADD_DIMENSION(exerciser, AT(OFFSET_L), low_bytes);
+	ADD_DIMENSION(exerciser, AT(OFFSET_H), high_bytes);
+	ADD_DIMENSION(exerciser, pair_low_bytes, low_bytes);
+	ADD_DIMENSION(exerciser, pair_high_bytes, high_bytes);
+	ADD_DIMENSION(exerciser, AT(OFFSET_F), flags);
+	EndGroup(exerciser);
+
+	BeginGroup(exerciser, "<adc,sbc> hl,<bc,de,hl,sp>");
+	BeginVariant(exerciser, 0xED420000, &default_registers);
+	ADD_DIMENSION(exerciser, AT(OFFSET_INSTRUCTION + 1), carry_16_opcodes);
+	ADD_DIMENSION(exerciser, AT(OFFSET_L), low_bytes);
+	ADD_DIMENSION(exerciser, AT(OFFSET_H), high_bytes);
+	ADD_DIMENSION(exerciser, pair_low_bytes, low_bytes);
+	ADD_DIMENSION(exerciser, pair_high_bytes, high_bytes);
+	ADD_DIMENSION(exerciser, AT(OFFSET_F), flags);
+	EndGroup(exerciser);
+
+	BeginGroup(exerciser, "add <ix,iy>,<bc,de,ix,iy,sp>");
+
+	for (i = 0; i < 2; ++i)
+	{
+		BeginVariant(exerciser, (i == 0 ? 0xDD000000 : 0xFD000000) | 0x090000, &default_registers);
+		ADD_DIMENSION(exerciser, AT(OFFSET_INSTRUCTION + 1), add_16_opcodes);
+		ADD_DIMENSION(exerciser, AT(i == 0 ? OFFSET_IXL : OFFSET_IYL), low_bytes);
+		ADD_DIMENSION(exerciser, AT(i == 0 ? OFFSET_IXH : OFFSET_IYH), high_bytes);
+		ADD_DIMENSION(exerciser, pair_low_bytes, low_bytes);
+		ADD_DIMENSION(exerciser, pair_high_bytes, high_bytes);
+		ADD_DIMENSION(exerciser, AT(OFFSET_F), flags);
+	}
+
+	EndGroup(exerciser);
+
+	/* 'DAA' gets every value of 'A', which takes two variants, as a dimension can only have 255 values. */
+	BeginGroup(exerciser, "daa");
+
+	for (i = 0; i < 2; ++i)
+	{
+		BeginVariant(exerciser, 0x27000000, &default_registers);
+		AddRange(exerciser, AT(OFFSET_A), i * 0x80, 0x80);
+		ADD_DIMENSION(exerciser, AT(OFFSET_F), daa_flags);
+	}
+
+	EndGroup(exerciser);
+
+	BeginGroup(exerciser, "<cpl,scf,ccf>");
+	BeginVariant(exerciser, 0x2F000000, &default_registers);
+	ADD_DIMENSION(exerciser, AT(OFFSET_INSTRUCTION), accumulator_opcodes);
+	ADD_DIMENSION(exerciser, AT(OFFSET_A), bytes);
+	ADD_DIMENSION(exerciser, AT(OFFSET_F), flags);
+	EndGroup(exerciser);
+
+	BeginGroup(exerciser, "neg");
+	BeginVariant(exerciser, 0xED440000, &default_registers);
+	ADD_DIMENSION(exerciser, AT(OFFSET_INSTRUCTION + 1), negate_opcodes);
+	ADD_DIMENSION(exerciser, AT(OFFSET_A), bytes);
+	ADD_DIMENSION(exerciser, AT(OFFSET_F), flags);
+	EndGroup(exerciser);
+
+	BeginGroup(exerciser, "<rlca,rrca,rla,rra>");
+	BeginVariant(exerciser, 0x07000000, &default_registers);
+	ADD_DIMENSION(exerciser, AT(OFFSET_INSTRUCTION), rotate_opcodes);
+	ADD_DIMENSION(exerciser, AT(OFFSET_A), bytes);
+	ADD_DIMENSION(exerciser, AT(OFFSET_F), flags);
+	EndGroup(exerciser);
+}
+
+static void AddBitGroups(Exerciser* const exerciser)
+{
+	static const unsigned char digit_opcodes[] = {0x67, 0x6F};
+
+	unsigned int i;
+
+	/* Every 'CB' opcode takes two variants, as a dimension can only have 255 values. */
+	BeginGroup(exerciser, "cb xx <b,c,d,e,h,l,(hl),a>");
+
+	for (i = 0; i < 2; ++i)
+	{
+		BeginVariant(exerciser, 0xCB000000, &default_registers);
+		AddRange(exerciser, AT(OFFSET_INSTRUCTION + 1), i * 0x80, 0x80);
+		ADD_DIMENSION(exerciser, AT(OFFSET_A) | AT(OFFSET_B) | AT(OFFSET_C) | AT(OFFSET_D) | AT(OFFSET_E) | AT(OFFSET_MEMORY), bytes);
+		ADD_DIMENSION(exerciser, AT(OFFSET_F), flags);
+	}
+
+	EndGroup(exerciser);
+
+	/* This includes the undocumented opcodes which also copy the result into a register. */
+	BeginGroup(exerciser, "<dd,fd> cb 01 xx");
+
+	for (i = 0; i < 4; ++i)
+	{
+		BeginVariant(exerciser, (i < 2 ? 0xDDCB0000 : 0xFDCB0000) | DISPLACEMENT << 8, &default_registers);
+		AddRange(exerciser, AT(OFFSET_INSTRUCTION + 3), i % 2 * 0x80, 0x80);
+		ADD_DIMENSION(exerciser, AT(OFFSET_MEMORY), bit_bytes);
+		ADD_DIMENSION(exerciser, AT(OFFSET_F), flags);
+	}
+
+	EndGroup(exerciser);
+
+	BeginGroup(exerciser, "<rrd,rld>");
+	BeginVariant(exerciser, 0xED670000, &default_registers);
+	ADD_DIMENSION(exerciser, AT(OFFSET_INSTRUCTION + 1), digit_opcodes);
+	ADD_DIMENSION(exerciser, AT(OFFSET_A), bytes);
+	ADD_DIMENSION(exerciser, AT(OFFSET_MEMORY), bytes);
+	ADD_DIMENSION(exerciser, AT(OFFSET_F), flags);
+	EndGroup(exerciser);
+}
+
+static void AddLoadGroups(Exerciser* const exerciser)
+{
+	static const unsigned char immediate_opcodes[] = {0x06, 0x0E, 0x16, 0x1E, 0x26, 0x2E, 0x36, 0x3E};
+	static const unsigned char index_immediate_opcodes[] = {0x26, 0x2E};
+	static const unsigned char immediate_16_opcodes[] = {0x01, 0x11, 0x21, 0x31};
+	static const unsigned char interrupt_vector_values[] = {0x00, 0x80, 0xFF};
+	/* Each of these runs once, as there is not much to vary. */
+	static const unsigned long memory_loads[] = {
+		0x0A000000, /* LD A,(BC) */
+		0x1A000000, /* LD A,(DE) */
+		0x02000000, /* LD (BC),A */
+		0x12000000, /* LD (DE),A */
+		0x3A000000 | WORD_AT(1, MEMORY_ADDRESS), /* LD A,(nn) */
+		0x32000000 | WORD_AT(1, MEMORY_ADDRESS), /* LD (nn),A */
+		0x2A000000 | WORD_AT(1, MEMORY_ADDRESS), /* LD HL,(nn) */
+		0x22000000 | WORD_AT(1, MEMORY_ADDRESS), /* LD (nn),HL */
+		0xED4B0000 | WORD_AT(2, MEMORY_ADDRESS), /* LD BC,(nn) */
+		0xED5B0000 | WORD_AT(2, MEMORY_ADDRESS), /* LD DE,(nn) */
+		0xED6B0000 | WORD_AT(2, MEMORY_ADDRESS), /* LD HL,(nn) */
+		0xED7B0000 | WORD_AT(2, MEMORY_ADDRESS), /* LD SP,(nn) */
+		0xED430000 | WORD_AT(2, MEMORY_ADDRESS), /* LD (nn),BC */
+		0xED530000 | WORD_AT(2, MEMORY_ADDRESS), /* LD (nn),DE */
+		0xED630000 | WORD_AT(2, MEMORY_ADDRESS), /* LD (nn),HL */
+		0xED730000 | WORD_AT(2, MEMORY_ADDRESS), /* LD (nn),SP */
+		0xDD2A0000 | WORD_AT(2, MEMORY_ADDRESS), /* LD IX,(nn) */
+		0xFD2A0000 | WORD_AT(2, MEMORY_ADDRESS), /* LD IY,(nn) */
+		0xDD220000 | WORD_AT(2, MEMORY_ADDRESS), /* LD (nn),IX */
+		0xFD220000 | WORD_AT(2, MEMORY_ADDRESS)  /* LD (nn),IY */
+	};
+	static const unsigned long exchanges[] = {
+		0xF9000000, /* LD SP,HL */
+		0xDDF90000, /* LD SP,IX */
+		0xFDF90000, /* LD SP,IY */
+		0xEB000000, /* EX DE,HL */
+		0x08000000, /* EX AF,AF' */
+		0xD9000000, /* EXX */
+		0xE3000000, /* EX (SP),HL */
+		0xDDE30000, /* EX (SP),IX */
+		0xFDE30000, /* EX (SP),IY */
+		0xC5000000, /* PUSH BC */
+		0xD5000000, /* PUSH DE */
+		0xE5000000, /* PUSH HL */
+		0xF5000000, /* PUSH AF */
+		0xDDE50000, /* PUSH IX */
+		0xFDE50000, /* PUSH IY */
+		0xC1000000, /* POP BC */
+		0xD1000000, /* POP DE */
+		0xE1000000, /* POP HL */
+		0xF1000000, /* POP AF */
+		0xDDE10000, /* POP IX */
+		0xFDE10000  /* POP IY */
+	};
+
+	/* 'LD r,r'' and the undocumented 'IX' and 'IY' versions of it, without 'HALT'. Those that use memory need a displacement. */
+	unsigned char register_opcodes[0x40], memory_opcodes[0x40];
+	unsigned int total_register_opcodes = 0, total_memory_opcodes = 0;
+	Registers registers;
+	unsigned int i;
+
+	for (i = 0x40; i < 0x80; ++i)
+	{
+		if (i == 0x76)
+			continue;
+		else if ((i & 7) == 6 || (i & 0xF8) == 0x70)
+			memory_opcodes[total_memory_opcodes++] = i;
+		else
+			register_opcodes[total_register_opcodes++] = i;
+	}
+
+	BeginGroup(exerciser, "ld <b,c,d,e,h,l,(hl),a>,<...>");
+	BeginVariant(exerciser, 0x40000000, &default_registers);
+	AddDimension(exerciser, AT(OFFSET_INSTRUCTION), register_opcodes, total_register_opcodes);
+	BeginVariant(exerciser, 0x46000000, &default_registers);
+	AddDimension(exerciser, AT(OFFSET_INSTRUCTION), memory_opcodes, total_memory_opcodes);
+	EndGroup(exerciser);
+
+	BeginGroup(exerciser, "ld <...>,<ixh,ixl,iyh,iyl>");
+
+	for (i = 0; i < 2; ++i)
+	{
+		BeginVariant(exerciser, (i == 0 ? 0xDD000000 : 0xFD000000) | 0x400000, &default_registers);
+		AddDimension(exerciser, AT(OFFSET_INSTRUCTION + 1), register_opcodes, total_register_opcodes);
+		BeginVariant(exerciser, (i == 0 ? 0xDD000000 : 0xFD000000) | 0x460000 | DISPLACEMENT << 8, &default_registers);
+		AddDimension(exerciser, AT(OFFSET_INSTRUCTION + 1), memory_opcodes, total_memory_opcodes);
+	}
+
+	EndGroup(exerciser);
+
+	BeginGroup(exerciser, "ld <b,c,d,e,h,l,(hl),a>,nn");
+	BeginVariant(exerciser, 0x06000000, &default_registers);
+	ADD_DIMENSION(exerciser, AT(OFFSET_INSTRUCTION), immediate_opcodes);
+	ADD_DIMENSION(exerciser, AT(OFFSET_INSTRUCTION + 1), bytes);
+
+	for (i = 0; i < 2; ++i)
+	{
+		BeginVariant(exerciser, (i == 0 ? 0xDD000000 : 0xFD000000) | 0x260000, &default_registers);
+		ADD_DIMENSION(exerciser, AT(OFFSET_INSTRUCTION + 1), index_immediate_opcodes);
+		ADD_DIMENSION(exerciser, AT(OFFSET_INSTRUCTION + 2), bytes);
+		BeginVariant(exerciser, (i == 0 ? 0xDD000000 : 0xFD000000) | 0x360000 | DISPLACEMENT << 8, &default_registers);
+		ADD_DIMENSION(exerciser, AT(OFFSET_INSTRUCTION + 3), bytes);
+	}
+
+	EndGroup(exerciser);
+
+	BeginGroup(exerciser, "ld <bc,de,hl,sp,ix,iy>,nnnn");
+	BeginVariant(exerciser, 0x01000000, &default_registers);
+	ADD_DIMENSION(exerciser, AT(OFFSET_INSTRUCTION), immediate_16_opcodes);
+	ADD_DIMENSION(exerciser, AT(OFFSET_INSTRUCTION + 1), low_bytes);
+	ADD_DIMENSION(exerciser, AT(OFFSET_INSTRUCTION + 2), high_bytes);
+
+	for (i = 0; i < 2; ++i)
+	{
+		BeginVariant(exerciser, (i == 0 ? 0xDD000000 : 0xFD000000) | 0x210000, &default_registers);
+		ADD_DIMENSION(exerciser, AT(OFFSET_INSTRUCTION + 2), low_bytes);
+		ADD_DIMENSION(exerciser, AT(OFFSET_INSTRUCTION + 3), high_bytes);
+	}
+
+	EndGroup(exerciser);
+
+	/* 'BC' and 'DE' point to the memory too, and 'HL', 'IX', and 'IY' do not, so that their stores can be seen. */
+	registers = default_registers;
+	registers.bc = registers.de = MEMORY_ADDRESS;
+	registers.hl = 0x2468;
+	registers.ix = 0x369C;
+	registers.iy = 0x48D0;
+
+	BeginGroup(exerciser, "ld <a,rr>,<(bc),(de),(nnnn)>");
+
+	for (i = 0; i < CC_COUNT_OF(memory_loads); ++i)
+		BeginVariant(exerciser, memory_loads[i], &registers);
+
+	EndGroup(exerciser);
+
+	BeginGroup(exerciser, "<ld sp,ex,exx,push,pop>");
+
+	for (i = 0; i < CC_COUNT_OF(exchanges); ++i)
+		BeginVariant(exerciser, exchanges[i], &default_registers);
+
+	EndGroup(exerciser);
+
+	/* 'LD A,I' copies 'IFF2' into the parity flag. 'LD A,R' is left out, as 'R' depends on everything that came before. */
+	BeginGroup(exerciser, "ld i,a / ld a,i");
+	BeginVariant(exerciser, 0xED47ED57, &default_registers);
+	ADD_DIMENSION(exerciser, AT(OFFSET_A), interrupt_vector_values);
+	ADD_DIMENSION(exerciser, AT(OFFSET_F), flags);
+	EndGroup(exerciser);
+}
+
+/* Every branch goes to TAKEN_ADDRESS, which skips the write to the marker that follows the instruction. */
+static void AddBranchGroups(Exerciser* const exerciser)
+{
+	static const unsigned char relative_opcodes[] = {0x20, 0x28, 0x30, 0x38};
+	static const unsigned char jump_opcodes[] = {0xC2, 0xCA, 0xD2, 0xDA, 0xE2, 0xEA, 0xF2, 0xFA};
+	static const unsigned char call_opcodes[] = {0xC4, 0xCC, 0xD4, 0xDC, 0xE4, 0xEC, 0xF4, 0xFC};
+	static const unsigned char return_opcodes[] = {0xC0, 0xC8, 0xD0, 0xD8, 0xE0, 0xE8, 0xF0, 0xF8};
+	static const unsigned char djnz_counts[] = {0x00, 0x01, 0x02};
+	/* The displacement that goes from the end of a 'JR' or 'DJNZ' in the slot to TAKEN_ADDRESS. */
+	const unsigned long relative = (TAKEN_ADDRESS - (SLOT_ADDRESS + 2)) << 16;
+
+	Registers registers;
+
+	BeginGroup(exerciser, "<jp,jr,djnz,call,ret,retn>");
+
+	BeginVariant(exerciser, 0x18000000 | relative, &default_registers); /* JR e */
+	BeginVariant(exerciser, 0x20000000 | relative, &default_registers); /* JR cc,e */
+	ADD_DIMENSION(exerciser, AT(OFFSET_INSTRUCTION), relative_opcodes);
+	ADD_DIMENSION(exerciser, AT(OFFSET_F), conditions);
+	BeginVariant(exerciser, 0x10000000 | relative, &default_registers); /* DJNZ e */
+	ADD_DIMENSION(exerciser, AT(OFFSET_B), djnz_counts);
+
+	BeginVariant(exerciser, 0xC3000000 | WORD_AT(1, TAKEN_ADDRESS), &default_registers); /* JP nn */
+	BeginVariant(exerciser, 0xC2000000 | WORD_AT(1, TAKEN_ADDRESS), &default_registers); /* JP cc,nn */
+	ADD_DIMENSION(exerciser, AT(OFFSET_INSTRUCTION), jump_opcodes);
+	ADD_DIMENSION(exerciser, AT(OFFSET_F), conditions);
+
+	registers = default_registers;
+	registers.hl = registers.ix = registers.iy = TAKEN_ADDRESS;
+	BeginVariant(exerciser, 0xE9000000, &registers); /* JP (HL) */
+	BeginVariant(exerciser, 0xDDE90000, &registers); /* JP (IX) */
+	BeginVariant(exerciser, 0xFDE90000, &registers); /* JP (IY) */
+
+	BeginVariant(exerciser, 0xCD000000 | WORD_AT(1, TAKEN_ADDRESS), &default_registers); /* CALL nn */
+	BeginVariant(exerciser, 0xC4000000 | WORD_AT(1, TAKEN_ADDRESS), &default_registers); /* CALL cc,nn */
+	ADD_DIMENSION(exerciser, AT(OFFSET_INSTRUCTION), call_opcodes);
+	ADD_DIMENSION(exerciser, AT(OFFSET_F), conditions);
+
+	BeginVariant(exerciser, 0xC9000000, &default_registers); /* RET */
+	BeginVariant(exerciser, 0xC0000000, &default_registers); /* RET cc */
+	ADD_DIMENSION(exerciser, AT(OFFSET_INSTRUCTION), return_opcodes);
+	ADD_DIMENSION(exerciser, AT(OFFSET_F), conditions);
+	BeginVariant(exerciser, 0xED450000, &default_registers); /* RETN */
+	BeginVariant(exerciser, 0xED4D0000, &default_registers); /* RETI */
+
+	EndGroup(exerciser);
+}
+
+/* The block transfers are kept within the 4 bytes of memory, and so never run for more than a few iterations. */
+static void AddBlockGroups(Exerciser* const exerciser)
+{
+	static const unsigned char increment_opcodes[] = {0xA0, 0xB0};
+	static const unsigned char decrement_opcodes[] = {0xA8, 0xB8};
+	static const unsigned char compare_increment_opcodes[] = {0xA1, 0xB1};
+	static const unsigned char compare_decrement_opcodes[] = {0xA9, 0xB9};
+	static const unsigned char transfer_counts[] = {0x01, 0x02};
+	static const unsigned char compare_counts[] = {0x01, 0x02, 0x04};
+	/* The undocumented flags of the transfers come from adding 'A' to the byte. */
+	static const unsigned char transfer_accumulators[] = {0x00, 0x5A};
+	/* The first byte, the last byte, and a byte that is not there. */
+	static const unsigned char compare_accumulators[] = {0x10, 0x40, 0x50};
+
+	Registers registers = default_registers;
+
+	BeginGroup(exerciser, "<ldi,ldir,ldd,lddr>");
+
+	registers.bc = 0;
+	registers.hl = MEMORY_ADDRESS;
+	registers.de = MEMORY_ADDRESS + 2;
+	BeginVariant(exerciser, 0xEDA00000, &registers);
+	ADD_DIMENSION(exerciser, AT(OFFSET_INSTRUCTION + 1), increment_opcodes);
+	ADD_DIMENSION(exerciser, AT(OFFSET_C), transfer_counts);
+	ADD_DIMENSION(exerciser, AT(OFFSET_A), transfer_accumulators);
+	ADD_DIMENSION(exerciser, AT(OFFSET_F), flags);
+
+	registers.hl = MEMORY_ADDRESS + 1;
+	registers.de = MEMORY_ADDRESS + 3;
+	BeginVariant(exerciser, 0xEDA80000, &registers);
+	ADD_DIMENSION(exerciser, AT(OFFSET_INSTRUCTION + 1), decrement_opcodes);
+	ADD_DIMENSION(exerciser, AT(OFFSET_C), transfer_counts);
+	ADD_DIMENSION(exerciser, AT(OFFSET_A), transfer_accumulators);
+	ADD_DIMENSION(exerciser, AT(OFFSET_F), flags);
+
+	EndGroup(exerciser);
+
+	BeginGroup(exerciser, "<cpi,cpir,cpd,cpdr>");
+
+	registers.memory[0] = 0x10;
+	registers.memory[1] = 0x20;
+	registers.memory[2] = 0x30;
+	registers.memory[3] = 0x40;
+
+	registers.hl = MEMORY_ADDRESS;
+	BeginVariant(exerciser, 0xEDA10000, &registers);
+	ADD_DIMENSION(exerciser, AT(OFFSET_INSTRUCTION + 1), compare_increment_opcodes);
+	ADD_DIMENSION(exerciser, AT(OFFSET_C), compare_counts);
+	ADD_DIMENSION(exerciser, AT(OFFSET_A), compare_accumulators);
+	ADD_DIMENSION(exerciser, AT(OFFSET_F), flags);
+
+	registers.hl = MEMORY_ADDRESS + 3;
+	BeginVariant(exerciser, 0xEDA90000, &registers);
+	ADD_DIMENSION(exerciser, AT(OFFSET_INSTRUCTION + 1), compare_decrement_opcodes);
+	ADD_DIMENSION(exerciser, AT(OFFSET_C), compare_counts);
+	ADD_DIMENSION(exerciser, AT(OFFSET_A), compare_accumulators);
+	ADD_DIMENSION(exerciser, AT(OFFSET_F), flags);
+
+	EndGroup(exerciser);
+}
+
+/* 'cpm-test.c' has nothing on its ports, so every read gets 0xFF. */
+static void AddInputOutputGroups(Exerciser* const exerciser)
+{
+	static const unsigned char ports[] = {0x00, 0xFE};
+	static const unsigned char immediate_opcodes[] = {0xD3, 0xDB};
+	static const unsigned char register_input_opcodes[] = {0x40, 0x48, 0x50, 0x58, 0x60, 0x68, 0x70, 0x78};
+	static const unsigned char register_output_opcodes[] = {0x41, 0x49, 0x51, 0x59, 0x61, 0x69, 0x71, 0x79};
+	static const unsigned char increment_opcodes[] = {0xA2, 0xA3};
+	static const unsigned char decrement_opcodes[] = {0xAA, 0xAB};
+	static const unsigned char repeat_increment_opcodes[] = {0xB2, 0xB3};
+	static const unsigned char repeat_decrement_opcodes[] = {0xBA, 0xBB};
+	/* The flags of the block transfers depend upon both 'B' and 'C'. */
+	static const unsigned char counts[] = {0x00, 0x01, 0x80};
+	static const unsigned char repeat_counts[] = {0x01, 0x02, 0x03};
+	static const unsigned char port_low_bytes[] = {0x00, 0xFF};
+
+	Registers registers = default_registers;
+
+	BeginGroup(exerciser, "<in,out> <a,r>,<(nn),(c)>");
+	BeginVariant(exerciser, 0xD3000000, &default_registers);
+	ADD_DIMENSION(exerciser, AT(OFFSET_INSTRUCTION), immediate_opcodes);
+	ADD_DIMENSION(exerciser, AT(OFFSET_INSTRUCTION + 1), ports);
+	ADD_DIMENSION(exerciser, AT(OFFSET_F), flags);
+	BeginVariant(exerciser, 0xED400000, &default_registers);
+	ADD_DIMENSION(exerciser, AT(OFFSET_INSTRUCTION + 1), register_input_opcodes);
+	ADD_DIMENSION(exerciser, AT(OFFSET_F), flags);
+	BeginVariant(exerciser, 0xED410000, &default_registers);
+	ADD_DIMENSION(exerciser, AT(OFFSET_INSTRUCTION + 1), register_output_opcodes);
+	EndGroup(exerciser);
+
+	BeginGroup(exerciser, "<ini,outi,ind,outd>");
+	registers.hl = MEMORY_ADDRESS + 1;
+	BeginVariant(exerciser, 0xEDA20000, &registers);
+	ADD_DIMENSION(exerciser, AT(OFFSET_INSTRUCTION + 1), increment_opcodes);
+	ADD_DIMENSION(exerciser, AT(OFFSET_B), counts);
+	ADD_DIMENSION(exerciser, AT(OFFSET_C), port_low_bytes);
+	ADD_DIMENSION(exerciser, AT(OFFSET_F), flags);
+	registers.hl = MEMORY_ADDRESS + 3;
+	BeginVariant(exerciser, 0xEDAA0000, &registers);
+	ADD_DIMENSION(exerciser, AT(OFFSET_INSTRUCTION + 1), decrement_opcodes);
+	ADD_DIMENSION(exerciser, AT(OFFSET_B), counts);
+	ADD_DIMENSION(exerciser, AT(OFFSET_C), port_low_bytes);
+	ADD_DIMENSION(exerciser, AT(OFFSET_F), flags);
+	EndGroup(exerciser);
+
+	BeginGroup(exerciser, "<inir,otir,indr,otdr>");
+	registers.hl = MEMORY_ADDRESS + 1;
+	BeginVariant(exerciser, 0xEDB20000, &registers);
+	ADD_DIMENSION(exerciser, AT(OFFSET_INSTRUCTION + 1), repeat_increment_opcodes);
+	ADD_DIMENSION(exerciser, AT(OFFSET_B), repeat_counts);
+	ADD_DIMENSION(exerciser, AT(OFFSET_C), port_low_bytes);
+	ADD_DIMENSION(exerciser, AT(OFFSET_F), flags);
+	registers.hl = MEMORY_ADDRESS + 3;
+	BeginVariant(exerciser, 0xEDBA0000, &registers);
+	ADD_DIMENSION(exerciser, AT(OFFSET_INSTRUCTION + 1), repeat_decrement_opcodes);
+	ADD_DIMENSION(exerciser, AT(OFFSET_B), repeat_counts);
+	ADD_DIMENSION(exerciser, AT(OFFSET_C), port_low_bytes);
+	ADD_DIMENSION(exerciser, AT(OFFSET_F), flags);
+	EndGroup(exerciser);
+}
+
+static void AddKnownResultGroups(Exerciser* const exerciser)
+{
+	size_t i, j;
+
+	for (i = 0; i < CC_COUNT_OF(known_result_groups); ++i)
+	{
+		const KnownResultGroup* const group = &known_result_groups[i];
+
+		BeginGroup(exerciser, group->name);
+
+		for (j = 0; j < group->total_test_cases; ++j)
+		{
+			const TestCase* const test_case = &group->test_cases[j];
+			Registers registers = default_registers;
+
+			registers.af = test_case->input.af;
+			registers.bc = test_case->input.bc;
+			registers.de = test_case->input.de;
+			registers.hl = test_case->input.hl;
+			registers.memory[0] = test_case->input.memory;
+
+			BeginVariant(exerciser, (unsigned long)test_case->instruction[0] << 24 | (unsigned long)test_case->instruction[1] << 16
+				| (unsigned long)test_case->instruction[2] << 8 | (unsigned long)test_case->instruction[3], &registers);
+
+			AddCheck(exerciser, OFFSET_F, DOCUMENTED_FLAGS, test_case->expected.af & DOCUMENTED_FLAGS);
+			AddCheck(exerciser, OFFSET_A, 0xFF, test_case->expected.af >> 8);
+			AddCheck(exerciser, OFFSET_C, 0xFF, test_case->expected.bc & 0xFF);
+			AddCheck(exerciser, OFFSET_B, 0xFF, test_case->expected.bc >> 8);
+			AddCheck(exerciser, OFFSET_E, 0xFF, test_case->expected.de & 0xFF);
+			AddCheck(exerciser, OFFSET_D, 0xFF, test_case->expected.de >> 8);
+			AddCheck(exerciser, OFFSET_L, 0xFF, test_case->expected.hl & 0xFF);
+			AddCheck(exerciser, OFFSET_H, 0xFF, test_case->expected.hl >> 8);
+			AddCheck(exerciser, OFFSET_MEMORY, 0xFF, test_case->expected.memory);
+		}
+
+		EndGroup(exerciser);
+	}
+}
+
+static cc_u16f ReadCallback(void* const user_data, const cc_u16f address)
+{
+	Exerciser* const exerciser = (Exerciser*)user_data;
+
+	return exerciser->ram[address];
+}
+
+static void WriteCallback(void* const user_data, const cc_u16f address, const cc_u16f value)
+{
+	Exerciser* const exerciser = (Exerciser*)user_data;
+
+	exerciser->ram[address] = value;
+}
+
+static void LogCallback(void* const user_data, const char* const format, ...)
+{
+	(void)user_data;
+	(void)format;
+}
+
+/* Runs the exerciser until it warm boots, and then fills in the CRCs that its groups got. */
+static cc_bool FillInCrcs(Exerciser* const exerciser)
+{
+	ClownZ80_ReadAndWriteCallbacks callbacks;
+	ClownZ80_State state;
+	size_t i;
+
+	memset(exerciser->ram, 0, sizeof(exerciser->ram));
+	memcpy(&exerciser->ram[PROGRAM_ADDRESS], exerciser->program, exerciser->program_size);
+	/* The BDOS does nothing, as there is nowhere for the output to go. */
+	exerciser->ram[0x0005] = 0xC9;
+
+	ClownZ80_State_Initialise(&state);
+	ClownZ80_Reset(&state);
+	state.program_counter = PROGRAM_ADDRESS;
+
+	ClownZ80_ReadAndWriteCallbacks_Initialise(&callbacks);
+	callbacks.read = ReadCallback;
+	callbacks.write = WriteCallback;
+	callbacks.log = LogCallback;
+	callbacks.user_data = exerciser;
+
+	while (state.program_counter != 0x0000)
+	{
+		ClownZ80_DoInstruction(&state, &callbacks);
+
+		if (state.total_cycles > MAXIMUM_CYCLES)
+			return cc_false;
+	}
+
+	for (i = 0; i < exerciser->total_groups; ++i)
+	{
+		const size_t position = exerciser->crc_positions[i];
+		const cc_u16f address = CRC_LOG_ADDRESS + i * 2;
+
+		exerciser->program[position + 0] = exerciser->ram[address + 0];
+		exerciser->program[position + 1] = exerciser->ram[address + 1];
+	}
+
+	return cc_true;
+}
+
+int main(const int argc, char** const argv)
+{
+	FILE *file;
+
+	if (argc < 2)
+	{
+		fputs("Usage: clownz80-cpm-exerciser-generator exerciser.com\n", stderr);
+		return EXIT_FAILURE;
+	}
+
+	memcpy(exerciser.program, runner, sizeof(runner));
+	exerciser.program_size = sizeof(runner);
+
+	AddArithmeticGroups(&exerciser);
+	AddBitGroups(&exerciser);
+	AddLoadGroups(&exerciser);
+	AddBranchGroups(&exerciser);
+	AddBlockGroups(&exerciser);
+	AddInputOutputGroups(&exerciser);
+	AddKnownResultGroups(&exerciser);
+
+	/* The end of the groups. */
+	EmitByte(&exerciser, 0);
+
+	if (exerciser.too_large)
+	{
+		fputs("The exerciser has outgrown the limits of its runner.\n", stderr);
+		return EXIT_FAILURE;
+	}
+
+	if (!FillInCrcs(&exerciser))
+	{
+		fputs("The exerciser did not finish.\n", stderr);
+		return EXIT_FAILURE;
+	}
+
+	file = fopen(argv[1], "wb");
+
+	if (file == NULL)
+	{
+		fprintf(stderr, "Could not open file '%s'.\n", argv[1]);
+		return EXIT_FAILURE;
+	}
+
+	fwrite(exerciser.program, 1, exerciser.program_size, file);
+
+	if (fclose(file) != 0)
+	{
+		fprintf(stderr, "Could not write file '%s'.\n", argv[1]);
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,345 @@
+/* Runs CP/M programs, such as the 'zexdoc' and 'zexall' instruction exercisers, and tallies the results that they print. */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "clowncommon/clowncommon.h"
+
+#include "engines.h"
+#include "interpreter.h"
+#ifdef CLOWNZ80_PROFILER
+	#include "profiler-report.h"
+#endif
+#ifdef CLOWNZ80_TRACER
+	#include "trace-writer.h"
+#endif
+
+/* CP/M programs are loaded here. */
+#define PROGRAM_ADDRESS 0x100
+/* The BDOS is placed at the top of memory, and the stack grows down from it. */
+#define BDOS_ADDRESS 0xFE00
+/* Writes to these addresses are intercepted, to let the Z80 code below talk to the host. */
+#define BDOS_CALL_PORT 0xFFFF
+#define WARM_BOOT_PORT 0xFFFE
+/* How many blocks the hot-spot profile lists. */
+#define HOT_SPOT_BLOCKS 20
+/* How many cycles 'ClownZ80_Run' is given at a time. */
+#define SLICE_CYCLES 0x10000
+/* How many of the tracer's buffers can be waiting to be written at once. */
+#define TRACE_WRITER_BUFFERS 0x40
+
+/* Warm boot, which programs do by jumping to 0x0000 when they are finished. */
+static const unsigned char warm_boot[] = {
+	0x32, 0xFE, 0xFF, /* 0000: LD (WARM_BOOT_PORT),A */
+	0x18, 0xFE,       /* 0003: JR 0003h */
+	0xC3, 0x00, 0xFE  /* 0005: JP BDOS_ADDRESS */
+};
+
+/* The BDOS, which hands the function number in 'C' over to the host. */
+static const unsigned char bdos[] = {
+	0x79,             /* FE00: LD A,C */
+	0x32, 0xFF, 0xFF, /* FE01: LD (BDOS_CALL_PORT),A */
+	0xC9              /* FE04: RET */
+};
+
+typedef struct Machine
+{
+	ClownZ80_State state;
+	cc_u8l ram[0x10000];
+	cc_bool finished;
+	/* The cycle that the program warm booted on. 'ClownZ80_Run' carries on to the end of its slice after that, which is
+	   mostly spent skipping the idle loop that the warm boot ends in, so the total number of cycles cannot be used. */
+	double finished_cycles;
+	/* The line that is currently being printed, so that it can be checked for a result. */
+	char line[0x100];
+	size_t line_length;
+	unsigned long groups_passed, groups_failed;
+} Machine;
+
+static Machine machine;
+
+static void TallyLine(Machine* const machine)
+{
+	machine->line[machine->line_length] = '\0';
+
+	/* The exercisers print either "OK" or "ERROR" at the end of each test group. */
+	if (strstr(machine->line, "ERROR") != NULL)
+		++machine->groups_failed;
+	else if (machine->line_length >= 2 && strcmp(&machine->line[machine->line_length - 2], "OK") == 0)
+		++machine->groups_passed;
+
+	machine->line_length = 0;
+}
+
+static void PrintCharacter(Machine* const machine, const char character)
+{
+	fputc(character, stdout);
+
+	if (character == '\n')
+	{
+		TallyLine(machine);
+	}
+	else if (character != '\r' && machine->line_length < sizeof(machine->line) - 1)
+	{
+		machine->line[machine->line_length++] = character;
+	}
+}
+
+static void DoBdosCall(Machine* const machine, const cc_u16f function)
+{
+	switch (function)
+	{
+		case 2: /* Console output. */
+			PrintCharacter(machine, machine->state.e);
+			break;
+
+		case 9: /* Print string. */
+		{
+			cc_u16f address = ((cc_u16f)machine->state.d << 8) | machine->state.e;
+
+			while (machine->ram[address] != '$')
+			{
+				PrintCharacter(machine, machine->ram[address]);
+				address = (address + 1) & 0xFFFF;
+			}
+
+			break;
+		}
+
+		default:
+			fprintf(stderr, "Unsupported BDOS function %u was called.\n", (unsigned int)function);
+			break;
+	}
+
+	fflush(stdout);
+}
+
+static cc_u16f ReadCallback(void* const user_data, const cc_u16f address)
+{
+	Machine* const machine = (Machine*)user_data;
+
+	return machine->ram[address];
+}
+
+static void WriteCallback(void* const user_data, const cc_u16f address, const cc_u16f value)
+{
+	Machine* const machine = (Machine*)user_data;
+
+	switch (address)
+	{
+		case BDOS_CALL_PORT:
+			DoBdosCall(machine, value);
+			break;
+
+		case WARM_BOOT_PORT:
+			machine->finished = cc_true;
+			machine->finished_cycles = machine->state.total_cycles;
+			break;
+
+		default:
+			machine->ram[address] = value;
+			break;
+	}
+}
+
+static void LogCallback(void* const user_data, const char* const format, ...)
+{
+	(void)user_data;
+	(void)format;
+}
+
+#ifdef CLOWNZ80_PROFILER
+static void PrintCallback(void* const user_data, const char* const format, ...)
+{
+	va_list args;
+
+	(void)user_data;
+
+	va_start(args, format);
+	vfprintf(stdout, format, args);
+	va_end(args);
+}
+#endif
+
+static cc_bool LoadProgram(Machine* const machine, const char* const file_path)
+{
+	cc_bool success = cc_false;
+	FILE* const file = fopen(file_path, "rb");
+
+	if (file == NULL)
+	{
+		fprintf(stderr, "Could not open file '%s'.\n", file_path);
+	}
+	else
+	{
+		const size_t maximum_size = BDOS_ADDRESS - PROGRAM_ADDRESS;
+		const size_t size = fread(&machine->ram[PROGRAM_ADDRESS], 1, maximum_size, file);
+
+		if (size == 0 || fgetc(file) != EOF)
+			fprintf(stderr, "File '%s' is either empty or too large to be a CP/M program.\n", file_path);
+		else
+			success = cc_true;
+
+		fclose(file);
+	}
+
+	return success;
+}
+
+int main(const int argc, char** const argv)
+{
+	static ClownZ80_EngineResources engine_resources;
+#ifdef CLOWNZ80_PROFILER
+	static ClownZ80_Profiler profiler;
+	const char *profile_format = NULL;
+#endif
+#ifdef CLOWNZ80_TRACER
+	static ClownZ80_Tracer tracer;
+	static ClownZ80_TraceWriter trace_writer;
+	const char *trace_file_path = NULL;
+#endif
+
+	ClownZ80_ReadAndWriteCallbacks callbacks;
+	ClownZ80_Engine engine = CLOWNZ80_ENGINE_STEP;
+	const char *file_path = NULL;
+	clock_t start_time;
+	double seconds;
+	int argument;
+
+	for (argument = 1; argument < argc; ++argument)
+	{
+		if (strcmp(argv[argument], "--engine") == 0 && argument + 1 < argc)
+		{
+			engine = ClownZ80_Engine_FromName(argv[++argument]);
+		}
+	#ifdef CLOWNZ80_PROFILER
+		else if (strcmp(argv[argument], "--profile") == 0 && argument + 1 < argc)
+		{
+			profile_format = argv[++argument];
+		}
+	#endif
+	#ifdef CLOWNZ80_TRACER
+		else if (strcmp(argv[argument], "--trace") == 0 && argument + 1 < argc)
+		{
+			trace_file_path = argv[++argument];
+		}
+	#endif
+		else
+		{
+			file_path = argv[argument];
+		}
+	}
+
+	if (file_path == NULL || engine == CLOWNZ80_TOTAL_ENGINES)
+	{
+		fputs("Usage: clownz80-cpm-test [--engine " CLOWNZ80_ENGINE_NAMES "] [--profile table|json|hotspots] [--trace file] program.com\n", stderr);
+		return EXIT_FAILURE;
+	}
+
+#ifdef CLOWNZ80_PROFILER
+	if (profile_format != NULL && strcmp(profile_format, "table") != 0 && strcmp(profile_format, "json") != 0 && strcmp(profile_format, "hotspots") != 0)
+	{
+		fprintf(stderr, "Unknown profile format '%s'.\n", profile_format);
+		return EXIT_FAILURE;
+	}
+#endif
+
+	memcpy(&machine.ram[0], warm_boot, sizeof(warm_boot));
+	memcpy(&machine.ram[BDOS_ADDRESS], bdos, sizeof(bdos));
+
+	if (!LoadProgram(&machine, file_path))
+		return EXIT_FAILURE;
+
+	ClownZ80_State_Initialise(&machine.state);
+	ClownZ80_Reset(&machine.state);
+	machine.state.program_counter = PROGRAM_ADDRESS;
+	machine.state.stack_pointer = BDOS_ADDRESS;
+
+	ClownZ80_ReadAndWriteCallbacks_Initialise(&callbacks);
+	callbacks.read = ReadCallback;
+	callbacks.write = WriteCallback;
+	callbacks.log = LogCallback;
+	callbacks.user_data = &machine;
+
+	/* The page which holds the ports is left unmapped, so that writes to it reach the callback. */
+	if (!ClownZ80_EngineResources_Initialise(&engine_resources, engine, &callbacks, machine.ram, 0xFF00))
+	{
+		fputs("The JIT is not available on this platform.\n", stderr);
+		return EXIT_FAILURE;
+	}
+
+#ifdef CLOWNZ80_PROFILER
+	if (profile_format != NULL)
+	{
+		ClownZ80_Profiler_Initialise(&profiler);
+		callbacks.profiler = &profiler;
+	}
+#endif
+
+#ifdef CLOWNZ80_TRACER
+	if (trace_file_path != NULL)
+	{
+		if (!ClownZ80_TraceWriter_Open(&trace_writer, trace_file_path, TRACE_WRITER_BUFFERS))
+		{
+			fprintf(stderr, "Could not create trace file '%s'.\n", trace_file_path);
+			return EXIT_FAILURE;
+		}
+
+		ClownZ80_Tracer_Initialise(&tracer, ClownZ80_TraceWriter_Write, &trace_writer);
+		callbacks.tracer = &tracer;
+	}
+#endif
+
+	start_time = clock();
+
+	while (!machine.finished)
+	{
+		if (engine == CLOWNZ80_ENGINE_STEP)
+			ClownZ80_DoInstruction(&machine.state, &callbacks);
+		else
+			ClownZ80_Run(&machine.state, &callbacks, SLICE_CYCLES);
+	}
+
+	seconds = (double)(clock() - start_time) / CLOCKS_PER_SEC;
+
+	ClownZ80_EngineResources_Deinitialise(&engine_resources);
+
+#ifdef CLOWNZ80_TRACER
+	if (trace_file_path != NULL)
+	{
+		ClownZ80_Tracer_Flush(&tracer);
+
+		if (!ClownZ80_TraceWriter_Close(&trace_writer))
+			fprintf(stderr, "Could not write trace file '%s'.\n", trace_file_path);
+	}
+#endif
+
+	/* Flush any unfinished line. */
+	if (machine.line_length != 0)
+	{
+		fputc('\n', stdout);
+		TallyLine(&machine);
+	}
+
+	fprintf(stdout, "\n%lu groups passed, %lu failed, using the '%s' engine.\n", machine.groups_passed, machine.groups_failed, ClownZ80_Engine_GetName(engine));
+	fprintf(stdout, "%.0f cycles took %.2f seconds (%.2f MHz).\n", machine.finished_cycles, seconds, seconds > 0.0 ? machine.finished_cycles / seconds / 1000000.0 : 0.0);
+
+#ifdef CLOWNZ80_PROFILER
+	if (profile_format != NULL)
+	{
+		fputc('\n', stdout);
+
+		if (strcmp(profile_format, "json") == 0)
+			ClownZ80_Profiler_PrintJSON(&profiler, PrintCallback, NULL);
+		else if (strcmp(profile_format, "hotspots") == 0)
+			ClownZ80_Profiler_PrintHotSpots(&profiler, HOT_SPOT_BLOCKS, ReadCallback, PrintCallback, &machine);
+		else
+			ClownZ80_Profiler_PrintTable(&profiler, PrintCallback, NULL);
+	}
+#endif
+
+	return machine.groups_failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
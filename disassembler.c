@@ -406,6 +406,8 @@ static cc_bool IsTerminatingInstruction(const ClownZ80_Opcode opcode)
 	return cc_false;
 }
 
+static void PrintOperand(State *state, unsigned int operand_index);
+
 static void PrintSpecialOperands(State* const state)
 {
 	switch ((ClownZ80_Opcode)state->metadata.opcode)
@@ -478,6 +480,41 @@ static void PrintSpecialOperands(State* const state)
 			state->print_callback(state->user_data, "sp,");
 			break;
 
+		case CLOWNZ80_OPCODE_OUT:
+			state->print_callback(state->user_data, "(");
+			PrintHexadecimal(state, ReadByte(state));
+			state->print_callback(state->user_data, "),a");
+			/* Since we manually handled the operand, blank it to prevent it from being printed a second time. */
+			state->metadata.operands[0] = CLOWNZ80_OPERAND_NONE;
+			break;
+
+		case CLOWNZ80_OPCODE_IN:
+			state->print_callback(state->user_data, "a,(");
+			PrintHexadecimal(state, ReadByte(state));
+			state->print_callback(state->user_data, ")");
+			/* Since we manually handled the operand, blank it to prevent it from being printed a second time. */
+			state->metadata.operands[0] = CLOWNZ80_OPERAND_NONE;
+			break;
+
+		case CLOWNZ80_OPCODE_IN_REGISTER:
+			PrintOperand(state, 1);
+			state->print_callback(state->user_data, ",(c)");
+			/* Since we manually handled the operand, blank it to prevent it from being printed a second time. */
+			state->metadata.operands[1] = CLOWNZ80_OPERAND_NONE;
+			break;
+
+		case CLOWNZ80_OPCODE_IN_NO_REGISTER:
+			state->print_callback(state->user_data, "(c)");
+			break;
+
+		case CLOWNZ80_OPCODE_OUT_REGISTER:
+			state->print_callback(state->user_data, "(c),");
+			break;
+
+		case CLOWNZ80_OPCODE_OUT_NO_REGISTER:
+			state->print_callback(state->user_data, "(c),0");
+			break;
+
 		case CLOWNZ80_OPCODE_NOP:
 		case CLOWNZ80_OPCODE_DJNZ:
 		case CLOWNZ80_OPCODE_LD_16BIT:
@@ -507,8 +544,6 @@ static void PrintSpecialOperands(State* const state)
 		case CLOWNZ80_OPCODE_JP_HL:
 		case CLOWNZ80_OPCODE_JP_UNCONDITIONAL:
 		case CLOWNZ80_OPCODE_CB_PREFIX:
-		case CLOWNZ80_OPCODE_OUT:
-		case CLOWNZ80_OPCODE_IN:
 		case CLOWNZ80_OPCODE_DI:
 		case CLOWNZ80_OPCODE_EI:
 		case CLOWNZ80_OPCODE_PUSH:
@@ -524,10 +559,6 @@ static void PrintSpecialOperands(State* const state)
 		case CLOWNZ80_OPCODE_SRA:
 		case CLOWNZ80_OPCODE_SLL:
 		case CLOWNZ80_OPCODE_SRL:
-		case CLOWNZ80_OPCODE_IN_REGISTER:
-		case CLOWNZ80_OPCODE_IN_NO_REGISTER:
-		case CLOWNZ80_OPCODE_OUT_REGISTER:
-		case CLOWNZ80_OPCODE_OUT_NO_REGISTER:
 		case CLOWNZ80_OPCODE_SBC_HL:
 		case CLOWNZ80_OPCODE_ADC_HL:
 		case CLOWNZ80_OPCODE_NEG:
@@ -0,0 +1,78 @@
+#include "engines.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#include "clowncommon/clowncommon.h"
+
+#define JIT_BUFFER_SIZE 0x100000
+
+static const char* const engine_names[CLOWNZ80_TOTAL_ENGINES] = {
+	"step",
+	"run",
+	"map",
+	"icache",
+	"blocks",
+	"jit"
+};
+
+ClownZ80_Engine ClownZ80_Engine_FromName(const char* const name)
+{
+	unsigned int engine;
+
+	for (engine = 0; engine < CLOWNZ80_TOTAL_ENGINES; ++engine)
+		if (strcmp(name, engine_names[engine]) == 0)
+			break;
+
+	return (ClownZ80_Engine)engine;
+}
+
+const char* ClownZ80_Engine_GetName(const ClownZ80_Engine engine)
+{
+	return engine_names[engine];
+}
+
+cc_bool ClownZ80_EngineResources_Initialise(ClownZ80_EngineResources* const resources, const ClownZ80_Engine engine, ClownZ80_ReadAndWriteCallbacks* const callbacks, cc_u8l* const ram, const cc_u32f mapped_length)
+{
+	resources->engine = engine;
+
+	callbacks->memory_map = NULL;
+	callbacks->instruction_cache = NULL;
+	callbacks->block_cache = NULL;
+	callbacks->jit = NULL;
+
+	if (engine >= CLOWNZ80_ENGINE_MEMORY_MAP)
+	{
+		ClownZ80_MemoryMap_Initialise(&resources->memory_map);
+		ClownZ80_MemoryMap_SetPages(&resources->memory_map, 0, mapped_length, ram, ram);
+		callbacks->memory_map = &resources->memory_map;
+	}
+
+	if (engine == CLOWNZ80_ENGINE_INSTRUCTION_CACHE)
+	{
+		ClownZ80_InstructionCache_Initialise(&resources->instruction_cache);
+		callbacks->instruction_cache = &resources->instruction_cache;
+	}
+
+	if (engine >= CLOWNZ80_ENGINE_BLOCK_CACHE)
+	{
+		ClownZ80_BlockCache_Initialise(&resources->block_cache);
+		callbacks->block_cache = &resources->block_cache;
+	}
+
+	if (engine == CLOWNZ80_ENGINE_JIT)
+	{
+		if (!ClownZ80_Jit_Initialise(&resources->jit, JIT_BUFFER_SIZE))
+			return cc_false;
+
+		callbacks->jit = &resources->jit;
+	}
+
+	return cc_true;
+}
+
+void ClownZ80_EngineResources_Deinitialise(ClownZ80_EngineResources* const resources)
+{
+	if (resources->engine == CLOWNZ80_ENGINE_JIT)
+		ClownZ80_Jit_Deinitialise(&resources->jit);
+}
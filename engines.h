@@ -0,0 +1,42 @@
+#ifndef CLOWNZ80_ENGINES_H
+#define CLOWNZ80_ENGINES_H
+
+#include "clowncommon/clowncommon.h"
+
+#include "interpreter.h"
+
+/* For usage messages. */
+#define CLOWNZ80_ENGINE_NAMES "step|run|map|icache|blocks|jit"
+
+/* The ways in which the test and benchmark programs can run the interpreter, from slowest to fastest. */
+typedef enum ClownZ80_Engine
+{
+	CLOWNZ80_ENGINE_STEP,              /* 'ClownZ80_DoInstruction', with everything going through the callbacks. */
+	CLOWNZ80_ENGINE_RUN,               /* 'ClownZ80_Run', with everything going through the callbacks. */
+	CLOWNZ80_ENGINE_MEMORY_MAP,        /* As above, plus the memory map. */
+	CLOWNZ80_ENGINE_INSTRUCTION_CACHE, /* As above, plus the instruction cache. */
+	CLOWNZ80_ENGINE_BLOCK_CACHE,       /* The memory map and the block cache. */
+	CLOWNZ80_ENGINE_JIT,               /* As above, plus the JIT. */
+	CLOWNZ80_TOTAL_ENGINES
+} ClownZ80_Engine;
+
+/* Everything that the engines may need. This is large, so it should not be put on the stack. */
+typedef struct ClownZ80_EngineResources
+{
+	ClownZ80_Engine engine;
+	ClownZ80_MemoryMap memory_map;
+	ClownZ80_InstructionCache instruction_cache;
+	ClownZ80_BlockCache block_cache;
+	ClownZ80_Jit jit;
+} ClownZ80_EngineResources;
+
+/* Returns 'CLOWNZ80_TOTAL_ENGINES' if there is no engine with the given name. */
+ClownZ80_Engine ClownZ80_Engine_FromName(const char *name);
+const char* ClownZ80_Engine_GetName(ClownZ80_Engine engine);
+/* Sets the optional members of 'callbacks' for the given engine, and clears the ones that it does not use.
+   If the engine uses the memory map, then the first 'mapped_length' bytes of the address space are mapped to 'ram' and the rest go through the callbacks.
+   Returns cc_false if the JIT is not available on this platform, in which case the resources must not be deinitialised. */
+cc_bool ClownZ80_EngineResources_Initialise(ClownZ80_EngineResources *resources, ClownZ80_Engine engine, ClownZ80_ReadAndWriteCallbacks *callbacks, cc_u8l *ram, cc_u32f mapped_length);
+void ClownZ80_EngineResources_Deinitialise(ClownZ80_EngineResources *resources);
+
+#endif /* CLOWNZ80_ENGINES_H */
@@ -0,0 +1,457 @@
+/* Runs a series of scenarios through the event queue, and checks the order that the events fire in, along with the cycle that
+   each of them fires on. The Z80 runs nothing but 'NOP's, which take 4 cycles each, so an event fires on the first multiple of
+   4 that is no sooner than the cycle that it is due on. Every scenario is run once in a single call to 'ClownZ80_Run', and once
+   in small slices, as an emulator would run it, which should make no difference. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "clowncommon/clowncommon.h"
+
+#include "engines.h"
+#include "interpreter.h"
+
+/* Not a multiple of 4, so that slices end part-way through instructions. */
+#define SLICE_CYCLES 7
+#define MAXIMUM_FIRINGS 0x40
+
+typedef enum Action
+{
+	ACTION_NONE,
+	ACTION_CANCEL,   /* Cancels the target. */
+	ACTION_SCHEDULE  /* Schedules the target for 'delay' cycles after the current one, every 'period' cycles. */
+} Action;
+
+/* What an event does when it fires. The target may be the event itself. */
+typedef struct EventInfo
+{
+	char name;
+	Action action;
+	unsigned int target;
+	double delay;
+	cc_u32f period;
+	/* The action is only done this many times. */
+	unsigned int total_actions;
+} EventInfo;
+
+typedef struct Firing
+{
+	char name;
+	unsigned long cycle;
+} Firing;
+
+typedef struct Scenario
+{
+	const char *name;
+	void (*set_up)(void);
+	unsigned long cycles;
+	/* In order of cycle, and then of name, as events that are due at the same cycle are run in no particular order. */
+	const Firing *expected;
+	size_t total_expected;
+} Scenario;
+
+static ClownZ80_EventQueue event_queue;
+static ClownZ80_Event events[CLOWNZ80_EVENT_QUEUE_SIZE + 1];
+static EventInfo event_infos[CC_COUNT_OF(events)];
+static Firing firings[MAXIMUM_FIRINGS];
+static unsigned int total_firings;
+static cc_bool set_up_failed;
+
+static cc_u8l ram[0x10000];
+
+static cc_u16f ReadCallback(void* const user_data, const cc_u16f address)
+{
+	(void)user_data;
+
+	return ram[address];
+}
+
+static void WriteCallback(void* const user_data, const cc_u16f address, const cc_u16f value)
+{
+	(void)user_data;
+
+	ram[address] = value;
+}
+
+static void LogCallback(void* const user_data, const char* const format, ...)
+{
+	(void)user_data;
+	(void)format;
+}
+
+static void EventCallback(void* const user_data, ClownZ80_State* const state, ClownZ80_Event* const event)
+{
+	EventInfo* const info = (EventInfo*)user_data;
+
+	(void)event;
+
+	if (total_firings != CC_COUNT_OF(firings))
+	{
+		firings[total_firings].name = info->name;
+		firings[total_firings].cycle = (unsigned long)state->total_cycles;
+	}
+
+	++total_firings;
+
+	if (info->total_actions != 0)
+	{
+		--info->total_actions;
+
+		switch (info->action)
+		{
+			case ACTION_NONE:
+				break;
+
+			case ACTION_CANCEL:
+				ClownZ80_EventQueue_Cancel(&event_queue, &events[info->target]);
+				break;
+
+			case ACTION_SCHEDULE:
+				ClownZ80_EventQueue_Schedule(&event_queue, &events[info->target], state->total_cycles + info->delay, info->period);
+				break;
+		}
+	}
+}
+
+static void AddEvent(const unsigned int index, const char name, const double cycle, const cc_u32f period)
+{
+	EventInfo* const info = &event_infos[index];
+
+	info->name = name;
+	info->action = ACTION_NONE;
+	info->total_actions = 0;
+
+	ClownZ80_Event_Initialise(&events[index], EventCallback, info);
+
+	if (!ClownZ80_EventQueue_Schedule(&event_queue, &events[index], cycle, period))
+		set_up_failed = cc_true;
+}
+
+static void SetAction(const unsigned int index, const Action action, const unsigned int target, const double delay, const cc_u32f period, const unsigned int total_actions)
+{
+	EventInfo* const info = &event_infos[index];
+
+	info->action = action;
+	info->target = target;
+	info->delay = delay;
+	info->period = period;
+	info->total_actions = total_actions;
+}
+
+/* Scheduled out of order, so that the heap has to sort them. */
+static void SetUpOneShots(void)
+{
+	AddEvent(0, 'A', 100, 0);
+	AddEvent(1, 'B', 20, 0);
+	AddEvent(2, 'C', 61, 0);
+	AddEvent(3, 'D', 40, 0);
+	AddEvent(4, 'E', 79, 0);
+}
+
+static const Firing one_shots[] = {
+	{'B', 20},
+	{'D', 40},
+	{'C', 64},
+	{'E', 80},
+	{'A', 100}
+};
+
+/* 'C' is due sooner than the others, but not by enough to land on a different instruction. */
+static void SetUpSameCycle(void)
+{
+	AddEvent(0, 'A', 50, 0);
+	AddEvent(1, 'B', 50, 0);
+	AddEvent(2, 'C', 49, 0);
+	AddEvent(3, 'D', 52, 0);
+}
+
+static const Firing same_cycle[] = {
+	{'A', 52},
+	{'B', 52},
+	{'C', 52},
+	{'D', 52}
+};
+
+/* Periodic events are rescheduled from the cycle that they were due on, not the cycle that they fired on, so they do not drift.
+   'P' and 'Q' keep landing on the same cycle as each other. The last firing of 'Q' is on the very last cycle of the run. */
+static void SetUpPeriodic(void)
+{
+	AddEvent(0, 'P', 50, 100);
+	AddEvent(1, 'Q', 50, 50);
+	AddEvent(2, 'O', 130, 0);
+}
+
+static const Firing periodic[] = {
+	{'P', 52},
+	{'Q', 52},
+	{'Q', 100},
+	{'O', 132},
+	{'P', 152},
+	{'Q', 152},
+	{'Q', 200},
+	{'P', 252},
+	{'Q', 252},
+	{'Q', 300},
+	{'P', 352},
+	{'Q', 352},
+	{'Q', 400}
+};
+
+/* 'A' cancels a one-shot, 'D' cancels a periodic event, and 'E' is a periodic event which cancels itself. */
+static void SetUpCancelling(void)
+{
+	AddEvent(0, 'A', 100, 0);
+	AddEvent(1, 'B', 200, 0);
+	AddEvent(2, 'C', 60, 60);
+	AddEvent(3, 'D', 150, 0);
+	AddEvent(4, 'E', 30, 30);
+
+	SetAction(0, ACTION_CANCEL, 1, 0, 0, 1);
+	SetAction(3, ACTION_CANCEL, 2, 0, 0, 1);
+	SetAction(4, ACTION_CANCEL, 4, 0, 0, 1);
+}
+
+static const Firing cancelling[] = {
+	{'E', 32},
+	{'C', 60},
+	{'A', 100},
+	{'C', 120},
+	{'D', 152}
+};
+
+/* 'R' is a one-shot which reschedules itself three times. 'S' schedules 'T' for the cycle that it is already on, so 'T' fires
+   straight after it. 'U' is a periodic event which turns itself into a one-shot that is due sooner than its next period. */
+static void SetUpRescheduling(void)
+{
+	AddEvent(0, 'R', 10, 0);
+	AddEvent(1, 'S', 100, 100);
+	AddEvent(3, 'U', 50, 1000);
+
+	/* 'T' is not scheduled until 'S' fires. */
+	event_infos[2].name = 'T';
+	event_infos[2].total_actions = 0;
+	ClownZ80_Event_Initialise(&events[2], EventCallback, &event_infos[2]);
+
+	SetAction(0, ACTION_SCHEDULE, 0, 30, 0, 3);
+	SetAction(1, ACTION_SCHEDULE, 2, 0, 0, 2);
+	SetAction(3, ACTION_SCHEDULE, 3, 25, 0, 1);
+}
+
+static const Firing rescheduling[] = {
+	{'R', 12},
+	{'R', 44},
+	{'U', 52},
+	{'R', 76},
+	{'U', 80},
+	{'S', 100},
+	{'T', 100},
+	{'R', 108},
+	{'S', 200},
+	{'T', 200}
+};
+
+/* 'F' and 'H' are due less than a cycle away when they are next, which must still make the Z80 run rather than doing 0 cycles forever. */
+static void SetUpFractional(void)
+{
+	AddEvent(0, 'F', 0.5, 0);
+	AddEvent(1, 'G', 8.25, 10);
+	AddEvent(2, 'H', 12.5, 0);
+}
+
+static const Firing fractional[] = {
+	{'F', 4},
+	{'G', 12},
+	{'H', 16},
+	{'G', 20},
+	{'G', 32},
+	{'G', 40}
+};
+
+static Firing full_queue[CLOWNZ80_EVENT_QUEUE_SIZE];
+
+/* Fills the queue, checks that one more event does not fit, and then moves the soonest event to the back and another to the front. */
+static void SetUpFullQueue(void)
+{
+	static const char names[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdef";
+
+	unsigned int i;
+
+	for (i = 0; i < CLOWNZ80_EVENT_QUEUE_SIZE; ++i)
+	{
+		/* Every slot, in a scrambled order. */
+		const unsigned int slot = (i * 13) % CLOWNZ80_EVENT_QUEUE_SIZE;
+
+		AddEvent(i, names[i], slot * 8 + 3, 0);
+		full_queue[slot].name = names[i];
+		full_queue[slot].cycle = slot * 8 + 4;
+	}
+
+	ClownZ80_Event_Initialise(&events[i], EventCallback, &event_infos[i]);
+
+	if (ClownZ80_EventQueue_Schedule(&event_queue, &events[i], 0, 0))
+	{
+		fputs("Full queue: an event was scheduled when the queue was full.\n", stdout);
+		set_up_failed = cc_true;
+	}
+
+	if (!ClownZ80_EventQueue_Schedule(&event_queue, &events[0], 1000, 0) || !ClownZ80_EventQueue_Schedule(&event_queue, &events[25], 1, 0))
+	{
+		fputs("Full queue: a scheduled event could not be moved when the queue was full.\n", stdout);
+		set_up_failed = cc_true;
+	}
+
+	/* 'A' was in slot 0, so 'Z' takes its place at the front, and everything after where 'Z' was in slot 5 moves up to make room for 'A' at the back. */
+	full_queue[0].name = 'Z';
+	memmove(&full_queue[5], &full_queue[6], sizeof(full_queue[0]) * (CLOWNZ80_EVENT_QUEUE_SIZE - 6));
+	full_queue[CLOWNZ80_EVENT_QUEUE_SIZE - 1].name = 'A';
+	full_queue[CLOWNZ80_EVENT_QUEUE_SIZE - 1].cycle = 1000;
+}
+
+static const Scenario scenarios[] = {
+	{"One-shots",    SetUpOneShots,     200, one_shots,    CC_COUNT_OF(one_shots)},
+	{"Same cycle",   SetUpSameCycle,    100, same_cycle,   CC_COUNT_OF(same_cycle)},
+	{"Periodic",     SetUpPeriodic,     400, periodic,     CC_COUNT_OF(periodic)},
+	{"Cancelling",   SetUpCancelling,   300, cancelling,   CC_COUNT_OF(cancelling)},
+	{"Rescheduling", SetUpRescheduling, 250, rescheduling, CC_COUNT_OF(rescheduling)},
+	{"Fractional",   SetUpFractional,   40,  fractional,   CC_COUNT_OF(fractional)},
+	{"Full queue",   SetUpFullQueue,    1000, full_queue,  CC_COUNT_OF(full_queue)}
+};
+
+static int CompareFirings(const void* const a, const void* const b)
+{
+	const Firing* const firing_a = (const Firing*)a;
+	const Firing* const firing_b = (const Firing*)b;
+
+	if (firing_a->cycle != firing_b->cycle)
+		return firing_a->cycle < firing_b->cycle ? -1 : 1;
+
+	return firing_a->name - firing_b->name;
+}
+
+static void PrintFirings(const char* const label, const Firing* const list, const size_t total)
+{
+	size_t i;
+
+	fprintf(stdout, "  %-9s", label);
+
+	for (i = 0; i < total; ++i)
+		fprintf(stdout, " %c@%lu", list[i].name, list[i].cycle);
+
+	fputc('\n', stdout);
+}
+
+static cc_bool RunScenario(const Scenario* const scenario, ClownZ80_ReadAndWriteCallbacks* const callbacks, const cc_u32f slice_cycles)
+{
+	ClownZ80_State state;
+	unsigned int i;
+	cc_bool in_order, match;
+
+	memset(&state, 0, sizeof(state));
+	ClownZ80_State_Initialise(&state);
+
+	ClownZ80_EventQueue_Initialise(&event_queue);
+	total_firings = 0;
+	set_up_failed = cc_false;
+
+	scenario->set_up();
+
+	while (state.total_cycles < scenario->cycles)
+		ClownZ80_Run(&state, callbacks, CC_MIN(slice_cycles, scenario->cycles - (unsigned long)state.total_cycles));
+
+	if (set_up_failed)
+		return cc_false;
+
+	if (total_firings > CC_COUNT_OF(firings))
+	{
+		fprintf(stdout, "%s: %u events fired, which is more than can be checked.\n", scenario->name, total_firings);
+		return cc_false;
+	}
+
+	in_order = cc_true;
+
+	for (i = 1; i < total_firings; ++i)
+		if (firings[i].cycle < firings[i - 1].cycle)
+			in_order = cc_false;
+
+	/* Events that fired on the same cycle could have done so in any order. */
+	qsort(firings, total_firings, sizeof(*firings), CompareFirings);
+
+	match = in_order && total_firings == scenario->total_expected;
+
+	for (i = 0; match && i < total_firings; ++i)
+		if (firings[i].name != scenario->expected[i].name || firings[i].cycle != scenario->expected[i].cycle)
+			match = cc_false;
+
+	if (!match)
+	{
+		fprintf(stdout, "%s, in slices of %lu cycles: the events fired %s.\n", scenario->name, (unsigned long)slice_cycles, in_order ? "at the wrong times" : "out of order");
+		PrintFirings("Expected:", scenario->expected, scenario->total_expected);
+		PrintFirings("Got:", firings, total_firings);
+		return cc_false;
+	}
+
+	return cc_true;
+}
+
+int main(const int argc, char** const argv)
+{
+	static ClownZ80_EngineResources engine_resources;
+
+	ClownZ80_ReadAndWriteCallbacks callbacks;
+	ClownZ80_Engine engine = CLOWNZ80_ENGINE_RUN;
+	unsigned int total_failed, i;
+	int argument;
+
+	for (argument = 1; argument < argc; ++argument)
+	{
+		if (strcmp(argv[argument], "--engine") == 0 && argument + 1 < argc)
+		{
+			engine = ClownZ80_Engine_FromName(argv[++argument]);
+		}
+		else
+		{
+			engine = CLOWNZ80_TOTAL_ENGINES;
+			break;
+		}
+	}
+
+	/* Events are only run by 'ClownZ80_Run'. */
+	if (engine == CLOWNZ80_TOTAL_ENGINES || engine == CLOWNZ80_ENGINE_STEP)
+	{
+		fputs("Usage: clownz80-event-queue-test [--engine run|map|icache|blocks|jit]\n", stderr);
+		fputs("  Defaults to 'run'.\n", stderr);
+		return EXIT_FAILURE;
+	}
+
+	ClownZ80_ReadAndWriteCallbacks_Initialise(&callbacks);
+	callbacks.read = ReadCallback;
+	callbacks.write = WriteCallback;
+	callbacks.log = LogCallback;
+	callbacks.user_data = NULL;
+
+	if (!ClownZ80_EngineResources_Initialise(&engine_resources, engine, &callbacks, ram, 0x10000))
+	{
+		fputs("The JIT is not available on this platform.\n", stderr);
+		return EXIT_FAILURE;
+	}
+
+	callbacks.event_queue = &event_queue;
+
+	total_failed = 0;
+
+	for (i = 0; i < CC_COUNT_OF(scenarios); ++i)
+	{
+		if (!RunScenario(&scenarios[i], &callbacks, scenarios[i].cycles))
+			++total_failed;
+
+		if (!RunScenario(&scenarios[i], &callbacks, SLICE_CYCLES))
+			++total_failed;
+	}
+
+	ClownZ80_EngineResources_Deinitialise(&engine_resources);
+
+	fprintf(stdout, "%u scenarios run, %u failed, using the '%s' engine.\n", (unsigned int)CC_COUNT_OF(scenarios) * 2, total_failed, ClownZ80_Engine_GetName(engine));
+
+	return total_failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,673 @@
+/* Checks every instruction against a corpus of randomised test cases.
+
+   'generate' runs each case on the reference, which executes one instruction at a time through the callbacks,
+   and records the outcomes to a file. 'replay' runs the same cases using one of the faster execution modes and
+   compares them to that file, using one thread per core.
+
+   Normally, each case is only run once, which is not enough for the block cache to compile it with the JIT, so the
+   'jit' engine goes no further than the block cache's decoded instructions. '--repeat' runs each case over and over
+   in place, checking every run, so that the later runs use the JIT's native code.
+
+   The cases themselves are not stored: each one is recreated from the seed in the file's header and its index.
+   Every case executes a single instruction, with random registers, in random memory, at a random address.
+   Every opcode of every instruction mode and register mode gets the same number of cases. */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "clowncommon/clowncommon.h"
+
+#include "engines.h"
+#include "interpreter.h"
+
+#define FILE_MAGIC "CZ80FUZZ"
+#define FILE_HEADER_SIZE (8 + 4 + 4)
+/* An instruction, plus an interrupt, cannot make more writes than this. */
+#define MAXIMUM_WRITES 4
+/* The registers, the cycle count, and the writes. */
+#define RECORD_SIZE (27 + 1 + 1 + MAXIMUM_WRITES * 3)
+#define MAXIMUM_INSTRUCTION_BYTES 5
+#define MAXIMUM_THREADS 64
+/* With '--repeat', each case is run this many times in a row: more than the block cache needs before it compiles a block with the JIT. */
+#define REPEATS 20
+
+/* An opcode, and the prefixes which select its instruction mode and register mode. */
+typedef struct Instruction
+{
+	cc_u8l prefixes[2];
+	cc_u8l total_prefixes;
+	cc_u8l opcode;
+	cc_bool has_displacement; /* 'DD CB' and 'FD CB' instructions have their displacement before the opcode. */
+} Instruction;
+
+typedef struct TestCase
+{
+	ClownZ80_State state;
+	cc_u8l bytes[MAXIMUM_INSTRUCTION_BYTES];
+} TestCase;
+
+typedef struct Machine
+{
+	ClownZ80_State state;
+	ClownZ80_ReadAndWriteCallbacks callbacks;
+	ClownZ80_EngineResources engine_resources;
+	cc_u8l ram[0x10000];
+	/* What 'ram' contains before every case. */
+	cc_u8l background[0x10000];
+	unsigned int total_writes;
+	cc_u16l write_addresses[MAXIMUM_WRITES + 1];
+	cc_u8l write_values[MAXIMUM_WRITES + 1];
+} Machine;
+
+typedef struct Job
+{
+	pthread_t thread;
+	ClownZ80_Engine engine;
+	cc_u32f seed;
+	unsigned long cases_per_instruction;
+	unsigned long first_case, total_cases;
+	unsigned int runs_per_case;
+	const unsigned char *records;
+	unsigned long failures;
+} Job;
+
+static Instruction instructions[0x100 * 7];
+static unsigned int total_instructions;
+
+static cc_u32f Hash(cc_u32f value)
+{
+	value = (value ^ (value >> 16)) & 0xFFFFFFFF;
+	value = (value * 0x7FEB352D) & 0xFFFFFFFF;
+	value = (value ^ (value >> 15)) & 0xFFFFFFFF;
+	value = (value * 0x846CA68B) & 0xFFFFFFFF;
+	value = (value ^ (value >> 16)) & 0xFFFFFFFF;
+
+	return value;
+}
+
+/* A xorshift generator, which gives the same numbers on every platform. */
+static cc_u8f RandomByte(cc_u32f* const random_state)
+{
+	cc_u32f value = *random_state;
+
+	value ^= (value << 13) & 0xFFFFFFFF;
+	value ^= value >> 17;
+	value ^= (value << 5) & 0xFFFFFFFF;
+
+	*random_state = value;
+
+	return (value >> 24) & 0xFF;
+}
+
+static void AddInstructions(const cc_u8f prefix_1, const cc_u8f prefix_2, const cc_bool has_displacement)
+{
+	cc_u16f opcode;
+
+	for (opcode = 0; opcode < 0x100; ++opcode)
+	{
+		Instruction* const instruction = &instructions[total_instructions];
+
+		/* Prefixes are covered by the instructions which follow them. */
+		if (prefix_2 == 0 && (opcode == 0xCB || opcode == 0xDD || opcode == 0xED || opcode == 0xFD))
+			continue;
+
+		instruction->prefixes[0] = prefix_1;
+		instruction->prefixes[1] = prefix_2;
+		instruction->total_prefixes = prefix_1 == 0 ? 0 : prefix_2 == 0 ? 1 : 2;
+		instruction->opcode = opcode;
+		instruction->has_displacement = has_displacement;
+		++total_instructions;
+	}
+}
+
+static void ListInstructions(void)
+{
+	/* Normal instructions, with each register mode. */
+	AddInstructions(0x00, 0x00, cc_false);
+	AddInstructions(0xDD, 0x00, cc_false);
+	AddInstructions(0xFD, 0x00, cc_false);
+	/* Bit instructions, with each register mode. */
+	AddInstructions(0xCB, 0x00, cc_false);
+	AddInstructions(0xDD, 0xCB, cc_true);
+	AddInstructions(0xFD, 0xCB, cc_true);
+	/* Miscellaneous instructions. */
+	AddInstructions(0xED, 0x00, cc_false);
+}
+
+static void InitialiseBackground(cc_u8l* const background, const cc_u32f seed)
+{
+	cc_u32f random_state = Hash(seed) | 1;
+	cc_u32f i;
+
+	for (i = 0; i < 0x10000; ++i)
+		background[i] = RandomByte(&random_state);
+}
+
+static void CreateTestCase(TestCase* const test_case, const cc_u32f seed, const unsigned long index, const unsigned long cases_per_instruction)
+{
+	const Instruction* const instruction = &instructions[index / cases_per_instruction];
+	ClownZ80_State* const state = &test_case->state;
+	cc_u32f random_state = Hash(seed ^ Hash(index)) | 1;
+	cc_u8f random_byte, i;
+
+	ClownZ80_State_Initialise(state);
+
+	state->program_counter = RandomByte(&random_state) << 8;
+	state->program_counter |= RandomByte(&random_state);
+	state->stack_pointer = RandomByte(&random_state) << 8;
+	state->stack_pointer |= RandomByte(&random_state);
+	state->a = RandomByte(&random_state);
+	state->f = RandomByte(&random_state);
+	state->b = RandomByte(&random_state);
+	state->c = RandomByte(&random_state);
+	state->d = RandomByte(&random_state);
+	state->e = RandomByte(&random_state);
+	state->h = RandomByte(&random_state);
+	state->l = RandomByte(&random_state);
+	state->a_ = RandomByte(&random_state);
+	state->f_ = RandomByte(&random_state);
+	state->b_ = RandomByte(&random_state);
+	state->c_ = RandomByte(&random_state);
+	state->d_ = RandomByte(&random_state);
+	state->e_ = RandomByte(&random_state);
+	state->h_ = RandomByte(&random_state);
+	state->l_ = RandomByte(&random_state);
+	state->ixh = RandomByte(&random_state);
+	state->ixl = RandomByte(&random_state);
+	state->iyh = RandomByte(&random_state);
+	state->iyl = RandomByte(&random_state);
+	state->r = RandomByte(&random_state);
+	state->i = RandomByte(&random_state);
+
+	/* Sometimes have an interrupt be taken after the instruction. */
+	random_byte = RandomByte(&random_state);
+	state->interrupts_enabled = (random_byte & 1) != 0;
+	state->interrupt_pending = (random_byte & 6) == 6;
+
+	/* Keep 'BC' small now and then, so that repeating instructions can finish. */
+	if ((random_byte & 0x18) == 0)
+	{
+		state->b = 0;
+		state->c &= 3;
+	}
+
+	/* Whatever follows the opcode is random: it is the instruction's literal or displacement, or just junk. */
+	for (i = 0; i < MAXIMUM_INSTRUCTION_BYTES; ++i)
+		test_case->bytes[i] = RandomByte(&random_state);
+
+	for (i = 0; i < instruction->total_prefixes; ++i)
+		test_case->bytes[i] = instruction->prefixes[i];
+
+	test_case->bytes[i + (instruction->has_displacement ? 1 : 0)] = instruction->opcode;
+}
+
+static cc_u16f ReadCallback(void* const user_data, const cc_u16f address)
+{
+	Machine* const machine = (Machine*)user_data;
+
+	return machine->ram[address];
+}
+
+static void WriteCallback(void* const user_data, const cc_u16f address, const cc_u16f value)
+{
+	Machine* const machine = (Machine*)user_data;
+
+	machine->ram[address] = value;
+
+	/* One extra write is kept, so that the reference can tell when there are too many. */
+	if (machine->total_writes != MAXIMUM_WRITES + 1)
+	{
+		machine->write_addresses[machine->total_writes] = address;
+		machine->write_values[machine->total_writes] = value;
+		++machine->total_writes;
+	}
+}
+
+static void LogCallback(void* const user_data, const char* const format, ...)
+{
+	(void)user_data;
+	(void)format;
+}
+
+static cc_bool InitialiseMachine(Machine* const machine, const ClownZ80_Engine engine, const cc_u32f seed)
+{
+	InitialiseBackground(machine->background, seed);
+	memcpy(machine->ram, machine->background, sizeof(machine->ram));
+
+	ClownZ80_ReadAndWriteCallbacks_Initialise(&machine->callbacks);
+	machine->callbacks.read = ReadCallback;
+	machine->callbacks.write = WriteCallback;
+	machine->callbacks.log = LogCallback;
+	machine->callbacks.user_data = machine;
+
+	return ClownZ80_EngineResources_Initialise(&machine->engine_resources, engine, &machine->callbacks, machine->ram, sizeof(machine->ram));
+}
+
+static void DeinitialiseMachine(Machine* const machine)
+{
+	ClownZ80_EngineResources_Deinitialise(&machine->engine_resources);
+}
+
+/* Memory is modified behind the Z80's back, so anything cached from it must be thrown away. */
+static void RestoreMemory(Machine* const machine, const cc_u16f address, const cc_u32f length)
+{
+	cc_u32f i;
+
+	for (i = 0; i < length; ++i)
+	{
+		const cc_u16f byte_address = (address + i) & 0xFFFF;
+
+		machine->ram[byte_address] = machine->background[byte_address];
+	}
+
+	if (machine->callbacks.instruction_cache != NULL)
+		ClownZ80_InstructionCache_Invalidate(machine->callbacks.instruction_cache, address, length);
+
+	if (machine->callbacks.block_cache != NULL)
+		ClownZ80_BlockCache_Invalidate(machine->callbacks.block_cache, address, length);
+}
+
+static void PlaceTestCase(Machine* const machine, const TestCase* const test_case)
+{
+	const cc_u16f address = test_case->state.program_counter;
+	cc_u16f i;
+
+	for (i = 0; i < MAXIMUM_INSTRUCTION_BYTES; ++i)
+		machine->ram[(address + i) & 0xFFFF] = test_case->bytes[i];
+
+	if (machine->callbacks.instruction_cache != NULL)
+		ClownZ80_InstructionCache_Invalidate(machine->callbacks.instruction_cache, address, MAXIMUM_INSTRUCTION_BYTES);
+
+	if (machine->callbacks.block_cache != NULL)
+		ClownZ80_BlockCache_Invalidate(machine->callbacks.block_cache, address, MAXIMUM_INSTRUCTION_BYTES);
+}
+
+/* Runs a case that has already been placed in memory. Returns the number of cycles taken. */
+static cc_u16f RunTestCase(Machine* const machine, const TestCase* const test_case, const ClownZ80_Engine engine)
+{
+	machine->state = test_case->state;
+	machine->total_writes = 0;
+
+	/* A budget of 1 cycle makes every execution mode stop after a single instruction. */
+	if (engine == CLOWNZ80_ENGINE_STEP)
+		return ClownZ80_DoInstruction(&machine->state, &machine->callbacks);
+	else
+		return ClownZ80_Run(&machine->state, &machine->callbacks, 1);
+}
+
+static void WriteRecord(unsigned char* const record, const Machine* const machine, const cc_u16f cycles)
+{
+	const ClownZ80_State* const state = &machine->state;
+	unsigned int i;
+
+	memset(record, 0, RECORD_SIZE);
+
+	record[0] = (state->program_counter >> 8) & 0xFF;
+	record[1] = state->program_counter & 0xFF;
+	record[2] = (state->stack_pointer >> 8) & 0xFF;
+	record[3] = state->stack_pointer & 0xFF;
+	record[4] = state->a;
+	record[5] = state->f;
+	record[6] = state->b;
+	record[7] = state->c;
+	record[8] = state->d;
+	record[9] = state->e;
+	record[10] = state->h;
+	record[11] = state->l;
+	record[12] = state->a_;
+	record[13] = state->f_;
+	record[14] = state->b_;
+	record[15] = state->c_;
+	record[16] = state->d_;
+	record[17] = state->e_;
+	record[18] = state->h_;
+	record[19] = state->l_;
+	record[20] = state->ixh;
+	record[21] = state->ixl;
+	record[22] = state->iyh;
+	record[23] = state->iyl;
+	record[24] = state->r;
+	record[25] = state->i;
+	record[26] = (state->interrupts_enabled ? 1 : 0) | (state->interrupt_pending ? 2 : 0) | (state->register_mode << 2);
+	record[27] = cycles;
+	record[28] = machine->total_writes;
+
+	for (i = 0; i < machine->total_writes; ++i)
+	{
+		record[29 + i * 3 + 0] = (machine->write_addresses[i] >> 8) & 0xFF;
+		record[29 + i * 3 + 1] = machine->write_addresses[i] & 0xFF;
+		record[29 + i * 3 + 2] = machine->write_values[i];
+	}
+}
+
+static void WriteLong(unsigned char* const buffer, const cc_u32f value)
+{
+	buffer[0] = (value >> 24) & 0xFF;
+	buffer[1] = (value >> 16) & 0xFF;
+	buffer[2] = (value >> 8) & 0xFF;
+	buffer[3] = value & 0xFF;
+}
+
+static cc_u32f ReadLong(const unsigned char* const buffer)
+{
+	return ((cc_u32f)buffer[0] << 24) | ((cc_u32f)buffer[1] << 16) | ((cc_u32f)buffer[2] << 8) | buffer[3];
+}
+
+static int Generate(const char* const file_path, const cc_u32f seed, const unsigned long cases_per_instruction)
+{
+	static Machine machine;
+
+	const unsigned long total_cases = total_instructions * cases_per_instruction;
+	unsigned char header[FILE_HEADER_SIZE];
+	unsigned char record[RECORD_SIZE];
+	unsigned long index;
+	FILE* const file = fopen(file_path, "wb");
+
+	if (file == NULL)
+	{
+		fprintf(stderr, "Could not open file '%s'.\n", file_path);
+		return EXIT_FAILURE;
+	}
+
+	memcpy(header, FILE_MAGIC, 8);
+	WriteLong(&header[8], seed);
+	WriteLong(&header[12], cases_per_instruction);
+	fwrite(header, 1, sizeof(header), file);
+
+	InitialiseMachine(&machine, CLOWNZ80_ENGINE_STEP, seed);
+
+	for (index = 0; index < total_cases; ++index)
+	{
+		TestCase test_case;
+		cc_u16f cycles;
+		unsigned int i;
+
+		CreateTestCase(&test_case, seed, index, cases_per_instruction);
+		PlaceTestCase(&machine, &test_case);
+		cycles = RunTestCase(&machine, &test_case, CLOWNZ80_ENGINE_STEP);
+
+		if (machine.total_writes > MAXIMUM_WRITES)
+		{
+			fprintf(stderr, "Case %lu made more than %u writes.\n", index, MAXIMUM_WRITES);
+			fclose(file);
+			return EXIT_FAILURE;
+		}
+
+		WriteRecord(record, &machine, cycles);
+		fwrite(record, 1, sizeof(record), file);
+
+		RestoreMemory(&machine, test_case.state.program_counter, MAXIMUM_INSTRUCTION_BYTES);
+
+		for (i = 0; i < machine.total_writes; ++i)
+			RestoreMemory(&machine, machine.write_addresses[i], 1);
+	}
+
+	fclose(file);
+
+	fprintf(stdout, "Generated %lu cases for %u instructions.\n", total_cases, total_instructions);
+
+	return EXIT_SUCCESS;
+}
+
+static void ReportFailure(const unsigned long index, const TestCase* const test_case, const char* const message)
+{
+	unsigned int i;
+
+	fprintf(stdout, "Case %lu, instruction", index);
+
+	for (i = 0; i < MAXIMUM_INSTRUCTION_BYTES; ++i)
+		fprintf(stdout, " %02X", (unsigned int)test_case->bytes[i]);
+
+	fprintf(stdout, " at %04X: %s\n", (unsigned int)test_case->state.program_counter, message);
+}
+
+/* Returns a description of how the run differs from the expected record, or NULL if it does not. */
+static const char* CheckTestCase(const Machine* const machine, const unsigned char* const expected, const cc_u16f cycles)
+{
+	unsigned char actual[RECORD_SIZE];
+	unsigned int i;
+
+	/* Writes to mapped memory bypass the callbacks, so they are checked against memory instead of the log. */
+	WriteRecord(actual, machine, cycles);
+
+	if (memcmp(actual, expected, 28) != 0)
+		return "the registers or cycle count differ";
+
+	for (i = 0; i < expected[28]; ++i)
+	{
+		const cc_u16f address = ((cc_u16f)expected[29 + i * 3 + 0] << 8) | expected[29 + i * 3 + 1];
+
+		/* A later write may overwrite an earlier one, so only the last write to each address is checked. */
+		unsigned int j;
+
+		for (j = i + 1; j < expected[28]; ++j)
+			if (address == (((cc_u16f)expected[29 + j * 3 + 0] << 8) | expected[29 + j * 3 + 1]))
+				break;
+
+		if (j == expected[28] && machine->ram[address] != expected[29 + i * 3 + 2])
+			return "a write is missing or wrong";
+	}
+
+	return NULL;
+}
+
+/* Puts back the memory that the case should have written, and the case itself, if it was written over. */
+static void UndoWrites(Machine* const machine, const TestCase* const test_case, const unsigned char* const expected)
+{
+	const cc_u16f address = test_case->state.program_counter;
+	cc_bool overwritten = cc_false;
+	unsigned int i;
+
+	for (i = 0; i < expected[28]; ++i)
+	{
+		const cc_u16f write_address = ((cc_u16f)expected[29 + i * 3 + 0] << 8) | expected[29 + i * 3 + 1];
+
+		RestoreMemory(machine, write_address, 1);
+
+		if (((write_address - address) & 0xFFFF) < MAXIMUM_INSTRUCTION_BYTES)
+			overwritten = cc_true;
+	}
+
+	if (overwritten)
+		PlaceTestCase(machine, test_case);
+}
+
+static void* ReplayJob(void* const user_data)
+{
+	Job* const job = (Job*)user_data;
+	Machine* const machine = (Machine*)malloc(sizeof(Machine));
+	unsigned long index;
+
+	if (machine == NULL || !InitialiseMachine(machine, job->engine, job->seed))
+	{
+		free(machine);
+		job->failures = job->total_cases;
+		return NULL;
+	}
+
+	for (index = job->first_case; index < job->first_case + job->total_cases; ++index)
+	{
+		const unsigned char* const expected = &job->records[index * RECORD_SIZE];
+		TestCase test_case;
+		unsigned int run;
+
+		CreateTestCase(&test_case, job->seed, index, job->cases_per_instruction);
+		PlaceTestCase(machine, &test_case);
+
+		for (run = 0; run < job->runs_per_case; ++run)
+		{
+			const cc_u16f cycles = RunTestCase(machine, &test_case, job->engine);
+			const char* const message = CheckTestCase(machine, expected, cycles);
+
+			UndoWrites(machine, &test_case, expected);
+
+			if (message != NULL)
+			{
+				ReportFailure(index, &test_case, message);
+				++job->failures;
+				break;
+			}
+		}
+
+		RestoreMemory(machine, test_case.state.program_counter, MAXIMUM_INSTRUCTION_BYTES);
+
+		/* Anything else that differs must have been written by mistake. */
+		if (memcmp(machine->ram, machine->background, sizeof(machine->ram)) != 0)
+		{
+			ReportFailure(index, &test_case, "memory was written which should not have been");
+			++job->failures;
+
+			memcpy(machine->ram, machine->background, sizeof(machine->ram));
+			RestoreMemory(machine, 0, 0x10000);
+		}
+	}
+
+	DeinitialiseMachine(machine);
+	free(machine);
+
+	return NULL;
+}
+
+static int Replay(const char* const file_path, const ClownZ80_Engine engine, unsigned long total_threads, const unsigned int runs_per_case)
+{
+	static Job jobs[MAXIMUM_THREADS];
+
+	unsigned char *buffer;
+	long file_size;
+	unsigned long total_cases, cases_per_instruction, failures, i;
+	cc_u32f seed;
+	FILE* const file = fopen(file_path, "rb");
+
+	if (file == NULL)
+	{
+		fprintf(stderr, "Could not open file '%s'.\n", file_path);
+		return EXIT_FAILURE;
+	}
+
+	fseek(file, 0, SEEK_END);
+	file_size = ftell(file);
+	rewind(file);
+
+	buffer = (unsigned char*)malloc(file_size < FILE_HEADER_SIZE ? FILE_HEADER_SIZE : file_size);
+
+	if (buffer == NULL || fread(buffer, 1, file_size, file) != (size_t)file_size || file_size < FILE_HEADER_SIZE || memcmp(buffer, FILE_MAGIC, 8) != 0)
+	{
+		fprintf(stderr, "File '%s' is not a test case file.\n", file_path);
+		free(buffer);
+		fclose(file);
+		return EXIT_FAILURE;
+	}
+
+	fclose(file);
+
+	seed = ReadLong(&buffer[8]);
+	cases_per_instruction = ReadLong(&buffer[12]);
+	total_cases = total_instructions * cases_per_instruction;
+
+	if ((unsigned long)file_size != FILE_HEADER_SIZE + total_cases * RECORD_SIZE)
+	{
+		fprintf(stderr, "File '%s' is the wrong size.\n", file_path);
+		free(buffer);
+		return EXIT_FAILURE;
+	}
+
+	total_threads = CC_MIN(total_threads, MAXIMUM_THREADS);
+
+	for (i = 0; i < total_threads; ++i)
+	{
+		Job* const job = &jobs[i];
+
+		job->engine = engine;
+		job->seed = seed;
+		job->cases_per_instruction = cases_per_instruction;
+		job->first_case = total_cases * i / total_threads;
+		job->total_cases = total_cases * (i + 1) / total_threads - job->first_case;
+		job->runs_per_case = runs_per_case;
+		job->records = &buffer[FILE_HEADER_SIZE];
+		job->failures = 0;
+
+		if (pthread_create(&job->thread, NULL, ReplayJob, job) != 0)
+		{
+			/* Do the work on this thread instead. */
+			ReplayJob(job);
+			job->thread = pthread_self();
+		}
+	}
+
+	failures = 0;
+
+	for (i = 0; i < total_threads; ++i)
+	{
+		if (!pthread_equal(jobs[i].thread, pthread_self()))
+			pthread_join(jobs[i].thread, NULL);
+
+		failures += jobs[i].failures;
+	}
+
+	free(buffer);
+
+	fprintf(stdout, "%lu of %lu cases failed, using the '%s' engine and %lu threads.\n", failures, total_cases, ClownZ80_Engine_GetName(engine), total_threads);
+
+	return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int main(const int argc, char** const argv)
+{
+	const char *file_path = NULL;
+	ClownZ80_Engine engine = CLOWNZ80_ENGINE_JIT;
+	cc_u32f seed = 1;
+	unsigned long cases_per_instruction = 1000;
+	long total_threads = sysconf(_SC_NPROCESSORS_ONLN);
+	unsigned int runs_per_case = 1;
+	int argument;
+
+	if (argc >= 3)
+	{
+		file_path = argv[2];
+
+		for (argument = 3; argument < argc; ++argument)
+		{
+			if (strcmp(argv[argument], "--engine") == 0 && argument + 1 < argc)
+			{
+				engine = ClownZ80_Engine_FromName(argv[++argument]);
+			}
+			else if (strcmp(argv[argument], "--seed") == 0 && argument + 1 < argc)
+			{
+				seed = strtoul(argv[++argument], NULL, 0) & 0xFFFFFFFF;
+			}
+			else if (strcmp(argv[argument], "--cases") == 0 && argument + 1 < argc)
+			{
+				cases_per_instruction = strtoul(argv[++argument], NULL, 0);
+			}
+			else if (strcmp(argv[argument], "--threads") == 0 && argument + 1 < argc)
+			{
+				total_threads = strtol(argv[++argument], NULL, 0);
+			}
+			else if (strcmp(argv[argument], "--repeat") == 0)
+			{
+				runs_per_case = REPEATS;
+			}
+			else
+			{
+				file_path = NULL;
+				break;
+			}
+		}
+	}
+
+	ListInstructions();
+
+	if (file_path != NULL && strcmp(argv[1], "generate") == 0 && cases_per_instruction != 0)
+		return Generate(file_path, seed, cases_per_instruction);
+	else if (file_path != NULL && strcmp(argv[1], "replay") == 0 && engine != CLOWNZ80_TOTAL_ENGINES)
+		return Replay(file_path, engine, total_threads < 1 ? 1 : total_threads, runs_per_case);
+
+	fputs("Usage: clownz80-fuzz-test generate cases.bin [--seed NUMBER] [--cases PER-INSTRUCTION]\n", stderr);
+	fputs("       clownz80-fuzz-test replay cases.bin [--engine " CLOWNZ80_ENGINE_NAMES "] [--threads COUNT] [--repeat]\n", stderr);
+	return EXIT_FAILURE;
+}
@@ -9,10 +9,22 @@ https://floooh.github.io/2021/12/06/z80-instruction-timing.html
 
 #include <assert.h>
 #include <stddef.h>
+#include <string.h>
+
+#ifdef CLOWNZ80_PROFILER
+	#include <stdlib.h>
+	#include <time.h>
+#endif
 
 #include "clowncommon/clowncommon.h"
 
 #include "common.h"
+#include "jit.h"
+
+/* 'lookup-table-generator.c' builds the interpreter without the lookup tables, as it is what creates them. */
+#ifdef CLOWNZ80_GENERATING_LOOKUP_TABLES
+#undef CLOWNZ80_PRECOMPUTE_INSTRUCTION_METADATA
+#endif
 
 enum
 {
@@ -30,22 +42,73 @@ enum
 	FLAG_MASK_SIGN = 1 << FLAG_BIT_SIGN
 };
 
-typedef struct Z80Instruction
+/* The operations whose flags can be computed lazily, using the state's 'flags_operation'. */
+typedef enum FlagsOperation
+{
+	FLAGS_OPERATION_NONE,     /* 'f' is up to date. */
+	FLAGS_OPERATION_ADD,      /* Sign, zero, half-carry, overflow, and carry. */
+	FLAGS_OPERATION_SUBTRACT, /* The same as above, except with a borrow instead of a half-carry, and with the subtract flag set. */
+	FLAGS_OPERATION_LOGIC,    /* Sign, zero, parity, and carry. */
+	FLAGS_OPERATION_AND       /* The same as above, except with the half-carry flag set. */
+} FlagsOperation;
+
+/* Including a 'DD' or 'FD' prefix. Any further prefixes are executed separately. */
+#define MAXIMUM_INSTRUCTION_LENGTH 5
+/* The number of times that a block must be executed before it is compiled to native code. */
+#define JIT_COMPILE_THRESHOLD 16
+
+typedef struct Z80Instruction Z80Instruction;
+
+typedef void (*InstructionHandler)(ClownZ80_State *state, const ClownZ80_ReadAndWriteCallbacks *callbacks, const Z80Instruction *instruction);
+
+struct Z80Instruction
 {
-#ifdef CLOWNZ80_PRECOMPUTE_INSTRUCTION_METADATA
 	const ClownZ80_InstructionMetadata *metadata;
-#else
-	ClownZ80_InstructionMetadata *metadata;
+	ClownZ80_InstructionMetadata metadata_buffer;
+#ifdef CLOWNZ80_PRECOMPUTE_INSTRUCTION_METADATA
+	InstructionHandler handler;
 #endif
 	cc_u16f literal;
+	cc_u16f displacement;
 	cc_u16f address;
 	cc_bool double_prefix_mode;
-} Z80Instruction;
+};
+
+typedef struct HandlerTableEntry
+{
+	InstructionHandler handler;
+	cc_u8l opcode; /* ClownZ80_Opcode */
+} HandlerTableEntry;
+
+/* The rows of 'instruction_lookup'. */
+enum
+{
+	INSTRUCTION_LOOKUP_NORMAL = 0, /* Plus 'ClownZ80_RegisterMode'. */
+	INSTRUCTION_LOOKUP_BITS = 3,   /* Plus 'ClownZ80_RegisterMode'. */
+	INSTRUCTION_LOOKUP_MISC = 6,
+	TOTAL_INSTRUCTION_LOOKUPS
+};
+
+/* The entries of 'instruction_lookup' pack an instruction's metadata and the index of its handler into 32 bits, so that the
+   whole table takes as little of the cache as possible. The opcode is not included, as it comes with the handler instead.
+   The condition and the embedded literal share a field, as no instruction has both. */
+#define PACKED_METADATA_HANDLER_SHIFT 0
+#define PACKED_METADATA_HANDLER_MASK 0x1FF
+#define PACKED_METADATA_OPERAND_0_SHIFT 9
+#define PACKED_METADATA_OPERAND_1_SHIFT 14
+#define PACKED_METADATA_OPERAND_MASK 0x1F
+#define PACKED_METADATA_LITERAL_SHIFT 19
+#define PACKED_METADATA_LITERAL_MASK 0xFF
+#define PACKED_METADATA_DISPLACEMENT_SHIFT 27
 
 #ifdef CLOWNZ80_PRECOMPUTE_INSTRUCTION_METADATA
-static ClownZ80_InstructionMetadata instruction_metadata_lookup_normal[3][0x100];
-static ClownZ80_InstructionMetadata instruction_metadata_lookup_bits[3][0x100];
-static ClownZ80_InstructionMetadata instruction_metadata_lookup_misc[0x100];
+/* 'instruction_lookup', which holds every instruction, indexed by the above rows and then by opcode. It is generated by
+   'lookup-table-generator.c', so that it is constant data, which needs no initialisation at run-time and can be shared by
+   every process. Indices are used instead of the handlers' addresses, as addresses would need to be relocated when the
+   library is loaded, making the table writable again. */
+#include "lookup-tables.h"
+
+static void LookUpInstruction(Z80Instruction *instruction, cc_u8f lookup, cc_u8f opcode);
 #endif
 
 static cc_bool EvaluateCondition(const cc_u8l flags, const ClownZ80_Condition condition)
@@ -83,12 +146,64 @@ static cc_bool EvaluateCondition(const cc_u8l flags, const ClownZ80_Condition co
 	}
 }
 
+static cc_u16f BusRead(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const cc_u16f address)
+{
+	/* Plain memory is accessed directly, sparing an indirect call. */
+	if (callbacks->memory_map != NULL)
+	{
+		const cc_u8l* const page = callbacks->memory_map->read[address >> CLOWNZ80_MEMORY_MAP_PAGE_SHIFT];
+
+		if (page != NULL)
+			return page[address % CLOWNZ80_MEMORY_MAP_PAGE_SIZE];
+	}
+
+	/* The callbacks could have side-effects, or return something different every time. */
+	++state->external_accesses;
+
+	return callbacks->read((void*)callbacks->user_data, address);
+}
+
+#ifdef CLOWNZ80_TRACER
+static void TraceMemoryWrite(ClownZ80_Tracer *tracer, cc_u16f address, cc_u16f data);
+#endif
+
+static void BusWrite(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const cc_u16f address, const cc_u16f data)
+{
+	++state->external_accesses;
+
+#ifdef CLOWNZ80_TRACER
+	if (callbacks->tracer != NULL)
+		TraceMemoryWrite(callbacks->tracer, address, data);
+#endif
+
+	/* Discard any cached instructions that are being overwritten. */
+	if (callbacks->instruction_cache != NULL)
+		ClownZ80_InstructionCache_Invalidate(callbacks->instruction_cache, address, 1);
+
+	if (callbacks->block_cache != NULL && (callbacks->block_cache->code_bitmap[address / 8] & (1 << (address % 8))) != 0)
+		ClownZ80_BlockCache_Invalidate(callbacks->block_cache, address, 1);
+
+	/* Plain memory is accessed directly, sparing an indirect call. */
+	if (callbacks->memory_map != NULL)
+	{
+		cc_u8l* const page = callbacks->memory_map->write[address >> CLOWNZ80_MEMORY_MAP_PAGE_SHIFT];
+
+		if (page != NULL)
+		{
+			page[address % CLOWNZ80_MEMORY_MAP_PAGE_SIZE] = data;
+			return;
+		}
+	}
+
+	callbacks->write((void*)callbacks->user_data, address, data);
+}
+
 static cc_u16f MemoryRead(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const cc_u16f address)
 {
 	/* Memory accesses take 3 cycles. */
 	state->cycles += 3;
 
-	return callbacks->read((void*)callbacks->user_data, address);
+	return BusRead(state, callbacks, address);
 }
 
 static void MemoryWrite(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const cc_u16f address, const cc_u16f data)
@@ -96,7 +211,7 @@ static void MemoryWrite(ClownZ80_State* const state, const ClownZ80_ReadAndWrite
 	/* Memory accesses take 3 cycles. */
 	state->cycles += 3;
 
-	callbacks->write((void*)callbacks->user_data, address, data);
+	BusWrite(state, callbacks, address, data);
 }
 
 static cc_u16f InstructionMemoryRead(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks)
@@ -135,6 +250,52 @@ static void MemoryWrite16Bit(ClownZ80_State* const state, const ClownZ80_ReadAnd
 	MemoryWrite(state, callbacks, (address + 1) & 0xFFFF, value >> 8);
 }
 
+static const ClownZ80_PortHandler* FindPortHandler(const ClownZ80_ReadAndWriteCallbacks* const callbacks, const cc_u16f port)
+{
+	const ClownZ80_PortMap* const port_map = callbacks->port_map;
+
+	if (port_map == NULL)
+		return NULL;
+	else if (port_map->full_handlers != NULL)
+		return &port_map->full_handlers[port];
+	else
+		return &port_map->handlers[port & 0xFF];
+}
+
+static cc_u16f PortRead(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const cc_u16f port)
+{
+	const ClownZ80_PortHandler* const handler = FindPortHandler(callbacks, port);
+
+	/* Port accesses take 4 cycles. */
+	state->cycles += 4;
+
+	/* Ports are hardware, so reading one could have side-effects, or return something different every time. */
+	++state->external_accesses;
+
+	if (handler != NULL && handler->read != NULL)
+		return handler->read((void*)handler->user_data, port);
+	else if (callbacks->port_read != NULL)
+		return callbacks->port_read((void*)callbacks->user_data, port);
+	else
+		/* Nothing is driving the data bus. */
+		return 0xFF;
+}
+
+static void PortWrite(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const cc_u16f port, const cc_u16f data)
+{
+	const ClownZ80_PortHandler* const handler = FindPortHandler(callbacks, port);
+
+	/* Port accesses take 4 cycles. */
+	state->cycles += 4;
+
+	++state->external_accesses;
+
+	if (handler != NULL && handler->write != NULL)
+		handler->write((void*)handler->user_data, port, data);
+	else if (callbacks->port_write != NULL)
+		callbacks->port_write((void*)callbacks->user_data, port, data);
+}
+
 static cc_u16f ReadOperand(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction, ClownZ80_Operand operand)
 {
 	cc_u16f value;
@@ -242,7 +403,7 @@ static cc_u16f ReadOperand(ClownZ80_State* const state, const ClownZ80_ReadAndWr
 			value = MemoryRead(state, callbacks, instruction->address);
 
 			if (instruction->metadata->opcode == CLOWNZ80_OPCODE_LD_16BIT)
-				value |= MemoryRead(state, callbacks, instruction->address + 1) << 8;
+				value |= MemoryRead(state, callbacks, (instruction->address + 1) & 0xFFFF) << 8;
 
 			break;
 	}
@@ -366,28 +527,38 @@ static void WriteOperand(ClownZ80_State* const state, const ClownZ80_ReadAndWrit
 	}
 }
 
-static void DecodeInstruction(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, Z80Instruction* const instruction)
+static void FetchInstruction(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, Z80Instruction* const instruction)
 {
 	cc_u16f opcode;
-	cc_u16f displacement;
 	cc_u16f i;
 
 	opcode = OpcodeFetch(state, callbacks);
 
-	/* Shut up a 'may be used uninitialised' compiler warning. */
-	displacement = 0;
+	/* A prefix is fetched along with the instruction that it modifies, so that the two are executed in one go.
+	   Interrupts cannot occur between them anyway. If the instruction is another prefix, then it is left as an
+	   instruction of its own, so that memory which is full of prefixes cannot trap the fetcher forever. */
+	if (opcode == 0xDD || opcode == 0xFD)
+	{
+		state->register_mode = opcode == 0xDD ? CLOWNZ80_REGISTER_MODE_IX : CLOWNZ80_REGISTER_MODE_IY;
+		opcode = OpcodeFetch(state, callbacks);
+	}
+
+	instruction->literal = 0;
+	instruction->displacement = 0;
+
+	instruction->metadata = &instruction->metadata_buffer;
 
 #ifdef CLOWNZ80_PRECOMPUTE_INSTRUCTION_METADATA
-	instruction->metadata = &instruction_metadata_lookup_normal[state->register_mode][opcode];
+	LookUpInstruction(instruction, INSTRUCTION_LOOKUP_NORMAL + state->register_mode, opcode);
 #else
-	Z80_DecodeInstructionMetadata(instruction->metadata, CLOWNZ80_INSTRUCTION_MODE_NORMAL, (ClownZ80_RegisterMode)state->register_mode, opcode);
+	ClownZ80_DecodeInstructionMetadata(&instruction->metadata_buffer, CLOWNZ80_INSTRUCTION_MODE_NORMAL, (ClownZ80_RegisterMode)state->register_mode, opcode);
 #endif
 
 	/* Obtain displacement byte if one exists. */
 	if (instruction->metadata->has_displacement)
 	{
-		displacement = InstructionMemoryRead(state, callbacks);
-		displacement = CC_SIGN_EXTEND_UINT(7, displacement);
+		instruction->displacement = InstructionMemoryRead(state, callbacks);
+		instruction->displacement = CC_SIGN_EXTEND_UINT(7, instruction->displacement);
 
 		/* The displacement byte adds 5 cycles on top of the 3 required to read it. */
 		state->cycles += 5;
@@ -409,9 +580,9 @@ static void DecodeInstruction(ClownZ80_State* const state, const ClownZ80_ReadAn
 				opcode = OpcodeFetch(state, callbacks);
 				
 			#ifdef CLOWNZ80_PRECOMPUTE_INSTRUCTION_METADATA
-				instruction->metadata = &instruction_metadata_lookup_bits[state->register_mode][opcode];
+				LookUpInstruction(instruction, INSTRUCTION_LOOKUP_BITS + state->register_mode, opcode);
 			#else
-				ClownZ80_DecodeInstructionMetadata(instruction->metadata, CLOWNZ80_INSTRUCTION_MODE_BITS, (ClownZ80_RegisterMode)state->register_mode, opcode);
+				ClownZ80_DecodeInstructionMetadata(&instruction->metadata_buffer, CLOWNZ80_INSTRUCTION_MODE_BITS, (ClownZ80_RegisterMode)state->register_mode, opcode);
 			#endif
 			}
 			else
@@ -425,24 +596,21 @@ static void DecodeInstruction(ClownZ80_State* const state, const ClownZ80_ReadAn
 				/* Reading the opcode is overlaid with the 5 displacement cycles, so the above memory read doesn't cost 3 cycles. */
 				state->cycles -= 3;
 
-				if (state->register_mode == CLOWNZ80_REGISTER_MODE_IX)
-					instruction->address = ((((cc_u16f)state->ixh << 8) | state->ixl) + displacement) & 0xFFFF;
-				else /*if (state->register_mode == CLOWNZ80_REGISTER_MODE_IY)*/
-					instruction->address = ((((cc_u16f)state->iyh << 8) | state->iyl) + displacement) & 0xFFFF;
-
 				/* TODO: Use a separate lookup for double-prefix mode? */
 			#ifdef CLOWNZ80_PRECOMPUTE_INSTRUCTION_METADATA
-				instruction->metadata = &instruction_metadata_lookup_bits[CLOWNZ80_REGISTER_MODE_HL][opcode];
+				LookUpInstruction(instruction, INSTRUCTION_LOOKUP_BITS + CLOWNZ80_REGISTER_MODE_HL, opcode);
 			#else
-				ClownZ80_DecodeInstructionMetadata(instruction->metadata, CLOWNZ80_INSTRUCTION_MODE_BITS, CLOWNZ80_REGISTER_MODE_HL, opcode);
+				ClownZ80_DecodeInstructionMetadata(&instruction->metadata_buffer, CLOWNZ80_INSTRUCTION_MODE_BITS, CLOWNZ80_REGISTER_MODE_HL, opcode);
 			#endif
 
 				if (instruction->metadata->operands[1] == CLOWNZ80_OPERAND_HL_INDIRECT)
+				{
 				#ifdef CLOWNZ80_PRECOMPUTE_INSTRUCTION_METADATA
-					instruction->metadata = &instruction_metadata_lookup_bits[state->register_mode][opcode];
+					LookUpInstruction(instruction, INSTRUCTION_LOOKUP_BITS + state->register_mode, opcode);
 				#else
-					ClownZ80_DecodeInstructionMetadata(instruction->metadata, CLOWNZ80_INSTRUCTION_MODE_BITS, (ClownZ80_RegisterMode)state->register_mode, opcode);
+					ClownZ80_DecodeInstructionMetadata(&instruction->metadata_buffer, CLOWNZ80_INSTRUCTION_MODE_BITS, (ClownZ80_RegisterMode)state->register_mode, opcode);
 				#endif
+				}
 			}
 
 			break;
@@ -451,9 +619,9 @@ static void DecodeInstruction(ClownZ80_State* const state, const ClownZ80_ReadAn
 			opcode = OpcodeFetch(state, callbacks);
 
 		#ifdef CLOWNZ80_PRECOMPUTE_INSTRUCTION_METADATA
-			instruction->metadata = &instruction_metadata_lookup_misc[opcode];
+			LookUpInstruction(instruction, INSTRUCTION_LOOKUP_MISC, opcode);
 		#else
-			ClownZ80_DecodeInstructionMetadata(instruction->metadata, CLOWNZ80_INSTRUCTION_MODE_MISC, CLOWNZ80_REGISTER_MODE_HL, opcode);
+			ClownZ80_DecodeInstructionMetadata(&instruction->metadata_buffer, CLOWNZ80_INSTRUCTION_MODE_MISC, CLOWNZ80_REGISTER_MODE_HL, opcode);
 		#endif
 
 			break;
@@ -483,6 +651,30 @@ static void DecodeInstruction(ClownZ80_State* const state, const ClownZ80_ReadAn
 			break;
 	}
 
+	/* Obtain the address of absolute memory operands.
+	   No instruction has both this and a literal, so the same storage is used for both. */
+	for (i = 0; i < 2; ++i)
+	{
+		if (instruction->metadata->operands[i] == CLOWNZ80_OPERAND_ADDRESS)
+		{
+			instruction->literal = InstructionMemoryRead(state, callbacks);
+			instruction->literal |= InstructionMemoryRead(state, callbacks) << 8;
+		}
+	}
+}
+
+static void ResolveOperandAddresses(const ClownZ80_State* const state, Z80Instruction* const instruction)
+{
+	cc_u16f i;
+
+	if (instruction->double_prefix_mode)
+	{
+		if (state->register_mode == CLOWNZ80_REGISTER_MODE_IX)
+			instruction->address = ((((cc_u16f)state->ixh << 8) | state->ixl) + instruction->displacement) & 0xFFFF;
+		else /*if (state->register_mode == CLOWNZ80_REGISTER_MODE_IY)*/
+			instruction->address = ((((cc_u16f)state->iyh << 8) | state->iyl) + instruction->displacement) & 0xFFFF;
+	}
+
 	/* Pre-calculate the address of indirect memory operands. */
 	for (i = 0; i < 2; ++i)
 	{
@@ -504,21 +696,104 @@ static void DecodeInstruction(ClownZ80_State* const state, const ClownZ80_ReadAn
 				break;
 
 			case CLOWNZ80_OPERAND_IX_INDIRECT:
-				instruction->address = ((((cc_u16f)state->ixh << 8) | state->ixl) + displacement) & 0xFFFF;
+				instruction->address = ((((cc_u16f)state->ixh << 8) | state->ixl) + instruction->displacement) & 0xFFFF;
 				break;
 
 			case CLOWNZ80_OPERAND_IY_INDIRECT:
-				instruction->address = ((((cc_u16f)state->iyh << 8) | state->iyl) + displacement) & 0xFFFF;
+				instruction->address = ((((cc_u16f)state->iyh << 8) | state->iyl) + instruction->displacement) & 0xFFFF;
 				break;
 
 			case CLOWNZ80_OPERAND_ADDRESS:
-				instruction->address = InstructionMemoryRead(state, callbacks);
-				instruction->address |= InstructionMemoryRead(state, callbacks) << 8;
+				instruction->address = instruction->literal;
 				break;
 		}
 	}
 }
 
+static cc_bool IsInstructionCacheable(const ClownZ80_ReadAndWriteCallbacks* const callbacks, const cc_u16f address, const cc_u16f length)
+{
+	const ClownZ80_MemoryMap* const memory_map = callbacks->memory_map;
+
+	/* Only instructions that lie entirely within plain memory can be cached, as reading memory-mapped I/O may have side-effects. */
+	/* Instructions are never longer than a page, so only the first and last bytes need checking. */
+	return length <= MAXIMUM_INSTRUCTION_LENGTH
+		&& memory_map != NULL
+		&& memory_map->read[address >> CLOWNZ80_MEMORY_MAP_PAGE_SHIFT] != NULL
+		&& memory_map->read[((address + length - 1) & 0xFFFF) >> CLOWNZ80_MEMORY_MAP_PAGE_SHIFT] != NULL;
+}
+
+static void SaveDecodedInstruction(ClownZ80_DecodedInstruction* const decoded_instruction, const Z80Instruction* const instruction, const cc_u16f length, const cc_u16f cycles, const cc_u16f opcode_fetches, const cc_u8f register_mode)
+{
+	decoded_instruction->metadata = *instruction->metadata;
+	decoded_instruction->literal = instruction->literal;
+	decoded_instruction->displacement = instruction->displacement;
+	decoded_instruction->length = length;
+	decoded_instruction->cycles = cycles;
+	decoded_instruction->opcode_fetches = opcode_fetches;
+	decoded_instruction->double_prefix_mode = instruction->double_prefix_mode;
+	decoded_instruction->register_mode = register_mode;
+#ifdef CLOWNZ80_PRECOMPUTE_INSTRUCTION_METADATA
+	decoded_instruction->handler = (void(*)(void))instruction->handler;
+#endif
+}
+
+static void LoadDecodedInstruction(ClownZ80_State* const state, const ClownZ80_DecodedInstruction* const decoded_instruction, Z80Instruction* const instruction)
+{
+	/* Replay the side-effects of fetching the instruction without actually doing it. */
+	state->program_counter = (state->program_counter + decoded_instruction->length) & 0xFFFF;
+	state->r = (state->r & 0x80) | ((state->r + decoded_instruction->opcode_fetches) & 0x7F);
+	state->cycles += decoded_instruction->cycles;
+	state->register_mode = decoded_instruction->register_mode;
+
+	instruction->metadata = &decoded_instruction->metadata;
+	instruction->literal = decoded_instruction->literal;
+	instruction->displacement = decoded_instruction->displacement;
+	instruction->double_prefix_mode = decoded_instruction->double_prefix_mode;
+#ifdef CLOWNZ80_PRECOMPUTE_INSTRUCTION_METADATA
+	instruction->handler = (InstructionHandler)decoded_instruction->handler;
+#endif
+}
+
+static void DecodeInstruction(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, Z80Instruction* const instruction)
+{
+	ClownZ80_InstructionCache* const instruction_cache = callbacks->instruction_cache;
+
+	if (instruction_cache == NULL)
+	{
+		FetchInstruction(state, callbacks, instruction);
+	}
+	else
+	{
+		const cc_u16f address = state->program_counter;
+		ClownZ80_InstructionCacheEntry* const entry = &instruction_cache->entries[address % CLOWNZ80_INSTRUCTION_CACHE_SIZE];
+
+		if (entry->instruction.length != 0 && entry->address == address && entry->register_mode == state->register_mode)
+		{
+			LoadDecodedInstruction(state, &entry->instruction, instruction);
+		}
+		else
+		{
+			const cc_u16f starting_r = state->r;
+			const cc_u16f starting_cycles = state->cycles;
+			const cc_u8l starting_register_mode = state->register_mode;
+			cc_u16f length;
+
+			FetchInstruction(state, callbacks, instruction);
+
+			length = (state->program_counter - address) & 0xFFFF;
+
+			if (IsInstructionCacheable(callbacks, address, length))
+			{
+				SaveDecodedInstruction(&entry->instruction, instruction, length, state->cycles - starting_cycles, (state->r - starting_r) & 0x7F, state->register_mode);
+				entry->address = address;
+				entry->register_mode = starting_register_mode;
+			}
+		}
+	}
+
+	ResolveOperandAddresses(state, instruction);
+}
+
 static cc_bool ComputeParity(cc_u8f value)
 {
 	value ^= value >> 4;
@@ -555,1478 +830,3932 @@ static cc_bool ComputeParity(cc_u8f value)
 
 #define WRITE_DESTINATION WriteOperand(state, callbacks, instruction, (ClownZ80_Operand)instruction->metadata->operands[1], result_value)
 
-static void ExecuteInstruction(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
-{
-	cc_u16f source_value;
-	cc_u16f destination_value;
-	cc_u16f result_value;
-	cc_u16f result_value_with_carry;
-	cc_u32f result_value_with_carry_16bit;
-	cc_u8l swap_holder;
-	cc_bool carry;
+#define UNIMPLEMENTED_Z80_INSTRUCTION(instruction) callbacks->log((void*)callbacks->user_data, "Unimplemented instruction " instruction " used at 0x%" CC_PRIXLEAST16, state->program_counter)
 
-	state->register_mode = CLOWNZ80_REGISTER_MODE_HL;
+static void MaterialiseFlags(ClownZ80_State* const state)
+{
+	const cc_u16f source_value = state->flags_source;
+	const cc_u16f destination_value = state->flags_destination;
+	const cc_u16f result_value_with_carry = state->flags_result;
+	const cc_u16f result_value = result_value_with_carry & 0xFF;
 
-	switch ((ClownZ80_Opcode)instruction->metadata->opcode)
+	switch ((FlagsOperation)state->flags_operation)
 	{
-		#define UNIMPLEMENTED_Z80_INSTRUCTION(instruction) callbacks->log((void*)callbacks->user_data, "Unimplemented instruction " instruction " used at 0x%" CC_PRIXLEAST16, state->program_counter)
+		case FLAGS_OPERATION_NONE:
+			return;
 
-		case CLOWNZ80_OPCODE_NOP:
-			/* Does nothing, naturally. */
+		case FLAGS_OPERATION_ADD:
+			state->f = 0;
+			CONDITION_CARRY;
+			CONDITION_SIGN;
+			CONDITION_ZERO;
+			CONDITION_HALF_CARRY;
+			CONDITION_OVERFLOW;
 			break;
 
-		case CLOWNZ80_OPCODE_EX_AF_AF:
-			SWAP(state->a, state->a_);
-			SWAP(state->f, state->f_);
-			break;
+		case FLAGS_OPERATION_SUBTRACT:
+			state->f = 0;
+			CONDITION_CARRY;
+			CONDITION_SIGN;
+			CONDITION_ZERO;
+			CONDITION_HALF_CARRY;
+			CONDITION_OVERFLOW;
 
-		case CLOWNZ80_OPCODE_DJNZ:
-			/* This instruction takes an extra cycle. */
-			state->cycles += 1;
+			state->f ^= FLAG_MASK_HALF_CARRY;
+			state->f |= FLAG_MASK_ADD_SUBTRACT;
+			break;
 
-			--state->b;
-			state->b &= 0xFF;
+		case FLAGS_OPERATION_LOGIC:
+			state->f = 0;
+			CONDITION_CARRY;
+			CONDITION_SIGN;
+			CONDITION_ZERO;
+			CONDITION_PARITY;
+			break;
 
-			if (state->b != 0)
-			{
-				state->program_counter += CC_SIGN_EXTEND_UINT(7, instruction->literal);
-				state->program_counter &= 0xFFFF;
+		case FLAGS_OPERATION_AND:
+			state->f = 0;
+			CONDITION_CARRY;
+			CONDITION_SIGN;
+			CONDITION_ZERO;
+			state->f |= FLAG_MASK_HALF_CARRY;
+			CONDITION_PARITY;
+			break;
+	}
 
-				/* Branching takes 5 cycles. */
-				state->cycles += 5;
-			}
+	state->flags_operation = FLAGS_OPERATION_NONE;
+}
 
-			break;
+/* Records the operands and result (including the carry in bit 8) of an operation, so that the flags can be computed from them later.
+   With lazy flags disabled, they are computed immediately instead. */
+static void SetFlags(ClownZ80_State* const state, const FlagsOperation operation, const cc_u16f source_value, const cc_u16f destination_value, const cc_u16f result_value_with_carry)
+{
+	state->flags_operation = operation;
+	state->flags_source = source_value & 0xFFFF;
+	state->flags_destination = destination_value & 0xFFFF;
+	state->flags_result = result_value_with_carry & 0xFFFF;
 
-		case CLOWNZ80_OPCODE_JR_CONDITIONAL:
-			if (!EvaluateCondition(state->f, (ClownZ80_Condition)instruction->metadata->condition))
-				break;
-			/* Fallthrough */
-		case CLOWNZ80_OPCODE_JR_UNCONDITIONAL:
-			state->program_counter += CC_SIGN_EXTEND_UINT(7, instruction->literal);
-			state->program_counter &= 0xFFFF;
+#ifndef CLOWNZ80_LAZY_FLAGS
+	MaterialiseFlags(state);
+#endif
+}
 
-			/* Branching takes 5 cycles. */
-			state->cycles += 5;
+/* Avoids computing the rest of the flags when only the carry is needed. */
+static cc_bool GetCarryFlag(const ClownZ80_State* const state)
+{
+	if (state->flags_operation == FLAGS_OPERATION_NONE)
+		return (state->f & FLAG_MASK_CARRY) != 0;
+	else
+		return (state->flags_result & 0x100) != 0;
+}
 
-			break;
+static void Execute_NOP(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	(void)state;
+	(void)callbacks;
+	(void)instruction;
+	/* Does nothing, naturally. */
+}
 
-		case CLOWNZ80_OPCODE_LD_8BIT:
-		case CLOWNZ80_OPCODE_LD_16BIT:
-			READ_SOURCE;
+static void Execute_EX_AF_AF(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	cc_u8l swap_holder;
 
-			result_value = source_value;
+	(void)callbacks;
+	(void)instruction;
 
-			WRITE_DESTINATION;
+	MaterialiseFlags(state);
 
-			break;
+	SWAP(state->a, state->a_);
+	SWAP(state->f, state->f_);
+}
 
-		case CLOWNZ80_OPCODE_ADD_HL:
-			READ_SOURCE;
-			READ_DESTINATION;
+static void Execute_DJNZ(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	(void)callbacks;
 
-			result_value_with_carry_16bit = (cc_u32f)source_value + (cc_u32f)destination_value;
-			result_value = result_value_with_carry_16bit & 0xFFFF;
+	/* This instruction takes an extra cycle. */
+	state->cycles += 1;
 
-			state->f &= FLAG_MASK_SIGN | FLAG_MASK_ZERO | FLAG_MASK_PARITY_OVERFLOW;
+	--state->b;
+	state->b &= 0xFF;
 
-			CONDITION_CARRY_16BIT;
-			CONDITION_HALF_CARRY_16BIT;
+	if (state->b != 0)
+	{
+		state->program_counter += CC_SIGN_EXTEND_UINT(7, instruction->literal);
+		state->program_counter &= 0xFFFF;
 
-			WRITE_DESTINATION;
+		/* Branching takes 5 cycles. */
+		state->cycles += 5;
+	}
+}
 
-			/* This instruction requires an extra 7 cycles. */
-			state->cycles += 7;
+static void Execute_JR_UNCONDITIONAL(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	(void)callbacks;
 
-			break;
+	state->program_counter += CC_SIGN_EXTEND_UINT(7, instruction->literal);
+	state->program_counter &= 0xFFFF;
 
-		case CLOWNZ80_OPCODE_INC_16BIT:
-			READ_DESTINATION;
+	/* Branching takes 5 cycles. */
+	state->cycles += 5;
+}
 
-			result_value = (destination_value + 1) & 0xFFFF;
+static void Execute_JR_CONDITIONAL(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	MaterialiseFlags(state);
 
-			WRITE_DESTINATION;
+	if (EvaluateCondition(state->f, (ClownZ80_Condition)instruction->metadata->condition))
+		Execute_JR_UNCONDITIONAL(state, callbacks, instruction);
+}
 
-			/* This instruction requires an extra 2 cycles. */
-			state->cycles += 2;
+static void Execute_LD(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	cc_u16f source_value;
+	cc_u16f result_value;
 
-			break;
+	READ_SOURCE;
 
-		case CLOWNZ80_OPCODE_DEC_16BIT:
-			READ_DESTINATION;
+	result_value = source_value;
 
-			result_value = (destination_value - 1) & 0xFFFF;
+	WRITE_DESTINATION;
+}
 
-			WRITE_DESTINATION;
+static void Execute_ADD_HL(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	cc_u16f source_value;
+	cc_u16f destination_value;
+	cc_u16f result_value;
+	cc_u32f result_value_with_carry_16bit;
 
-			/* This instruction requires an extra 2 cycles. */
-			state->cycles += 2;
+	MaterialiseFlags(state);
 
-			break;
+	READ_SOURCE;
+	READ_DESTINATION;
 
-		case CLOWNZ80_OPCODE_INC_8BIT:
-			source_value = 1;
-			READ_DESTINATION;
+	result_value_with_carry_16bit = (cc_u32f)source_value + (cc_u32f)destination_value;
+	result_value = result_value_with_carry_16bit & 0xFFFF;
 
-			result_value = (destination_value + source_value) & 0xFF;
+	state->f &= FLAG_MASK_SIGN | FLAG_MASK_ZERO | FLAG_MASK_PARITY_OVERFLOW;
 
-			state->f &= FLAG_MASK_CARRY;
+	CONDITION_CARRY_16BIT;
+	CONDITION_HALF_CARRY_16BIT;
 
-			CONDITION_SIGN;
-			CONDITION_ZERO;
-			CONDITION_HALF_CARRY;
-			CONDITION_OVERFLOW;
+	WRITE_DESTINATION;
 
-			WRITE_DESTINATION;
+	/* This instruction requires an extra 7 cycles. */
+	state->cycles += 7;
+}
 
-			/* The memory-accessing version takes an extra cycle. */
-			state->cycles += instruction->metadata->operands[1] == CLOWNZ80_OPERAND_HL_INDIRECT
-				|| instruction->metadata->operands[1] == CLOWNZ80_OPERAND_IX_INDIRECT
-				|| instruction->metadata->operands[1] == CLOWNZ80_OPERAND_IY_INDIRECT;
+static void Execute_INC_16BIT(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	cc_u16f destination_value;
+	cc_u16f result_value;
 
-			break;
+	READ_DESTINATION;
 
-		case CLOWNZ80_OPCODE_DEC_8BIT:
-			source_value = -1;
-			READ_DESTINATION;
+	result_value = (destination_value + 1) & 0xFFFF;
 
-			result_value = (destination_value + source_value) & 0xFF;
+	WRITE_DESTINATION;
 
-			state->f &= FLAG_MASK_CARRY;
+	/* This instruction requires an extra 2 cycles. */
+	state->cycles += 2;
+}
 
-			CONDITION_SIGN;
-			CONDITION_ZERO;
-			CONDITION_HALF_CARRY;
-			CONDITION_OVERFLOW;
+static void Execute_DEC_16BIT(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	cc_u16f destination_value;
+	cc_u16f result_value;
 
-			state->f ^= FLAG_MASK_HALF_CARRY;
-			state->f |= FLAG_MASK_ADD_SUBTRACT;
+	READ_DESTINATION;
 
-			WRITE_DESTINATION;
+	result_value = (destination_value - 1) & 0xFFFF;
 
-			/* The memory-accessing version takes an extra cycle. */
-			state->cycles += instruction->metadata->operands[1] == CLOWNZ80_OPERAND_HL_INDIRECT
-				|| instruction->metadata->operands[1] == CLOWNZ80_OPERAND_IX_INDIRECT
-				|| instruction->metadata->operands[1] == CLOWNZ80_OPERAND_IY_INDIRECT;
+	WRITE_DESTINATION;
 
-			break;
+	/* This instruction requires an extra 2 cycles. */
+	state->cycles += 2;
+}
 
-		case CLOWNZ80_OPCODE_RLCA:
-			carry = (state->a & 0x80) != 0;
+static cc_u16f Operation_INC_8BIT(ClownZ80_State* const state, const cc_u16f value)
+{
+	cc_u16f source_value;
+	cc_u16f destination_value;
+	cc_u16f result_value;
 
-			state->a <<= 1;
-			state->a &= 0xFF;
-			state->a |= carry ? 0x01 : 0;
+	source_value = 1;
+	destination_value = value;
 
-			state->f &= FLAG_MASK_SIGN | FLAG_MASK_ZERO | FLAG_MASK_PARITY_OVERFLOW;
-			state->f |= carry ? FLAG_MASK_CARRY : 0;
+	result_value = (destination_value + source_value) & 0xFF;
 
-			break;
+	SetFlags(state, FLAGS_OPERATION_ADD, source_value, destination_value, result_value | (GetCarryFlag(state) ? 0x100 : 0));
 
-		case CLOWNZ80_OPCODE_RRCA:
-			carry = (state->a & 0x01) != 0;
+	return result_value;
+}
 
-			state->a >>= 1;
-			state->a |= carry ? 0x80 : 0;
+static void Execute_INC_8BIT(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	cc_u16f destination_value;
+	cc_u16f result_value;
 
-			state->f &= FLAG_MASK_SIGN | FLAG_MASK_ZERO | FLAG_MASK_PARITY_OVERFLOW;
-			state->f |= carry ? FLAG_MASK_CARRY : 0;
+	READ_DESTINATION;
+	result_value = Operation_INC_8BIT(state, destination_value);
+	WRITE_DESTINATION;
 
-			break;
+	/* The memory-accessing version takes an extra cycle. */
+	state->cycles += instruction->metadata->operands[1] == CLOWNZ80_OPERAND_HL_INDIRECT
+		|| instruction->metadata->operands[1] == CLOWNZ80_OPERAND_IX_INDIRECT
+		|| instruction->metadata->operands[1] == CLOWNZ80_OPERAND_IY_INDIRECT;
+}
 
-		case CLOWNZ80_OPCODE_RLA:
-			carry = (state->a & 0x80) != 0;
+static cc_u16f Operation_DEC_8BIT(ClownZ80_State* const state, const cc_u16f value)
+{
+	cc_u16f source_value;
+	cc_u16f destination_value;
+	cc_u16f result_value;
 
-			state->a <<= 1;
-			state->a &= 0xFF;
-			state->a |= (state->f & FLAG_MASK_CARRY) != 0 ? 1 : 0;
+	source_value = -1;
+	destination_value = value;
 
-			state->f &= FLAG_MASK_SIGN | FLAG_MASK_ZERO | FLAG_MASK_PARITY_OVERFLOW;
-			state->f |= carry ? FLAG_MASK_CARRY : 0;
+	result_value = (destination_value + source_value) & 0xFF;
 
-			break;
+	SetFlags(state, FLAGS_OPERATION_SUBTRACT, source_value, destination_value, result_value | (GetCarryFlag(state) ? 0x100 : 0));
 
-		case CLOWNZ80_OPCODE_RRA:
-			carry = (state->a & 0x01) != 0;
+	return result_value;
+}
 
-			state->a >>= 1;
-			state->a |= (state->f & FLAG_MASK_CARRY) != 0 ? 0x80 : 0;
+static void Execute_DEC_8BIT(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	cc_u16f destination_value;
+	cc_u16f result_value;
 
-			state->f &= FLAG_MASK_SIGN | FLAG_MASK_ZERO | FLAG_MASK_PARITY_OVERFLOW;
-			state->f |= carry ? FLAG_MASK_CARRY : 0;
+	READ_DESTINATION;
+	result_value = Operation_DEC_8BIT(state, destination_value);
+	WRITE_DESTINATION;
 
-			break;
+	/* The memory-accessing version takes an extra cycle. */
+	state->cycles += instruction->metadata->operands[1] == CLOWNZ80_OPERAND_HL_INDIRECT
+		|| instruction->metadata->operands[1] == CLOWNZ80_OPERAND_IX_INDIRECT
+		|| instruction->metadata->operands[1] == CLOWNZ80_OPERAND_IY_INDIRECT;
+}
 
-		case CLOWNZ80_OPCODE_DAA:
-		{
-			cc_u16f correction_factor;
+static void Execute_RLCA(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	cc_bool carry;
 
-			const cc_u16f original_a = state->a;
+	(void)callbacks;
+	(void)instruction;
 
-			correction_factor = ((state->a + 0x66) ^ state->a) & 0x110;
-			correction_factor |= (state->f & FLAG_MASK_CARRY) << (8 - FLAG_BIT_CARRY);
-			correction_factor |= (state->f & FLAG_MASK_HALF_CARRY) << (4 - FLAG_BIT_HALF_CARRY);
-			correction_factor = (correction_factor >> 2) | (correction_factor >> 3);
+	MaterialiseFlags(state);
 
-			if ((state->f & FLAG_MASK_ADD_SUBTRACT) != 0)
-				state->a -= correction_factor;
-			else
-				state->a += correction_factor;
+	carry = (state->a & 0x80) != 0;
 
-			state->a &= 0xFF;
+	state->a <<= 1;
+	state->a &= 0xFF;
+	state->a |= carry ? 0x01 : 0;
 
-			state->f &= FLAG_MASK_ADD_SUBTRACT;
-			state->f |= (state->a >> (7 - FLAG_BIT_SIGN)) & FLAG_MASK_SIGN;
-			state->f |= (state->a == 0) << FLAG_BIT_ZERO;
-			state->f |= ((original_a ^ state->a) >> (4 - FLAG_BIT_HALF_CARRY)) & FLAG_MASK_HALF_CARRY; /* Binary carry. */
-			state->f |= ComputeParity(state->a) ? FLAG_MASK_PARITY_OVERFLOW : 0;
-			state->f |= (correction_factor >> (6 - FLAG_BIT_CARRY)) & FLAG_MASK_CARRY; /* Decimal carry. */
+	state->f &= FLAG_MASK_SIGN | FLAG_MASK_ZERO | FLAG_MASK_PARITY_OVERFLOW;
+	state->f |= carry ? FLAG_MASK_CARRY : 0;
+}
 
-			break;
-		}
+static void Execute_RRCA(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	cc_bool carry;
 
-		case CLOWNZ80_OPCODE_CPL:
-			state->a = ~state->a;
-			state->a &= 0xFF;
+	(void)callbacks;
+	(void)instruction;
 
-			state->f |= FLAG_MASK_HALF_CARRY | FLAG_MASK_ADD_SUBTRACT;
+	MaterialiseFlags(state);
 
-			break;
+	carry = (state->a & 0x01) != 0;
 
-		case CLOWNZ80_OPCODE_SCF:
-			state->f &= FLAG_MASK_SIGN | FLAG_MASK_ZERO | FLAG_MASK_PARITY_OVERFLOW;
-			state->f |= FLAG_MASK_CARRY;
-			break;
+	state->a >>= 1;
+	state->a |= carry ? 0x80 : 0;
 
-		case CLOWNZ80_OPCODE_CCF:
-			state->f &= ~(FLAG_MASK_ADD_SUBTRACT | FLAG_MASK_HALF_CARRY);
+	state->f &= FLAG_MASK_SIGN | FLAG_MASK_ZERO | FLAG_MASK_PARITY_OVERFLOW;
+	state->f |= carry ? FLAG_MASK_CARRY : 0;
+}
 
-			state->f |= (state->f & FLAG_MASK_CARRY) != 0 ? FLAG_MASK_HALF_CARRY : 0;
-			state->f ^= FLAG_MASK_CARRY;
+static void Execute_RLA(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	cc_bool carry;
 
-			break;
+	(void)callbacks;
+	(void)instruction;
 
-		case CLOWNZ80_OPCODE_HALT:
-			/* TODO */
-			UNIMPLEMENTED_Z80_INSTRUCTION("HALT");
-			break;
+	MaterialiseFlags(state);
 
-		case CLOWNZ80_OPCODE_ADD_A:
-			READ_SOURCE;
-			destination_value = state->a;
+	carry = (state->a & 0x80) != 0;
 
-			result_value_with_carry = destination_value + source_value;
-			result_value = result_value_with_carry & 0xFF;
+	state->a <<= 1;
+	state->a &= 0xFF;
+	state->a |= (state->f & FLAG_MASK_CARRY) != 0 ? 1 : 0;
 
-			state->f = 0;
-			CONDITION_CARRY;
-			CONDITION_SIGN;
-			CONDITION_ZERO;
-			CONDITION_HALF_CARRY;
-			CONDITION_OVERFLOW;
+	state->f &= FLAG_MASK_SIGN | FLAG_MASK_ZERO | FLAG_MASK_PARITY_OVERFLOW;
+	state->f |= carry ? FLAG_MASK_CARRY : 0;
+}
 
-			state->a = result_value;
+static void Execute_RRA(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	cc_bool carry;
 
-			break;
+	(void)callbacks;
+	(void)instruction;
 
-		case CLOWNZ80_OPCODE_ADC_A:
-			READ_SOURCE;
-			destination_value = state->a;
+	MaterialiseFlags(state);
 
-			result_value_with_carry = destination_value + source_value + ((state->f & FLAG_MASK_CARRY) != 0 ? 1 : 0);
-			result_value = result_value_with_carry & 0xFF;
+	carry = (state->a & 0x01) != 0;
 
-			state->f = 0;
-			CONDITION_CARRY;
-			CONDITION_SIGN;
-			CONDITION_ZERO;
-			CONDITION_HALF_CARRY;
-			CONDITION_OVERFLOW;
+	state->a >>= 1;
+	state->a |= (state->f & FLAG_MASK_CARRY) != 0 ? 0x80 : 0;
 
-			state->a = result_value;
+	state->f &= FLAG_MASK_SIGN | FLAG_MASK_ZERO | FLAG_MASK_PARITY_OVERFLOW;
+	state->f |= carry ? FLAG_MASK_CARRY : 0;
+}
 
-			break;
+static void Execute_DAA(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	cc_u16f correction_factor;
 
-		case CLOWNZ80_OPCODE_SUB:
-			READ_SOURCE;
-			source_value = ~source_value;
-			destination_value = state->a;
+	const cc_u16f original_a = state->a;
 
-			result_value_with_carry = destination_value + source_value + 1;
-			result_value = result_value_with_carry & 0xFF;
+	(void)callbacks;
+	(void)instruction;
 
-			state->f = 0;
-			CONDITION_CARRY;
-			CONDITION_SIGN;
-			CONDITION_ZERO;
-			CONDITION_HALF_CARRY;
-			CONDITION_OVERFLOW;
+	MaterialiseFlags(state);
 
-			state->f ^= FLAG_MASK_HALF_CARRY;
-			state->f |= FLAG_MASK_ADD_SUBTRACT;
+	correction_factor = ((state->a + 0x66) ^ state->a) & 0x110;
+	correction_factor |= (state->f & FLAG_MASK_CARRY) << (8 - FLAG_BIT_CARRY);
+	correction_factor |= (state->f & FLAG_MASK_HALF_CARRY) << (4 - FLAG_BIT_HALF_CARRY);
+	correction_factor = (correction_factor >> 2) | (correction_factor >> 3);
 
-			state->a = result_value;
+	if ((state->f & FLAG_MASK_ADD_SUBTRACT) != 0)
+		state->a -= correction_factor;
+	else
+		state->a += correction_factor;
 
-			break;
+	state->a &= 0xFF;
 
-		case CLOWNZ80_OPCODE_SBC_A:
-			READ_SOURCE;
-			source_value = ~source_value;
-			destination_value = state->a;
+	state->f &= FLAG_MASK_ADD_SUBTRACT;
+	state->f |= (state->a >> (7 - FLAG_BIT_SIGN)) & FLAG_MASK_SIGN;
+	state->f |= (state->a == 0) << FLAG_BIT_ZERO;
+	state->f |= ((original_a ^ state->a) >> (4 - FLAG_BIT_HALF_CARRY)) & FLAG_MASK_HALF_CARRY; /* Binary carry. */
+	state->f |= ComputeParity(state->a) ? FLAG_MASK_PARITY_OVERFLOW : 0;
+	state->f |= (correction_factor >> (6 - FLAG_BIT_CARRY)) & FLAG_MASK_CARRY; /* Decimal carry. */
+}
 
-			result_value_with_carry = destination_value + source_value + ((state->f & FLAG_MASK_CARRY) != 0 ? 0 : 1);
-			result_value = result_value_with_carry & 0xFF;
+static void Execute_CPL(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	(void)callbacks;
+	(void)instruction;
 
-			state->f = 0;
-			CONDITION_CARRY;
-			CONDITION_SIGN;
-			CONDITION_ZERO;
-			CONDITION_HALF_CARRY;
-			CONDITION_OVERFLOW;
+	MaterialiseFlags(state);
 
-			state->f ^= FLAG_MASK_HALF_CARRY;
-			state->f |= FLAG_MASK_ADD_SUBTRACT;
+	state->a = ~state->a;
+	state->a &= 0xFF;
 
-			state->a = result_value;
+	state->f |= FLAG_MASK_HALF_CARRY | FLAG_MASK_ADD_SUBTRACT;
+}
 
-			break;
+static void Execute_SCF(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	(void)callbacks;
+	(void)instruction;
 
-		case CLOWNZ80_OPCODE_AND:
-			READ_SOURCE;
-			destination_value = state->a;
+	MaterialiseFlags(state);
 
-			result_value = destination_value & source_value;
+	state->f &= FLAG_MASK_SIGN | FLAG_MASK_ZERO | FLAG_MASK_PARITY_OVERFLOW;
+	state->f |= FLAG_MASK_CARRY;
+}
 
-			state->f = 0;
-			CONDITION_SIGN;
-			CONDITION_ZERO;
-			state->f |= FLAG_MASK_HALF_CARRY;
-			CONDITION_PARITY;
+static void Execute_CCF(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	(void)callbacks;
+	(void)instruction;
 
-			state->a = result_value;
+	MaterialiseFlags(state);
 
-			break;
+	state->f &= ~(FLAG_MASK_ADD_SUBTRACT | FLAG_MASK_HALF_CARRY);
 
-		case CLOWNZ80_OPCODE_XOR:
-			READ_SOURCE;
-			destination_value = state->a;
+	state->f |= (state->f & FLAG_MASK_CARRY) != 0 ? FLAG_MASK_HALF_CARRY : 0;
+	state->f ^= FLAG_MASK_CARRY;
+}
 
-			result_value = destination_value ^ source_value;
+static void Execute_HALT(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	(void)callbacks;
+	(void)instruction;
 
-			state->f = 0;
-			CONDITION_SIGN;
-			CONDITION_ZERO;
-			CONDITION_PARITY;
+	/* The program counter is left after the instruction, as that is where execution resumes once an interrupt is taken. */
+	state->halted = cc_true;
+}
 
-			state->a = result_value;
+static void Operation_ADD_A(ClownZ80_State* const state, const cc_u16f value)
+{
+	cc_u16f source_value;
+	cc_u16f destination_value;
+	cc_u16f result_value;
+	cc_u16f result_value_with_carry;
 
-			break;
+	source_value = value;
+	destination_value = state->a;
 
-		case CLOWNZ80_OPCODE_OR:
-			READ_SOURCE;
-			destination_value = state->a;
+	result_value_with_carry = destination_value + source_value;
+	result_value = result_value_with_carry & 0xFF;
 
-			result_value = destination_value | source_value;
+	SetFlags(state, FLAGS_OPERATION_ADD, source_value, destination_value, result_value_with_carry);
 
-			state->f = 0;
-			CONDITION_SIGN;
-			CONDITION_ZERO;
-			CONDITION_PARITY;
+	state->a = result_value;
+}
 
-			state->a = result_value;
+static void Execute_ADD_A(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	cc_u16f source_value;
 
-			break;
+	READ_SOURCE;
+	Operation_ADD_A(state, source_value);
+}
 
-		case CLOWNZ80_OPCODE_CP:
-			READ_SOURCE;
-			source_value = ~source_value;
-			destination_value = state->a;
+static void Operation_ADC_A(ClownZ80_State* const state, const cc_u16f value)
+{
+	cc_u16f source_value;
+	cc_u16f destination_value;
+	cc_u16f result_value;
+	cc_u16f result_value_with_carry;
 
-			result_value_with_carry = destination_value + source_value + 1;
-			result_value = result_value_with_carry & 0xFF;
+	source_value = value;
+	destination_value = state->a;
 
-			state->f = 0;
-			CONDITION_CARRY;
-			CONDITION_SIGN;
-			CONDITION_ZERO;
-			CONDITION_HALF_CARRY;
-			CONDITION_OVERFLOW;
+	result_value_with_carry = destination_value + source_value + (GetCarryFlag(state) ? 1 : 0);
+	result_value = result_value_with_carry & 0xFF;
 
-			state->f ^= FLAG_MASK_HALF_CARRY;
-			state->f |= FLAG_MASK_ADD_SUBTRACT;
+	SetFlags(state, FLAGS_OPERATION_ADD, source_value, destination_value, result_value_with_carry);
 
-			break;
+	state->a = result_value;
+}
 
-		case CLOWNZ80_OPCODE_POP:
-			result_value = MemoryRead16Bit(state, callbacks, state->stack_pointer);
+static void Execute_ADC_A(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	cc_u16f source_value;
 
-			WRITE_DESTINATION;
+	READ_SOURCE;
+	Operation_ADC_A(state, source_value);
+}
 
-			state->stack_pointer += 2;
-			state->stack_pointer &= 0xFFFF;
+static void Operation_SUB(ClownZ80_State* const state, const cc_u16f value)
+{
+	cc_u16f source_value;
+	cc_u16f destination_value;
+	cc_u16f result_value;
+	cc_u16f result_value_with_carry;
 
-			break;
+	source_value = ~value;
+	destination_value = state->a;
 
-		case CLOWNZ80_OPCODE_RET_CONDITIONAL:
-			/* This instruction requires an extra cycle. */
-			state->cycles += 1;
+	result_value_with_carry = destination_value + source_value + 1;
+	result_value = result_value_with_carry & 0xFF;
 
-			if (!EvaluateCondition(state->f, (ClownZ80_Condition)instruction->metadata->condition))
-				break;
-			/* Fallthrough */
-		case CLOWNZ80_OPCODE_RET_UNCONDITIONAL:
-		case CLOWNZ80_OPCODE_RETN: /* TODO: The IFF1/IFF2 stuff. */
-		case CLOWNZ80_OPCODE_RETI: /* Ditto. */
-			state->program_counter = MemoryRead16Bit(state, callbacks, state->stack_pointer);
-			state->stack_pointer += 2;
-			state->stack_pointer &= 0xFFFF;
-			break;
+	SetFlags(state, FLAGS_OPERATION_SUBTRACT, source_value, destination_value, result_value_with_carry);
 
-		case CLOWNZ80_OPCODE_EXX:
-			SWAP(state->b, state->b_);
-			SWAP(state->c, state->c_);
-			SWAP(state->d, state->d_);
-			SWAP(state->e, state->e_);
-			SWAP(state->h, state->h_);
-			SWAP(state->l, state->l_);
-			break;
+	state->a = result_value;
+}
 
-		case CLOWNZ80_OPCODE_LD_SP_HL:
-			/* This instruction requires 2 cycles. */
-			state->cycles += 2;
+static void Execute_SUB(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	cc_u16f source_value;
 
-			READ_SOURCE;
+	READ_SOURCE;
+	Operation_SUB(state, source_value);
+}
 
-			state->stack_pointer = source_value;
+static void Operation_SBC_A(ClownZ80_State* const state, const cc_u16f value)
+{
+	cc_u16f source_value;
+	cc_u16f destination_value;
+	cc_u16f result_value;
+	cc_u16f result_value_with_carry;
 
-			break;
+	source_value = ~value;
+	destination_value = state->a;
 
-		case CLOWNZ80_OPCODE_JP_CONDITIONAL:
-			if (!EvaluateCondition(state->f, (ClownZ80_Condition)instruction->metadata->condition))
-				break;
-			/* Fallthrough */
-		case CLOWNZ80_OPCODE_JP_UNCONDITIONAL:
-		case CLOWNZ80_OPCODE_JP_HL:
-			READ_SOURCE;
+	result_value_with_carry = destination_value + source_value + (GetCarryFlag(state) ? 0 : 1);
+	result_value = result_value_with_carry & 0xFF;
 
-			state->program_counter = source_value;
+	SetFlags(state, FLAGS_OPERATION_SUBTRACT, source_value, destination_value, result_value_with_carry);
 
-			break;
+	state->a = result_value;
+}
 
-		case CLOWNZ80_OPCODE_CB_PREFIX:
-		case CLOWNZ80_OPCODE_ED_PREFIX:
-			/* Should never occur: these are handled by `DecodeInstruction`. */
-			assert(0);
-			break;
+static void Execute_SBC_A(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	cc_u16f source_value;
 
-		case CLOWNZ80_OPCODE_DD_PREFIX:
-			state->register_mode = CLOWNZ80_REGISTER_MODE_IX;
-			break;
+	READ_SOURCE;
+	Operation_SBC_A(state, source_value);
+}
 
-		case CLOWNZ80_OPCODE_FD_PREFIX:
-			state->register_mode = CLOWNZ80_REGISTER_MODE_IY;
-			break;
+static void Operation_AND(ClownZ80_State* const state, const cc_u16f value)
+{
+	cc_u16f source_value;
+	cc_u16f destination_value;
+	cc_u16f result_value;
 
-		case CLOWNZ80_OPCODE_OUT:
-			/* TODO */
-			UNIMPLEMENTED_Z80_INSTRUCTION("OUT");
-			break;
+	source_value = value;
+	destination_value = state->a;
 
-		case CLOWNZ80_OPCODE_IN:
-			/* TODO */
-			UNIMPLEMENTED_Z80_INSTRUCTION("IN");
-			break;
+	result_value = destination_value & source_value;
 
-		case CLOWNZ80_OPCODE_EX_SP_HL:
-			/* This instruction requires 3 extra cycles. */
-			state->cycles += 3;
+	SetFlags(state, FLAGS_OPERATION_AND, 0, 0, result_value);
 
-			READ_DESTINATION;
-			result_value = MemoryRead16Bit(state, callbacks, state->stack_pointer);
-			MemoryWrite16Bit(state, callbacks, state->stack_pointer, destination_value);
-			WRITE_DESTINATION;
-			break;
+	state->a = result_value;
+}
 
-		case CLOWNZ80_OPCODE_EX_DE_HL:
-			SWAP(state->d, state->h);
-			SWAP(state->e, state->l);
-			break;
+static void Execute_AND(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	cc_u16f source_value;
 
-		case CLOWNZ80_OPCODE_DI:
-			state->interrupts_enabled = cc_false;
-			break;
+	READ_SOURCE;
+	Operation_AND(state, source_value);
+}
 
-		case CLOWNZ80_OPCODE_EI:
-			state->interrupts_enabled = cc_true;
-			break;
+static void Operation_XOR(ClownZ80_State* const state, const cc_u16f value)
+{
+	cc_u16f source_value;
+	cc_u16f destination_value;
+	cc_u16f result_value;
 
-		case CLOWNZ80_OPCODE_PUSH:
-			/* This instruction requires an extra cycle. */
-			state->cycles += 1;
+	source_value = value;
+	destination_value = state->a;
 
-			READ_SOURCE;
+	result_value = destination_value ^ source_value;
 
-			--state->stack_pointer;
-			state->stack_pointer &= 0xFFFF;
-			MemoryWrite(state, callbacks, state->stack_pointer, source_value >> 8);
+	SetFlags(state, FLAGS_OPERATION_LOGIC, 0, 0, result_value);
 
-			--state->stack_pointer;
-			state->stack_pointer &= 0xFFFF;
-			MemoryWrite(state, callbacks, state->stack_pointer, source_value & 0xFF);
+	state->a = result_value;
+}
 
-			break;
+static void Execute_XOR(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	cc_u16f source_value;
 
-		case CLOWNZ80_OPCODE_CALL_CONDITIONAL:
-			if (!EvaluateCondition(state->f, (ClownZ80_Condition)instruction->metadata->condition))
-				break;
-			/* Fallthrough */
-		case CLOWNZ80_OPCODE_CALL_UNCONDITIONAL:
-			/* This instruction takes an extra cycle. */
-			state->cycles += 1;
+	READ_SOURCE;
+	Operation_XOR(state, source_value);
+}
 
-			--state->stack_pointer;
-			state->stack_pointer &= 0xFFFF;
-			MemoryWrite(state, callbacks, state->stack_pointer, state->program_counter >> 8);
+static void Operation_OR(ClownZ80_State* const state, const cc_u16f value)
+{
+	cc_u16f source_value;
+	cc_u16f destination_value;
+	cc_u16f result_value;
 
-			--state->stack_pointer;
-			state->stack_pointer &= 0xFFFF;
-			MemoryWrite(state, callbacks, state->stack_pointer, state->program_counter & 0xFF);
+	source_value = value;
+	destination_value = state->a;
 
-			state->program_counter = instruction->literal;
-			break;
+	result_value = destination_value | source_value;
 
-		case CLOWNZ80_OPCODE_RST:
-			/* This instruction requires an extra cycle. */
-			state->cycles += 1;
+	SetFlags(state, FLAGS_OPERATION_LOGIC, 0, 0, result_value);
 
-			--state->stack_pointer;
-			state->stack_pointer &= 0xFFFF;
-			MemoryWrite(state, callbacks, state->stack_pointer, state->program_counter >> 8);
+	state->a = result_value;
+}
 
-			--state->stack_pointer;
-			state->stack_pointer &= 0xFFFF;
-			MemoryWrite(state, callbacks, state->stack_pointer, state->program_counter & 0xFF);
+static void Execute_OR(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	cc_u16f source_value;
 
-			state->program_counter = instruction->metadata->embedded_literal;
-			break;
+	READ_SOURCE;
+	Operation_OR(state, source_value);
+}
 
-		case CLOWNZ80_OPCODE_RLC:
-			READ_DESTINATION;
+static void Operation_CP(ClownZ80_State* const state, const cc_u16f value)
+{
+	cc_u16f source_value;
+	cc_u16f destination_value;
+	cc_u16f result_value_with_carry;
 
-			carry = (destination_value & 0x80) != 0;
+	source_value = ~value;
+	destination_value = state->a;
 
-			result_value = (destination_value << 1) & 0xFF;
-			result_value |= carry ? 0x01 : 0;
+	result_value_with_carry = destination_value + source_value + 1;
 
-			state->f = 0;
-			state->f |= carry ? FLAG_MASK_CARRY : 0;
-			CONDITION_SIGN;
-			CONDITION_ZERO;
-			CONDITION_PARITY;
+	SetFlags(state, FLAGS_OPERATION_SUBTRACT, source_value, destination_value, result_value_with_carry);
+}
 
-			WRITE_DESTINATION;
+static void Execute_CP(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	cc_u16f source_value;
 
-			/* The memory-accessing version takes an extra cycle. */
-			state->cycles += instruction->metadata->operands[1] == CLOWNZ80_OPERAND_HL_INDIRECT
-				|| instruction->metadata->operands[1] == CLOWNZ80_OPERAND_IX_INDIRECT
-				|| instruction->metadata->operands[1] == CLOWNZ80_OPERAND_IY_INDIRECT;
+	READ_SOURCE;
+	Operation_CP(state, source_value);
+}
 
-			break;
+static void Execute_POP(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	cc_u16f result_value;
 
-		case CLOWNZ80_OPCODE_RRC:
-			READ_DESTINATION;
+	/* In case this is 'POP AF', which must not have its flags overwritten by pending ones. */
+	MaterialiseFlags(state);
 
-			carry = (destination_value & 0x01) != 0;
+	result_value = MemoryRead16Bit(state, callbacks, state->stack_pointer);
 
-			result_value = destination_value >> 1;
-			result_value |= carry ? 0x80 : 0;
+	WRITE_DESTINATION;
 
-			state->f = 0;
-			state->f |= carry ? FLAG_MASK_CARRY : 0;
-			CONDITION_SIGN;
-			CONDITION_ZERO;
-			CONDITION_PARITY;
+	state->stack_pointer += 2;
+	state->stack_pointer &= 0xFFFF;
+}
 
-			WRITE_DESTINATION;
+static void Execute_RET_UNCONDITIONAL(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	(void)instruction;
 
-			/* The memory-accessing version takes an extra cycle. */
-			state->cycles += instruction->metadata->operands[1] == CLOWNZ80_OPERAND_HL_INDIRECT
-				|| instruction->metadata->operands[1] == CLOWNZ80_OPERAND_IX_INDIRECT
-				|| instruction->metadata->operands[1] == CLOWNZ80_OPERAND_IY_INDIRECT;
+	state->program_counter = MemoryRead16Bit(state, callbacks, state->stack_pointer);
+	state->stack_pointer += 2;
+	state->stack_pointer &= 0xFFFF;
+}
 
-			break;
+static void Execute_RET_CONDITIONAL(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	MaterialiseFlags(state);
 
-		case CLOWNZ80_OPCODE_RL:
-			READ_DESTINATION;
+	/* This instruction requires an extra cycle. */
+	state->cycles += 1;
 
-			carry = (destination_value & 0x80) != 0;
+	if (EvaluateCondition(state->f, (ClownZ80_Condition)instruction->metadata->condition))
+		Execute_RET_UNCONDITIONAL(state, callbacks, instruction);
+}
 
-			result_value = (destination_value << 1) & 0xFF;
-			result_value |= (state->f &= FLAG_MASK_CARRY) != 0 ? 0x01 : 0;
+static void Execute_EXX(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	cc_u8l swap_holder;
 
-			state->f = 0;
-			state->f |= carry ? FLAG_MASK_CARRY : 0;
-			CONDITION_SIGN;
-			CONDITION_ZERO;
-			CONDITION_PARITY;
+	(void)callbacks;
+	(void)instruction;
 
-			WRITE_DESTINATION;
+	SWAP(state->b, state->b_);
+	SWAP(state->c, state->c_);
+	SWAP(state->d, state->d_);
+	SWAP(state->e, state->e_);
+	SWAP(state->h, state->h_);
+	SWAP(state->l, state->l_);
+}
 
-			/* The memory-accessing version takes an extra cycle. */
-			state->cycles += instruction->metadata->operands[1] == CLOWNZ80_OPERAND_HL_INDIRECT
-				|| instruction->metadata->operands[1] == CLOWNZ80_OPERAND_IX_INDIRECT
-				|| instruction->metadata->operands[1] == CLOWNZ80_OPERAND_IY_INDIRECT;
+static void Execute_LD_SP_HL(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	cc_u16f source_value;
 
-			break;
+	/* This instruction requires 2 cycles. */
+	state->cycles += 2;
 
-		case CLOWNZ80_OPCODE_RR:
-			READ_DESTINATION;
+	READ_SOURCE;
 
-			carry = (destination_value & 0x01) != 0;
+	state->stack_pointer = source_value;
+}
 
-			result_value = destination_value >> 1;
-			result_value |= (state->f &= FLAG_MASK_CARRY) != 0 ? 0x80 : 0;
+static void Execute_JP_UNCONDITIONAL(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	cc_u16f source_value;
 
-			state->f = 0;
-			state->f |= carry ? FLAG_MASK_CARRY : 0;
-			CONDITION_SIGN;
-			CONDITION_ZERO;
-			CONDITION_PARITY;
+	READ_SOURCE;
 
-			WRITE_DESTINATION;
+	state->program_counter = source_value;
+}
 
-			/* The memory-accessing version takes an extra cycle. */
-			state->cycles += instruction->metadata->operands[1] == CLOWNZ80_OPERAND_HL_INDIRECT
-				|| instruction->metadata->operands[1] == CLOWNZ80_OPERAND_IX_INDIRECT
-				|| instruction->metadata->operands[1] == CLOWNZ80_OPERAND_IY_INDIRECT;
+static void Execute_JP_CONDITIONAL(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	MaterialiseFlags(state);
 
-			break;
+	if (EvaluateCondition(state->f, (ClownZ80_Condition)instruction->metadata->condition))
+		Execute_JP_UNCONDITIONAL(state, callbacks, instruction);
+}
 
-		case CLOWNZ80_OPCODE_SLA:
-			READ_DESTINATION;
+static void Execute_CB_ED_PREFIX(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	(void)state;
+	(void)callbacks;
+	(void)instruction;
 
-			carry = (destination_value & 0x80) != 0;
+	/* Should never occur: these are handled by `DecodeInstruction`. */
+	assert(0);
+}
 
-			result_value = (destination_value << 1) & 0xFF;
+static void Execute_DD_PREFIX(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	(void)callbacks;
+	(void)instruction;
 
-			state->f = 0;
-			state->f |= (result_value & 0x80) != 0 ? FLAG_MASK_SIGN : 0;
-			state->f |= result_value == 0 ? FLAG_MASK_ZERO : 0;
-			CONDITION_PARITY;
-			state->f |= carry ? FLAG_MASK_CARRY : 0;
+	state->register_mode = CLOWNZ80_REGISTER_MODE_IX;
+}
 
-			WRITE_DESTINATION;
+static void Execute_FD_PREFIX(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	(void)callbacks;
+	(void)instruction;
 
-			/* The memory-accessing version takes an extra cycle. */
-			state->cycles += instruction->metadata->operands[1] == CLOWNZ80_OPERAND_HL_INDIRECT
-				|| instruction->metadata->operands[1] == CLOWNZ80_OPERAND_IX_INDIRECT
-				|| instruction->metadata->operands[1] == CLOWNZ80_OPERAND_IY_INDIRECT;
+	state->register_mode = CLOWNZ80_REGISTER_MODE_IY;
+}
 
-			break;
+static void Execute_OUT(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	/* The upper 8 bits of the port come from 'a'. */
+	PortWrite(state, callbacks, ((cc_u16f)state->a << 8) | instruction->literal, state->a);
+}
 
-		case CLOWNZ80_OPCODE_SLL:
-			READ_DESTINATION;
+static void Execute_IN(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	/* The upper 8 bits of the port come from 'a'. */
+	state->a = PortRead(state, callbacks, ((cc_u16f)state->a << 8) | instruction->literal);
+}
 
-			carry = (destination_value & 0x80) != 0;
+static void Execute_EX_SP_HL(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	cc_u16f destination_value;
+	cc_u16f result_value;
 
-			result_value = ((destination_value << 1) | 1) & 0xFF;
+	/* This instruction requires 3 extra cycles. */
+	state->cycles += 3;
 
-			state->f = 0;
-			state->f |= (result_value & 0x80) != 0 ? FLAG_MASK_SIGN : 0;
-			state->f |= result_value == 0 ? FLAG_MASK_ZERO : 0;
-			CONDITION_PARITY;
-			state->f |= carry ? FLAG_MASK_CARRY : 0;
+	READ_DESTINATION;
+	result_value = MemoryRead16Bit(state, callbacks, state->stack_pointer);
+	MemoryWrite16Bit(state, callbacks, state->stack_pointer, destination_value);
+	WRITE_DESTINATION;
+}
 
-			WRITE_DESTINATION;
+static void Execute_EX_DE_HL(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	cc_u8l swap_holder;
 
-			/* The memory-accessing version takes an extra cycle. */
-			state->cycles += instruction->metadata->operands[1] == CLOWNZ80_OPERAND_HL_INDIRECT
-				|| instruction->metadata->operands[1] == CLOWNZ80_OPERAND_IX_INDIRECT
-				|| instruction->metadata->operands[1] == CLOWNZ80_OPERAND_IY_INDIRECT;
+	(void)callbacks;
+	(void)instruction;
 
-			break;
+	SWAP(state->d, state->h);
+	SWAP(state->e, state->l);
+}
 
-		case CLOWNZ80_OPCODE_SRA:
-			READ_DESTINATION;
+static void Execute_DI(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	(void)callbacks;
+	(void)instruction;
 
-			carry = (destination_value & 0x01) != 0;
+	state->interrupts_enabled = cc_false;
+}
 
-			result_value = (destination_value >> 1) | (destination_value & 0x80);
+static void Execute_EI(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	(void)callbacks;
+	(void)instruction;
 
-			state->f = 0;
-			state->f |= (result_value & 0x80) != 0 ? FLAG_MASK_SIGN : 0;
-			state->f |= result_value == 0 ? FLAG_MASK_ZERO : 0;
-			CONDITION_PARITY;
-			state->f |= carry ? FLAG_MASK_CARRY : 0;
+	state->interrupts_enabled = cc_true;
+}
 
-			WRITE_DESTINATION;
+static void Execute_PUSH(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	cc_u16f source_value;
 
-			/* The memory-accessing version takes an extra cycle. */
-			state->cycles += instruction->metadata->operands[1] == CLOWNZ80_OPERAND_HL_INDIRECT
-				|| instruction->metadata->operands[1] == CLOWNZ80_OPERAND_IX_INDIRECT
-				|| instruction->metadata->operands[1] == CLOWNZ80_OPERAND_IY_INDIRECT;
+	/* In case this is 'PUSH AF'. */
+	MaterialiseFlags(state);
 
-			break;
+	/* This instruction requires an extra cycle. */
+	state->cycles += 1;
 
-		case CLOWNZ80_OPCODE_SRL:
-			READ_DESTINATION;
+	READ_SOURCE;
 
-			carry = (destination_value & 0x01) != 0;
+	--state->stack_pointer;
+	state->stack_pointer &= 0xFFFF;
+	MemoryWrite(state, callbacks, state->stack_pointer, source_value >> 8);
 
-			result_value = destination_value >> 1;
+	--state->stack_pointer;
+	state->stack_pointer &= 0xFFFF;
+	MemoryWrite(state, callbacks, state->stack_pointer, source_value & 0xFF);
+}
 
-			state->f = 0;
-			state->f |= (result_value & 0x80) != 0 ? FLAG_MASK_SIGN : 0;
-			state->f |= result_value == 0 ? FLAG_MASK_ZERO : 0;
-			CONDITION_PARITY;
-			state->f |= carry ? FLAG_MASK_CARRY : 0;
+static void Execute_CALL_UNCONDITIONAL(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	/* This instruction takes an extra cycle. */
+	state->cycles += 1;
 
-			WRITE_DESTINATION;
+	--state->stack_pointer;
+	state->stack_pointer &= 0xFFFF;
+	MemoryWrite(state, callbacks, state->stack_pointer, state->program_counter >> 8);
 
-			/* The memory-accessing version takes an extra cycle. */
-			state->cycles += instruction->metadata->operands[1] == CLOWNZ80_OPERAND_HL_INDIRECT
-				|| instruction->metadata->operands[1] == CLOWNZ80_OPERAND_IX_INDIRECT
-				|| instruction->metadata->operands[1] == CLOWNZ80_OPERAND_IY_INDIRECT;
+	--state->stack_pointer;
+	state->stack_pointer &= 0xFFFF;
+	MemoryWrite(state, callbacks, state->stack_pointer, state->program_counter & 0xFF);
 
-			break;
+	state->program_counter = instruction->literal;
+}
 
-		case CLOWNZ80_OPCODE_BIT:
-			READ_DESTINATION;
+static void Execute_CALL_CONDITIONAL(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	MaterialiseFlags(state);
 
-			/* The setting of the parity and sign bits doesn't seem to be documented anywhere. */
-			/* TODO: See if emulating this instruction with a SUB instruction produces the proper condition codes. */
-			state->f &= FLAG_MASK_CARRY;
-			state->f |= ((destination_value & instruction->metadata->embedded_literal) == 0) ? FLAG_MASK_ZERO | FLAG_MASK_PARITY_OVERFLOW : 0;
-			state->f |= FLAG_MASK_HALF_CARRY;
-			state->f |= instruction->metadata->embedded_literal == 0x80 && (state->f & FLAG_MASK_ZERO) == 0 ? FLAG_MASK_SIGN : 0;
+	if (EvaluateCondition(state->f, (ClownZ80_Condition)instruction->metadata->condition))
+		Execute_CALL_UNCONDITIONAL(state, callbacks, instruction);
+}
 
-			/* The memory-accessing version takes an extra cycle. */
-			state->cycles += instruction->metadata->operands[1] == CLOWNZ80_OPERAND_HL_INDIRECT
-				|| instruction->metadata->operands[1] == CLOWNZ80_OPERAND_IX_INDIRECT
-				|| instruction->metadata->operands[1] == CLOWNZ80_OPERAND_IY_INDIRECT;
+static void Execute_RST(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	/* This instruction requires an extra cycle. */
+	state->cycles += 1;
 
-			break;
+	--state->stack_pointer;
+	state->stack_pointer &= 0xFFFF;
+	MemoryWrite(state, callbacks, state->stack_pointer, state->program_counter >> 8);
 
-		case CLOWNZ80_OPCODE_RES:
-			READ_DESTINATION;
+	--state->stack_pointer;
+	state->stack_pointer &= 0xFFFF;
+	MemoryWrite(state, callbacks, state->stack_pointer, state->program_counter & 0xFF);
 
-			result_value = destination_value & instruction->metadata->embedded_literal;
+	state->program_counter = instruction->metadata->embedded_literal;
+}
 
-			WRITE_DESTINATION;
+static void Execute_RLC(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	cc_u16f destination_value;
+	cc_u16f result_value;
+	cc_bool carry;
 
-			/* The memory-accessing version takes an extra cycle. */
-			state->cycles += instruction->metadata->operands[1] == CLOWNZ80_OPERAND_HL_INDIRECT
-				|| instruction->metadata->operands[1] == CLOWNZ80_OPERAND_IX_INDIRECT
-				|| instruction->metadata->operands[1] == CLOWNZ80_OPERAND_IY_INDIRECT;
+	READ_DESTINATION;
 
-			break;
+	carry = (destination_value & 0x80) != 0;
 
-		case CLOWNZ80_OPCODE_SET:
-			READ_DESTINATION;
+	result_value = (destination_value << 1) & 0xFF;
+	result_value |= carry ? 0x01 : 0;
 
-			result_value = destination_value | instruction->metadata->embedded_literal;
+	SetFlags(state, FLAGS_OPERATION_LOGIC, 0, 0, result_value | (carry ? 0x100 : 0));
 
-			WRITE_DESTINATION;
+	WRITE_DESTINATION;
 
-			/* The memory-accessing version takes an extra cycle. */
-			state->cycles += instruction->metadata->operands[1] == CLOWNZ80_OPERAND_HL_INDIRECT
-				|| instruction->metadata->operands[1] == CLOWNZ80_OPERAND_IX_INDIRECT
-				|| instruction->metadata->operands[1] == CLOWNZ80_OPERAND_IY_INDIRECT;
+	/* The memory-accessing version takes an extra cycle. */
+	state->cycles += instruction->metadata->operands[1] == CLOWNZ80_OPERAND_HL_INDIRECT
+		|| instruction->metadata->operands[1] == CLOWNZ80_OPERAND_IX_INDIRECT
+		|| instruction->metadata->operands[1] == CLOWNZ80_OPERAND_IY_INDIRECT;
+}
 
-			break;
+static void Execute_RRC(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	cc_u16f destination_value;
+	cc_u16f result_value;
+	cc_bool carry;
 
-		case CLOWNZ80_OPCODE_IN_REGISTER:
-			UNIMPLEMENTED_Z80_INSTRUCTION("IN (register)");
-			break;
+	READ_DESTINATION;
 
-		case CLOWNZ80_OPCODE_IN_NO_REGISTER:
-			UNIMPLEMENTED_Z80_INSTRUCTION("IN (no register)");
-			break;
+	carry = (destination_value & 0x01) != 0;
 
-		case CLOWNZ80_OPCODE_OUT_REGISTER:
-			UNIMPLEMENTED_Z80_INSTRUCTION("OUT (register)");
-			break;
+	result_value = destination_value >> 1;
+	result_value |= carry ? 0x80 : 0;
 
-		case CLOWNZ80_OPCODE_OUT_NO_REGISTER:
-			UNIMPLEMENTED_Z80_INSTRUCTION("OUT (no register)");
-			break;
+	SetFlags(state, FLAGS_OPERATION_LOGIC, 0, 0, result_value | (carry ? 0x100 : 0));
 
-		case CLOWNZ80_OPCODE_SBC_HL:
-			READ_SOURCE;
-			READ_DESTINATION;
+	WRITE_DESTINATION;
 
-			source_value = ~(cc_u32f)source_value;
+	/* The memory-accessing version takes an extra cycle. */
+	state->cycles += instruction->metadata->operands[1] == CLOWNZ80_OPERAND_HL_INDIRECT
+		|| instruction->metadata->operands[1] == CLOWNZ80_OPERAND_IX_INDIRECT
+		|| instruction->metadata->operands[1] == CLOWNZ80_OPERAND_IY_INDIRECT;
+}
 
-			result_value_with_carry_16bit = (cc_u32f)source_value + (cc_u32f)destination_value + ((state->f & FLAG_MASK_CARRY) != 0 ? 0 : 1);;
-			result_value = result_value_with_carry_16bit & 0xFFFF;
+static void Execute_RL(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	cc_u16f destination_value;
+	cc_u16f result_value;
+	cc_bool carry;
 
-			state->f = 0;
+	READ_DESTINATION;
 
-			CONDITION_SIGN_16BIT;
-			CONDITION_ZERO;
-			CONDITION_HALF_CARRY_16BIT;
-			CONDITION_OVERFLOW_16BIT;
-			CONDITION_CARRY_16BIT;
+	carry = (destination_value & 0x80) != 0;
 
-			state->f ^= FLAG_MASK_HALF_CARRY;
-			state->f |= FLAG_MASK_ADD_SUBTRACT;
+	result_value = (destination_value << 1) & 0xFF;
+	result_value |= GetCarryFlag(state) ? 0x01 : 0;
 
-			WRITE_DESTINATION;
+	SetFlags(state, FLAGS_OPERATION_LOGIC, 0, 0, result_value | (carry ? 0x100 : 0));
 
-			/* This instruction requires an extra 7 cycles. */
-			state->cycles += 7;
+	WRITE_DESTINATION;
 
-			break;
+	/* The memory-accessing version takes an extra cycle. */
+	state->cycles += instruction->metadata->operands[1] == CLOWNZ80_OPERAND_HL_INDIRECT
+		|| instruction->metadata->operands[1] == CLOWNZ80_OPERAND_IX_INDIRECT
+		|| instruction->metadata->operands[1] == CLOWNZ80_OPERAND_IY_INDIRECT;
+}
 
-		case CLOWNZ80_OPCODE_ADC_HL:
-			READ_SOURCE;
-			READ_DESTINATION;
+static void Execute_RR(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	cc_u16f destination_value;
+	cc_u16f result_value;
+	cc_bool carry;
 
-			result_value_with_carry_16bit = (cc_u32f)source_value + (cc_u32f)destination_value + ((state->f & FLAG_MASK_CARRY) != 0 ? 1 : 0);
-			result_value = result_value_with_carry_16bit & 0xFFFF;
+	READ_DESTINATION;
 
-			state->f = 0;
+	carry = (destination_value & 0x01) != 0;
 
-			CONDITION_SIGN_16BIT;
-			CONDITION_ZERO;
-			CONDITION_HALF_CARRY_16BIT;
-			CONDITION_OVERFLOW_16BIT;
-			CONDITION_CARRY_16BIT;
+	result_value = destination_value >> 1;
+	result_value |= GetCarryFlag(state) ? 0x80 : 0;
 
-			WRITE_DESTINATION;
+	SetFlags(state, FLAGS_OPERATION_LOGIC, 0, 0, result_value | (carry ? 0x100 : 0));
 
-			/* This instruction requires an extra 7 cycles. */
-			state->cycles += 7;
+	WRITE_DESTINATION;
 
-			break;
+	/* The memory-accessing version takes an extra cycle. */
+	state->cycles += instruction->metadata->operands[1] == CLOWNZ80_OPERAND_HL_INDIRECT
+		|| instruction->metadata->operands[1] == CLOWNZ80_OPERAND_IX_INDIRECT
+		|| instruction->metadata->operands[1] == CLOWNZ80_OPERAND_IY_INDIRECT;
+}
 
-		case CLOWNZ80_OPCODE_NEG:
-			source_value = state->a;
-			source_value = ~source_value;
-			destination_value = 0;
+static void Execute_SLA(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	cc_u16f destination_value;
+	cc_u16f result_value;
+	cc_bool carry;
 
-			result_value_with_carry = destination_value + source_value + 1;
-			result_value = result_value_with_carry & 0xFF;
+	READ_DESTINATION;
 
-			state->f = 0;
-			CONDITION_CARRY;
-			CONDITION_SIGN;
-			CONDITION_ZERO;
-			CONDITION_HALF_CARRY;
-			CONDITION_OVERFLOW;
+	carry = (destination_value & 0x80) != 0;
 
-			state->f ^= FLAG_MASK_HALF_CARRY;
-			state->f |= FLAG_MASK_ADD_SUBTRACT;
+	result_value = (destination_value << 1) & 0xFF;
 
-			state->a = result_value;
+	SetFlags(state, FLAGS_OPERATION_LOGIC, 0, 0, result_value | (carry ? 0x100 : 0));
 
-			break;
+	WRITE_DESTINATION;
 
-		case CLOWNZ80_OPCODE_IM:
-			UNIMPLEMENTED_Z80_INSTRUCTION("IM");
-			break;
+	/* The memory-accessing version takes an extra cycle. */
+	state->cycles += instruction->metadata->operands[1] == CLOWNZ80_OPERAND_HL_INDIRECT
+		|| instruction->metadata->operands[1] == CLOWNZ80_OPERAND_IX_INDIRECT
+		|| instruction->metadata->operands[1] == CLOWNZ80_OPERAND_IY_INDIRECT;
+}
 
-		case CLOWNZ80_OPCODE_LD_I_A:
-			/* This instruction requires an extra cycle. */
-			state->cycles += 1;
+static void Execute_SLL(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	cc_u16f destination_value;
+	cc_u16f result_value;
+	cc_bool carry;
 
-			state->i = state->a;
+	READ_DESTINATION;
 
-			break;
+	carry = (destination_value & 0x80) != 0;
 
-		case CLOWNZ80_OPCODE_LD_R_A:
-			/* This instruction requires an extra cycle. */
-			state->cycles += 1;
+	result_value = ((destination_value << 1) | 1) & 0xFF;
 
-			state->r = state->a;
+	SetFlags(state, FLAGS_OPERATION_LOGIC, 0, 0, result_value | (carry ? 0x100 : 0));
 
-			break;
+	WRITE_DESTINATION;
 
-		case CLOWNZ80_OPCODE_LD_A_I:
-			/* This instruction requires an extra cycle. */
-			state->cycles += 1;
+	/* The memory-accessing version takes an extra cycle. */
+	state->cycles += instruction->metadata->operands[1] == CLOWNZ80_OPERAND_HL_INDIRECT
+		|| instruction->metadata->operands[1] == CLOWNZ80_OPERAND_IX_INDIRECT
+		|| instruction->metadata->operands[1] == CLOWNZ80_OPERAND_IY_INDIRECT;
+}
 
-			state->a = state->i;
+static void Execute_SRA(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	cc_u16f destination_value;
+	cc_u16f result_value;
+	cc_bool carry;
 
-			state->f &= FLAG_MASK_CARRY;
-			state->f |= (state->a >> (7 - FLAG_BIT_SIGN)) & FLAG_MASK_SIGN;
-			state->f |= state->a == 0 ? FLAG_MASK_ZERO : 0;
-			/* TODO: IFF2 parity bit stuff. */
+	READ_DESTINATION;
 
-			break;
+	carry = (destination_value & 0x01) != 0;
 
-		case CLOWNZ80_OPCODE_LD_A_R:
-			/* This instruction requires an extra cycle. */
-			state->cycles += 1;
+	result_value = (destination_value >> 1) | (destination_value & 0x80);
 
-			state->a = state->r;
+	SetFlags(state, FLAGS_OPERATION_LOGIC, 0, 0, result_value | (carry ? 0x100 : 0));
 
-			state->f &= FLAG_MASK_CARRY;
-			state->f |= (state->a >> (7 - FLAG_BIT_SIGN)) & FLAG_MASK_SIGN;
-			state->f |= state->a == 0 ? FLAG_MASK_ZERO : 0;
-			/* TODO: IFF2 parity bit stuff. */
+	WRITE_DESTINATION;
 
-			break;
+	/* The memory-accessing version takes an extra cycle. */
+	state->cycles += instruction->metadata->operands[1] == CLOWNZ80_OPERAND_HL_INDIRECT
+		|| instruction->metadata->operands[1] == CLOWNZ80_OPERAND_IX_INDIRECT
+		|| instruction->metadata->operands[1] == CLOWNZ80_OPERAND_IY_INDIRECT;
+}
 
-		case CLOWNZ80_OPCODE_RRD:
-		{
-			const cc_u16f hl = ((cc_u16f)state->h << 8) | state->l;
-			const cc_u8f hl_value = MemoryRead(state, callbacks, hl);
-			const cc_u8f hl_high = (hl_value >> 4) & 0xF;
-			const cc_u8f hl_low = (hl_value >> 0) & 0xF;
-			const cc_u8f a_high = (state->a >> 4) & 0xF;
-			const cc_u8f a_low = (state->a >> 0) & 0xF;
+static void Execute_SRL(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	cc_u16f destination_value;
+	cc_u16f result_value;
+	cc_bool carry;
 
-			/* This instruction requires an extra 4 cycles. */
-			state->cycles += 4;
+	READ_DESTINATION;
 
-			MemoryWrite(state, callbacks, hl, (a_low << 4) | (hl_high << 0));
-			result_value = (a_high << 4) | (hl_low << 0);
+	carry = (destination_value & 0x01) != 0;
 
-			state->f &= FLAG_MASK_CARRY;
-			CONDITION_SIGN;
-			CONDITION_ZERO;
-			CONDITION_PARITY;
+	result_value = destination_value >> 1;
 
-			state->a = result_value;
+	SetFlags(state, FLAGS_OPERATION_LOGIC, 0, 0, result_value | (carry ? 0x100 : 0));
 
-			break;
-		}
+	WRITE_DESTINATION;
 
-		case CLOWNZ80_OPCODE_RLD:
-		{
-			const cc_u16f hl = ((cc_u16f)state->h << 8) | state->l;
-			const cc_u8f hl_value = MemoryRead(state, callbacks, hl);
-			const cc_u8f hl_high = (hl_value >> 4) & 0xF;
-			const cc_u8f hl_low = (hl_value >> 0) & 0xF;
-			const cc_u8f a_high = (state->a >> 4) & 0xF;
-			const cc_u8f a_low = (state->a >> 0) & 0xF;
+	/* The memory-accessing version takes an extra cycle. */
+	state->cycles += instruction->metadata->operands[1] == CLOWNZ80_OPERAND_HL_INDIRECT
+		|| instruction->metadata->operands[1] == CLOWNZ80_OPERAND_IX_INDIRECT
+		|| instruction->metadata->operands[1] == CLOWNZ80_OPERAND_IY_INDIRECT;
+}
 
-			/* This instruction requires an extra 4 cycles. */
-			state->cycles += 4;
+static void Execute_BIT(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	cc_u16f destination_value;
 
-			MemoryWrite(state, callbacks, hl, (hl_low << 4) | (a_low << 0));
-			result_value = (a_high << 4) | (hl_high << 0);
+	MaterialiseFlags(state);
 
-			state->f &= FLAG_MASK_CARRY;
-			CONDITION_SIGN;
-			CONDITION_ZERO;
-			CONDITION_PARITY;
+	READ_DESTINATION;
 
-			state->a = result_value;
+	/* The setting of the parity and sign bits doesn't seem to be documented anywhere. */
+	/* TODO: See if emulating this instruction with a SUB instruction produces the proper condition codes. */
+	state->f &= FLAG_MASK_CARRY;
+	state->f |= ((destination_value & instruction->metadata->embedded_literal) == 0) ? FLAG_MASK_ZERO | FLAG_MASK_PARITY_OVERFLOW : 0;
+	state->f |= FLAG_MASK_HALF_CARRY;
+	state->f |= instruction->metadata->embedded_literal == 0x80 && (state->f & FLAG_MASK_ZERO) == 0 ? FLAG_MASK_SIGN : 0;
 
-			break;
-		}
+	/* The memory-accessing version takes an extra cycle. */
+	state->cycles += instruction->metadata->operands[1] == CLOWNZ80_OPERAND_HL_INDIRECT
+		|| instruction->metadata->operands[1] == CLOWNZ80_OPERAND_IX_INDIRECT
+		|| instruction->metadata->operands[1] == CLOWNZ80_OPERAND_IY_INDIRECT;
+}
 
-		case CLOWNZ80_OPCODE_LDI:
-		{
-			const cc_u16f de = ((cc_u16f)state->d << 8) | state->e;
-			const cc_u16f hl = ((cc_u16f)state->h << 8) | state->l;
+static void Execute_RES(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	cc_u16f destination_value;
+	cc_u16f result_value;
 
-			MemoryWrite(state, callbacks, de, MemoryRead(state, callbacks, hl));
+	READ_DESTINATION;
 
-			/* Increment 'hl'. */
-			++state->l;
-			state->l &= 0xFF;
+	result_value = destination_value & instruction->metadata->embedded_literal;
 
-			if (state->l == 0)
-			{
-				++state->h;
-				state->h &= 0xFF;
-			}
+	WRITE_DESTINATION;
 
-			/* Increment 'de'. */
-			++state->e;
-			state->e &= 0xFF;
+	/* The memory-accessing version takes an extra cycle. */
+	state->cycles += instruction->metadata->operands[1] == CLOWNZ80_OPERAND_HL_INDIRECT
+		|| instruction->metadata->operands[1] == CLOWNZ80_OPERAND_IX_INDIRECT
+		|| instruction->metadata->operands[1] == CLOWNZ80_OPERAND_IY_INDIRECT;
+}
 
-			if (state->e == 0)
-			{
-				++state->d;
-				state->d &= 0xFF;
-			}
+static void Execute_SET(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	cc_u16f destination_value;
+	cc_u16f result_value;
 
-			/* Decrement 'bc'. */
-			--state->c;
-			state->c &= 0xFF;
+	READ_DESTINATION;
 
-			if (state->c == 0xFF)
-			{
-				--state->b;
-				state->b &= 0xFF;
-			}
+	result_value = destination_value | instruction->metadata->embedded_literal;
 
-			state->f &= FLAG_MASK_CARRY | FLAG_MASK_ZERO | FLAG_MASK_SIGN;
-			state->f |= (state->b | state->c) != 0 ? FLAG_MASK_PARITY_OVERFLOW : 0;
+	WRITE_DESTINATION;
 
-			/* This instruction requires an extra 2 cycles. */
-			state->cycles += 2;
+	/* The memory-accessing version takes an extra cycle. */
+	state->cycles += instruction->metadata->operands[1] == CLOWNZ80_OPERAND_HL_INDIRECT
+		|| instruction->metadata->operands[1] == CLOWNZ80_OPERAND_IX_INDIRECT
+		|| instruction->metadata->operands[1] == CLOWNZ80_OPERAND_IY_INDIRECT;
+}
 
-			break;
-		}
+static cc_u16f InputFromC(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks)
+{
+	const cc_u16f result_value = PortRead(state, callbacks, ((cc_u16f)state->b << 8) | state->c);
 
-		case CLOWNZ80_OPCODE_LDD:
-		{
-			const cc_u16f de = ((cc_u16f)state->d << 8) | state->e;
-			const cc_u16f hl = ((cc_u16f)state->h << 8) | state->l;
+	MaterialiseFlags(state);
 
-			MemoryWrite(state, callbacks, de, MemoryRead(state, callbacks, hl));
+	state->f &= FLAG_MASK_CARRY;
+	CONDITION_SIGN;
+	CONDITION_ZERO;
+	CONDITION_PARITY;
 
-			/* Decrement 'hl'. */
-			--state->l;
-			state->l &= 0xFF;
+	return result_value;
+}
 
-			if (state->l == 0xFF)
-			{
-				--state->h;
-				state->h &= 0xFF;
-			}
+static void Execute_IN_REGISTER(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	const cc_u16f result_value = InputFromC(state, callbacks);
 
-			/* Decrement 'de'. */
-			--state->e;
-			state->e &= 0xFF;
+	WRITE_DESTINATION;
+}
 
-			if (state->e == 0xFF)
-			{
-				--state->d;
-				state->d &= 0xFF;
-			}
+static void Execute_IN_NO_REGISTER(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	(void)instruction;
 
-			/* Decrement 'bc'. */
-			--state->c;
-			state->c &= 0xFF;
+	/* Only the flags are kept. */
+	InputFromC(state, callbacks);
+}
 
-			if (state->c == 0xFF)
-			{
-				--state->b;
-				state->b &= 0xFF;
-			}
+static void Execute_OUT_REGISTER(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	cc_u16f source_value;
 
-			state->f &= FLAG_MASK_CARRY | FLAG_MASK_ZERO | FLAG_MASK_SIGN;
-			state->f |= (state->b | state->c) != 0 ? FLAG_MASK_PARITY_OVERFLOW : 0;
+	READ_SOURCE;
 
-			/* This instruction requires an extra 2 cycles. */
-			state->cycles += 2;
+	PortWrite(state, callbacks, ((cc_u16f)state->b << 8) | state->c, source_value);
+}
 
-			break;
-		}
+static void Execute_OUT_NO_REGISTER(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	(void)instruction;
 
-		case CLOWNZ80_OPCODE_LDIR:
-		{
-			const cc_u16f de = ((cc_u16f)state->d << 8) | state->e;
-			const cc_u16f hl = ((cc_u16f)state->h << 8) | state->l;
+	/* This is what an NMOS Z80 outputs. A CMOS Z80 outputs 0xFF instead. */
+	PortWrite(state, callbacks, ((cc_u16f)state->b << 8) | state->c, 0);
+}
 
-			MemoryWrite(state, callbacks, de, MemoryRead(state, callbacks, hl));
+static void Execute_SBC_HL(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	cc_u16f source_value;
+	cc_u16f destination_value;
+	cc_u16f result_value;
+	cc_u32f result_value_with_carry_16bit;
 
-			/* Increment 'hl'. */
-			++state->l;
-			state->l &= 0xFF;
+	MaterialiseFlags(state);
 
-			if (state->l == 0)
-			{
-				++state->h;
-				state->h &= 0xFF;
-			}
+	READ_SOURCE;
+	READ_DESTINATION;
 
-			/* Increment 'de'. */
-			++state->e;
-			state->e &= 0xFF;
+	source_value = ~(cc_u32f)source_value;
 
-			if (state->e == 0)
-			{
-				++state->d;
-				state->d &= 0xFF;
-			}
+	result_value_with_carry_16bit = (cc_u32f)source_value + (cc_u32f)destination_value + ((state->f & FLAG_MASK_CARRY) != 0 ? 0 : 1);;
+	result_value = result_value_with_carry_16bit & 0xFFFF;
 
-			/* Decrement 'bc'. */
-			--state->c;
-			state->c &= 0xFF;
+	state->f = 0;
 
-			if (state->c == 0xFF)
-			{
-				--state->b;
-				state->b &= 0xFF;
-			}
+	CONDITION_SIGN_16BIT;
+	CONDITION_ZERO;
+	CONDITION_HALF_CARRY_16BIT;
+	CONDITION_OVERFLOW_16BIT;
+	CONDITION_CARRY_16BIT;
 
-			state->f &= FLAG_MASK_CARRY | FLAG_MASK_ZERO | FLAG_MASK_SIGN;
-			state->f |= (state->b | state->c) != 0 ? FLAG_MASK_PARITY_OVERFLOW : 0;
+	state->f ^= FLAG_MASK_HALF_CARRY;
+	state->f |= FLAG_MASK_ADD_SUBTRACT;
 
-			/* This instruction requires an extra 2 cycles. */
-			state->cycles += 2;
+	WRITE_DESTINATION;
 
-			if ((state->f & FLAG_MASK_PARITY_OVERFLOW) != 0)
-			{
-				/* An extra 5 cycles are needed here. */
-				state->cycles += 5;
+	/* This instruction requires an extra 7 cycles. */
+	state->cycles += 7;
+}
 
-				state->program_counter -= 2;
-			}
+static void Execute_ADC_HL(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	cc_u16f source_value;
+	cc_u16f destination_value;
+	cc_u16f result_value;
+	cc_u32f result_value_with_carry_16bit;
 
-			break;
-		}
+	MaterialiseFlags(state);
 
-		case CLOWNZ80_OPCODE_LDDR:
-		{
-			const cc_u16f de = ((cc_u16f)state->d << 8) | state->e;
-			const cc_u16f hl = ((cc_u16f)state->h << 8) | state->l;
+	READ_SOURCE;
+	READ_DESTINATION;
 
-			MemoryWrite(state, callbacks, de, MemoryRead(state, callbacks, hl));
+	result_value_with_carry_16bit = (cc_u32f)source_value + (cc_u32f)destination_value + ((state->f & FLAG_MASK_CARRY) != 0 ? 1 : 0);
+	result_value = result_value_with_carry_16bit & 0xFFFF;
 
-			/* Decrement 'hl'. */
-			--state->l;
-			state->l &= 0xFF;
+	state->f = 0;
 
-			if (state->l == 0xFF)
-			{
-				--state->h;
-				state->h &= 0xFF;
-			}
+	CONDITION_SIGN_16BIT;
+	CONDITION_ZERO;
+	CONDITION_HALF_CARRY_16BIT;
+	CONDITION_OVERFLOW_16BIT;
+	CONDITION_CARRY_16BIT;
 
-			/* Decrement 'de'. */
-			--state->e;
-			state->e &= 0xFF;
+	WRITE_DESTINATION;
 
-			if (state->e == 0xFF)
-			{
-				--state->d;
-				state->d &= 0xFF;
-			}
+	/* This instruction requires an extra 7 cycles. */
+	state->cycles += 7;
+}
 
-			/* Decrement 'bc'. */
-			--state->c;
-			state->c &= 0xFF;
+static void Execute_NEG(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	cc_u16f source_value;
+	cc_u16f destination_value;
+	cc_u16f result_value;
+	cc_u16f result_value_with_carry;
 
-			if (state->c == 0xFF)
-			{
-				--state->b;
-				state->b &= 0xFF;
-			}
+	(void)callbacks;
+	(void)instruction;
 
-			state->f &= FLAG_MASK_CARRY | FLAG_MASK_ZERO | FLAG_MASK_SIGN;
-			state->f |= (state->b | state->c) != 0 ? FLAG_MASK_PARITY_OVERFLOW : 0;
+	source_value = state->a;
+	source_value = ~source_value;
+	destination_value = 0;
 
-			/* This instruction requires an extra 2 cycles. */
-			state->cycles += 2;
+	result_value_with_carry = destination_value + source_value + 1;
+	result_value = result_value_with_carry & 0xFF;
 
-			if ((state->f & FLAG_MASK_PARITY_OVERFLOW) != 0)
-			{
-				/* An extra 5 cycles are needed here. */
-				state->cycles += 5;
+	SetFlags(state, FLAGS_OPERATION_SUBTRACT, source_value, destination_value, result_value_with_carry);
 
-				state->program_counter -= 2;
-			}
+	state->a = result_value;
+}
 
-			break;
-		}
+static void Execute_IM(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	(void)instruction;
 
-		case CLOWNZ80_OPCODE_CPI:
-		{
-			const cc_u16f hl = ((cc_u16f)state->h << 8) | state->l;
+	UNIMPLEMENTED_Z80_INSTRUCTION("IM");
+}
 
-			source_value = MemoryRead(state, callbacks, hl);
-			destination_value = state->a;
-			result_value = destination_value - source_value;
+static void Execute_LD_I_A(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	(void)callbacks;
+	(void)instruction;
 
-			/* Increment 'hl'. */
-			++state->l;
-			state->l &= 0xFF;
+	/* This instruction requires an extra cycle. */
+	state->cycles += 1;
 
-			if (state->l == 0)
-			{
-				++state->h;
-				state->h &= 0xFF;
-			}
+	state->i = state->a;
+}
 
-			/* Decrement 'bc'. */
-			--state->c;
-			state->c &= 0xFF;
+static void Execute_LD_R_A(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	(void)callbacks;
+	(void)instruction;
 
-			if (state->c == 0xFF)
-			{
-				--state->b;
-				state->b &= 0xFF;
-			}
+	/* This instruction requires an extra cycle. */
+	state->cycles += 1;
 
-			state->f &= FLAG_MASK_CARRY;
-			state->f |= (state->b | state->c) != 0 ? FLAG_MASK_PARITY_OVERFLOW : 0;
-			CONDITION_SIGN;
-			CONDITION_ZERO;
-			CONDITION_HALF_CARRY;
+	state->r = state->a;
+}
 
-			state->f |= FLAG_MASK_ADD_SUBTRACT;
+static void Execute_LD_A_I(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	(void)callbacks;
+	(void)instruction;
 
-			/* This instruction requires an extra 2 cycles. */
-			state->cycles += 2;
+	MaterialiseFlags(state);
 
-			break;
-		}
+	/* This instruction requires an extra cycle. */
+	state->cycles += 1;
 
-		case CLOWNZ80_OPCODE_CPD:
-		{
-			const cc_u16f hl = ((cc_u16f)state->h << 8) | state->l;
+	state->a = state->i;
 
-			source_value = MemoryRead(state, callbacks, hl);
-			destination_value = state->a;
-			result_value = destination_value - source_value;
+	state->f &= FLAG_MASK_CARRY;
+	state->f |= (state->a >> (7 - FLAG_BIT_SIGN)) & FLAG_MASK_SIGN;
+	state->f |= state->a == 0 ? FLAG_MASK_ZERO : 0;
+	/* TODO: IFF2 parity bit stuff. */
+}
 
-			/* Decrement 'hl'. */
-			--state->l;
-			state->l &= 0xFF;
+static void Execute_LD_A_R(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	(void)callbacks;
+	(void)instruction;
 
-			if (state->l == 0xFF)
-			{
-				--state->h;
-				state->h &= 0xFF;
-			}
+	MaterialiseFlags(state);
 
-			/* Decrement 'bc'. */
-			--state->c;
-			state->c &= 0xFF;
+	/* This instruction requires an extra cycle. */
+	state->cycles += 1;
 
-			if (state->c == 0xFF)
-			{
-				--state->b;
-				state->b &= 0xFF;
-			}
+	state->a = state->r;
 
-			state->f &= FLAG_MASK_CARRY;
-			state->f |= (state->b | state->c) != 0 ? FLAG_MASK_PARITY_OVERFLOW : 0;
-			CONDITION_SIGN;
-			CONDITION_ZERO;
-			CONDITION_HALF_CARRY;
+	state->f &= FLAG_MASK_CARRY;
+	state->f |= (state->a >> (7 - FLAG_BIT_SIGN)) & FLAG_MASK_SIGN;
+	state->f |= state->a == 0 ? FLAG_MASK_ZERO : 0;
+	/* TODO: IFF2 parity bit stuff. */
+}
 
-			state->f |= FLAG_MASK_ADD_SUBTRACT;
+static void Execute_RRD(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	cc_u16f result_value;
 
-			/* This instruction requires an extra 2 cycles. */
-			state->cycles += 2;
+	const cc_u16f hl = ((cc_u16f)state->h << 8) | state->l;
+	const cc_u8f hl_value = MemoryRead(state, callbacks, hl);
+	const cc_u8f hl_high = (hl_value >> 4) & 0xF;
+	const cc_u8f hl_low = (hl_value >> 0) & 0xF;
+	const cc_u8f a_high = (state->a >> 4) & 0xF;
+	const cc_u8f a_low = (state->a >> 0) & 0xF;
 
-			break;
-		}
+	(void)instruction;
 
-		case CLOWNZ80_OPCODE_CPIR:
-		{
-			const cc_u16f hl = ((cc_u16f)state->h << 8) | state->l;
+	MaterialiseFlags(state);
 
-			source_value = MemoryRead(state, callbacks, hl);
-			destination_value = state->a;
-			result_value = destination_value - source_value;
+	/* This instruction requires an extra 4 cycles. */
+	state->cycles += 4;
 
-			/* Increment 'hl'. */
-			++state->l;
-			state->l &= 0xFF;
+	MemoryWrite(state, callbacks, hl, (a_low << 4) | (hl_high << 0));
+	result_value = (a_high << 4) | (hl_low << 0);
 
-			if (state->l == 0)
-			{
-				++state->h;
-				state->h &= 0xFF;
-			}
+	state->f &= FLAG_MASK_CARRY;
+	CONDITION_SIGN;
+	CONDITION_ZERO;
+	CONDITION_PARITY;
 
-			/* Decrement 'bc'. */
-			--state->c;
-			state->c &= 0xFF;
+	state->a = result_value;
+}
 
-			if (state->c == 0xFF)
-			{
-				--state->b;
-				state->b &= 0xFF;
-			}
+static void Execute_RLD(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	cc_u16f result_value;
 
-			state->f &= FLAG_MASK_CARRY;
-			state->f |= (state->b | state->c) != 0 ? FLAG_MASK_PARITY_OVERFLOW : 0;
-			CONDITION_SIGN;
-			CONDITION_ZERO;
-			CONDITION_HALF_CARRY;
+	const cc_u16f hl = ((cc_u16f)state->h << 8) | state->l;
+	const cc_u8f hl_value = MemoryRead(state, callbacks, hl);
+	const cc_u8f hl_high = (hl_value >> 4) & 0xF;
+	const cc_u8f hl_low = (hl_value >> 0) & 0xF;
+	const cc_u8f a_high = (state->a >> 4) & 0xF;
+	const cc_u8f a_low = (state->a >> 0) & 0xF;
 
-			state->f |= FLAG_MASK_ADD_SUBTRACT;
+	(void)instruction;
 
-			/* This instruction requires an extra 2 cycles. */
-			state->cycles += 2;
+	MaterialiseFlags(state);
 
-			if ((state->f & FLAG_MASK_PARITY_OVERFLOW) != 0 && (state->f & FLAG_MASK_ZERO) == 0)
-			{
-				/* An extra 5 cycles are needed here. */
-				state->cycles += 5;
+	/* This instruction requires an extra 4 cycles. */
+	state->cycles += 4;
 
-				state->program_counter -= 2;
-			}
+	MemoryWrite(state, callbacks, hl, (hl_low << 4) | (a_low << 0));
+	result_value = (a_high << 4) | (hl_high << 0);
 
-			break;
-		}
+	state->f &= FLAG_MASK_CARRY;
+	CONDITION_SIGN;
+	CONDITION_ZERO;
+	CONDITION_PARITY;
 
-		case CLOWNZ80_OPCODE_CPDR:
-		{
-			const cc_u16f hl = ((cc_u16f)state->h << 8) | state->l;
+	state->a = result_value;
+}
 
-			source_value = MemoryRead(state, callbacks, hl);
-			destination_value = state->a;
-			result_value = destination_value - source_value;
+static void Execute_LDI(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	const cc_u16f de = ((cc_u16f)state->d << 8) | state->e;
+	const cc_u16f hl = ((cc_u16f)state->h << 8) | state->l;
 
-			/* Decrement 'hl'. */
-			--state->l;
-			state->l &= 0xFF;
+	(void)instruction;
 
-			if (state->l == 0xFF)
-			{
-				--state->h;
-				state->h &= 0xFF;
-			}
+	MaterialiseFlags(state);
 
-			/* Decrement 'bc'. */
-			--state->c;
-			state->c &= 0xFF;
+	MemoryWrite(state, callbacks, de, MemoryRead(state, callbacks, hl));
 
-			if (state->c == 0xFF)
-			{
-				--state->b;
-				state->b &= 0xFF;
-			}
+	/* Increment 'hl'. */
+	++state->l;
+	state->l &= 0xFF;
 
-			state->f &= FLAG_MASK_CARRY;
-			state->f |= (state->b | state->c) != 0 ? FLAG_MASK_PARITY_OVERFLOW : 0;
-			CONDITION_SIGN;
-			CONDITION_ZERO;
-			CONDITION_HALF_CARRY;
+	if (state->l == 0)
+	{
+		++state->h;
+		state->h &= 0xFF;
+	}
 
-			state->f |= FLAG_MASK_ADD_SUBTRACT;
+	/* Increment 'de'. */
+	++state->e;
+	state->e &= 0xFF;
 
-			/* This instruction requires an extra 2 cycles. */
-			state->cycles += 2;
+	if (state->e == 0)
+	{
+		++state->d;
+		state->d &= 0xFF;
+	}
 
-			if ((state->f & FLAG_MASK_PARITY_OVERFLOW) != 0 && (state->f & FLAG_MASK_ZERO) == 0)
-			{
-				/* An extra 5 cycles are needed here. */
-				state->cycles += 5;
+	/* Decrement 'bc'. */
+	--state->c;
+	state->c &= 0xFF;
 
-				state->program_counter -= 2;
-			}
+	if (state->c == 0xFF)
+	{
+		--state->b;
+		state->b &= 0xFF;
+	}
+
+	state->f &= FLAG_MASK_CARRY | FLAG_MASK_ZERO | FLAG_MASK_SIGN;
+	state->f |= (state->b | state->c) != 0 ? FLAG_MASK_PARITY_OVERFLOW : 0;
+
+	/* This instruction requires an extra 2 cycles. */
+	state->cycles += 2;
+}
+
+static void Execute_LDD(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	const cc_u16f de = ((cc_u16f)state->d << 8) | state->e;
+	const cc_u16f hl = ((cc_u16f)state->h << 8) | state->l;
+
+	(void)instruction;
+
+	MaterialiseFlags(state);
+
+	MemoryWrite(state, callbacks, de, MemoryRead(state, callbacks, hl));
+
+	/* Decrement 'hl'. */
+	--state->l;
+	state->l &= 0xFF;
+
+	if (state->l == 0xFF)
+	{
+		--state->h;
+		state->h &= 0xFF;
+	}
+
+	/* Decrement 'de'. */
+	--state->e;
+	state->e &= 0xFF;
+
+	if (state->e == 0xFF)
+	{
+		--state->d;
+		state->d &= 0xFF;
+	}
+
+	/* Decrement 'bc'. */
+	--state->c;
+	state->c &= 0xFF;
+
+	if (state->c == 0xFF)
+	{
+		--state->b;
+		state->b &= 0xFF;
+	}
+
+	state->f &= FLAG_MASK_CARRY | FLAG_MASK_ZERO | FLAG_MASK_SIGN;
+	state->f |= (state->b | state->c) != 0 ? FLAG_MASK_PARITY_OVERFLOW : 0;
+
+	/* This instruction requires an extra 2 cycles. */
+	state->cycles += 2;
+}
+
+static void Execute_LDIR(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	const cc_u16f de = ((cc_u16f)state->d << 8) | state->e;
+	const cc_u16f hl = ((cc_u16f)state->h << 8) | state->l;
+
+	(void)instruction;
+
+	MaterialiseFlags(state);
+
+	MemoryWrite(state, callbacks, de, MemoryRead(state, callbacks, hl));
+
+	/* Increment 'hl'. */
+	++state->l;
+	state->l &= 0xFF;
+
+	if (state->l == 0)
+	{
+		++state->h;
+		state->h &= 0xFF;
+	}
+
+	/* Increment 'de'. */
+	++state->e;
+	state->e &= 0xFF;
+
+	if (state->e == 0)
+	{
+		++state->d;
+		state->d &= 0xFF;
+	}
+
+	/* Decrement 'bc'. */
+	--state->c;
+	state->c &= 0xFF;
+
+	if (state->c == 0xFF)
+	{
+		--state->b;
+		state->b &= 0xFF;
+	}
+
+	state->f &= FLAG_MASK_CARRY | FLAG_MASK_ZERO | FLAG_MASK_SIGN;
+	state->f |= (state->b | state->c) != 0 ? FLAG_MASK_PARITY_OVERFLOW : 0;
+
+	/* This instruction requires an extra 2 cycles. */
+	state->cycles += 2;
+
+	if ((state->f & FLAG_MASK_PARITY_OVERFLOW) != 0)
+	{
+		/* An extra 5 cycles are needed here. */
+		state->cycles += 5;
+
+		state->program_counter -= 2;
+	}
+}
+
+static void Execute_LDDR(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	const cc_u16f de = ((cc_u16f)state->d << 8) | state->e;
+	const cc_u16f hl = ((cc_u16f)state->h << 8) | state->l;
+
+	(void)instruction;
+
+	MaterialiseFlags(state);
+
+	MemoryWrite(state, callbacks, de, MemoryRead(state, callbacks, hl));
+
+	/* Decrement 'hl'. */
+	--state->l;
+	state->l &= 0xFF;
+
+	if (state->l == 0xFF)
+	{
+		--state->h;
+		state->h &= 0xFF;
+	}
+
+	/* Decrement 'de'. */
+	--state->e;
+	state->e &= 0xFF;
+
+	if (state->e == 0xFF)
+	{
+		--state->d;
+		state->d &= 0xFF;
+	}
+
+	/* Decrement 'bc'. */
+	--state->c;
+	state->c &= 0xFF;
+
+	if (state->c == 0xFF)
+	{
+		--state->b;
+		state->b &= 0xFF;
+	}
+
+	state->f &= FLAG_MASK_CARRY | FLAG_MASK_ZERO | FLAG_MASK_SIGN;
+	state->f |= (state->b | state->c) != 0 ? FLAG_MASK_PARITY_OVERFLOW : 0;
+
+	/* This instruction requires an extra 2 cycles. */
+	state->cycles += 2;
+
+	if ((state->f & FLAG_MASK_PARITY_OVERFLOW) != 0)
+	{
+		/* An extra 5 cycles are needed here. */
+		state->cycles += 5;
+
+		state->program_counter -= 2;
+	}
+}
+
+static void Execute_CPI(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	cc_u16f source_value;
+	cc_u16f destination_value;
+	cc_u16f result_value;
+
+	const cc_u16f hl = ((cc_u16f)state->h << 8) | state->l;
+
+	(void)instruction;
+
+	MaterialiseFlags(state);
+
+	source_value = MemoryRead(state, callbacks, hl);
+	destination_value = state->a;
+	result_value = destination_value - source_value;
+
+	/* Increment 'hl'. */
+	++state->l;
+	state->l &= 0xFF;
+
+	if (state->l == 0)
+	{
+		++state->h;
+		state->h &= 0xFF;
+	}
+
+	/* Decrement 'bc'. */
+	--state->c;
+	state->c &= 0xFF;
+
+	if (state->c == 0xFF)
+	{
+		--state->b;
+		state->b &= 0xFF;
+	}
+
+	state->f &= FLAG_MASK_CARRY;
+	state->f |= (state->b | state->c) != 0 ? FLAG_MASK_PARITY_OVERFLOW : 0;
+	CONDITION_SIGN;
+	CONDITION_ZERO;
+	CONDITION_HALF_CARRY;
+
+	state->f |= FLAG_MASK_ADD_SUBTRACT;
+
+	/* This instruction requires an extra 2 cycles. */
+	state->cycles += 2;
+}
+
+static void Execute_CPD(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	cc_u16f source_value;
+	cc_u16f destination_value;
+	cc_u16f result_value;
+
+	const cc_u16f hl = ((cc_u16f)state->h << 8) | state->l;
+
+	(void)instruction;
+
+	MaterialiseFlags(state);
+
+	source_value = MemoryRead(state, callbacks, hl);
+	destination_value = state->a;
+	result_value = destination_value - source_value;
+
+	/* Decrement 'hl'. */
+	--state->l;
+	state->l &= 0xFF;
+
+	if (state->l == 0xFF)
+	{
+		--state->h;
+		state->h &= 0xFF;
+	}
+
+	/* Decrement 'bc'. */
+	--state->c;
+	state->c &= 0xFF;
+
+	if (state->c == 0xFF)
+	{
+		--state->b;
+		state->b &= 0xFF;
+	}
+
+	state->f &= FLAG_MASK_CARRY;
+	state->f |= (state->b | state->c) != 0 ? FLAG_MASK_PARITY_OVERFLOW : 0;
+	CONDITION_SIGN;
+	CONDITION_ZERO;
+	CONDITION_HALF_CARRY;
+
+	state->f |= FLAG_MASK_ADD_SUBTRACT;
+
+	/* This instruction requires an extra 2 cycles. */
+	state->cycles += 2;
+}
+
+static void Execute_CPIR(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	cc_u16f source_value;
+	cc_u16f destination_value;
+	cc_u16f result_value;
+
+	const cc_u16f hl = ((cc_u16f)state->h << 8) | state->l;
+
+	(void)instruction;
+
+	MaterialiseFlags(state);
+
+	source_value = MemoryRead(state, callbacks, hl);
+	destination_value = state->a;
+	result_value = destination_value - source_value;
+
+	/* Increment 'hl'. */
+	++state->l;
+	state->l &= 0xFF;
+
+	if (state->l == 0)
+	{
+		++state->h;
+		state->h &= 0xFF;
+	}
+
+	/* Decrement 'bc'. */
+	--state->c;
+	state->c &= 0xFF;
+
+	if (state->c == 0xFF)
+	{
+		--state->b;
+		state->b &= 0xFF;
+	}
+
+	state->f &= FLAG_MASK_CARRY;
+	state->f |= (state->b | state->c) != 0 ? FLAG_MASK_PARITY_OVERFLOW : 0;
+	CONDITION_SIGN;
+	CONDITION_ZERO;
+	CONDITION_HALF_CARRY;
+
+	state->f |= FLAG_MASK_ADD_SUBTRACT;
+
+	/* This instruction requires an extra 2 cycles. */
+	state->cycles += 2;
+
+	if ((state->f & FLAG_MASK_PARITY_OVERFLOW) != 0 && (state->f & FLAG_MASK_ZERO) == 0)
+	{
+		/* An extra 5 cycles are needed here. */
+		state->cycles += 5;
+
+		state->program_counter -= 2;
+	}
+}
+
+static void Execute_CPDR(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	cc_u16f source_value;
+	cc_u16f destination_value;
+	cc_u16f result_value;
+
+	const cc_u16f hl = ((cc_u16f)state->h << 8) | state->l;
+
+	(void)instruction;
+
+	MaterialiseFlags(state);
+
+	source_value = MemoryRead(state, callbacks, hl);
+	destination_value = state->a;
+	result_value = destination_value - source_value;
+
+	/* Decrement 'hl'. */
+	--state->l;
+	state->l &= 0xFF;
+
+	if (state->l == 0xFF)
+	{
+		--state->h;
+		state->h &= 0xFF;
+	}
+
+	/* Decrement 'bc'. */
+	--state->c;
+	state->c &= 0xFF;
+
+	if (state->c == 0xFF)
+	{
+		--state->b;
+		state->b &= 0xFF;
+	}
+
+	state->f &= FLAG_MASK_CARRY;
+	state->f |= (state->b | state->c) != 0 ? FLAG_MASK_PARITY_OVERFLOW : 0;
+	CONDITION_SIGN;
+	CONDITION_ZERO;
+	CONDITION_HALF_CARRY;
+
+	state->f |= FLAG_MASK_ADD_SUBTRACT;
+
+	/* This instruction requires an extra 2 cycles. */
+	state->cycles += 2;
+
+	if ((state->f & FLAG_MASK_PARITY_OVERFLOW) != 0 && (state->f & FLAG_MASK_ZERO) == 0)
+	{
+		/* An extra 5 cycles are needed here. */
+		state->cycles += 5;
+
+		state->program_counter -= 2;
+	}
+}
+
+/* The flags of the block I/O instructions are mostly based on 'b', but some of them are based on the byte that was transferred,
+   and 'k', which is that byte added to the lower 8 bits of the register pair that was used alongside 'hl'. */
+static void SetBlockInputOutputFlags(ClownZ80_State* const state, const cc_u16f value, const cc_u16f k)
+{
+	const cc_u16f result_value = state->b;
+
+	state->f = 0;
+	CONDITION_SIGN;
+	CONDITION_ZERO;
+	state->f |= ComputeParity((k & 7) ^ state->b) ? FLAG_MASK_PARITY_OVERFLOW : 0;
+	state->f |= k > 0xFF ? FLAG_MASK_HALF_CARRY | FLAG_MASK_CARRY : 0;
+	state->f |= (value & 0x80) != 0 ? FLAG_MASK_ADD_SUBTRACT : 0;
+}
+
+static void InputToMemory(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const cc_bool increment)
+{
+	const cc_u16f hl = ((cc_u16f)state->h << 8) | state->l;
+	const cc_u16f next_hl = (hl + (increment ? 1 : 0xFFFF)) & 0xFFFF;
+
+	cc_u16f value;
+
+	MaterialiseFlags(state);
+
+	/* This instruction requires an extra cycle. */
+	++state->cycles;
+
+	value = PortRead(state, callbacks, ((cc_u16f)state->b << 8) | state->c);
+	MemoryWrite(state, callbacks, hl, value);
+
+	state->h = next_hl >> 8;
+	state->l = next_hl & 0xFF;
+
+	--state->b;
+	state->b &= 0xFF;
+
+	SetBlockInputOutputFlags(state, value, value + ((state->c + (increment ? 1 : 0xFF)) & 0xFF));
+}
+
+static void OutputFromMemory(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const cc_bool increment)
+{
+	const cc_u16f hl = ((cc_u16f)state->h << 8) | state->l;
+	const cc_u16f next_hl = (hl + (increment ? 1 : 0xFFFF)) & 0xFFFF;
+
+	cc_u16f value;
+
+	MaterialiseFlags(state);
+
+	/* This instruction requires an extra cycle. */
+	++state->cycles;
+
+	value = MemoryRead(state, callbacks, hl);
+
+	/* Unlike the input instructions, 'b' is decremented before it is used as part of the port. */
+	--state->b;
+	state->b &= 0xFF;
+
+	PortWrite(state, callbacks, ((cc_u16f)state->b << 8) | state->c, value);
+
+	state->h = next_hl >> 8;
+	state->l = next_hl & 0xFF;
+
+	SetBlockInputOutputFlags(state, value, value + state->l);
+}
+
+static void RepeatBlockInputOutput(ClownZ80_State* const state)
+{
+	if (state->b != 0)
+	{
+		/* An extra 5 cycles are needed here. */
+		state->cycles += 5;
+
+		state->program_counter = (state->program_counter - 2) & 0xFFFF;
+	}
+}
+
+static void Execute_INI(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	(void)instruction;
+
+	InputToMemory(state, callbacks, cc_true);
+}
+
+static void Execute_IND(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	(void)instruction;
+
+	InputToMemory(state, callbacks, cc_false);
+}
+
+static void Execute_INIR(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	(void)instruction;
+
+	InputToMemory(state, callbacks, cc_true);
+	RepeatBlockInputOutput(state);
+}
+
+static void Execute_INDR(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	(void)instruction;
+
+	InputToMemory(state, callbacks, cc_false);
+	RepeatBlockInputOutput(state);
+}
+
+static void Execute_OUTI(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	(void)instruction;
+
+	OutputFromMemory(state, callbacks, cc_true);
+}
+
+static void Execute_OUTD(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	(void)instruction;
+
+	OutputFromMemory(state, callbacks, cc_false);
+}
+
+static void Execute_OTIR(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	(void)instruction;
+
+	OutputFromMemory(state, callbacks, cc_true);
+	RepeatBlockInputOutput(state);
+}
+
+static void Execute_OTDR(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	(void)instruction;
+
+	OutputFromMemory(state, callbacks, cc_false);
+	RepeatBlockInputOutput(state);
+}
+
+#undef UNIMPLEMENTED_Z80_INSTRUCTION
+
+/* Specialised handlers for the most common instructions, with their operands resolved at compile time instead of by
+   'ReadOperand' and 'WriteOperand'. They are generated by macros, one for each combination of operands. */
+
+#define OPERAND_A state->a
+#define OPERAND_B state->b
+#define OPERAND_C state->c
+#define OPERAND_D state->d
+#define OPERAND_E state->e
+#define OPERAND_H state->h
+#define OPERAND_L state->l
+#define OPERAND_IXH state->ixh
+#define OPERAND_IXL state->ixl
+#define OPERAND_IYH state->iyh
+#define OPERAND_IYL state->iyl
+/* All memory operands, including '(IX+d)', have had their address resolved ahead of time. */
+#define OPERAND_MEMORY MemoryRead(state, callbacks, instruction->address)
+#define OPERAND_LITERAL instruction->literal
+
+#define SPECIALISED_REGISTERS(X, ARGUMENT) \
+	X(ARGUMENT, A) \
+	X(ARGUMENT, B) \
+	X(ARGUMENT, C) \
+	X(ARGUMENT, D) \
+	X(ARGUMENT, E) \
+	X(ARGUMENT, H) \
+	X(ARGUMENT, L) \
+	X(ARGUMENT, IXH) \
+	X(ARGUMENT, IXL) \
+	X(ARGUMENT, IYH) \
+	X(ARGUMENT, IYL)
+
+/* Literals can only be sources, so they come last, allowing the other operands to be used as destinations too. */
+#define SPECIALISED_OPERANDS(X, ARGUMENT) \
+	SPECIALISED_REGISTERS(X, ARGUMENT) \
+	X(ARGUMENT, MEMORY) \
+	X(ARGUMENT, LITERAL)
+
+#define DEFINE_OPERAND_INDEX(ARGUMENT, OPERAND) SPECIALISED_OPERAND_##OPERAND,
+
+enum
+{
+	SPECIALISED_OPERANDS(DEFINE_OPERAND_INDEX, UNUSED)
+	TOTAL_SPECIALISED_OPERANDS,
+	TOTAL_SPECIALISED_DESTINATIONS = SPECIALISED_OPERAND_LITERAL
+};
+
+#define HANDLER_PARAMETERS ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction
+
+#define DEFINE_LD_HANDLER(DESTINATION, SOURCE) \
+static void Execute_LD_##DESTINATION##_##SOURCE(HANDLER_PARAMETERS) \
+{ \
+	(void)callbacks; \
+	(void)instruction; \
+	OPERAND_##DESTINATION = OPERAND_##SOURCE; \
+}
+
+#define DEFINE_LD_MEMORY_HANDLER(UNUSED, SOURCE) \
+static void Execute_LD_MEMORY_##SOURCE(HANDLER_PARAMETERS) \
+{ \
+	MemoryWrite(state, callbacks, instruction->address, OPERAND_##SOURCE); \
+}
+
+#define DEFINE_ALU_HANDLER(OPERATION, SOURCE) \
+static void Execute_##OPERATION##_##SOURCE(HANDLER_PARAMETERS) \
+{ \
+	(void)callbacks; \
+	(void)instruction; \
+	Operation_##OPERATION(state, OPERAND_##SOURCE); \
+}
+
+#define DEFINE_INC_DEC_HANDLER(OPERATION, DESTINATION) \
+static void Execute_##OPERATION##_##DESTINATION(HANDLER_PARAMETERS) \
+{ \
+	(void)callbacks; \
+	(void)instruction; \
+	OPERAND_##DESTINATION = Operation_##OPERATION(state, OPERAND_##DESTINATION); \
+}
+
+#define LIST_LD_HANDLER(DESTINATION, SOURCE) {Execute_LD_##DESTINATION##_##SOURCE, CLOWNZ80_OPCODE_LD_8BIT},
+#define LIST_HANDLER(OPERATION, OPERAND) {Execute_##OPERATION##_##OPERAND, CLOWNZ80_OPCODE_##OPERATION},
+
+SPECIALISED_OPERANDS(DEFINE_LD_HANDLER, A)
+SPECIALISED_OPERANDS(DEFINE_LD_HANDLER, B)
+SPECIALISED_OPERANDS(DEFINE_LD_HANDLER, C)
+SPECIALISED_OPERANDS(DEFINE_LD_HANDLER, D)
+SPECIALISED_OPERANDS(DEFINE_LD_HANDLER, E)
+SPECIALISED_OPERANDS(DEFINE_LD_HANDLER, H)
+SPECIALISED_OPERANDS(DEFINE_LD_HANDLER, L)
+SPECIALISED_OPERANDS(DEFINE_LD_HANDLER, IXH)
+SPECIALISED_OPERANDS(DEFINE_LD_HANDLER, IXL)
+SPECIALISED_OPERANDS(DEFINE_LD_HANDLER, IYH)
+SPECIALISED_OPERANDS(DEFINE_LD_HANDLER, IYL)
+SPECIALISED_OPERANDS(DEFINE_LD_MEMORY_HANDLER, UNUSED)
+
+SPECIALISED_OPERANDS(DEFINE_ALU_HANDLER, ADD_A)
+SPECIALISED_OPERANDS(DEFINE_ALU_HANDLER, ADC_A)
+SPECIALISED_OPERANDS(DEFINE_ALU_HANDLER, SUB)
+SPECIALISED_OPERANDS(DEFINE_ALU_HANDLER, SBC_A)
+SPECIALISED_OPERANDS(DEFINE_ALU_HANDLER, AND)
+SPECIALISED_OPERANDS(DEFINE_ALU_HANDLER, XOR)
+SPECIALISED_OPERANDS(DEFINE_ALU_HANDLER, OR)
+SPECIALISED_OPERANDS(DEFINE_ALU_HANDLER, CP)
+
+/* The memory-accessing versions of these take an extra cycle, so they are left to the generic handlers. */
+SPECIALISED_REGISTERS(DEFINE_INC_DEC_HANDLER, INC_8BIT)
+SPECIALISED_REGISTERS(DEFINE_INC_DEC_HANDLER, DEC_8BIT)
+
+/* Where each group of handlers begins in 'instruction_handlers'. */
+enum
+{
+	/* Indexed by destination, and then by source. 'LD (HL),(HL)' does not exist, so its entry is never used. */
+	HANDLER_INDEX_LD_8BIT = CLOWNZ80_OPCODE_OTDR + 1,
+	/* Indexed by 'ClownZ80_Opcode' minus 'CLOWNZ80_OPCODE_ADD_A', and then by source. */
+	HANDLER_INDEX_ALU = HANDLER_INDEX_LD_8BIT + TOTAL_SPECIALISED_DESTINATIONS * TOTAL_SPECIALISED_OPERANDS,
+	/* Indexed by destination. */
+	HANDLER_INDEX_INC_8BIT = HANDLER_INDEX_ALU + 8 * TOTAL_SPECIALISED_OPERANDS,
+	HANDLER_INDEX_DEC_8BIT = HANDLER_INDEX_INC_8BIT + SPECIALISED_OPERAND_MEMORY
+};
+
+/* Every handler, so that they can be referred to by index instead of by address. The generic handlers come first, and are
+   indexed by 'ClownZ80_Opcode', so they must be kept in the same order. The specialised handlers follow, as laid out above. */
+static const HandlerTableEntry instruction_handlers[] = {
+	{Execute_NOP, CLOWNZ80_OPCODE_NOP},
+	{Execute_EX_AF_AF, CLOWNZ80_OPCODE_EX_AF_AF},
+	{Execute_DJNZ, CLOWNZ80_OPCODE_DJNZ},
+	{Execute_JR_UNCONDITIONAL, CLOWNZ80_OPCODE_JR_UNCONDITIONAL},
+	{Execute_JR_CONDITIONAL, CLOWNZ80_OPCODE_JR_CONDITIONAL},
+	{Execute_LD, CLOWNZ80_OPCODE_LD_16BIT},
+	{Execute_ADD_HL, CLOWNZ80_OPCODE_ADD_HL},
+	{Execute_LD, CLOWNZ80_OPCODE_LD_8BIT},
+	{Execute_INC_16BIT, CLOWNZ80_OPCODE_INC_16BIT},
+	{Execute_DEC_16BIT, CLOWNZ80_OPCODE_DEC_16BIT},
+	{Execute_INC_8BIT, CLOWNZ80_OPCODE_INC_8BIT},
+	{Execute_DEC_8BIT, CLOWNZ80_OPCODE_DEC_8BIT},
+	{Execute_RLCA, CLOWNZ80_OPCODE_RLCA},
+	{Execute_RRCA, CLOWNZ80_OPCODE_RRCA},
+	{Execute_RLA, CLOWNZ80_OPCODE_RLA},
+	{Execute_RRA, CLOWNZ80_OPCODE_RRA},
+	{Execute_DAA, CLOWNZ80_OPCODE_DAA},
+	{Execute_CPL, CLOWNZ80_OPCODE_CPL},
+	{Execute_SCF, CLOWNZ80_OPCODE_SCF},
+	{Execute_CCF, CLOWNZ80_OPCODE_CCF},
+	{Execute_HALT, CLOWNZ80_OPCODE_HALT},
+	{Execute_ADD_A, CLOWNZ80_OPCODE_ADD_A},
+	{Execute_ADC_A, CLOWNZ80_OPCODE_ADC_A},
+	{Execute_SUB, CLOWNZ80_OPCODE_SUB},
+	{Execute_SBC_A, CLOWNZ80_OPCODE_SBC_A},
+	{Execute_AND, CLOWNZ80_OPCODE_AND},
+	{Execute_XOR, CLOWNZ80_OPCODE_XOR},
+	{Execute_OR, CLOWNZ80_OPCODE_OR},
+	{Execute_CP, CLOWNZ80_OPCODE_CP},
+	{Execute_RET_CONDITIONAL, CLOWNZ80_OPCODE_RET_CONDITIONAL},
+	{Execute_POP, CLOWNZ80_OPCODE_POP},
+	{Execute_RET_UNCONDITIONAL, CLOWNZ80_OPCODE_RET_UNCONDITIONAL},
+	{Execute_EXX, CLOWNZ80_OPCODE_EXX},
+	{Execute_JP_UNCONDITIONAL, CLOWNZ80_OPCODE_JP_HL},
+	{Execute_LD_SP_HL, CLOWNZ80_OPCODE_LD_SP_HL},
+	{Execute_JP_CONDITIONAL, CLOWNZ80_OPCODE_JP_CONDITIONAL},
+	{Execute_JP_UNCONDITIONAL, CLOWNZ80_OPCODE_JP_UNCONDITIONAL},
+	{Execute_CB_ED_PREFIX, CLOWNZ80_OPCODE_CB_PREFIX},
+	{Execute_OUT, CLOWNZ80_OPCODE_OUT},
+	{Execute_IN, CLOWNZ80_OPCODE_IN},
+	{Execute_EX_SP_HL, CLOWNZ80_OPCODE_EX_SP_HL},
+	{Execute_EX_DE_HL, CLOWNZ80_OPCODE_EX_DE_HL},
+	{Execute_DI, CLOWNZ80_OPCODE_DI},
+	{Execute_EI, CLOWNZ80_OPCODE_EI},
+	{Execute_CALL_CONDITIONAL, CLOWNZ80_OPCODE_CALL_CONDITIONAL},
+	{Execute_PUSH, CLOWNZ80_OPCODE_PUSH},
+	{Execute_CALL_UNCONDITIONAL, CLOWNZ80_OPCODE_CALL_UNCONDITIONAL},
+	{Execute_DD_PREFIX, CLOWNZ80_OPCODE_DD_PREFIX},
+	{Execute_CB_ED_PREFIX, CLOWNZ80_OPCODE_ED_PREFIX},
+	{Execute_FD_PREFIX, CLOWNZ80_OPCODE_FD_PREFIX},
+	{Execute_RST, CLOWNZ80_OPCODE_RST},
+	{Execute_RLC, CLOWNZ80_OPCODE_RLC},
+	{Execute_RRC, CLOWNZ80_OPCODE_RRC},
+	{Execute_RL, CLOWNZ80_OPCODE_RL},
+	{Execute_RR, CLOWNZ80_OPCODE_RR},
+	{Execute_SLA, CLOWNZ80_OPCODE_SLA},
+	{Execute_SRA, CLOWNZ80_OPCODE_SRA},
+	{Execute_SLL, CLOWNZ80_OPCODE_SLL},
+	{Execute_SRL, CLOWNZ80_OPCODE_SRL},
+	{Execute_BIT, CLOWNZ80_OPCODE_BIT},
+	{Execute_RES, CLOWNZ80_OPCODE_RES},
+	{Execute_SET, CLOWNZ80_OPCODE_SET},
+	{Execute_IN_REGISTER, CLOWNZ80_OPCODE_IN_REGISTER},
+	{Execute_IN_NO_REGISTER, CLOWNZ80_OPCODE_IN_NO_REGISTER},
+	{Execute_OUT_REGISTER, CLOWNZ80_OPCODE_OUT_REGISTER},
+	{Execute_OUT_NO_REGISTER, CLOWNZ80_OPCODE_OUT_NO_REGISTER},
+	{Execute_SBC_HL, CLOWNZ80_OPCODE_SBC_HL},
+	{Execute_ADC_HL, CLOWNZ80_OPCODE_ADC_HL},
+	{Execute_NEG, CLOWNZ80_OPCODE_NEG},
+	{Execute_RET_UNCONDITIONAL, CLOWNZ80_OPCODE_RETN},
+	{Execute_RET_UNCONDITIONAL, CLOWNZ80_OPCODE_RETI},
+	{Execute_IM, CLOWNZ80_OPCODE_IM},
+	{Execute_LD_I_A, CLOWNZ80_OPCODE_LD_I_A},
+	{Execute_LD_R_A, CLOWNZ80_OPCODE_LD_R_A},
+	{Execute_LD_A_I, CLOWNZ80_OPCODE_LD_A_I},
+	{Execute_LD_A_R, CLOWNZ80_OPCODE_LD_A_R},
+	{Execute_RRD, CLOWNZ80_OPCODE_RRD},
+	{Execute_RLD, CLOWNZ80_OPCODE_RLD},
+	{Execute_LDI, CLOWNZ80_OPCODE_LDI},
+	{Execute_LDD, CLOWNZ80_OPCODE_LDD},
+	{Execute_LDIR, CLOWNZ80_OPCODE_LDIR},
+	{Execute_LDDR, CLOWNZ80_OPCODE_LDDR},
+	{Execute_CPI, CLOWNZ80_OPCODE_CPI},
+	{Execute_CPD, CLOWNZ80_OPCODE_CPD},
+	{Execute_CPIR, CLOWNZ80_OPCODE_CPIR},
+	{Execute_CPDR, CLOWNZ80_OPCODE_CPDR},
+	{Execute_INI, CLOWNZ80_OPCODE_INI},
+	{Execute_IND, CLOWNZ80_OPCODE_IND},
+	{Execute_INIR, CLOWNZ80_OPCODE_INIR},
+	{Execute_INDR, CLOWNZ80_OPCODE_INDR},
+	{Execute_OUTI, CLOWNZ80_OPCODE_OUTI},
+	{Execute_OUTD, CLOWNZ80_OPCODE_OUTD},
+	{Execute_OTIR, CLOWNZ80_OPCODE_OTIR},
+	{Execute_OTDR, CLOWNZ80_OPCODE_OTDR},
+
+	SPECIALISED_OPERANDS(LIST_LD_HANDLER, A)
+	SPECIALISED_OPERANDS(LIST_LD_HANDLER, B)
+	SPECIALISED_OPERANDS(LIST_LD_HANDLER, C)
+	SPECIALISED_OPERANDS(LIST_LD_HANDLER, D)
+	SPECIALISED_OPERANDS(LIST_LD_HANDLER, E)
+	SPECIALISED_OPERANDS(LIST_LD_HANDLER, H)
+	SPECIALISED_OPERANDS(LIST_LD_HANDLER, L)
+	SPECIALISED_OPERANDS(LIST_LD_HANDLER, IXH)
+	SPECIALISED_OPERANDS(LIST_LD_HANDLER, IXL)
+	SPECIALISED_OPERANDS(LIST_LD_HANDLER, IYH)
+	SPECIALISED_OPERANDS(LIST_LD_HANDLER, IYL)
+	SPECIALISED_OPERANDS(LIST_LD_HANDLER, MEMORY)
+
+	SPECIALISED_OPERANDS(LIST_HANDLER, ADD_A)
+	SPECIALISED_OPERANDS(LIST_HANDLER, ADC_A)
+	SPECIALISED_OPERANDS(LIST_HANDLER, SUB)
+	SPECIALISED_OPERANDS(LIST_HANDLER, SBC_A)
+	SPECIALISED_OPERANDS(LIST_HANDLER, AND)
+	SPECIALISED_OPERANDS(LIST_HANDLER, XOR)
+	SPECIALISED_OPERANDS(LIST_HANDLER, OR)
+	SPECIALISED_OPERANDS(LIST_HANDLER, CP)
+
+	SPECIALISED_REGISTERS(LIST_HANDLER, INC_8BIT)
+	SPECIALISED_REGISTERS(LIST_HANDLER, DEC_8BIT)
+};
+
+#undef LIST_HANDLER
+#undef LIST_LD_HANDLER
+#undef DEFINE_INC_DEC_HANDLER
+#undef DEFINE_ALU_HANDLER
+#undef DEFINE_LD_MEMORY_HANDLER
+#undef DEFINE_LD_HANDLER
+#undef HANDLER_PARAMETERS
+#undef DEFINE_OPERAND_INDEX
+#undef SPECIALISED_OPERANDS
+#undef SPECIALISED_REGISTERS
+#undef OPERAND_LITERAL
+#undef OPERAND_MEMORY
+#undef OPERAND_IYL
+#undef OPERAND_IYH
+#undef OPERAND_IXL
+#undef OPERAND_IXH
+#undef OPERAND_L
+#undef OPERAND_H
+#undef OPERAND_E
+#undef OPERAND_D
+#undef OPERAND_C
+#undef OPERAND_B
+#undef OPERAND_A
+
+#ifdef CLOWNZ80_PRECOMPUTE_INSTRUCTION_METADATA
+static void LookUpInstruction(Z80Instruction* const instruction, const cc_u8f lookup, const cc_u8f opcode)
+{
+	const cc_u32f packed = instruction_lookup[lookup][opcode];
+	const HandlerTableEntry* const handler = &instruction_handlers[(packed >> PACKED_METADATA_HANDLER_SHIFT) & PACKED_METADATA_HANDLER_MASK];
+	const cc_u8f literal = (packed >> PACKED_METADATA_LITERAL_SHIFT) & PACKED_METADATA_LITERAL_MASK;
+
+	instruction->handler = handler->handler;
+	instruction->metadata_buffer.opcode = handler->opcode;
+	instruction->metadata_buffer.operands[0] = (packed >> PACKED_METADATA_OPERAND_0_SHIFT) & PACKED_METADATA_OPERAND_MASK;
+	instruction->metadata_buffer.operands[1] = (packed >> PACKED_METADATA_OPERAND_1_SHIFT) & PACKED_METADATA_OPERAND_MASK;
+	/* Whichever of these the instruction does not use is left with junk in it. */
+	instruction->metadata_buffer.condition = literal & 7;
+	instruction->metadata_buffer.embedded_literal = literal;
+	instruction->metadata_buffer.has_displacement = (packed >> PACKED_METADATA_DISPLACEMENT_SHIFT) & 1;
+}
+#else
+/* Returns -1 if the operand has no specialised handlers. */
+static int GetSpecialisedOperandIndex(const ClownZ80_Operand operand)
+{
+	switch (operand)
+	{
+		case CLOWNZ80_OPERAND_A:
+			return SPECIALISED_OPERAND_A;
+
+		case CLOWNZ80_OPERAND_B:
+			return SPECIALISED_OPERAND_B;
+
+		case CLOWNZ80_OPERAND_C:
+			return SPECIALISED_OPERAND_C;
+
+		case CLOWNZ80_OPERAND_D:
+			return SPECIALISED_OPERAND_D;
+
+		case CLOWNZ80_OPERAND_E:
+			return SPECIALISED_OPERAND_E;
+
+		case CLOWNZ80_OPERAND_H:
+			return SPECIALISED_OPERAND_H;
+
+		case CLOWNZ80_OPERAND_L:
+			return SPECIALISED_OPERAND_L;
+
+		case CLOWNZ80_OPERAND_IXH:
+			return SPECIALISED_OPERAND_IXH;
+
+		case CLOWNZ80_OPERAND_IXL:
+			return SPECIALISED_OPERAND_IXL;
+
+		case CLOWNZ80_OPERAND_IYH:
+			return SPECIALISED_OPERAND_IYH;
+
+		case CLOWNZ80_OPERAND_IYL:
+			return SPECIALISED_OPERAND_IYL;
+
+		case CLOWNZ80_OPERAND_BC_INDIRECT:
+		case CLOWNZ80_OPERAND_DE_INDIRECT:
+		case CLOWNZ80_OPERAND_HL_INDIRECT:
+		case CLOWNZ80_OPERAND_IX_INDIRECT:
+		case CLOWNZ80_OPERAND_IY_INDIRECT:
+		case CLOWNZ80_OPERAND_ADDRESS:
+			return SPECIALISED_OPERAND_MEMORY;
+
+		case CLOWNZ80_OPERAND_LITERAL_8BIT:
+			return SPECIALISED_OPERAND_LITERAL;
+
+		default:
+			return -1;
+	}
+}
+
+/* Picks a specialised handler for the instruction if there is one, or the generic handler if not. Returns its index in 'instruction_handlers'. */
+static cc_u16f SelectHandlerIndex(const ClownZ80_InstructionMetadata* const metadata)
+{
+	const int source = GetSpecialisedOperandIndex((ClownZ80_Operand)metadata->operands[0]);
+	const int destination = GetSpecialisedOperandIndex((ClownZ80_Operand)metadata->operands[1]);
+
+	switch ((ClownZ80_Opcode)metadata->opcode)
+	{
+		default:
+			break;
+
+		case CLOWNZ80_OPCODE_LD_8BIT:
+			if (source != -1 && destination != -1 && destination < TOTAL_SPECIALISED_DESTINATIONS)
+				return HANDLER_INDEX_LD_8BIT + destination * TOTAL_SPECIALISED_OPERANDS + source;
+
+			break;
+
+		case CLOWNZ80_OPCODE_ADD_A:
+		case CLOWNZ80_OPCODE_ADC_A:
+		case CLOWNZ80_OPCODE_SUB:
+		case CLOWNZ80_OPCODE_SBC_A:
+		case CLOWNZ80_OPCODE_AND:
+		case CLOWNZ80_OPCODE_XOR:
+		case CLOWNZ80_OPCODE_OR:
+		case CLOWNZ80_OPCODE_CP:
+			if (source != -1)
+				return HANDLER_INDEX_ALU + (metadata->opcode - CLOWNZ80_OPCODE_ADD_A) * TOTAL_SPECIALISED_OPERANDS + source;
+
+			break;
+
+		case CLOWNZ80_OPCODE_INC_8BIT:
+			if (destination != -1 && destination < SPECIALISED_OPERAND_MEMORY)
+				return HANDLER_INDEX_INC_8BIT + destination;
+
+			break;
+
+		case CLOWNZ80_OPCODE_DEC_8BIT:
+			if (destination != -1 && destination < SPECIALISED_OPERAND_MEMORY)
+				return HANDLER_INDEX_DEC_8BIT + destination;
+
+			break;
+	}
+
+	return metadata->opcode;
+}
+#endif
+
+static InstructionHandler GetInstructionHandler(const Z80Instruction* const instruction)
+{
+#ifdef CLOWNZ80_PRECOMPUTE_INSTRUCTION_METADATA
+	return instruction->handler;
+#else
+	return instruction_handlers[SelectHandlerIndex(instruction->metadata)].handler;
+#endif
+}
+
+#ifdef CLOWNZ80_PROFILER
+static cc_u32f GetSampleInterval(ClownZ80_Profiler* const profiler)
+{
+	/* The interval is random, so that loops cannot line up with it and have the same instruction sampled every time. */
+	cc_u32f random = profiler->random;
+
+	random ^= (random << 13) & 0xFFFFFFFF;
+	random ^= random >> 17;
+	random ^= (random << 5) & 0xFFFFFFFF;
+	profiler->random = random;
+
+	return 1 + random % (CLOWNZ80_PROFILER_SAMPLE_INTERVAL * 2 - 1);
+}
+
+static void ProfileHandler(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction, const InstructionHandler handler, const cc_u16f address)
+{
+	ClownZ80_Profiler* const profiler = callbacks->profiler;
+	ClownZ80_ProfilerEntry* const entry = &profiler->entries[state->register_mode][instruction->metadata->opcode];
+
+	/* The program counter has already been moved past the instruction. */
+	profiler->address_lengths[address] = (state->program_counter - address) & 0xFF;
+
+	state->register_mode = CLOWNZ80_REGISTER_MODE_HL;
+
+	if (--profiler->sample_countdown != 0)
+	{
+		handler(state, callbacks, instruction);
+	}
+	else
+	{
+		const clock_t start_clock = clock();
+
+		handler(state, callbacks, instruction);
+
+		entry->sampled_clocks += (double)(clock() - start_clock) - profiler->clock_overhead;
+		entry->sampled_executions += 1;
+		profiler->sample_countdown = GetSampleInterval(profiler);
+	}
+
+	entry->executions += 1;
+	entry->cycles += state->cycles;
+	profiler->address_executions[address] += 1;
+	profiler->address_cycles[address] += state->cycles;
+}
+#endif
+
+#ifdef CLOWNZ80_TRACER
+/* The most that a record can take up: the flags, the address, five instruction bytes, seven writes, the cycles, and every register. */
+#define MAXIMUM_TRACE_RECORD_SIZE (1 + 2 + 5 + 7 * (3 + 1) + 1 + 4 + CLOWNZ80_TRACE_TOTAL_REGISTERS)
+
+static void TraceByte(ClownZ80_Tracer* const tracer, const cc_u8f value)
+{
+	tracer->buffer[tracer->buffer_used++] = value;
+}
+
+static void TraceVariableLengthValue(ClownZ80_Tracer* const tracer, cc_u32f value)
+{
+	while (value >= 0x80)
+	{
+		TraceByte(tracer, (value & 0x7F) | 0x80);
+		value >>= 7;
+	}
+
+	TraceByte(tracer, value);
+}
+
+static void BeginTraceRecord(ClownZ80_Tracer* const tracer, const ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const cc_u16f address)
+{
+	const ClownZ80_MemoryMap* const memory_map = callbacks->memory_map;
+	/* The program counter has already been moved past the instruction. */
+	const cc_u16f length = (state->program_counter - address) & 0xFFFF;
+	cc_u8f flags = length - 1;
+	cc_u16f i;
+
+	assert(length >= 1 && length <= 5);
+
+	if (tracer->buffer_used > CLOWNZ80_TRACER_BUFFER_SIZE - MAXIMUM_TRACE_RECORD_SIZE)
+		ClownZ80_Tracer_Flush(tracer);
+
+	/* The flags are filled in once they are known. */
+	tracer->record_start = tracer->buffer_used++;
+
+	if (address != tracer->next_address)
+	{
+		flags |= CLOWNZ80_TRACE_RECORD_ADDRESS;
+		TraceByte(tracer, address & 0xFF);
+		TraceByte(tracer, address >> 8);
+	}
+
+	tracer->next_address = state->program_counter;
+
+	for (i = 0; i < length; ++i)
+		if (memory_map == NULL || memory_map->read[((address + i) & 0xFFFF) >> CLOWNZ80_MEMORY_MAP_PAGE_SHIFT] == NULL)
+			break;
+
+	if (i != length)
+	{
+		flags |= CLOWNZ80_TRACE_RECORD_BYTES_OMITTED;
+	}
+	else
+	{
+		for (i = 0; i < length; ++i)
+		{
+			const cc_u16f byte_address = (address + i) & 0xFFFF;
+
+			TraceByte(tracer, memory_map->read[byte_address >> CLOWNZ80_MEMORY_MAP_PAGE_SHIFT][byte_address % CLOWNZ80_MEMORY_MAP_PAGE_SIZE]);
+		}
+	}
+
+	tracer->buffer[tracer->record_start] = flags;
+}
+
+static void TraceMemoryWrite(ClownZ80_Tracer* const tracer, const cc_u16f address, const cc_u16f data)
+{
+	const cc_u16f difference = (address - tracer->previous_write_address) & 0xFFFF;
+
+	assert((tracer->buffer[tracer->record_start] >> CLOWNZ80_TRACE_RECORD_WRITES_SHIFT & CLOWNZ80_TRACE_RECORD_WRITES_MASK) != CLOWNZ80_TRACE_RECORD_WRITES_MASK);
+
+	tracer->buffer[tracer->record_start] += 1 << CLOWNZ80_TRACE_RECORD_WRITES_SHIFT;
+
+	/* Zigzag-encoded, so that small backward steps, such as those of a push, are small too. */
+	TraceVariableLengthValue(tracer, (difference & 0x8000) != 0 ? ((0x10000 - difference) << 1) - 1 : difference << 1);
+	TraceByte(tracer, data);
+
+	tracer->previous_write_address = address;
+}
+
+static void EndTraceRecord(ClownZ80_Tracer* const tracer, ClownZ80_State* const state)
+{
+	cc_u8l registers[CLOWNZ80_TRACER_REGISTER_SLOTS];
+	cc_u32f changed, remaining;
+	cc_u8f group, i;
+
+	/* The flags have to be computed in order to tell whether they have changed. */
+	MaterialiseFlags(state);
+
+	registers[CLOWNZ80_TRACE_REGISTER_F] = state->f;
+	registers[CLOWNZ80_TRACE_REGISTER_A] = state->a;
+	registers[CLOWNZ80_TRACE_REGISTER_C] = state->c;
+	registers[CLOWNZ80_TRACE_REGISTER_B] = state->b;
+	registers[CLOWNZ80_TRACE_REGISTER_E] = state->e;
+	registers[CLOWNZ80_TRACE_REGISTER_D] = state->d;
+	registers[CLOWNZ80_TRACE_REGISTER_L] = state->l;
+	registers[CLOWNZ80_TRACE_REGISTER_H] = state->h;
+	registers[CLOWNZ80_TRACE_REGISTER_SP_LOW] = state->stack_pointer & 0xFF;
+	registers[CLOWNZ80_TRACE_REGISTER_SP_HIGH] = state->stack_pointer >> 8;
+	registers[CLOWNZ80_TRACE_REGISTER_IXL] = state->ixl;
+	registers[CLOWNZ80_TRACE_REGISTER_IXH] = state->ixh;
+	registers[CLOWNZ80_TRACE_REGISTER_IYL] = state->iyl;
+	registers[CLOWNZ80_TRACE_REGISTER_IYH] = state->iyh;
+	registers[CLOWNZ80_TRACE_REGISTER_F_] = state->f_;
+	registers[CLOWNZ80_TRACE_REGISTER_A_] = state->a_;
+	registers[CLOWNZ80_TRACE_REGISTER_C_] = state->c_;
+	registers[CLOWNZ80_TRACE_REGISTER_B_] = state->b_;
+	registers[CLOWNZ80_TRACE_REGISTER_E_] = state->e_;
+	registers[CLOWNZ80_TRACE_REGISTER_D_] = state->d_;
+	registers[CLOWNZ80_TRACE_REGISTER_L_] = state->l_;
+	registers[CLOWNZ80_TRACE_REGISTER_H_] = state->h_;
+	registers[CLOWNZ80_TRACE_REGISTER_I] = state->i;
+	registers[CLOWNZ80_TRACE_REGISTER_INTERRUPTS_ENABLED] = state->interrupts_enabled;
+	registers[CLOWNZ80_TRACE_REGISTER_INTERRUPT_PENDING] = state->interrupt_pending;
+	memset(&registers[CLOWNZ80_TRACE_TOTAL_REGISTERS], 0, sizeof(registers) - CLOWNZ80_TRACE_TOTAL_REGISTERS);
+
+	assert(state->cycles <= 0xFF);
+	TraceByte(tracer, state->cycles);
+
+	/* Few registers change at once, so they are compared eight at a time, and only looked at individually if some of them differ. */
+	changed = 0;
+
+	for (group = 0; group < CLOWNZ80_TRACE_TOTAL_REGISTERS; group += 8)
+		if (memcmp(&registers[group], &tracer->registers[group], 8) != 0)
+			for (i = group; i < group + 8; ++i)
+				changed |= (cc_u32f)(registers[i] != tracer->registers[i]) << i;
+
+	TraceVariableLengthValue(tracer, changed);
+
+	/* The registers which change the most are the first ones, so this usually stops early. */
+	for (i = 0, remaining = changed; remaining != 0; ++i, remaining >>= 1)
+	{
+		if ((remaining & 1) != 0)
+		{
+			TraceByte(tracer, registers[i]);
+			tracer->registers[i] = registers[i];
+		}
+	}
+}
+#endif
+
+/* 'address' is where the instruction began, which is only needed by the profiler and the tracer. */
+static void RunHandler(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction, const InstructionHandler handler, const cc_u16f address)
+{
+#ifdef CLOWNZ80_TRACER
+	if (callbacks->tracer != NULL)
+		BeginTraceRecord(callbacks->tracer, state, callbacks, address);
+#endif
+
+#ifdef CLOWNZ80_PROFILER
+	if (callbacks->profiler != NULL)
+	{
+		ProfileHandler(state, callbacks, instruction, handler, address);
+		return;
+	}
+#elif !defined(CLOWNZ80_TRACER)
+	(void)address;
+#endif
+
+	state->register_mode = CLOWNZ80_REGISTER_MODE_HL;
+
+	handler(state, callbacks, instruction);
+}
+
+static void ExecuteInstruction(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction, const cc_u16f address)
+{
+	RunHandler(state, callbacks, instruction, GetInstructionHandler(instruction), address);
+}
+
+void ClownZ80_Constant_Initialise(void)
+{
+	/* Nothing to do: the lookup tables are generated ahead of time by 'lookup-table-generator.c'. */
+}
+
+void ClownZ80_State_Initialise(ClownZ80_State* const state)
+{
+	ClownZ80_Reset(state);
+
+	/* Update on the next cycle. */
+	state->cycles = 1;
+
+	state->total_cycles = 0;
+	state->external_accesses = 0;
+}
+
+void ClownZ80_Reset(ClownZ80_State* const state)
+{
+	/* Revert back to a prefix-free mode. */
+	state->register_mode = CLOWNZ80_REGISTER_MODE_HL;
+
+	state->program_counter = 0;
+
+	/* The official Z80 manual claims that this happens ('z80cpu_um.pdf' page 18). */
+	state->interrupts_enabled = cc_false;
+
+	state->interrupt_pending = cc_false;
+
+	state->halted = cc_false;
+
+	state->flags_operation = FLAGS_OPERATION_NONE;
+}
+
+void ClownZ80_MemoryMap_Initialise(ClownZ80_MemoryMap* const memory_map)
+{
+	ClownZ80_MemoryMap_SetPages(memory_map, 0, 0x10000, NULL, NULL);
+}
+
+void ClownZ80_MemoryMap_SetPages(ClownZ80_MemoryMap* const memory_map, const cc_u16f address, const cc_u32f length, const cc_u8l* const read_buffer, cc_u8l* const write_buffer)
+{
+	cc_u32f i;
+
+	/* Only whole pages can be mapped. */
+	assert(address % CLOWNZ80_MEMORY_MAP_PAGE_SIZE == 0);
+	assert(length % CLOWNZ80_MEMORY_MAP_PAGE_SIZE == 0);
+	assert(address + length <= 0x10000);
+
+	for (i = 0; i < length / CLOWNZ80_MEMORY_MAP_PAGE_SIZE; ++i)
+	{
+		const cc_u16f page = (address / CLOWNZ80_MEMORY_MAP_PAGE_SIZE) + i;
+		const cc_u32f offset = i * CLOWNZ80_MEMORY_MAP_PAGE_SIZE;
+
+		memory_map->read[page] = read_buffer == NULL ? NULL : &read_buffer[offset];
+		memory_map->write[page] = write_buffer == NULL ? NULL : &write_buffer[offset];
+	}
+}
+
+void ClownZ80_PortMap_Initialise(ClownZ80_PortMap* const port_map, ClownZ80_PortHandler* const full_handlers)
+{
+	port_map->full_handlers = NULL;
+	ClownZ80_PortMap_SetPorts(port_map, 0, 0x100, NULL, NULL, NULL);
+
+	port_map->full_handlers = full_handlers;
+
+	if (full_handlers != NULL)
+		ClownZ80_PortMap_SetPorts(port_map, 0, 0x10000, NULL, NULL, NULL);
+}
+
+void ClownZ80_PortMap_SetPorts(ClownZ80_PortMap* const port_map, const cc_u16f port, const cc_u32f total_ports, const ClownZ80_PortReadCallback read, const ClownZ80_PortWriteCallback write, const void* const user_data)
+{
+	ClownZ80_PortHandler* const handlers = port_map->full_handlers != NULL ? port_map->full_handlers : port_map->handlers;
+	cc_u32f i;
+
+	assert(port + total_ports <= (port_map->full_handlers != NULL ? 0x10000 : 0x100));
+
+	for (i = 0; i < total_ports; ++i)
+	{
+		ClownZ80_PortHandler* const handler = &handlers[port + i];
+
+		handler->read = read;
+		handler->write = write;
+		handler->user_data = user_data;
+	}
+}
+
+void ClownZ80_InstructionCache_Initialise(ClownZ80_InstructionCache* const instruction_cache)
+{
+	cc_u16f i;
+
+	for (i = 0; i < CLOWNZ80_INSTRUCTION_CACHE_SIZE; ++i)
+		instruction_cache->entries[i].instruction.length = 0;
+}
+
+void ClownZ80_InstructionCache_Invalidate(ClownZ80_InstructionCache* const instruction_cache, const cc_u16f address, const cc_u32f length)
+{
+	cc_u32f i;
+
+	if (length + MAXIMUM_INSTRUCTION_LENGTH - 1 >= CLOWNZ80_INSTRUCTION_CACHE_SIZE)
+	{
+		/* Every slot would be visited anyway, so just clear the whole thing. */
+		for (i = 0; i < CLOWNZ80_INSTRUCTION_CACHE_SIZE; ++i)
+		{
+			ClownZ80_InstructionCacheEntry* const entry = &instruction_cache->entries[i];
+
+			/* The subtraction wraps, so that instructions which start before the region are caught as well. */
+			if (((entry->address - address) & 0xFFFF) < length || ((address - entry->address) & 0xFFFF) < entry->instruction.length)
+				entry->instruction.length = 0;
+		}
+	}
+	else
+	{
+		/* Instructions which begin shortly before the modified region may still overlap it. */
+		for (i = 0; i < length + MAXIMUM_INSTRUCTION_LENGTH - 1; ++i)
+		{
+			const cc_u16f entry_address = (address - (MAXIMUM_INSTRUCTION_LENGTH - 1) + i) & 0xFFFF;
+			ClownZ80_InstructionCacheEntry* const entry = &instruction_cache->entries[entry_address % CLOWNZ80_INSTRUCTION_CACHE_SIZE];
+
+			if (entry->address == entry_address && (((entry_address - address) & 0xFFFF) < length || ((address - entry_address) & 0xFFFF) < entry->instruction.length))
+				entry->instruction.length = 0;
+		}
+	}
+}
+
+void ClownZ80_BlockCache_Initialise(ClownZ80_BlockCache* const block_cache)
+{
+	cc_u16f i;
+
+	for (i = 0; i < CLOWNZ80_BLOCK_CACHE_SIZE; ++i)
+		block_cache->blocks[i].total_instructions = 0;
+
+	for (i = 0; i < CC_COUNT_OF(block_cache->code_bitmap); ++i)
+		block_cache->code_bitmap[i] = 0;
+}
+
+void ClownZ80_BlockCache_Invalidate(ClownZ80_BlockCache* const block_cache, const cc_u16f address, const cc_u32f length)
+{
+	cc_u32f i;
+
+	/* Blocks can be long, so, rather than look for every block that could overlap the region, just check them all. */
+	for (i = 0; i < CLOWNZ80_BLOCK_CACHE_SIZE; ++i)
+	{
+		ClownZ80_Block* const block = &block_cache->blocks[i];
+
+		/* The subtraction wraps, so that blocks which start before the region are caught as well. */
+		/* Note that a block being executed will stop early if it is invalidated, which is what allows it to modify itself. */
+		if (((block->address - address) & 0xFFFF) < length || ((address - block->address) & 0xFFFF) < block->length)
+			block->total_instructions = 0;
+	}
+
+	/* No block covers the region any more. */
+	for (i = 0; i < length && i < 0x10000; ++i)
+	{
+		const cc_u16f byte_address = (address + i) & 0xFFFF;
+
+		block_cache->code_bitmap[byte_address / 8] &= ~(1 << (byte_address % 8));
+	}
+}
+
+void ClownZ80_Interrupt(ClownZ80_State* const state, const cc_bool assert_interrupt)
+{
+	state->interrupt_pending = assert_interrupt;
+}
+
+static void TakeInterrupt(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks)
+{
+	state->interrupts_enabled = cc_false;
+	state->interrupt_pending = cc_false;
+	state->halted = cc_false;
+
+	/* TODO: Other interrupt durations. */
+	state->cycles += 13; /* Interrupt mode 1 duration. */
+
+	--state->stack_pointer;
+	state->stack_pointer &= 0xFFFF;
+	BusWrite(state, callbacks, state->stack_pointer, state->program_counter >> 8);
+
+	--state->stack_pointer;
+	state->stack_pointer &= 0xFFFF;
+	BusWrite(state, callbacks, state->stack_pointer, state->program_counter & 0xFF);
+
+	state->program_counter = 0x38;
+}
+
+static cc_bool DoInterrupt(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const Z80Instruction* const instruction)
+{
+	/* TODO: The other interrupt modes. */
+	if (!state->interrupt_pending
+		|| !state->interrupts_enabled
+		/* Interrupts should not be able to occur directly after a prefix instruction. */
+		|| instruction->metadata->opcode == CLOWNZ80_OPCODE_DD_PREFIX
+		|| instruction->metadata->opcode == CLOWNZ80_OPCODE_FD_PREFIX
+		/* Curiously, interrupts do not occur directly after 'EI' instructions either. */
+		|| instruction->metadata->opcode == CLOWNZ80_OPCODE_EI)
+		return cc_false;
+
+	TakeInterrupt(state, callbacks);
+
+	return cc_true;
+}
+
+/* A halted Z80 executes what amounts to a 'NOP' over and over, until an interrupt is taken.
+   Interrupts cannot be requested in the middle of 'ClownZ80_Run', so, if one is not waiting to be taken already,
+   then nothing can happen before the budget runs out, and all of those 'NOP's are done at once. */
+static cc_u32f DoHalted(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const cc_u32f cycle_budget)
+{
+	const cc_bool interrupted = state->interrupt_pending && state->interrupts_enabled;
+	cc_u32f iterations;
+
+	if (interrupted || cycle_budget <= 4)
+		iterations = 1;
+	else
+		iterations = (cycle_budget + 3) / 4;
+
+#ifdef CLOWNZ80_TRACER
+	/* Every iteration needs a record of its own, which makes it look like the 'HALT' is being executed again. */
+	if (callbacks->tracer != NULL)
+	{
+		iterations = 1;
+		BeginTraceRecord(callbacks->tracer, state, callbacks, (state->program_counter - 1) & 0xFFFF);
+	}
+#endif
+
+	/* Each 'NOP' is an opcode fetch, which takes 4 cycles and increments 'R'. */
+	state->cycles = 4;
+	state->r = (state->r & 0x80) | ((state->r + iterations) & 0x7F);
+
+	if (interrupted)
+		TakeInterrupt(state, callbacks);
+
+#ifdef CLOWNZ80_TRACER
+	if (callbacks->tracer != NULL)
+		EndTraceRecord(callbacks->tracer, state);
+#endif
+
+	return state->cycles + (iterations - 1) * 4;
+}
+
+static cc_bool IsRepeatingBlockTransferInstruction(const ClownZ80_Opcode opcode)
+{
+	switch (opcode)
+	{
+		case CLOWNZ80_OPCODE_LDIR:
+		case CLOWNZ80_OPCODE_LDDR:
+		case CLOWNZ80_OPCODE_CPIR:
+		case CLOWNZ80_OPCODE_CPDR:
+			return cc_true;
+
+		default:
+			return cc_false;
+	}
+}
+
+static void InvalidateCachedCode(const ClownZ80_ReadAndWriteCallbacks* const callbacks, const cc_u16f address, const cc_u16f length)
+{
+	cc_u16f i;
+
+	if (callbacks->instruction_cache != NULL)
+		ClownZ80_InstructionCache_Invalidate(callbacks->instruction_cache, address, length);
+
+	if (callbacks->block_cache != NULL)
+	{
+		const cc_u8l* const code_bitmap = callbacks->block_cache->code_bitmap;
+		cc_bool is_code = code_bitmap[((address + length - 1) & 0xFFFF) / 8] != 0;
+
+		/* Whole bytes of the bitmap are checked at once, so neighbouring code can cause an unnecessary invalidation, which is harmless. */
+		for (i = 0; i < length && !is_code; i += 8)
+			is_code = code_bitmap[((address + i) & 0xFFFF) / 8] != 0;
+
+		if (is_code)
+			ClownZ80_BlockCache_Invalidate(callbacks->block_cache, address, length);
+	}
+}
+
+/* If the instruction at the program counter is LDIR, LDDR, CPIR, or CPDR, then this performs as many of its iterations
+   as it can directly on host memory, instead of decoding and executing the instruction again for every byte.
+   The final iteration is always left to the interpreter, so 'BC' never reaches 0 here and the flags are simple to produce.
+   It stops early if the budget runs out, or if memory which is not mapped is reached.
+   Returns the number of cycles that were executed, which may be 0. */
+static cc_u32f DoBlockTransfer(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const cc_u32f cycle_budget)
+{
+	const ClownZ80_MemoryMap* const memory_map = callbacks->memory_map;
+	const cc_u16f program_counter = state->program_counter;
+	const cc_u8l *opcode_page, *operation_page;
+	cc_bool increment, compare;
+	cc_u32f iteration_cycles, cycles_done;
+#ifdef CLOWNZ80_PROFILER
+	clock_t start_clock = 0;
+#endif
+
+#ifdef CLOWNZ80_TRACER
+	/* Every iteration needs a record of its own, so they are left to the interpreter. */
+	if (callbacks->tracer != NULL)
+		return 0;
+#endif
+
+	/* If an interrupt is waiting, then it would be taken after the next iteration. */
+	if (memory_map == NULL || state->register_mode != CLOWNZ80_REGISTER_MODE_HL || (state->interrupt_pending && state->interrupts_enabled))
+		return 0;
+
+	opcode_page = memory_map->read[program_counter >> CLOWNZ80_MEMORY_MAP_PAGE_SHIFT];
+	operation_page = memory_map->read[((program_counter + 1) & 0xFFFF) >> CLOWNZ80_MEMORY_MAP_PAGE_SHIFT];
+
+	if (opcode_page == NULL || operation_page == NULL || opcode_page[program_counter % CLOWNZ80_MEMORY_MAP_PAGE_SIZE] != 0xED)
+		return 0;
+
+	switch (operation_page[(program_counter + 1) % CLOWNZ80_MEMORY_MAP_PAGE_SIZE])
+	{
+		case 0xB0: /* LDIR */
+			increment = cc_true;
+			compare = cc_false;
+			break;
+
+		case 0xB8: /* LDDR */
+			increment = cc_false;
+			compare = cc_false;
+			break;
+
+		case 0xB1: /* CPIR */
+			increment = cc_true;
+			compare = cc_true;
+			break;
+
+		case 0xB9: /* CPDR */
+			increment = cc_false;
+			compare = cc_true;
+			break;
+
+		default:
+			return 0;
+	}
+
+	/* Two opcode fetches, a read, possibly a write, and the extra cycles of the instruction and of repeating it,
+	   the same as the instructions' handlers. */
+	iteration_cycles = (4 + 4) + 3 + (compare ? 0 : 3) + 2 + 5;
+
+	MaterialiseFlags(state);
+
+#ifdef CLOWNZ80_PROFILER
+	if (callbacks->profiler != NULL)
+		start_clock = clock();
+#endif
+
+	cycles_done = 0;
+
+	while (cycles_done < cycle_budget)
+	{
+		const cc_u16f bc = ((cc_u16f)state->b << 8) | state->c;
+		const cc_u16f de = ((cc_u16f)state->d << 8) | state->e;
+		const cc_u16f hl = ((cc_u16f)state->h << 8) | state->l;
+		const cc_u8l* const source_page = memory_map->read[hl >> CLOWNZ80_MEMORY_MAP_PAGE_SHIFT];
+		const cc_u16f source_offset = hl % CLOWNZ80_MEMORY_MAP_PAGE_SIZE;
+		const cc_u32f iterations_affordable = (cycle_budget - cycles_done + iteration_cycles - 1) / iteration_cycles;
+		cc_bool found = cc_false;
+		cc_u16f iterations, i;
+
+		if (source_page == NULL)
+			break;
+
+		/* Every iteration but the one which brings 'BC' to 0. Note that a 'BC' of 0 means 0x10000 iterations. */
+		iterations = (bc - 1) & 0xFFFF;
+
+		/* Do not cross a page boundary, as the next page could be mapped somewhere else. */
+		iterations = CC_MIN(iterations, increment ? CLOWNZ80_MEMORY_MAP_PAGE_SIZE - source_offset : source_offset + 1);
+		iterations = CC_MIN(iterations, iterations_affordable);
+
+		if (compare)
+		{
+			/* Stop before the iteration which finds the byte, as it ends the instruction. */
+			if (increment)
+			{
+				const cc_u8l* const match = (const cc_u8l*)memchr(&source_page[source_offset], state->a, iterations);
+
+				if (match != NULL)
+				{
+					iterations = (cc_u16f)(match - &source_page[source_offset]);
+					found = cc_true;
+				}
+			}
+			else
+			{
+				for (i = 0; i < iterations; ++i)
+				{
+					if (source_page[source_offset - i] == state->a)
+					{
+						iterations = i;
+						found = cc_true;
+						break;
+					}
+				}
+			}
+
+			if (iterations != 0)
+			{
+				const cc_u16f source_value = source_page[increment ? source_offset + iterations - 1 : source_offset - (iterations - 1)];
+				const cc_u16f destination_value = state->a;
+				const cc_u16f result_value = destination_value - source_value;
+
+				/* 'BC' has not reached 0 and the byte has not been found, so the parity and zero flags are known. */
+				state->f &= FLAG_MASK_CARRY;
+				state->f |= FLAG_MASK_PARITY_OVERFLOW;
+				CONDITION_SIGN;
+				CONDITION_HALF_CARRY;
+
+				state->f |= FLAG_MASK_ADD_SUBTRACT;
+			}
+		}
+		else
+		{
+			cc_u8l* const destination_page = memory_map->write[de >> CLOWNZ80_MEMORY_MAP_PAGE_SHIFT];
+			const cc_u16f destination_offset = de % CLOWNZ80_MEMORY_MAP_PAGE_SIZE;
+			cc_u16f first_address;
+
+			if (destination_page == NULL)
+				break;
+
+			iterations = CC_MIN(iterations, increment ? CLOWNZ80_MEMORY_MAP_PAGE_SIZE - destination_offset : destination_offset + 1);
+
+			/* Do not overwrite the instruction itself, as the next iteration would then be something else. */
+			for (i = 0; i < 2; ++i)
+			{
+				const cc_u16f distance = (increment ? (program_counter + i) - de : de - (program_counter + i)) & 0xFFFF;
+
+				iterations = CC_MIN(iterations, distance);
+			}
+
+			if (iterations == 0)
+				break;
+
+			if (increment)
+			{
+				cc_u8l* const destination = &destination_page[destination_offset];
+				const cc_u8l* const source = &source_page[source_offset];
+
+				/* Overlapping copies repeat the pattern that is already there, which 'memmove' would not do. */
+				if (destination + iterations <= source || source + iterations <= destination)
+				{
+					memcpy(destination, source, iterations);
+				}
+				else
+				{
+					for (i = 0; i < iterations; ++i)
+						destination[i] = source[i];
+				}
+
+				first_address = de;
+			}
+			else
+			{
+				for (i = 0; i < iterations; ++i)
+					destination_page[destination_offset - i] = source_page[source_offset - i];
+
+				first_address = (de - (iterations - 1)) & 0xFFFF;
+			}
+
+			InvalidateCachedCode(callbacks, first_address, iterations);
+
+			/* 'BC' has not reached 0. This is not necessarily a repeat of an earlier iteration, so the flags must still be set. */
+			state->f &= FLAG_MASK_CARRY | FLAG_MASK_ZERO | FLAG_MASK_SIGN;
+			state->f |= FLAG_MASK_PARITY_OVERFLOW;
+
+			if (increment)
+			{
+				state->d = ((de + iterations) >> 8) & 0xFF;
+				state->e = (de + iterations) & 0xFF;
+			}
+			else
+			{
+				state->d = ((de - iterations) >> 8) & 0xFF;
+				state->e = (de - iterations) & 0xFF;
+			}
+		}
+
+		if (iterations == 0)
+			break;
+
+		if (increment)
+		{
+			state->h = ((hl + iterations) >> 8) & 0xFF;
+			state->l = (hl + iterations) & 0xFF;
+		}
+		else
+		{
+			state->h = ((hl - iterations) >> 8) & 0xFF;
+			state->l = (hl - iterations) & 0xFF;
+		}
+
+		state->b = ((bc - iterations) >> 8) & 0xFF;
+		state->c = (bc - iterations) & 0xFF;
+
+		/* Each iteration fetches both bytes of the instruction again. */
+		state->r = (state->r & 0x80) | ((state->r + iterations * 2) & 0x7F);
+
+		cycles_done += iterations * iteration_cycles;
+
+		if (found)
+			break;
+	}
+
+#ifdef CLOWNZ80_PROFILER
+	/* The iterations are all timed together, as there are usually a lot of them. */
+	if (callbacks->profiler != NULL && cycles_done != 0)
+	{
+		const ClownZ80_Opcode opcode = compare ? (increment ? CLOWNZ80_OPCODE_CPIR : CLOWNZ80_OPCODE_CPDR) : (increment ? CLOWNZ80_OPCODE_LDIR : CLOWNZ80_OPCODE_LDDR);
+		ClownZ80_ProfilerEntry* const entry = &callbacks->profiler->entries[CLOWNZ80_REGISTER_MODE_HL][opcode];
+		const double iterations = (double)(cycles_done / iteration_cycles);
+
+		entry->executions += iterations;
+		entry->cycles += cycles_done;
+		entry->sampled_executions += iterations;
+		entry->sampled_clocks += (double)(clock() - start_clock) - callbacks->profiler->clock_overhead;
+		callbacks->profiler->address_executions[program_counter] += iterations;
+		callbacks->profiler->address_cycles[program_counter] += cycles_done;
+	}
+#endif
+
+	return cycles_done;
+}
+
+static cc_u32f DoInstruction(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const cc_u32f cycle_budget)
+{
+	/* Process new instruction. */
+	const cc_u16f address = state->program_counter;
+	Z80Instruction instruction;
+	cc_u32f cycles;
+
+	if (state->halted)
+		return DoHalted(state, callbacks, cycle_budget);
+
+	state->cycles = 0;
+
+	DecodeInstruction(state, callbacks, &instruction);
+
+	ExecuteInstruction(state, callbacks, &instruction, address);
+
+	/* Perform interrupt after processing the instruction. */
+	DoInterrupt(state, callbacks, &instruction);
+
+#ifdef CLOWNZ80_TRACER
+	if (callbacks->tracer != NULL)
+		EndTraceRecord(callbacks->tracer, state);
+#endif
+
+	cycles = state->cycles;
+
+	/* Finish off block transfers in bulk, rather than one byte at a time. */
+	if (IsRepeatingBlockTransferInstruction((ClownZ80_Opcode)instruction.metadata->opcode) && cycles < cycle_budget)
+		cycles += DoBlockTransfer(state, callbacks, cycle_budget - cycles);
+
+	return cycles;
+}
+
+cc_u16f ClownZ80_DoInstruction(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks)
+{
+	/* Only one instruction is wanted, so block transfers cannot be done in bulk. */
+	const cc_u16f cycles = DoInstruction(state, callbacks, 0);
+
+	state->total_cycles += cycles;
+
+	/* The caller may want to read the flags. */
+	MaterialiseFlags(state);
+
+	return cycles;
+}
+
+static cc_bool IsBlockTerminatingInstruction(const ClownZ80_Opcode opcode)
+{
+	switch (opcode)
+	{
+		case CLOWNZ80_OPCODE_DJNZ:
+		case CLOWNZ80_OPCODE_JR_UNCONDITIONAL:
+		case CLOWNZ80_OPCODE_JR_CONDITIONAL:
+		case CLOWNZ80_OPCODE_HALT:
+		case CLOWNZ80_OPCODE_RET_CONDITIONAL:
+		case CLOWNZ80_OPCODE_RET_UNCONDITIONAL:
+		case CLOWNZ80_OPCODE_JP_HL:
+		case CLOWNZ80_OPCODE_JP_CONDITIONAL:
+		case CLOWNZ80_OPCODE_JP_UNCONDITIONAL:
+		case CLOWNZ80_OPCODE_CALL_CONDITIONAL:
+		case CLOWNZ80_OPCODE_CALL_UNCONDITIONAL:
+		case CLOWNZ80_OPCODE_RST:
+		case CLOWNZ80_OPCODE_RETN:
+		case CLOWNZ80_OPCODE_RETI:
+		case CLOWNZ80_OPCODE_LDIR:
+		case CLOWNZ80_OPCODE_LDDR:
+		case CLOWNZ80_OPCODE_CPIR:
+		case CLOWNZ80_OPCODE_CPDR:
+		case CLOWNZ80_OPCODE_INIR:
+		case CLOWNZ80_OPCODE_INDR:
+		case CLOWNZ80_OPCODE_OTIR:
+		case CLOWNZ80_OPCODE_OTDR:
+			/* These may change the program counter. */
+			return cc_true;
+
+		default:
+			return cc_false;
+	}
+}
+
+static void TranslateBlock(const ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, ClownZ80_Block* const block)
+{
+	ClownZ80_BlockCache* const block_cache = callbacks->block_cache;
+
+	/* Instructions are fetched using a copy of the state, so that the real one is left untouched. */
+	ClownZ80_State scratch_state = *state;
+	cc_u16f i;
+
+	block->address = state->program_counter;
+	block->register_mode = state->register_mode;
+	block->total_instructions = 0;
+	block->executions = 0;
+	block->native_code = NULL;
+	block->may_be_idle_loop = cc_false;
+
+	while (block->total_instructions < CLOWNZ80_BLOCK_MAXIMUM_INSTRUCTIONS)
+	{
+		ClownZ80_DecodedInstruction* const block_instruction = &block->instructions[block->total_instructions];
+		const cc_u16f address = scratch_state.program_counter;
+		const cc_u16f starting_r = scratch_state.r;
+		Z80Instruction instruction;
+
+		/* The instruction's length is not known until it has been fetched, so assume the worst. */
+		if (!IsInstructionCacheable(callbacks, address, MAXIMUM_INSTRUCTION_LENGTH))
+			break;
+
+		scratch_state.cycles = 0;
+		FetchInstruction(&scratch_state, callbacks, &instruction);
+
+		SaveDecodedInstruction(block_instruction, &instruction, (scratch_state.program_counter - address) & 0xFFFF, scratch_state.cycles, (scratch_state.r - starting_r) & 0x7F, scratch_state.register_mode);
+		block_instruction->handler = (void(*)(void))GetInstructionHandler(&instruction);
+		++block->total_instructions;
+
+		/* Prefixes change how the next instruction is decoded. */
+		if (instruction.metadata->opcode == CLOWNZ80_OPCODE_DD_PREFIX)
+			scratch_state.register_mode = CLOWNZ80_REGISTER_MODE_IX;
+		else if (instruction.metadata->opcode == CLOWNZ80_OPCODE_FD_PREFIX)
+			scratch_state.register_mode = CLOWNZ80_REGISTER_MODE_IY;
+		else
+			scratch_state.register_mode = CLOWNZ80_REGISTER_MODE_HL;
+
+		if (IsBlockTerminatingInstruction((ClownZ80_Opcode)instruction.metadata->opcode))
+			break;
+	}
+
+	block->length = (scratch_state.program_counter - block->address) & 0xFFFF;
+
+	if (block->total_instructions != 0)
+	{
+		switch (block->instructions[block->total_instructions - 1].metadata.opcode)
+		{
+			case CLOWNZ80_OPCODE_JR_UNCONDITIONAL:
+			case CLOWNZ80_OPCODE_JR_CONDITIONAL:
+			case CLOWNZ80_OPCODE_JP_UNCONDITIONAL:
+			case CLOWNZ80_OPCODE_JP_CONDITIONAL:
+				block->may_be_idle_loop = cc_true;
+				break;
+
+			default:
+				break;
+		}
+	}
+
+	/* Mark the block's bytes as code, so that writes to them will invalidate it. */
+	for (i = 0; i < block->length; ++i)
+	{
+		const cc_u16f byte_address = (block->address + i) & 0xFFFF;
+
+		block_cache->code_bitmap[byte_address / 8] |= 1 << (byte_address % 8);
+	}
+}
+
+/* Returns whether the rest of the block can be executed. */
+static cc_bool DoBlockInstruction(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const ClownZ80_Block* const block, const cc_u16f instruction_index)
+{
+	const ClownZ80_DecodedInstruction* const block_instruction = &block->instructions[instruction_index];
+	const cc_u16f address = state->program_counter;
+	Z80Instruction instruction;
+	cc_bool interrupted;
+
+	state->cycles = 0;
+
+	LoadDecodedInstruction(state, block_instruction, &instruction);
+	ResolveOperandAddresses(state, &instruction);
+
+	RunHandler(state, callbacks, &instruction, (InstructionHandler)block_instruction->handler, address);
+
+	interrupted = DoInterrupt(state, callbacks, &instruction);
+
+#ifdef CLOWNZ80_TRACER
+	if (callbacks->tracer != NULL)
+		EndTraceRecord(callbacks->tracer, state);
+#endif
+
+	return !interrupted;
+}
+
+static cc_bool JitFallback(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const ClownZ80_Block* const block, const cc_u16f instruction_index)
+{
+	const cc_bool carry_on = DoBlockInstruction(state, callbacks, block, instruction_index);
+
+	/* Native code accesses the flags directly. */
+	MaterialiseFlags(state);
 
+	/* Native code checks for neither invalidated blocks nor interrupts, so it must stop if either could happen. */
+	return carry_on
+		&& block->total_instructions != 0
+		&& !(state->interrupt_pending && state->interrupts_enabled);
+}
+
+static ClownZ80_JitFunction GetNativeCode(ClownZ80_Jit* const jit, ClownZ80_Block* const block)
+{
+	ClownZ80_JitFunction native_code;
+
+	if (block->native_code != NULL && block->jit_generation == jit->generation)
+		return (ClownZ80_JitFunction)block->native_code;
+
+	/* Compiling is slow, so only bother with blocks that are executed often. */
+	if (block->executions < JIT_COMPILE_THRESHOLD)
+	{
+		++block->executions;
+		return NULL;
+	}
+
+	native_code = ClownZ80_Jit_CompileBlock(jit, block, JitFallback);
+
+	/* If the buffer is full, then empty it and try again. */
+	if (native_code == NULL)
+	{
+		ClownZ80_Jit_Flush(jit);
+		native_code = ClownZ80_Jit_CompileBlock(jit, block, JitFallback);
+	}
+
+	/* If it still does not fit, then hold off on trying again. */
+	if (native_code == NULL)
+		block->executions = 0;
+
+	block->native_code = (void(*)(void))native_code;
+	block->jit_generation = jit->generation;
+
+	return native_code;
+}
+
+static cc_u32f DoBlockInstructions(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const ClownZ80_Block* const block, const cc_u32f cycle_budget)
+{
+	cc_u32f cycles_done = 0;
+	cc_u16f i;
+
+	/* The block is re-checked on every iteration, as an instruction could have invalidated it by overwriting a later instruction. */
+	for (i = 0; i < block->total_instructions && cycles_done < cycle_budget; ++i)
+	{
+		const cc_bool carry_on = DoBlockInstruction(state, callbacks, block, i);
+
+		cycles_done += state->cycles;
+
+		if (!carry_on)
 			break;
+	}
+
+	return cycles_done;
+}
+
+/* Whether running a loop once has left the state as it was, other than 'R', the cycles, and the lazy flags, which must be materialised. */
+static cc_bool IsStateUnchanged(const ClownZ80_State* const before, const ClownZ80_State* const after)
+{
+	return before->register_mode == after->register_mode
+		&& before->program_counter == after->program_counter
+		&& before->stack_pointer == after->stack_pointer
+		&& before->a == after->a && before->f == after->f
+		&& before->b == after->b && before->c == after->c
+		&& before->d == after->d && before->e == after->e
+		&& before->h == after->h && before->l == after->l
+		&& before->a_ == after->a_ && before->f_ == after->f_
+		&& before->b_ == after->b_ && before->c_ == after->c_
+		&& before->d_ == after->d_ && before->e_ == after->e_
+		&& before->h_ == after->h_ && before->l_ == after->l_
+		&& before->ixh == after->ixh && before->ixl == after->ixl
+		&& before->iyh == after->iyh && before->iyl == after->iyl
+		&& before->i == after->i
+		&& before->interrupts_enabled == after->interrupts_enabled
+		&& before->interrupt_pending == after->interrupt_pending
+		&& before->halted == after->halted
+		&& before->external_accesses == after->external_accesses;
+}
+
+/* Polling loops, such as 'loop: LD A,(flag); OR A; JR Z,loop', do nothing but wait for memory to change or for an interrupt.
+   Neither can happen in the middle of 'ClownZ80_Run', unless the loop itself writes to memory or reads through the callbacks.
+   So, if an iteration of the loop does neither, and leaves the state just as it found it, then so will every iteration until
+   the end of the budget, and they can all be skipped. The loop is then run again on the next call to 'ClownZ80_Run', in case
+   anything changed in between. */
+static cc_u32f DoIdleLoop(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, ClownZ80_Block* const block, const cc_u32f cycle_budget)
+{
+	ClownZ80_State before;
+	cc_u32f iteration_cycles, iterations;
+
+	MaterialiseFlags(state);
+	before = *state;
+
+	iteration_cycles = DoBlockInstructions(state, callbacks, block, cycle_budget);
+
+	/* The loop was left, such as to take an interrupt. */
+	if (state->program_counter != block->address || iteration_cycles == 0)
+		return iteration_cycles;
+
+	MaterialiseFlags(state);
+
+	if (!IsStateUnchanged(&before, state))
+	{
+		/* The loop is doing real work, so do not waste time checking it again. */
+		block->may_be_idle_loop = cc_false;
+		return iteration_cycles;
+	}
+
+	if (iteration_cycles >= cycle_budget)
+		return iteration_cycles;
+
+	/* As with the other instructions, the last iteration may overshoot the budget. */
+	iterations = (cycle_budget - iteration_cycles + iteration_cycles - 1) / iteration_cycles;
+
+	/* Only the lower 7 bits of 'R' increment, so overflowing the multiplication is harmless. */
+	state->r = (state->r & 0x80) | ((state->r + iterations * ((state->r - before.r) & 0x7F)) & 0x7F);
+
+	return iteration_cycles * (iterations + 1);
+}
+
+static cc_u32f DoBlock(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const cc_u32f cycle_budget)
+{
+	ClownZ80_Block* const block = &callbacks->block_cache->blocks[state->program_counter % CLOWNZ80_BLOCK_CACHE_SIZE];
+	ClownZ80_JitFunction native_code;
+	cc_bool ends_in_block_transfer, use_native_code, check_idle_loop;
+	cc_u32f cycles_done;
+
+	if (state->halted)
+		return DoHalted(state, callbacks, cycle_budget);
+
+	if (block->total_instructions == 0 || block->address != state->program_counter || block->register_mode != state->register_mode)
+	{
+		TranslateBlock(state, callbacks, block);
+
+		/* Instructions in memory-mapped I/O cannot be translated, so fall back on executing them normally. */
+		if (block->total_instructions == 0)
+			return DoInstruction(state, callbacks, cycle_budget);
+	}
+
+	/* Remembered now, as the block could be invalidated while it is executed. */
+	ends_in_block_transfer = IsRepeatingBlockTransferInstruction((ClownZ80_Opcode)block->instructions[block->total_instructions - 1].metadata.opcode);
+
+	/* Native code does not check for interrupts, so it cannot be used while one is waiting to be taken. */
+	use_native_code = callbacks->jit != NULL && !(state->interrupt_pending && state->interrupts_enabled);
+
+#ifdef CLOWNZ80_PROFILER
+	/* Native code does not go through the handlers, so it would not be profiled. */
+	use_native_code = use_native_code && callbacks->profiler == NULL;
+#endif
+
+#ifdef CLOWNZ80_TRACER
+	/* Likewise for the tracer. */
+	use_native_code = use_native_code && callbacks->tracer == NULL;
+#endif
+
+	if (use_native_code)
+		native_code = GetNativeCode(callbacks->jit, block);
+	else
+		native_code = NULL;
+
+	if (native_code != NULL)
+	{
+		/* Native code accesses the flags directly. */
+		MaterialiseFlags(state);
+
+		cycles_done = native_code(state, callbacks, cycle_budget);
+	}
+	else
+	{
+		cycles_done = DoBlockInstructions(state, callbacks, block, cycle_budget);
+	}
+
+	/* Finish off block transfers in bulk, rather than one byte at a time. */
+	if (ends_in_block_transfer && cycles_done < cycle_budget)
+		cycles_done += DoBlockTransfer(state, callbacks, cycle_budget - cycles_done);
+
+	/* The state on the way into a loop can differ from the state within it, so loops are only checked once they have gone around. */
+	check_idle_loop = block->may_be_idle_loop && block->total_instructions != 0 && state->program_counter == block->address;
+
+#ifdef CLOWNZ80_PROFILER
+	/* Skipping a loop's iterations would leave them out of the profile. */
+	check_idle_loop = check_idle_loop && callbacks->profiler == NULL;
+#endif
+
+#ifdef CLOWNZ80_TRACER
+	/* Likewise for the trace. */
+	check_idle_loop = check_idle_loop && callbacks->tracer == NULL;
+#endif
+
+	if (check_idle_loop && cycles_done < cycle_budget)
+		cycles_done += DoIdleLoop(state, callbacks, block, cycle_budget - cycles_done);
+
+	return cycles_done;
+}
+
+static cc_u32f DoCycles(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const cc_u32f cycle_budget)
+{
+	cc_u32f cycles_done = 0;
+
+	/* Keeping the loop inside the library allows the decoder and executor to be inlined into it,
+	   avoiding a function call and a round-trip through the caller for every instruction. */
+	/* The final instruction may overshoot the budget: the caller can deduct the excess from their next budget. */
+	if (callbacks->block_cache != NULL)
+	{
+		while (cycles_done < cycle_budget)
+		{
+			const cc_u32f cycles = DoBlock(state, callbacks, cycle_budget - cycles_done);
+
+			cycles_done += cycles;
+			state->total_cycles += cycles;
 		}
+	}
+	else
+	{
+		while (cycles_done < cycle_budget)
+		{
+			const cc_u32f cycles = DoInstruction(state, callbacks, cycle_budget - cycles_done);
 
-		case CLOWNZ80_OPCODE_INI:
-			UNIMPLEMENTED_Z80_INSTRUCTION("INI");
-			break;
+			cycles_done += cycles;
+			state->total_cycles += cycles;
+		}
+	}
 
-		case CLOWNZ80_OPCODE_IND:
-			UNIMPLEMENTED_Z80_INSTRUCTION("IND");
-			break;
+	return cycles_done;
+}
 
-		case CLOWNZ80_OPCODE_INIR:
-			UNIMPLEMENTED_Z80_INSTRUCTION("INIR");
-			break;
+static cc_bool IsEventSooner(const ClownZ80_Event* const event, const ClownZ80_Event* const other_event)
+{
+	return event->cycle < other_event->cycle;
+}
 
-		case CLOWNZ80_OPCODE_INDR:
-			UNIMPLEMENTED_Z80_INSTRUCTION("INDR");
-			break;
+static void PlaceEvent(ClownZ80_EventQueue* const event_queue, ClownZ80_Event* const event, const size_t index)
+{
+	event_queue->heap[index] = event;
+	event->queue_index = index;
+}
 
-		case CLOWNZ80_OPCODE_OUTI:
-			UNIMPLEMENTED_Z80_INSTRUCTION("OTDI");
-			break;
+/* Moves the event towards the front of the heap until its parent is no later than it, and then towards the back until its children
+   are no sooner than it, which puts it in the right place whichever way its cycle has changed. */
+static void SiftEvent(ClownZ80_EventQueue* const event_queue, ClownZ80_Event* const event)
+{
+	size_t index = event->queue_index;
 
-		case CLOWNZ80_OPCODE_OUTD:
-			UNIMPLEMENTED_Z80_INSTRUCTION("OUTD");
-			break;
+	while (index != 0 && IsEventSooner(event, event_queue->heap[(index - 1) / 2]))
+	{
+		PlaceEvent(event_queue, event_queue->heap[(index - 1) / 2], index);
+		index = (index - 1) / 2;
+	}
 
-		case CLOWNZ80_OPCODE_OTIR:
-			UNIMPLEMENTED_Z80_INSTRUCTION("OTIR");
-			break;
+	for (;;)
+	{
+		const size_t left = index * 2 + 1;
+		const size_t right = left + 1;
+		size_t soonest = index;
+		const ClownZ80_Event *soonest_event = event;
 
-		case CLOWNZ80_OPCODE_OTDR:
-			UNIMPLEMENTED_Z80_INSTRUCTION("OTDR");
+		if (left < event_queue->total_events && IsEventSooner(event_queue->heap[left], soonest_event))
+		{
+			soonest = left;
+			soonest_event = event_queue->heap[left];
+		}
+
+		if (right < event_queue->total_events && IsEventSooner(event_queue->heap[right], soonest_event))
+			soonest = right;
+
+		if (soonest == index)
 			break;
 
-		#undef UNIMPLEMENTED_Z80_INSTRUCTION
+		PlaceEvent(event_queue, event_queue->heap[soonest], index);
+		index = soonest;
 	}
+
+	PlaceEvent(event_queue, event, index);
 }
 
-void ClownZ80_Constant_Initialise(void)
+static void RunEvent(ClownZ80_EventQueue* const event_queue, ClownZ80_State* const state)
 {
-#ifdef CLOWNZ80_PRECOMPUTE_INSTRUCTION_METADATA
-	cc_u16f i;
+	ClownZ80_Event* const event = event_queue->heap[0];
+
+	/* This is done before the callback, so that it can cancel or reschedule the event. */
+	if (event->period != 0)
+	{
+		event->cycle += event->period;
+		SiftEvent(event_queue, event);
+	}
+	else
+	{
+		ClownZ80_EventQueue_Cancel(event_queue, event);
+	}
+
+	/* The callback may want to read the flags. */
+	MaterialiseFlags(state);
+
+	event->callback((void*)event->user_data, state, event);
+}
+
+/* Runs up to each event in turn, so that everything in between is run without having to check the time. */
+static cc_u32f DoCyclesWithEvents(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const cc_u32f cycle_budget)
+{
+	ClownZ80_EventQueue* const event_queue = callbacks->event_queue;
+	cc_u32f cycles_done = 0;
 
-	/* Pre-compute instruction metadata, to speed up opcode decoding. */
-	for (i = 0; i < 0x100; ++i)
+	for (;;)
 	{
-		ClownZ80_DecodeInstructionMetadata(&instruction_metadata_lookup_normal[CLOWNZ80_REGISTER_MODE_HL][i], CLOWNZ80_INSTRUCTION_MODE_NORMAL, CLOWNZ80_REGISTER_MODE_HL, i);
-		ClownZ80_DecodeInstructionMetadata(&instruction_metadata_lookup_normal[CLOWNZ80_REGISTER_MODE_IX][i], CLOWNZ80_INSTRUCTION_MODE_NORMAL, CLOWNZ80_REGISTER_MODE_IX, i);
-		ClownZ80_DecodeInstructionMetadata(&instruction_metadata_lookup_normal[CLOWNZ80_REGISTER_MODE_IY][i], CLOWNZ80_INSTRUCTION_MODE_NORMAL, CLOWNZ80_REGISTER_MODE_IY, i);
+		cc_u32f cycles_to_do;
 
-		ClownZ80_DecodeInstructionMetadata(&instruction_metadata_lookup_bits[CLOWNZ80_REGISTER_MODE_HL][i], CLOWNZ80_INSTRUCTION_MODE_BITS, CLOWNZ80_REGISTER_MODE_HL, i);
-		ClownZ80_DecodeInstructionMetadata(&instruction_metadata_lookup_bits[CLOWNZ80_REGISTER_MODE_IX][i], CLOWNZ80_INSTRUCTION_MODE_BITS, CLOWNZ80_REGISTER_MODE_IX, i);
-		ClownZ80_DecodeInstructionMetadata(&instruction_metadata_lookup_bits[CLOWNZ80_REGISTER_MODE_IY][i], CLOWNZ80_INSTRUCTION_MODE_BITS, CLOWNZ80_REGISTER_MODE_IY, i);
+		while (event_queue->total_events != 0 && event_queue->heap[0]->cycle <= state->total_cycles)
+			RunEvent(event_queue, state);
 
-		ClownZ80_DecodeInstructionMetadata(&instruction_metadata_lookup_misc[i], CLOWNZ80_INSTRUCTION_MODE_MISC, CLOWNZ80_REGISTER_MODE_HL, i);
+		if (cycles_done >= cycle_budget)
+			break;
+
+		cycles_to_do = cycle_budget - cycles_done;
+
+		if (event_queue->total_events != 0 && event_queue->heap[0]->cycle - state->total_cycles < cycles_to_do)
+			cycles_to_do = (cc_u32f)(event_queue->heap[0]->cycle - state->total_cycles);
+
+		/* Events are due on whole cycles, but the host could give one a fractional cycle, which would round down to 0 here. */
+		if (cycles_to_do == 0)
+			cycles_to_do = 1;
+
+		cycles_done += DoCycles(state, callbacks, cycles_to_do);
 	}
+
+	return cycles_done;
+}
+
+cc_u32f ClownZ80_Run(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks, const cc_u32f cycle_budget)
+{
+	cc_u32f cycles_done;
+
+	if (callbacks->event_queue == NULL)
+		cycles_done = DoCycles(state, callbacks, cycle_budget);
+	else
+		cycles_done = DoCyclesWithEvents(state, callbacks, cycle_budget);
+
+	/* The caller may want to read the flags. */
+	MaterialiseFlags(state);
+
+	return cycles_done;
+}
+
+void ClownZ80_ReadAndWriteCallbacks_Initialise(ClownZ80_ReadAndWriteCallbacks* const callbacks)
+{
+	callbacks->memory_map = NULL;
+	callbacks->port_map = NULL;
+	callbacks->port_read = NULL;
+	callbacks->port_write = NULL;
+	callbacks->instruction_cache = NULL;
+	callbacks->block_cache = NULL;
+	callbacks->jit = NULL;
+	callbacks->event_queue = NULL;
+#ifdef CLOWNZ80_PROFILER
+	callbacks->profiler = NULL;
+#endif
+#ifdef CLOWNZ80_TRACER
+	callbacks->tracer = NULL;
 #endif
 }
 
-void ClownZ80_State_Initialise(ClownZ80_State* const state)
+void ClownZ80_Instance_Initialise(ClownZ80_Instance* const instance, const ClownZ80_ReadAndWriteCallbacks* const callbacks)
 {
-	ClownZ80_Reset(state);
+	ClownZ80_State_Initialise(&instance->state);
+	instance->callbacks = *callbacks;
+	instance->cycles_overshot = 0;
+}
 
-	/* Update on the next cycle. */
-	state->cycles = 1;
+void ClownZ80_RunInstances(ClownZ80_Instance* const instances, const size_t total_instances, const cc_u32f cycle_budget)
+{
+	size_t i;
+
+	/* Each instance uses up the whole budget before moving on to the next, rather than them taking turns
+	   one instruction at a time, so that only one instance's state, memory, and caches are needed at once. */
+	for (i = 0; i < total_instances; ++i)
+	{
+		ClownZ80_Instance* const instance = &instances[i];
+
+		/* Instances which overshot their last budget by enough have nothing to do this time. */
+		if (instance->cycles_overshot >= cycle_budget)
+		{
+			instance->cycles_overshot -= cycle_budget;
+		}
+		else
+		{
+			const cc_u32f instance_budget = cycle_budget - instance->cycles_overshot;
+
+			instance->cycles_overshot = ClownZ80_Run(&instance->state, &instance->callbacks, instance_budget) - instance_budget;
+		}
+	}
 }
 
-void ClownZ80_Reset(ClownZ80_State* const state)
+void ClownZ80_Event_Initialise(ClownZ80_Event* const event, const ClownZ80_EventCallback callback, const void* const user_data)
 {
-	/* Revert back to a prefix-free mode. */
-	state->register_mode = CLOWNZ80_REGISTER_MODE_HL;
+	event->callback = callback;
+	event->user_data = user_data;
+	event->scheduled = cc_false;
+}
 
-	state->program_counter = 0;
+void ClownZ80_EventQueue_Initialise(ClownZ80_EventQueue* const event_queue)
+{
+	event_queue->total_events = 0;
+}
 
-	/* The official Z80 manual claims that this happens ('z80cpu_um.pdf' page 18). */
-	state->interrupts_enabled = cc_false;
+cc_bool ClownZ80_EventQueue_Schedule(ClownZ80_EventQueue* const event_queue, ClownZ80_Event* const event, const double cycle, const cc_u32f period)
+{
+	if (!event->scheduled)
+	{
+		if (event_queue->total_events == CC_COUNT_OF(event_queue->heap))
+			return cc_false;
 
-	state->interrupt_pending = cc_false;
+		event->scheduled = cc_true;
+		PlaceEvent(event_queue, event, event_queue->total_events++);
+	}
+
+	event->cycle = cycle;
+	event->period = period;
+	SiftEvent(event_queue, event);
+
+	return cc_true;
 }
 
-void ClownZ80_Interrupt(ClownZ80_State* const state, const cc_bool assert_interrupt)
+void ClownZ80_EventQueue_Cancel(ClownZ80_EventQueue* const event_queue, ClownZ80_Event* const event)
 {
-	state->interrupt_pending = assert_interrupt;
+	ClownZ80_Event *last_event;
+
+	if (!event->scheduled)
+		return;
+
+	event->scheduled = cc_false;
+
+	/* Fill the gap with the last event. */
+	last_event = event_queue->heap[--event_queue->total_events];
+
+	if (last_event != event)
+	{
+		PlaceEvent(event_queue, last_event, event->queue_index);
+		SiftEvent(event_queue, last_event);
+	}
 }
 
-cc_u16f ClownZ80_DoInstruction(ClownZ80_State* const state, const ClownZ80_ReadAndWriteCallbacks* const callbacks)
+#ifdef CLOWNZ80_PROFILER
+/* Indexed by 'ClownZ80_Opcode', so this must be kept in the same order. */
+static const char* const opcode_names[] = {
+	"NOP",
+	"EX_AF_AF",
+	"DJNZ",
+	"JR_UNCONDITIONAL",
+	"JR_CONDITIONAL",
+	"LD_16BIT",
+	"ADD_HL",
+	"LD_8BIT",
+	"INC_16BIT",
+	"DEC_16BIT",
+	"INC_8BIT",
+	"DEC_8BIT",
+	"RLCA",
+	"RRCA",
+	"RLA",
+	"RRA",
+	"DAA",
+	"CPL",
+	"SCF",
+	"CCF",
+	"HALT",
+	"ADD_A",
+	"ADC_A",
+	"SUB",
+	"SBC_A",
+	"AND",
+	"XOR",
+	"OR",
+	"CP",
+	"RET_CONDITIONAL",
+	"POP",
+	"RET_UNCONDITIONAL",
+	"EXX",
+	"JP_HL",
+	"LD_SP_HL",
+	"JP_CONDITIONAL",
+	"JP_UNCONDITIONAL",
+	"CB_PREFIX",
+	"OUT",
+	"IN",
+	"EX_SP_HL",
+	"EX_DE_HL",
+	"DI",
+	"EI",
+	"CALL_CONDITIONAL",
+	"PUSH",
+	"CALL_UNCONDITIONAL",
+	"DD_PREFIX",
+	"ED_PREFIX",
+	"FD_PREFIX",
+	"RST",
+	"RLC",
+	"RRC",
+	"RL",
+	"RR",
+	"SLA",
+	"SRA",
+	"SLL",
+	"SRL",
+	"BIT",
+	"RES",
+	"SET",
+	"IN_REGISTER",
+	"IN_NO_REGISTER",
+	"OUT_REGISTER",
+	"OUT_NO_REGISTER",
+	"SBC_HL",
+	"ADC_HL",
+	"NEG",
+	"RETN",
+	"RETI",
+	"IM",
+	"LD_I_A",
+	"LD_R_A",
+	"LD_A_I",
+	"LD_A_R",
+	"RRD",
+	"RLD",
+	"LDI",
+	"LDD",
+	"LDIR",
+	"LDDR",
+	"CPI",
+	"CPD",
+	"CPIR",
+	"CPDR",
+	"INI",
+	"IND",
+	"INIR",
+	"INDR",
+	"OUTI",
+	"OUTD",
+	"OTIR",
+	"OTDR"
+};
+
+/* Indexed by 'ClownZ80_RegisterMode'. */
+static const char* const prefix_names[] = {"", "DD", "FD"};
+
+#define TOTAL_PROFILER_ENTRIES (3 * (CLOWNZ80_OPCODE_OTDR + 1))
+
+static int CompareProfilerEntries(const void* const a, const void* const b)
 {
-	/* Process new instruction. */
-	Z80Instruction instruction;
+	const double cycles_a = (*(const ClownZ80_ProfilerEntry* const*)a)->cycles;
+	const double cycles_b = (*(const ClownZ80_ProfilerEntry* const*)b)->cycles;
 
-#ifndef CLOWNZ80_PRECOMPUTE_INSTRUCTION_METADATA
-	ClownZ80_InstructionMetadata metadata;
-	instruction.metadata = &metadata;
-#endif
+	/* Most cycles first. */
+	return cycles_a < cycles_b ? 1 : cycles_a > cycles_b ? -1 : 0;
+}
 
-	state->cycles = 0;
+/* Fills 'sorted' with the entries which have been executed, most cycles first, and returns how many there are. */
+static size_t SortProfilerEntries(const ClownZ80_Profiler* const profiler, const ClownZ80_ProfilerEntry** const sorted)
+{
+	const ClownZ80_ProfilerEntry* const entries = &profiler->entries[0][0];
+	size_t i, total = 0;
 
-	DecodeInstruction(state, callbacks, &instruction);
+	for (i = 0; i < TOTAL_PROFILER_ENTRIES; ++i)
+		if (entries[i].executions != 0)
+			sorted[total++] = &entries[i];
 
-	ExecuteInstruction(state, callbacks, &instruction);
+	qsort(sorted, total, sizeof(*sorted), CompareProfilerEntries);
 
-	/* Perform interrupt after processing the instruction. */
-	/* TODO: The other interrupt modes. */
-	if (state->interrupt_pending
-		&& state->interrupts_enabled
-		/* Interrupts should not be able to occur directly after a prefix instruction. */
-		&& instruction.metadata->opcode != CLOWNZ80_OPCODE_DD_PREFIX
-		&& instruction.metadata->opcode != CLOWNZ80_OPCODE_FD_PREFIX
-		/* Curiously, interrupts do not occur directly after 'EI' instructions either. */
-		&& instruction.metadata->opcode != CLOWNZ80_OPCODE_EI)
+	return total;
+}
+
+static double EstimateHostSeconds(const ClownZ80_ProfilerEntry* const entry)
+{
+	/* Scale the sampled time up to cover every execution. */
+	/* Taking out the clock's overhead can leave a little less than nothing. */
+	if (entry->sampled_executions == 0 || entry->sampled_clocks <= 0.0)
+		return 0.0;
+
+	return entry->sampled_clocks / entry->sampled_executions * entry->executions / CLOCKS_PER_SEC;
+}
+
+static const char* GetProfilerEntryPrefix(const ClownZ80_Profiler* const profiler, const ClownZ80_ProfilerEntry* const entry)
+{
+	return prefix_names[(size_t)(entry - &profiler->entries[0][0]) / CC_COUNT_OF(profiler->entries[0])];
+}
+
+static const char* GetProfilerEntryOpcode(const ClownZ80_Profiler* const profiler, const ClownZ80_ProfilerEntry* const entry)
+{
+	return opcode_names[(size_t)(entry - &profiler->entries[0][0]) % CC_COUNT_OF(profiler->entries[0])];
+}
+
+void ClownZ80_Profiler_Initialise(ClownZ80_Profiler* const profiler)
+{
+	clock_t total_overhead = 0;
+	cc_u16f i;
+
+	memset(profiler->entries, 0, sizeof(profiler->entries));
+	memset(profiler->address_executions, 0, sizeof(profiler->address_executions));
+	memset(profiler->address_cycles, 0, sizeof(profiler->address_cycles));
+	memset(profiler->address_lengths, 0, sizeof(profiler->address_lengths));
+	profiler->random = 0x12345678;
+	profiler->sample_countdown = GetSampleInterval(profiler);
+
+	/* Reading the clock takes about as long as a whole instruction, so measure how much it adds to a sample, so that it can be taken back out. */
+	for (i = 0; i < 0x400; ++i)
+	{
+		const clock_t start_clock = clock();
+
+		total_overhead += clock() - start_clock;
+	}
+
+	profiler->clock_overhead = (double)total_overhead / 0x400;
+}
+
+void ClownZ80_Profiler_PrintTable(const ClownZ80_Profiler* const profiler, const ClownZ80_Profiler_PrintCallback print_callback, const void* const user_data)
+{
+	const ClownZ80_ProfilerEntry *sorted[TOTAL_PROFILER_ENTRIES];
+	const size_t total_sorted = SortProfilerEntries(profiler, sorted);
+	double total_cycles = 0.0, total_host_seconds = 0.0;
+	size_t i;
+
+	for (i = 0; i < total_sorted; ++i)
+	{
+		total_cycles += sorted[i]->cycles;
+		total_host_seconds += EstimateHostSeconds(sorted[i]);
+	}
+
+	print_callback((void*)user_data, "Prefix  Opcode                  Executions          Cycles  Cycles%%    Host ms   Host%%\n");
+
+	for (i = 0; i < total_sorted; ++i)
+	{
+		const ClownZ80_ProfilerEntry* const entry = sorted[i];
+		const double host_seconds = EstimateHostSeconds(entry);
+
+		print_callback((void*)user_data, "%-6s  %-18s  %14.0f  %14.0f  %6.2f%%  %9.3f  %6.2f%%\n",
+			GetProfilerEntryPrefix(profiler, entry), GetProfilerEntryOpcode(profiler, entry), entry->executions, entry->cycles,
+			total_cycles == 0.0 ? 0.0 : entry->cycles / total_cycles * 100.0, host_seconds * 1000.0,
+			total_host_seconds == 0.0 ? 0.0 : host_seconds / total_host_seconds * 100.0);
+	}
+}
+
+void ClownZ80_Profiler_PrintJSON(const ClownZ80_Profiler* const profiler, const ClownZ80_Profiler_PrintCallback print_callback, const void* const user_data)
+{
+	const ClownZ80_ProfilerEntry *sorted[TOTAL_PROFILER_ENTRIES];
+	const size_t total_sorted = SortProfilerEntries(profiler, sorted);
+	size_t i;
+
+	print_callback((void*)user_data, "[\n");
+
+	for (i = 0; i < total_sorted; ++i)
+	{
+		const ClownZ80_ProfilerEntry* const entry = sorted[i];
+
+		print_callback((void*)user_data, "\t{\"prefix\": \"%s\", \"opcode\": \"%s\", \"executions\": %.0f, \"cycles\": %.0f, \"host_seconds\": %g}%s\n",
+			GetProfilerEntryPrefix(profiler, entry), GetProfilerEntryOpcode(profiler, entry), entry->executions, entry->cycles,
+			EstimateHostSeconds(entry), i == total_sorted - 1 ? "" : ",");
+	}
+
+	print_callback((void*)user_data, "]\n");
+}
+
+size_t ClownZ80_Profiler_GetHotBlocks(const ClownZ80_Profiler* const profiler, ClownZ80_ProfilerBlock* const blocks, const size_t maximum_blocks, double* const total_cycles)
+{
+	ClownZ80_ProfilerBlock block;
+	size_t total_blocks = 0;
+	cc_u32f address;
+
+	if (total_cycles != NULL)
+		*total_cycles = 0.0;
+
+	block.length = 0;
+
+	/* One past the end, so that the last block is finished off. */
+	for (address = 0; address <= 0x10000; ++address)
 	{
-		state->interrupts_enabled = cc_false;
-		state->interrupt_pending = cc_false;
+		const cc_bool executed = address != 0x10000 && profiler->address_executions[address] != 0;
+
+		/* Extend the current block if this instruction follows on from it. */
+		if (executed && block.length != 0 && address == block.address + block.length && profiler->address_executions[address] == block.executions)
+		{
+			block.length += profiler->address_lengths[address];
+			block.cycles += profiler->address_cycles[address];
+		}
+		else if (executed || address == 0x10000)
+		{
+			/* Finish the current block by inserting it among the hottest so far, if it is hot enough. */
+			if (block.length != 0)
+			{
+				size_t i = total_blocks;
 
-		/* TODO: Other interrupt durations. */
-		state->cycles += 13; /* Interrupt mode 1 duration. */
+				if (total_cycles != NULL)
+					*total_cycles += block.cycles;
 
-		--state->stack_pointer;
-		state->stack_pointer &= 0xFFFF;
-		callbacks->write((void*)callbacks->user_data, state->stack_pointer, state->program_counter >> 8);
+				for (; i != 0 && blocks[i - 1].cycles < block.cycles; --i)
+					if (i < maximum_blocks)
+						blocks[i] = blocks[i - 1];
 
-		--state->stack_pointer;
-		state->stack_pointer &= 0xFFFF;
-		callbacks->write((void*)callbacks->user_data, state->stack_pointer, state->program_counter & 0xFF);
+				if (i < maximum_blocks)
+				{
+					blocks[i] = block;
+					total_blocks = CC_MIN(total_blocks + 1, maximum_blocks);
+				}
+			}
 
-		state->program_counter = 0x38;
+			if (executed)
+			{
+				block.address = address;
+				block.length = profiler->address_lengths[address];
+				block.executions = profiler->address_executions[address];
+				block.cycles = profiler->address_cycles[address];
+			}
+		}
 	}
 
-	return state->cycles;
+	return total_blocks;
+}
+
+#undef TOTAL_PROFILER_ENTRIES
+#endif
+
+#ifdef CLOWNZ80_TRACER
+void ClownZ80_Tracer_Initialise(ClownZ80_Tracer* const tracer, const ClownZ80_Tracer_FlushCallback flush_callback, const void* const user_data)
+{
+	tracer->flush_callback = flush_callback;
+	tracer->user_data = user_data;
+	tracer->buffer_used = 0;
+	tracer->record_start = 0;
+	memset(tracer->registers, 0, sizeof(tracer->registers));
+	tracer->next_address = 0;
+	tracer->previous_write_address = 0;
+}
+
+void ClownZ80_Tracer_Flush(ClownZ80_Tracer* const tracer)
+{
+	if (tracer->buffer_used != 0)
+		tracer->flush_callback((void*)tracer->user_data, tracer->buffer, tracer->buffer_used);
+
+	tracer->buffer_used = 0;
 }
+#endif
@@ -1,15 +1,31 @@
 #ifndef CLOWNZ80_INTERPRETER_H
 #define CLOWNZ80_INTERPRETER_H
 
-/* If enabled, a lookup table is used to optimise opcode decoding. Disable this to save RAM. */
+/* If enabled, lookup tables are used to optimise opcode decoding. Disable this to make the library smaller. */
 #define CLOWNZ80_PRECOMPUTE_INSTRUCTION_METADATA
 
+/* If enabled, the flags are only computed when something needs them, instead of after every instruction. */
+#define CLOWNZ80_LAZY_FLAGS
+
+/* Define 'CLOWNZ80_PROFILER' (such as with the CMake option of the same name) to build in the profiler.
+   It is left out by default, as it slows every instruction down, even when it is not in use. */
+
+/* Likewise, define 'CLOWNZ80_TRACER' to build in the tracer. */
+
+#include <stddef.h>
+
 #include "clowncommon/clowncommon.h"
 
+#include "common.h"
+
 typedef struct ClownZ80_State
 {
 	cc_u8l register_mode; /* ClownZ80_RegisterMode */
-	cc_u16l cycles;
+	cc_u16l cycles; /* Of the current instruction. */
+	/* How many cycles have been run since the state was initialised. It is brought up to date after every instruction, or, when the block
+	   cache is used, every block, so, during a memory access, it is the cycle that the instruction or block began on. A double, as C89
+	   has no 64-bit integer type: it is exact for up to 2^53 cycles, which is decades of emulated time. */
+	double total_cycles;
 	cc_u16l program_counter;
 	cc_u16l stack_pointer;
 	cc_u8l a, f, b, c, d, e, h, l;
@@ -18,20 +34,367 @@ typedef struct ClownZ80_State
 	cc_u8l r, i;
 	cc_bool interrupts_enabled;
 	cc_bool interrupt_pending;
+	cc_bool halted; /* By a 'HALT' instruction, until an interrupt is taken. */
+	/* Private: counts memory writes, and reads that went through the callbacks, for telling whether a loop has any effect. */
+	cc_u16l external_accesses;
+	/* Private: the last operation whose flags have not been computed yet. 'f' is always up to date
+	   once 'ClownZ80_DoInstruction' or 'ClownZ80_Run' has returned. */
+	cc_u8l flags_operation;
+	cc_u16l flags_source, flags_destination, flags_result;
 } ClownZ80_State;
 
+/* The address space is split into pages of this size, as a power of two. */
+#define CLOWNZ80_MEMORY_MAP_PAGE_SHIFT 8
+#define CLOWNZ80_MEMORY_MAP_PAGE_SIZE (1 << CLOWNZ80_MEMORY_MAP_PAGE_SHIFT)
+#define CLOWNZ80_MEMORY_MAP_TOTAL_PAGES (0x10000 >> CLOWNZ80_MEMORY_MAP_PAGE_SHIFT)
+
+typedef struct ClownZ80_MemoryMap
+{
+	/* Each entry points to the host memory that backs the start of a page.
+	   Pages with a NULL entry are accessed through the read and write callbacks instead,
+	   so ROM can be mapped for reading only, and memory-mapped I/O left unmapped entirely. */
+	const cc_u8l *read[CLOWNZ80_MEMORY_MAP_TOTAL_PAGES];
+	cc_u8l *write[CLOWNZ80_MEMORY_MAP_TOTAL_PAGES];
+} ClownZ80_MemoryMap;
+
+/* Used by the 'IN' and 'OUT' instructions, and the like. */
+typedef cc_u16f (*ClownZ80_PortReadCallback)(void *user_data, cc_u16f port);
+typedef void (*ClownZ80_PortWriteCallback)(void *user_data, cc_u16f port, cc_u16f value);
+
+typedef struct ClownZ80_PortHandler
+{
+	/* Either may be NULL, in which case the access goes to the catch-all callbacks instead. */
+	ClownZ80_PortReadCallback read;
+	ClownZ80_PortWriteCallback write;
+	const void *user_data;
+} ClownZ80_PortHandler;
+
+/* Sends each I/O port's accesses straight to a handler of its own, sparing the host from having to look the port up itself. */
+typedef struct ClownZ80_PortMap
+{
+	/* Indexed by the lower 8 bits of the port, as that is all that most machines decode: the upper 8 bits are just whatever
+	   is in 'A' or 'B' at the time. Handlers are still given the whole port. */
+	ClownZ80_PortHandler handlers[0x100];
+	/* Optional: indexed by the whole port, for machines which decode all 16 bits of it. If this is set, then 'handlers' is not used.
+	   Must have 0x10000 entries. May be NULL. */
+	ClownZ80_PortHandler *full_handlers;
+} ClownZ80_PortMap;
+
+/* An instruction that has already been fetched and decoded, along with the side-effects of fetching it. */
+typedef struct ClownZ80_DecodedInstruction
+{
+	ClownZ80_InstructionMetadata metadata;
+	cc_u16l literal;
+	cc_u16l displacement;
+	cc_u8l length;
+	cc_u8l cycles;
+	cc_u8l opcode_fetches;
+	cc_bool double_prefix_mode;
+	cc_u8l register_mode; /* ClownZ80_RegisterMode, after any prefix that was fetched along with the instruction. */
+	/* Executes the instruction. Its real type is private to the interpreter. */
+	void (*handler)(void);
+} ClownZ80_DecodedInstruction;
+
+/* The number of instructions that the instruction cache can hold. Must be a power of two. */
+#define CLOWNZ80_INSTRUCTION_CACHE_SIZE 0x400
+
+typedef struct ClownZ80_InstructionCacheEntry
+{
+	ClownZ80_DecodedInstruction instruction; /* A length of 0 means that the entry is unused. */
+	cc_u16l address;
+	cc_u8l register_mode; /* ClownZ80_RegisterMode */
+} ClownZ80_InstructionCacheEntry;
+
+typedef struct ClownZ80_InstructionCache
+{
+	/* Indexed by the address of the instruction, modulo the size of the cache. */
+	ClownZ80_InstructionCacheEntry entries[CLOWNZ80_INSTRUCTION_CACHE_SIZE];
+} ClownZ80_InstructionCache;
+
+/* The maximum number of instructions in a block. */
+#define CLOWNZ80_BLOCK_MAXIMUM_INSTRUCTIONS 16
+/* The number of blocks that the block cache can hold. Must be a power of two. */
+#define CLOWNZ80_BLOCK_CACHE_SIZE 0x100
+
+/* A run of instructions which always execute one after the other, ending at the first one which may branch. */
+typedef struct ClownZ80_Block
+{
+	cc_u16l address;
+	cc_u16l length; /* In bytes. */
+	cc_u8l register_mode; /* ClownZ80_RegisterMode */
+	cc_u8l total_instructions; /* 0 if the block is unused. */
+	cc_u16l executions; /* Used to find blocks which are worth compiling to native code. */
+	cc_u32l jit_generation; /* The native code is only valid if this matches the JIT's. */
+	/* The block compiled to native code, or NULL. Its real type is private to the JIT. */
+	void (*native_code)(void);
+	/* The block ends in a jump, which could lead back to its start, making it a polling loop. Cleared once it is seen to do real work. */
+	cc_bool may_be_idle_loop;
+	ClownZ80_DecodedInstruction instructions[CLOWNZ80_BLOCK_MAXIMUM_INSTRUCTIONS];
+} ClownZ80_Block;
+
+typedef struct ClownZ80_BlockCache
+{
+	/* Indexed by the address of the block, modulo the size of the cache. */
+	ClownZ80_Block blocks[CLOWNZ80_BLOCK_CACHE_SIZE];
+	/* One bit for each byte of the address space, which is set if the byte may belong to a block.
+	   This spares writes to data from having to search for blocks to invalidate. */
+	cc_u8l code_bitmap[0x10000 / 8];
+} ClownZ80_BlockCache;
+
+typedef struct ClownZ80_Jit
+{
+	/* Executable memory that native code is written to. When it runs out, it is emptied and started anew. */
+	unsigned char *buffer;
+	size_t buffer_size;
+	size_t buffer_used;
+	/* Incremented whenever the buffer is emptied, so that blocks can tell when their native code is gone. */
+	cc_u32l generation;
+} ClownZ80_Jit;
+
+/* The most events that can be scheduled at once. */
+#define CLOWNZ80_EVENT_QUEUE_SIZE 32
+
+struct ClownZ80_Event;
+
+/* Called once the Z80 reaches the event's cycle, in between instructions. It may schedule and cancel events, including this one. */
+typedef void (*ClownZ80_EventCallback)(void *user_data, ClownZ80_State *state, struct ClownZ80_Event *event);
+
+/* An event is owned by the host, and must stay in place for as long as it is scheduled. */
+typedef struct ClownZ80_Event
+{
+	ClownZ80_EventCallback callback;
+	const void *user_data;
+	/* Private. */
+	double cycle;
+	cc_u32l period; /* 0 if the event only happens once. */
+	size_t queue_index; /* Where it is in the queue's heap, if it is scheduled. */
+	cc_bool scheduled;
+} ClownZ80_Event;
+
+/* Events that are run by 'ClownZ80_Run' at set cycles, which saves the host from having to check the time after every instruction.
+   Events are scheduled against the 'total_cycles' of the state that the queue is used with, so a queue cannot be shared between states. */
+typedef struct ClownZ80_EventQueue
+{
+	/* Private: a binary heap, with the soonest event first. */
+	ClownZ80_Event *heap[CLOWNZ80_EVENT_QUEUE_SIZE];
+	size_t total_events;
+} ClownZ80_EventQueue;
+
+#ifdef CLOWNZ80_PROFILER
+/* The average number of instructions between samples of the host's time, as timing every instruction would slow them down too much. */
+#define CLOWNZ80_PROFILER_SAMPLE_INTERVAL 64
+
+typedef struct ClownZ80_ProfilerEntry
+{
+	/* These are doubles, as they can outgrow a 32-bit counter. */
+	double executions;
+	double cycles;
+	/* The executions whose host time was sampled, and how many 'clock' ticks they took altogether. */
+	double sampled_executions;
+	double sampled_clocks;
+} ClownZ80_ProfilerEntry;
+
+typedef struct ClownZ80_Profiler
+{
+	/* Indexed by 'ClownZ80_RegisterMode' (which is to say, the 'DD' or 'FD' prefix), and then by 'ClownZ80_Opcode'. 'CB' and
+	   'ED' instructions mostly have opcodes of their own, but those which do not, such as 'LD (nn),BC', are counted together
+	   with their unprefixed equivalents. */
+	ClownZ80_ProfilerEntry entries[3][CLOWNZ80_OPCODE_OTDR + 1];
+	/* Indexed by the address that each instruction starts at, including any prefix. */
+	double address_executions[0x10000];
+	double address_cycles[0x10000];
+	cc_u8l address_lengths[0x10000]; /* In bytes. */
+	/* Private. */
+	cc_u32l sample_countdown, random;
+	double clock_overhead; /* How many ticks that reading the clock adds to a sample. */
+} ClownZ80_Profiler;
+
+/* A run of instructions which follow on from one another and were all executed the same number of times, which makes
+   it a basic block, or near enough. */
+typedef struct ClownZ80_ProfilerBlock
+{
+	cc_u16l address;
+	cc_u32l length; /* In bytes. */
+	double executions;
+	double cycles; /* Of all of the block's instructions together. */
+} ClownZ80_ProfilerBlock;
+
+typedef void (*ClownZ80_Profiler_PrintCallback)(void *user_data, const char *format, ...);
+#endif
+
+#ifdef CLOWNZ80_TRACER
+#define CLOWNZ80_TRACER_BUFFER_SIZE 0x4000
+
+/* The tracer writes a record for every instruction that is executed, made up of the following, in order:
+   - A byte of 'CLOWNZ80_TRACE_RECORD_*' flags.
+   - The address of the instruction, little-endian, if it is not the address that followed the previous instruction.
+   - The bytes of the instruction, unless they are not in memory that is mapped for reading, in which case they are omitted,
+     as reading them through the callbacks could have side-effects. A 'DD' or 'FD' prefix is part of the instruction that it
+     is fetched with, so an instruction can be up to 5 bytes long.
+   - Each memory write, as a variable-length value of the difference from the previous write's address, zigzag-encoded
+     (0, -1, 1, -2, and so on), followed by the byte that was written.
+   - The cycles taken, as a byte. These include any interrupt that was taken after the instruction.
+   - A variable-length bitfield of which of the 'CLOWNZ80_TRACE_REGISTER_*' registers changed, which is 0 if none did,
+     followed by their new values, in the order of their bits.
+   Variable-length values are stored seven bits at a time, lowest first, with the top bit set on every byte but the last.
+   Everything is relative to an earlier record, with every register, the address, and the last write's address starting at 0,
+   so that the records are small and repetitive, which suits general-purpose compression.
+   While the Z80 is halted, a record is written every 4 cycles, as though the 'HALT' instruction were being executed again. */
+#define CLOWNZ80_TRACE_RECORD_LENGTH_MASK     0x07 /* The length of the instruction, minus 1. */
+#define CLOWNZ80_TRACE_RECORD_BYTES_OMITTED   0x08
+#define CLOWNZ80_TRACE_RECORD_ADDRESS         0x10
+#define CLOWNZ80_TRACE_RECORD_WRITES_SHIFT    5
+#define CLOWNZ80_TRACE_RECORD_WRITES_MASK     0x07 /* The number of memory writes. */
+
+/* Ordered so that the most frequently changed registers fit in the first byte of the bitfield.
+   'R' is left out, as it changes with almost every instruction in a way that can be worked out from the instructions. */
+typedef enum ClownZ80_TraceRegister
+{
+	CLOWNZ80_TRACE_REGISTER_F,
+	CLOWNZ80_TRACE_REGISTER_A,
+	CLOWNZ80_TRACE_REGISTER_C,
+	CLOWNZ80_TRACE_REGISTER_B,
+	CLOWNZ80_TRACE_REGISTER_E,
+	CLOWNZ80_TRACE_REGISTER_D,
+	CLOWNZ80_TRACE_REGISTER_L,
+	CLOWNZ80_TRACE_REGISTER_H,
+	CLOWNZ80_TRACE_REGISTER_SP_LOW,
+	CLOWNZ80_TRACE_REGISTER_SP_HIGH,
+	CLOWNZ80_TRACE_REGISTER_IXL,
+	CLOWNZ80_TRACE_REGISTER_IXH,
+	CLOWNZ80_TRACE_REGISTER_IYL,
+	CLOWNZ80_TRACE_REGISTER_IYH,
+	CLOWNZ80_TRACE_REGISTER_F_,
+	CLOWNZ80_TRACE_REGISTER_A_,
+	CLOWNZ80_TRACE_REGISTER_C_,
+	CLOWNZ80_TRACE_REGISTER_B_,
+	CLOWNZ80_TRACE_REGISTER_E_,
+	CLOWNZ80_TRACE_REGISTER_D_,
+	CLOWNZ80_TRACE_REGISTER_L_,
+	CLOWNZ80_TRACE_REGISTER_H_,
+	CLOWNZ80_TRACE_REGISTER_I,
+	CLOWNZ80_TRACE_REGISTER_INTERRUPTS_ENABLED,
+	CLOWNZ80_TRACE_REGISTER_INTERRUPT_PENDING,
+	CLOWNZ80_TRACE_TOTAL_REGISTERS
+} ClownZ80_TraceRegister;
+
+/* Rounded up to a multiple of 8, so that the registers can be compared in groups of 8. */
+#define CLOWNZ80_TRACER_REGISTER_SLOTS ((CLOWNZ80_TRACE_TOTAL_REGISTERS + 7) / 8 * 8)
+
+/* Called with the records whenever the buffer fills up. They must be copied before it returns, as the buffer is then reused.
+   As this is called in the middle of running the Z80, it should be quick, such as by leaving the writing to another thread. */
+typedef void (*ClownZ80_Tracer_FlushCallback)(void *user_data, const unsigned char *data, size_t size);
+
+typedef struct ClownZ80_Tracer
+{
+	ClownZ80_Tracer_FlushCallback flush_callback;
+	const void *user_data;
+	/* Private. */
+	unsigned char buffer[CLOWNZ80_TRACER_BUFFER_SIZE];
+	size_t buffer_used;
+	size_t record_start; /* Where the flags of the record that is being written are. */
+	cc_u8l registers[CLOWNZ80_TRACER_REGISTER_SLOTS]; /* As of the previous record. */
+	cc_u16l next_address, previous_write_address;
+} ClownZ80_Tracer;
+#endif
+
+/* Must be cleared with 'ClownZ80_ReadAndWriteCallbacks_Initialise' before any of its members are set, as anything that is
+   left uninitialised is used: even 'ClownZ80_DoInstruction' goes through the memory map and the port map when they are set. */
 typedef struct ClownZ80_ReadAndWriteCallbacks
 {
 	cc_u16f (*read)(void *user_data, cc_u16f address);
 	void (*write)(void *user_data, cc_u16f address, cc_u16f value);
 	CC_ATTRIBUTE_PRINTF(2, 3) void (*log)(void *user_data, const char* const format, ...);
 	const void *user_data;
+	/* Optional: accesses to pages that are mapped to host memory bypass the callbacks. May be NULL. */
+	const ClownZ80_MemoryMap *memory_map;
+	/* Optional: ports with a handler in the port map are accessed through it instead of the catch-all callbacks below. May be NULL. */
+	const ClownZ80_PortMap *port_map;
+	/* Optional: catch-all callbacks for port accesses. Either may be NULL, in which case reads return 0xFF,
+	   as nothing is driving the data bus, and writes are ignored. */
+	ClownZ80_PortReadCallback port_read;
+	ClownZ80_PortWriteCallback port_write;
+	/* Optional: decoded instructions are kept here so that they do not need decoding again. May be NULL.
+	   Only instructions in memory that is mapped for reading are cached. If that memory is modified by
+	   anything other than the Z80, then 'ClownZ80_InstructionCache_Invalidate' must be called. */
+	ClownZ80_InstructionCache *instruction_cache;
+	/* Optional: used by 'ClownZ80_Run' to execute whole blocks of decoded instructions at once. May be NULL.
+	   The same rules as the instruction cache apply, except that 'ClownZ80_BlockCache_Invalidate' must be called instead. */
+	ClownZ80_BlockCache *block_cache;
+	/* Optional: compiles frequently-executed blocks to native code. Requires the block cache. May be NULL.
+	   A JIT can be shared between multiple block caches. */
+	ClownZ80_Jit *jit;
+	/* Optional: events to run at set cycles. May be NULL. Events are only run by 'ClownZ80_Run', which stops at each one to run it,
+	   so the instructions in between are run uninterrupted. */
+	ClownZ80_EventQueue *event_queue;
+#ifdef CLOWNZ80_PROFILER
+	/* Optional: records every instruction that is executed. May be NULL.
+	   Native code cannot be profiled, so the JIT is not used while this is set. */
+	ClownZ80_Profiler *profiler;
+#endif
+#ifdef CLOWNZ80_TRACER
+	/* Optional: records every instruction that is executed. May be NULL.
+	   Native code and bulk block transfers skip over instructions, so neither is used while this is set. */
+	ClownZ80_Tracer *tracer;
+#endif
 } ClownZ80_ReadAndWriteCallbacks;
 
+/* For running many Z80s together with 'ClownZ80_RunInstances'. Each instance's state and callbacks are kept side by side,
+   so that an array of them can be walked through without chasing pointers. */
+typedef struct ClownZ80_Instance
+{
+	ClownZ80_State state;
+	ClownZ80_ReadAndWriteCallbacks callbacks;
+	/* Private: how far the last run went over its budget, which is deducted from the next one. */
+	cc_u32l cycles_overshot;
+} ClownZ80_Instance;
+
+/* Does nothing, as there are no longer any tables to initialise at run-time. Kept for compatibility. */
 void ClownZ80_Constant_Initialise(void);
 void ClownZ80_State_Initialise(ClownZ80_State *state);
 void ClownZ80_Reset(ClownZ80_State *state);
 void ClownZ80_Interrupt(ClownZ80_State *state, cc_bool assert_interrupt);
 cc_u16f ClownZ80_DoInstruction(ClownZ80_State *state, const ClownZ80_ReadAndWriteCallbacks *callbacks);
+cc_u32f ClownZ80_Run(ClownZ80_State *state, const ClownZ80_ReadAndWriteCallbacks *callbacks, cc_u32f cycle_budget);
+/* Sets every optional member to NULL, leaving the rest for the host to set. */
+void ClownZ80_ReadAndWriteCallbacks_Initialise(ClownZ80_ReadAndWriteCallbacks *callbacks);
+void ClownZ80_Instance_Initialise(ClownZ80_Instance *instance, const ClownZ80_ReadAndWriteCallbacks *callbacks);
+void ClownZ80_RunInstances(ClownZ80_Instance *instances, size_t total_instances, cc_u32f cycle_budget);
+void ClownZ80_MemoryMap_Initialise(ClownZ80_MemoryMap *memory_map);
+void ClownZ80_MemoryMap_SetPages(ClownZ80_MemoryMap *memory_map, cc_u16f address, cc_u32f length, const cc_u8l *read_buffer, cc_u8l *write_buffer);
+/* 'full_handlers' is the optional 16-bit table, which is cleared along with the 8-bit one. May be NULL. */
+void ClownZ80_PortMap_Initialise(ClownZ80_PortMap *port_map, ClownZ80_PortHandler *full_handlers);
+/* Sets the handlers of the ports in whichever table is in use. Either callback may be NULL. */
+void ClownZ80_PortMap_SetPorts(ClownZ80_PortMap *port_map, cc_u16f port, cc_u32f total_ports, ClownZ80_PortReadCallback read, ClownZ80_PortWriteCallback write, const void *user_data);
+void ClownZ80_InstructionCache_Initialise(ClownZ80_InstructionCache *instruction_cache);
+void ClownZ80_InstructionCache_Invalidate(ClownZ80_InstructionCache *instruction_cache, cc_u16f address, cc_u32f length);
+void ClownZ80_BlockCache_Initialise(ClownZ80_BlockCache *block_cache);
+void ClownZ80_BlockCache_Invalidate(ClownZ80_BlockCache *block_cache, cc_u16f address, cc_u32f length);
+cc_bool ClownZ80_Jit_Initialise(ClownZ80_Jit *jit, size_t buffer_size);
+void ClownZ80_Jit_Deinitialise(ClownZ80_Jit *jit);
+void ClownZ80_Event_Initialise(ClownZ80_Event *event, ClownZ80_EventCallback callback, const void *user_data);
+void ClownZ80_EventQueue_Initialise(ClownZ80_EventQueue *event_queue);
+/* Schedules the event for when the state's 'total_cycles' reaches 'cycle', and then every 'period' cycles after that, unless 'period' is 0.
+   An event which is already scheduled is moved. Events that are due at the same cycle are run in no particular order.
+   Returns cc_false if the queue is full. */
+cc_bool ClownZ80_EventQueue_Schedule(ClownZ80_EventQueue *event_queue, ClownZ80_Event *event, double cycle, cc_u32f period);
+/* Does nothing if the event is not scheduled. */
+void ClownZ80_EventQueue_Cancel(ClownZ80_EventQueue *event_queue, ClownZ80_Event *event);
+#ifdef CLOWNZ80_PROFILER
+/* Also used to reset the profiler. */
+void ClownZ80_Profiler_Initialise(ClownZ80_Profiler *profiler);
+/* These print the instructions that have been executed, with the most cycles first. Host times are estimated from the samples. */
+void ClownZ80_Profiler_PrintTable(const ClownZ80_Profiler *profiler, ClownZ80_Profiler_PrintCallback print_callback, const void *user_data);
+void ClownZ80_Profiler_PrintJSON(const ClownZ80_Profiler *profiler, ClownZ80_Profiler_PrintCallback print_callback, const void *user_data);
+/* Fills 'blocks' with up to 'maximum_blocks' of the blocks which took the most cycles, most first, and returns how many there were.
+   If 'total_cycles' is not NULL, then it is set to the cycles taken by every instruction, for working out percentages. */
+size_t ClownZ80_Profiler_GetHotBlocks(const ClownZ80_Profiler *profiler, ClownZ80_ProfilerBlock *blocks, size_t maximum_blocks, double *total_cycles);
+#endif
+#ifdef CLOWNZ80_TRACER
+/* Also used to start the records over, such as for a new file. */
+void ClownZ80_Tracer_Initialise(ClownZ80_Tracer *tracer, ClownZ80_Tracer_FlushCallback flush_callback, const void *user_data);
+/* Hands any records that are still in the buffer to the flush callback. Must be called once the Z80 is done running. */
+void ClownZ80_Tracer_Flush(ClownZ80_Tracer *tracer);
+#endif
 
 #endif /* CLOWNZ80_INTERPRETER_H */
@@ -0,0 +1,1040 @@
+/*
+An x86-64 backend for the block cache.
+
+Instructions that only operate on registers are compiled to native code, while everything else is
+handed back to the interpreter through the fallback callback, so memory accesses always go through
+the usual memory map and callbacks.
+
+Native code keeps the following in registers:
+rbx - The Z80 state.
+r12 - The callbacks.
+r13 - The number of cycles executed so far.
+r14 - The cycle budget.
+*/
+
+/* Only the System V calling convention is supported. */
+#if (defined(__x86_64__) || defined(__amd64__)) && !defined(_WIN32)
+	#define JIT_SUPPORTED
+
+	/* For 'MAP_ANONYMOUS'. */
+	#define _DEFAULT_SOURCE
+#endif
+
+#include "jit.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#ifdef JIT_SUPPORTED
+	#include <sys/mman.h>
+
+	#if !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+		#define MAP_ANONYMOUS MAP_ANON
+	#endif
+#endif
+
+#include "clowncommon/clowncommon.h"
+
+#include "interpreter.h"
+
+#ifdef JIT_SUPPORTED
+
+enum
+{
+	HOST_REGISTER_EAX = 0,
+	HOST_REGISTER_ECX = 1,
+	HOST_REGISTER_EDX = 2,
+	HOST_REGISTER_AH = 4
+};
+
+enum
+{
+	HOST_CONDITION_BELOW = 0x2,
+	HOST_CONDITION_ABOVE_OR_EQUAL = 0x3,
+	HOST_CONDITION_ZERO = 0x4,
+	HOST_CONDITION_NOT_ZERO = 0x5
+};
+
+#define STATE_OFFSET(member) offsetof(ClownZ80_State, member)
+
+/* Enough for a handful of jumps per instruction. */
+#define MAXIMUM_EPILOGUE_JUMPS (CLOWNZ80_BLOCK_MAXIMUM_INSTRUCTIONS * 3)
+
+typedef struct Emitter
+{
+	unsigned char *buffer;
+	size_t buffer_size;
+	size_t position;
+	size_t epilogue_jumps[MAXIMUM_EPILOGUE_JUMPS];
+	cc_u16f total_epilogue_jumps;
+	cc_bool overflowed;
+} Emitter;
+
+typedef struct Compiler
+{
+	Emitter emitter;
+	const ClownZ80_Block *block;
+	ClownZ80_JitFallback fallback;
+	cc_u16f program_counter;
+	cc_u16f pending_opcode_fetches; /* Increments of 'R' that have yet to be written to the state. */
+	cc_u8f register_mode;           /* The value of the state's 'register_mode', as of the current instruction. */
+} Compiler;
+
+/***********
+* Emitter *
+***********/
+
+static void Emit8(Emitter* const emitter, const unsigned long value)
+{
+	if (emitter->position < emitter->buffer_size)
+		emitter->buffer[emitter->position] = value & 0xFF;
+	else
+		emitter->overflowed = cc_true;
+
+	++emitter->position;
+}
+
+static void Emit16(Emitter* const emitter, const unsigned long value)
+{
+	Emit8(emitter, value >> 0);
+	Emit8(emitter, value >> 8);
+}
+
+static void Emit32(Emitter* const emitter, const unsigned long value)
+{
+	Emit16(emitter, value >> 0);
+	Emit16(emitter, value >> 16);
+}
+
+static void Emit64(Emitter* const emitter, const void* const pointer)
+{
+	unsigned char bytes[sizeof(pointer)];
+	size_t i;
+
+	/* x86-64 is little-endian, so the pointer's bytes are already in the right order. */
+	memcpy(bytes, &pointer, sizeof(pointer));
+
+	for (i = 0; i < sizeof(bytes); ++i)
+		Emit8(emitter, bytes[i]);
+}
+
+static void Emit64Function(Emitter* const emitter, const ClownZ80_JitFallback function)
+{
+	unsigned char bytes[sizeof(function)];
+	size_t i;
+
+	memcpy(bytes, &function, sizeof(function));
+
+	for (i = 0; i < sizeof(bytes); ++i)
+		Emit8(emitter, bytes[i]);
+}
+
+static void EmitModRMWithStateOffset(Emitter* const emitter, const cc_u8f reg, const size_t offset)
+{
+	/* '[rbx+disp8]'. */
+	Emit8(emitter, (1 << 6) | (reg << 3) | 3);
+	Emit8(emitter, offset);
+}
+
+/* Returns the position of the 32-bit displacement, to be patched later. */
+static size_t EmitJumpConditional(Emitter* const emitter, const cc_u8f condition)
+{
+	Emit8(emitter, 0x0F);
+	Emit8(emitter, 0x80 | condition);
+	Emit32(emitter, 0);
+	return emitter->position - 4;
+}
+
+static size_t EmitJump(Emitter* const emitter)
+{
+	Emit8(emitter, 0xE9);
+	Emit32(emitter, 0);
+	return emitter->position - 4;
+}
+
+static void PatchJump(Emitter* const emitter, const size_t displacement_position, const size_t destination)
+{
+	const unsigned long displacement = (unsigned long)(destination - (displacement_position + 4));
+
+	if (displacement_position + 4 <= emitter->buffer_size)
+	{
+		emitter->buffer[displacement_position + 0] = (displacement >> 0) & 0xFF;
+		emitter->buffer[displacement_position + 1] = (displacement >> 8) & 0xFF;
+		emitter->buffer[displacement_position + 2] = (displacement >> 16) & 0xFF;
+		emitter->buffer[displacement_position + 3] = (displacement >> 24) & 0xFF;
+	}
+}
+
+static void AddEpilogueJump(Emitter* const emitter, const size_t displacement_position)
+{
+	if (emitter->total_epilogue_jumps < MAXIMUM_EPILOGUE_JUMPS)
+		emitter->epilogue_jumps[emitter->total_epilogue_jumps++] = displacement_position;
+	else
+		emitter->overflowed = cc_true;
+}
+
+static void EmitJumpToEpilogue(Emitter* const emitter)
+{
+	AddEpilogueJump(emitter, EmitJump(emitter));
+}
+
+static void EmitJumpConditionalToEpilogue(Emitter* const emitter, const cc_u8f condition)
+{
+	AddEpilogueJump(emitter, EmitJumpConditional(emitter, condition));
+}
+
+/* 'movzx reg, byte [rbx+offset]' */
+static void EmitLoadByte(Emitter* const emitter, const cc_u8f reg, const size_t offset)
+{
+	Emit8(emitter, 0x0F);
+	Emit8(emitter, 0xB6);
+	EmitModRMWithStateOffset(emitter, reg, offset);
+}
+
+/* 'mov byte [rbx+offset], reg' */
+static void EmitStoreByte(Emitter* const emitter, const cc_u8f reg, const size_t offset)
+{
+	Emit8(emitter, 0x88);
+	EmitModRMWithStateOffset(emitter, reg, offset);
+}
+
+/* 'mov byte [rbx+offset], value' */
+static void EmitStoreByteImmediate(Emitter* const emitter, const size_t offset, const cc_u8f value)
+{
+	Emit8(emitter, 0xC6);
+	EmitModRMWithStateOffset(emitter, 0, offset);
+	Emit8(emitter, value);
+}
+
+/* 'mov word [rbx+offset], value' */
+static void EmitStoreWordImmediate(Emitter* const emitter, const size_t offset, const cc_u16f value)
+{
+	Emit8(emitter, 0x66);
+	Emit8(emitter, 0xC7);
+	EmitModRMWithStateOffset(emitter, 0, offset);
+	Emit16(emitter, value);
+}
+
+/* 'add r13, value' */
+static void EmitAddCycles(Emitter* const emitter, const cc_u16f cycles)
+{
+	Emit8(emitter, 0x49);
+	Emit8(emitter, 0x81);
+	Emit8(emitter, 0xC5);
+	Emit32(emitter, cycles);
+}
+
+/* 'cmp r13, r14' */
+static void EmitCompareCyclesWithBudget(Emitter* const emitter)
+{
+	Emit8(emitter, 0x4D);
+	Emit8(emitter, 0x39);
+	Emit8(emitter, 0xF5);
+}
+
+static void EmitSwapBytes(Emitter* const emitter, const size_t offset_a, const size_t offset_b)
+{
+	EmitLoadByte(emitter, HOST_REGISTER_EAX, offset_a);
+	EmitLoadByte(emitter, HOST_REGISTER_ECX, offset_b);
+	EmitStoreByte(emitter, HOST_REGISTER_ECX, offset_a);
+	EmitStoreByte(emitter, HOST_REGISTER_EAX, offset_b);
+}
+
+/* Converts the host's flags to the Z80's. Conveniently, the two share the same layout, except for the overflow flag. */
+static void EmitStoreFlags(Emitter* const emitter, const cc_u8f host_flags_mask, const cc_bool overflow, const cc_u8f extra_flags, const cc_bool preserve_carry)
+{
+	/* pushfq */
+	Emit8(emitter, 0x9C);
+	/* pop rcx */
+	Emit8(emitter, 0x59);
+
+	if (overflow)
+	{
+		/* mov edx, ecx */
+		Emit8(emitter, 0x89);
+		Emit8(emitter, 0xCA);
+		/* shr edx, 11 - 2 */
+		Emit8(emitter, 0xC1);
+		Emit8(emitter, 0xEA);
+		Emit8(emitter, 11 - 2);
+		/* and edx, 1 << 2 */
+		Emit8(emitter, 0x83);
+		Emit8(emitter, 0xE2);
+		Emit8(emitter, 1 << 2);
+	}
+
+	/* and ecx, host_flags_mask */
+	Emit8(emitter, 0x81);
+	Emit8(emitter, 0xE1);
+	Emit32(emitter, host_flags_mask);
+
+	if (overflow)
+	{
+		/* or ecx, edx */
+		Emit8(emitter, 0x09);
+		Emit8(emitter, 0xD1);
+	}
+
+	if (extra_flags != 0)
+	{
+		/* or ecx, extra_flags */
+		Emit8(emitter, 0x83);
+		Emit8(emitter, 0xC9);
+		Emit8(emitter, extra_flags);
+	}
+
+	if (preserve_carry)
+	{
+		EmitLoadByte(emitter, HOST_REGISTER_EDX, STATE_OFFSET(f));
+		/* and edx, 1 */
+		Emit8(emitter, 0x83);
+		Emit8(emitter, 0xE2);
+		Emit8(emitter, 0x01);
+		/* or ecx, edx */
+		Emit8(emitter, 0x09);
+		Emit8(emitter, 0xD1);
+	}
+
+	EmitStoreByte(emitter, HOST_REGISTER_ECX, STATE_OFFSET(f));
+}
+
+static void EmitPrologue(Emitter* const emitter)
+{
+	/* push rbp */
+	Emit8(emitter, 0x55);
+	/* push rbx */
+	Emit8(emitter, 0x53);
+	/* push r12 */
+	Emit8(emitter, 0x41);
+	Emit8(emitter, 0x54);
+	/* push r13 */
+	Emit8(emitter, 0x41);
+	Emit8(emitter, 0x55);
+	/* push r14 */
+	Emit8(emitter, 0x41);
+	Emit8(emitter, 0x56);
+	/* mov rbx, rdi */
+	Emit8(emitter, 0x48);
+	Emit8(emitter, 0x89);
+	Emit8(emitter, 0xFB);
+	/* mov r12, rsi */
+	Emit8(emitter, 0x49);
+	Emit8(emitter, 0x89);
+	Emit8(emitter, 0xF4);
+	/* xor r13d, r13d */
+	Emit8(emitter, 0x45);
+	Emit8(emitter, 0x31);
+	Emit8(emitter, 0xED);
+
+	/* 'mov r14, rdx', or 'mov r14d, edx' if 'cc_u32f' really is 32-bit. */
+	if (sizeof(cc_u32f) == 8)
+		Emit8(emitter, 0x49);
+	else
+		Emit8(emitter, 0x41);
+
+	Emit8(emitter, 0x89);
+	Emit8(emitter, 0xD6);
+}
+
+static void EmitEpilogue(Emitter* const emitter)
+{
+	/* mov rax, r13 */
+	Emit8(emitter, 0x4C);
+	Emit8(emitter, 0x89);
+	Emit8(emitter, 0xE8);
+	/* pop r14 */
+	Emit8(emitter, 0x41);
+	Emit8(emitter, 0x5E);
+	/* pop r13 */
+	Emit8(emitter, 0x41);
+	Emit8(emitter, 0x5D);
+	/* pop r12 */
+	Emit8(emitter, 0x41);
+	Emit8(emitter, 0x5C);
+	/* pop rbx */
+	Emit8(emitter, 0x5B);
+	/* pop rbp */
+	Emit8(emitter, 0x5D);
+	/* ret */
+	Emit8(emitter, 0xC3);
+}
+
+/************
+* Compiler *
+************/
+
+static int GetRegisterOffset(const ClownZ80_Operand operand)
+{
+	switch (operand)
+	{
+		case CLOWNZ80_OPERAND_A:
+			return STATE_OFFSET(a);
+
+		case CLOWNZ80_OPERAND_B:
+			return STATE_OFFSET(b);
+
+		case CLOWNZ80_OPERAND_C:
+			return STATE_OFFSET(c);
+
+		case CLOWNZ80_OPERAND_D:
+			return STATE_OFFSET(d);
+
+		case CLOWNZ80_OPERAND_E:
+			return STATE_OFFSET(e);
+
+		case CLOWNZ80_OPERAND_H:
+			return STATE_OFFSET(h);
+
+		case CLOWNZ80_OPERAND_L:
+			return STATE_OFFSET(l);
+
+		default:
+			return -1;
+	}
+}
+
+/* Returns the offsets of the upper and lower bytes of a register pair, or cc_false if the operand is not one. */
+static cc_bool GetRegisterPairOffsets(const ClownZ80_Operand operand, size_t* const upper_offset, size_t* const lower_offset)
+{
+	switch (operand)
+	{
+		case CLOWNZ80_OPERAND_BC:
+			*upper_offset = STATE_OFFSET(b);
+			*lower_offset = STATE_OFFSET(c);
+			return cc_true;
+
+		case CLOWNZ80_OPERAND_DE:
+			*upper_offset = STATE_OFFSET(d);
+			*lower_offset = STATE_OFFSET(e);
+			return cc_true;
+
+		case CLOWNZ80_OPERAND_HL:
+			*upper_offset = STATE_OFFSET(h);
+			*lower_offset = STATE_OFFSET(l);
+			return cc_true;
+
+		default:
+			/* Leave them defined anyway, so that callers which have already checked the operand do not need to check again. */
+			*upper_offset = *lower_offset = 0;
+			return cc_false;
+	}
+}
+
+static cc_bool IsRegisterOrLiteral(const ClownZ80_Operand operand)
+{
+	return operand == CLOWNZ80_OPERAND_LITERAL_8BIT || GetRegisterOffset(operand) != -1;
+}
+
+static cc_bool IsRegisterPairOrStackPointer(const ClownZ80_Operand operand)
+{
+	size_t upper_offset, lower_offset;
+
+	return operand == CLOWNZ80_OPERAND_SP || GetRegisterPairOffsets(operand, &upper_offset, &lower_offset);
+}
+
+static cc_bool IsCompilable(const ClownZ80_InstructionMetadata* const metadata)
+{
+	const ClownZ80_Operand source = (ClownZ80_Operand)metadata->operands[0];
+	const ClownZ80_Operand destination = (ClownZ80_Operand)metadata->operands[1];
+
+	switch ((ClownZ80_Opcode)metadata->opcode)
+	{
+		case CLOWNZ80_OPCODE_NOP:
+		case CLOWNZ80_OPCODE_EX_AF_AF:
+		case CLOWNZ80_OPCODE_EXX:
+		case CLOWNZ80_OPCODE_EX_DE_HL:
+		case CLOWNZ80_OPCODE_DI:
+		case CLOWNZ80_OPCODE_DD_PREFIX:
+		case CLOWNZ80_OPCODE_FD_PREFIX:
+		case CLOWNZ80_OPCODE_DJNZ:
+		case CLOWNZ80_OPCODE_JR_UNCONDITIONAL:
+		case CLOWNZ80_OPCODE_JR_CONDITIONAL:
+		case CLOWNZ80_OPCODE_JP_UNCONDITIONAL:
+		case CLOWNZ80_OPCODE_JP_CONDITIONAL:
+			return cc_true;
+
+		case CLOWNZ80_OPCODE_LD_8BIT:
+			return IsRegisterOrLiteral(source) && GetRegisterOffset(destination) != -1;
+
+		case CLOWNZ80_OPCODE_LD_16BIT:
+			return source == CLOWNZ80_OPERAND_LITERAL_16BIT && IsRegisterPairOrStackPointer(destination);
+
+		case CLOWNZ80_OPCODE_INC_8BIT:
+		case CLOWNZ80_OPCODE_DEC_8BIT:
+			return GetRegisterOffset(destination) != -1;
+
+		case CLOWNZ80_OPCODE_INC_16BIT:
+		case CLOWNZ80_OPCODE_DEC_16BIT:
+			return IsRegisterPairOrStackPointer(destination);
+
+		case CLOWNZ80_OPCODE_ADD_A:
+		case CLOWNZ80_OPCODE_ADC_A:
+		case CLOWNZ80_OPCODE_SUB:
+		case CLOWNZ80_OPCODE_SBC_A:
+		case CLOWNZ80_OPCODE_AND:
+		case CLOWNZ80_OPCODE_XOR:
+		case CLOWNZ80_OPCODE_OR:
+		case CLOWNZ80_OPCODE_CP:
+			return IsRegisterOrLiteral(source);
+
+		default:
+			return cc_false;
+	}
+}
+
+static void EmitFlushOpcodeFetches(Compiler* const compiler)
+{
+	Emitter* const emitter = &compiler->emitter;
+
+	if (compiler->pending_opcode_fetches == 0)
+		return;
+
+	/* Increment the lower 7 bits of the 'R' register. */
+	EmitLoadByte(emitter, HOST_REGISTER_EAX, STATE_OFFSET(r));
+	/* mov ecx, eax */
+	Emit8(emitter, 0x89);
+	Emit8(emitter, 0xC1);
+	/* and ecx, 0x80 */
+	Emit8(emitter, 0x81);
+	Emit8(emitter, 0xE1);
+	Emit32(emitter, 0x80);
+	/* add eax, pending_opcode_fetches */
+	Emit8(emitter, 0x05);
+	Emit32(emitter, compiler->pending_opcode_fetches);
+	/* and eax, 0x7F */
+	Emit8(emitter, 0x83);
+	Emit8(emitter, 0xE0);
+	Emit8(emitter, 0x7F);
+	/* or eax, ecx */
+	Emit8(emitter, 0x09);
+	Emit8(emitter, 0xC8);
+	EmitStoreByte(emitter, HOST_REGISTER_EAX, STATE_OFFSET(r));
+
+	compiler->pending_opcode_fetches = 0;
+}
+
+static void EmitSetRegisterMode(Compiler* const compiler, const ClownZ80_RegisterMode register_mode)
+{
+	if (compiler->register_mode != register_mode)
+	{
+		EmitStoreByteImmediate(&compiler->emitter, STATE_OFFSET(register_mode), register_mode);
+		compiler->register_mode = register_mode;
+	}
+}
+
+/* Leaves the native code, bringing the state up to date first. */
+static void EmitExit(Compiler* const compiler, const cc_u16f program_counter, const cc_u16f last_instruction_cycles)
+{
+	Emitter* const emitter = &compiler->emitter;
+	const cc_u16f pending_opcode_fetches = compiler->pending_opcode_fetches;
+
+	EmitStoreWordImmediate(emitter, STATE_OFFSET(program_counter), program_counter);
+	EmitStoreWordImmediate(emitter, STATE_OFFSET(cycles), last_instruction_cycles);
+	EmitFlushOpcodeFetches(compiler);
+	EmitJumpToEpilogue(emitter);
+
+	/* Other paths through the code may still have these fetches pending. */
+	compiler->pending_opcode_fetches = pending_opcode_fetches;
+}
+
+/* Exits if the cycle budget has been used up. */
+static void EmitCheckBudget(Compiler* const compiler, const cc_u16f last_instruction_cycles)
+{
+	Emitter* const emitter = &compiler->emitter;
+	size_t skip;
+
+	EmitCompareCyclesWithBudget(emitter);
+	skip = EmitJumpConditional(emitter, HOST_CONDITION_BELOW);
+	EmitExit(compiler, compiler->program_counter, last_instruction_cycles);
+	PatchJump(emitter, skip, emitter->position);
+}
+
+static void EmitBranch(Compiler* const compiler, const cc_u16f destination, const cc_u16f cycles, const size_t loop_start)
+{
+	Emitter* const emitter = &compiler->emitter;
+	const cc_u16f pending_opcode_fetches = compiler->pending_opcode_fetches;
+
+	EmitAddCycles(emitter, cycles);
+
+	if (destination == compiler->block->address && compiler->block->register_mode == CLOWNZ80_REGISTER_MODE_HL)
+	{
+		/* The block is branching back to its own start, so just loop within the native code. */
+		size_t exit;
+
+		/* Every iteration has to start from the same place, so 'R' cannot be left pending. */
+		EmitFlushOpcodeFetches(compiler);
+
+		EmitCompareCyclesWithBudget(emitter);
+		exit = EmitJumpConditional(emitter, HOST_CONDITION_ABOVE_OR_EQUAL);
+		PatchJump(emitter, EmitJump(emitter), loop_start);
+		PatchJump(emitter, exit, emitter->position);
+	}
+
+	EmitExit(compiler, destination, cycles);
+
+	/* The branch may not be taken, in which case these fetches are still pending. */
+	compiler->pending_opcode_fetches = pending_opcode_fetches;
+}
+
+/* Emits a test of the Z80's flags, and returns the host condition under which the Z80 condition is false. */
+static cc_u8f EmitEvaluateCondition(Emitter* const emitter, const ClownZ80_Condition condition)
+{
+	static const cc_u8l masks[8] = {0x40, 0x40, 0x01, 0x01, 0x04, 0x04, 0x80, 0x80};
+
+	/* test byte [rbx+f], mask */
+	Emit8(emitter, 0xF6);
+	EmitModRMWithStateOffset(emitter, 0, STATE_OFFSET(f));
+	Emit8(emitter, masks[condition]);
+
+	/* The even conditions are true when the flag is clear, while the odd ones are true when it is set. */
+	return condition % 2 == 0 ? HOST_CONDITION_NOT_ZERO : HOST_CONDITION_ZERO;
+}
+
+static void EmitALUOperation(Compiler* const compiler, const ClownZ80_InstructionMetadata* const metadata, const cc_u16f literal)
+{
+	/* The register-to-register and immediate forms of 'add', 'or', 'adc', 'sbb', 'and', 'sub', 'xor', and 'cmp'. */
+	enum {HOST_ADD = 0, HOST_OR = 1, HOST_ADC = 2, HOST_SBB = 3, HOST_AND = 4, HOST_SUB = 5, HOST_XOR = 6, HOST_CMP = 7};
+
+	Emitter* const emitter = &compiler->emitter;
+	const ClownZ80_Operand source = (ClownZ80_Operand)metadata->operands[0];
+	cc_u8f operation;
+
+	switch ((ClownZ80_Opcode)metadata->opcode)
+	{
+		default:
+		case CLOWNZ80_OPCODE_ADD_A:
+			operation = HOST_ADD;
+			break;
+
+		case CLOWNZ80_OPCODE_ADC_A:
+			operation = HOST_ADC;
+			break;
+
+		case CLOWNZ80_OPCODE_SUB:
+			operation = HOST_SUB;
+			break;
+
+		case CLOWNZ80_OPCODE_SBC_A:
+			operation = HOST_SBB;
+			break;
+
+		case CLOWNZ80_OPCODE_AND:
+			operation = HOST_AND;
+			break;
+
+		case CLOWNZ80_OPCODE_XOR:
+			operation = HOST_XOR;
+			break;
+
+		case CLOWNZ80_OPCODE_OR:
+			operation = HOST_OR;
+			break;
+
+		case CLOWNZ80_OPCODE_CP:
+			operation = HOST_CMP;
+			break;
+	}
+
+	EmitLoadByte(emitter, HOST_REGISTER_EAX, STATE_OFFSET(a));
+
+	if (source != CLOWNZ80_OPERAND_LITERAL_8BIT)
+		EmitLoadByte(emitter, HOST_REGISTER_EDX, GetRegisterOffset(source));
+
+	if (operation == HOST_ADC || operation == HOST_SBB)
+	{
+		/* Move the Z80's carry flag into the host's. */
+		EmitLoadByte(emitter, HOST_REGISTER_ECX, STATE_OFFSET(f));
+		/* shr cl, 1 */
+		Emit8(emitter, 0xD0);
+		Emit8(emitter, 0xE9);
+	}
+
+	if (source == CLOWNZ80_OPERAND_LITERAL_8BIT)
+	{
+		/* op al, literal */
+		Emit8(emitter, (operation << 3) | 4);
+		Emit8(emitter, literal);
+	}
+	else
+	{
+		/* op al, dl */
+		Emit8(emitter, operation << 3);
+		Emit8(emitter, 0xD0);
+	}
+
+	if (operation != HOST_CMP)
+		EmitStoreByte(emitter, HOST_REGISTER_EAX, STATE_OFFSET(a));
+
+	switch (operation)
+	{
+		case HOST_ADD:
+		case HOST_ADC:
+			EmitStoreFlags(emitter, 0xD1, cc_true, 0, cc_false);
+			break;
+
+		case HOST_SUB:
+		case HOST_SBB:
+		case HOST_CMP:
+			EmitStoreFlags(emitter, 0xD1, cc_true, 0x02, cc_false);
+			break;
+
+		case HOST_AND:
+			EmitStoreFlags(emitter, 0xC4, cc_false, 0x10, cc_false);
+			break;
+
+		case HOST_XOR:
+		case HOST_OR:
+			EmitStoreFlags(emitter, 0xC4, cc_false, 0, cc_false);
+			break;
+	}
+}
+
+static void EmitInstruction(Compiler* const compiler, const ClownZ80_DecodedInstruction* const instruction, const cc_u16f instruction_index, const size_t loop_start)
+{
+	Emitter* const emitter = &compiler->emitter;
+	const ClownZ80_InstructionMetadata* const metadata = &instruction->metadata;
+	const ClownZ80_Operand source = (ClownZ80_Operand)metadata->operands[0];
+	const ClownZ80_Operand destination = (ClownZ80_Operand)metadata->operands[1];
+	const cc_bool is_last_instruction = instruction_index + 1 == compiler->block->total_instructions;
+	const cc_u16f next_program_counter = (compiler->program_counter + instruction->length) & 0xFFFF;
+	cc_u16f cycles;
+	size_t upper_offset, lower_offset;
+
+	if (!IsCompilable(metadata))
+	{
+		/* Let the interpreter handle this one. */
+		EmitStoreWordImmediate(emitter, STATE_OFFSET(program_counter), compiler->program_counter);
+		EmitFlushOpcodeFetches(compiler);
+
+		/* mov rdi, rbx */
+		Emit8(emitter, 0x48);
+		Emit8(emitter, 0x89);
+		Emit8(emitter, 0xDF);
+		/* mov rsi, r12 */
+		Emit8(emitter, 0x4C);
+		Emit8(emitter, 0x89);
+		Emit8(emitter, 0xE6);
+		/* mov rdx, block */
+		Emit8(emitter, 0x48);
+		Emit8(emitter, 0xBA);
+		Emit64(emitter, compiler->block);
+		/* mov ecx, instruction_index */
+		Emit8(emitter, 0xB9);
+		Emit32(emitter, instruction_index);
+		/* mov rax, fallback */
+		Emit8(emitter, 0x48);
+		Emit8(emitter, 0xB8);
+		Emit64Function(emitter, compiler->fallback);
+		/* call rax */
+		Emit8(emitter, 0xFF);
+		Emit8(emitter, 0xD0);
+
+		/* movzx ecx, word [rbx+cycles] */
+		Emit8(emitter, 0x0F);
+		Emit8(emitter, 0xB7);
+		EmitModRMWithStateOffset(emitter, HOST_REGISTER_ECX, STATE_OFFSET(cycles));
+		/* add r13, rcx */
+		Emit8(emitter, 0x49);
+		Emit8(emitter, 0x01);
+		Emit8(emitter, 0xCD);
+
+		/* The interpreter always leaves the state in prefix-free mode, as prefixes are never handed to it. */
+		compiler->register_mode = CLOWNZ80_REGISTER_MODE_HL;
+		compiler->program_counter = next_program_counter;
+
+		/* The state is now completely up to date, so exiting is just a matter of returning. */
+		if (is_last_instruction)
+		{
+			EmitJumpToEpilogue(emitter);
+		}
+		else
+		{
+			/* test al, al */
+			Emit8(emitter, 0x84);
+			Emit8(emitter, 0xC0);
+			EmitJumpConditionalToEpilogue(emitter, HOST_CONDITION_ZERO);
+			EmitCompareCyclesWithBudget(emitter);
+			EmitJumpConditionalToEpilogue(emitter, HOST_CONDITION_ABOVE_OR_EQUAL);
+		}
+
+		return;
+	}
+
+	/* Prefixes are the only instructions which do not leave the state in prefix-free mode. */
+	if (metadata->opcode == CLOWNZ80_OPCODE_DD_PREFIX)
+		EmitSetRegisterMode(compiler, CLOWNZ80_REGISTER_MODE_IX);
+	else if (metadata->opcode == CLOWNZ80_OPCODE_FD_PREFIX)
+		EmitSetRegisterMode(compiler, CLOWNZ80_REGISTER_MODE_IY);
+	else
+		EmitSetRegisterMode(compiler, CLOWNZ80_REGISTER_MODE_HL);
+
+	compiler->pending_opcode_fetches += instruction->opcode_fetches;
+	cycles = instruction->cycles;
+
+	switch ((ClownZ80_Opcode)metadata->opcode)
+	{
+		default:
+		case CLOWNZ80_OPCODE_NOP:
+		case CLOWNZ80_OPCODE_DD_PREFIX:
+		case CLOWNZ80_OPCODE_FD_PREFIX:
+			break;
+
+		case CLOWNZ80_OPCODE_EX_AF_AF:
+			EmitSwapBytes(emitter, STATE_OFFSET(a), STATE_OFFSET(a_));
+			EmitSwapBytes(emitter, STATE_OFFSET(f), STATE_OFFSET(f_));
+			break;
+
+		case CLOWNZ80_OPCODE_EXX:
+			EmitSwapBytes(emitter, STATE_OFFSET(b), STATE_OFFSET(b_));
+			EmitSwapBytes(emitter, STATE_OFFSET(c), STATE_OFFSET(c_));
+			EmitSwapBytes(emitter, STATE_OFFSET(d), STATE_OFFSET(d_));
+			EmitSwapBytes(emitter, STATE_OFFSET(e), STATE_OFFSET(e_));
+			EmitSwapBytes(emitter, STATE_OFFSET(h), STATE_OFFSET(h_));
+			EmitSwapBytes(emitter, STATE_OFFSET(l), STATE_OFFSET(l_));
+			break;
+
+		case CLOWNZ80_OPCODE_EX_DE_HL:
+			EmitSwapBytes(emitter, STATE_OFFSET(d), STATE_OFFSET(h));
+			EmitSwapBytes(emitter, STATE_OFFSET(e), STATE_OFFSET(l));
+			break;
+
+		case CLOWNZ80_OPCODE_DI:
+			EmitStoreByteImmediate(emitter, STATE_OFFSET(interrupts_enabled), cc_false);
+			break;
+
+		case CLOWNZ80_OPCODE_LD_8BIT:
+			if (source == CLOWNZ80_OPERAND_LITERAL_8BIT)
+			{
+				EmitStoreByteImmediate(emitter, GetRegisterOffset(destination), instruction->literal);
+			}
+			else
+			{
+				EmitLoadByte(emitter, HOST_REGISTER_EAX, GetRegisterOffset(source));
+				EmitStoreByte(emitter, HOST_REGISTER_EAX, GetRegisterOffset(destination));
+			}
+
+			break;
+
+		case CLOWNZ80_OPCODE_LD_16BIT:
+			if (destination == CLOWNZ80_OPERAND_SP)
+			{
+				EmitStoreWordImmediate(emitter, STATE_OFFSET(stack_pointer), instruction->literal);
+			}
+			else
+			{
+				GetRegisterPairOffsets(destination, &upper_offset, &lower_offset);
+				EmitStoreByteImmediate(emitter, upper_offset, instruction->literal >> 8);
+				EmitStoreByteImmediate(emitter, lower_offset, instruction->literal & 0xFF);
+			}
+
+			break;
+
+		case CLOWNZ80_OPCODE_INC_8BIT:
+		case CLOWNZ80_OPCODE_DEC_8BIT:
+			EmitLoadByte(emitter, HOST_REGISTER_EAX, GetRegisterOffset(destination));
+			/* 'inc al' or 'dec al' */
+			Emit8(emitter, 0xFE);
+			Emit8(emitter, metadata->opcode == CLOWNZ80_OPCODE_INC_8BIT ? 0xC0 : 0xC8);
+			EmitStoreByte(emitter, HOST_REGISTER_EAX, GetRegisterOffset(destination));
+			EmitStoreFlags(emitter, 0xD0, cc_true, metadata->opcode == CLOWNZ80_OPCODE_INC_8BIT ? 0 : 0x02, cc_true);
+			break;
+
+		case CLOWNZ80_OPCODE_INC_16BIT:
+		case CLOWNZ80_OPCODE_DEC_16BIT:
+			if (destination == CLOWNZ80_OPERAND_SP)
+			{
+				/* 'inc word [rbx+stack_pointer]' or 'dec word [rbx+stack_pointer]' */
+				Emit8(emitter, 0x66);
+				Emit8(emitter, 0xFF);
+				EmitModRMWithStateOffset(emitter, metadata->opcode == CLOWNZ80_OPCODE_INC_16BIT ? 0 : 1, STATE_OFFSET(stack_pointer));
+			}
+			else
+			{
+				GetRegisterPairOffsets(destination, &upper_offset, &lower_offset);
+				EmitLoadByte(emitter, HOST_REGISTER_EAX, upper_offset);
+				/* shl eax, 8 */
+				Emit8(emitter, 0xC1);
+				Emit8(emitter, 0xE0);
+				Emit8(emitter, 8);
+				/* mov al, byte [rbx+lower_offset] */
+				Emit8(emitter, 0x8A);
+				EmitModRMWithStateOffset(emitter, HOST_REGISTER_EAX, lower_offset);
+				/* 'inc eax' or 'dec eax' */
+				Emit8(emitter, 0xFF);
+				Emit8(emitter, metadata->opcode == CLOWNZ80_OPCODE_INC_16BIT ? 0xC0 : 0xC8);
+				EmitStoreByte(emitter, HOST_REGISTER_EAX, lower_offset);
+				EmitStoreByte(emitter, HOST_REGISTER_AH, upper_offset);
+			}
+
+			/* This instruction requires an extra 2 cycles. */
+			cycles += 2;
+
+			break;
+
+		case CLOWNZ80_OPCODE_ADD_A:
+		case CLOWNZ80_OPCODE_ADC_A:
+		case CLOWNZ80_OPCODE_SUB:
+		case CLOWNZ80_OPCODE_SBC_A:
+		case CLOWNZ80_OPCODE_AND:
+		case CLOWNZ80_OPCODE_XOR:
+		case CLOWNZ80_OPCODE_OR:
+		case CLOWNZ80_OPCODE_CP:
+			EmitALUOperation(compiler, metadata, instruction->literal);
+			break;
+
+		case CLOWNZ80_OPCODE_JR_UNCONDITIONAL:
+			/* Branching takes 5 cycles. */
+			EmitBranch(compiler, (next_program_counter + CC_SIGN_EXTEND_UINT(7, instruction->literal)) & 0xFFFF, cycles + 5, loop_start);
+			return;
+
+		case CLOWNZ80_OPCODE_JP_UNCONDITIONAL:
+			EmitBranch(compiler, instruction->literal, cycles, loop_start);
+			return;
+
+		case CLOWNZ80_OPCODE_JR_CONDITIONAL:
+		case CLOWNZ80_OPCODE_JP_CONDITIONAL:
+		case CLOWNZ80_OPCODE_DJNZ:
+		{
+			const cc_bool is_jr = metadata->opcode != CLOWNZ80_OPCODE_JP_CONDITIONAL;
+			const cc_u16f branch_cycles = is_jr ? 5 : 0;
+			const cc_u16f destination_address = is_jr ? (next_program_counter + CC_SIGN_EXTEND_UINT(7, instruction->literal)) & 0xFFFF : instruction->literal;
+			size_t not_taken;
+
+			if (metadata->opcode == CLOWNZ80_OPCODE_DJNZ)
+			{
+				/* This instruction takes an extra cycle. */
+				cycles += 1;
+
+				/* dec byte [rbx+b] */
+				Emit8(emitter, 0xFE);
+				EmitModRMWithStateOffset(emitter, 1, STATE_OFFSET(b));
+				not_taken = EmitJumpConditional(emitter, HOST_CONDITION_ZERO);
+			}
+			else
+			{
+				not_taken = EmitJumpConditional(emitter, EmitEvaluateCondition(emitter, (ClownZ80_Condition)metadata->condition));
+			}
+
+			EmitBranch(compiler, destination_address, cycles + branch_cycles, loop_start);
+
+			PatchJump(emitter, not_taken, emitter->position);
+			compiler->program_counter = next_program_counter;
+			EmitAddCycles(emitter, cycles);
+			EmitExit(compiler, next_program_counter, cycles);
+			return;
+		}
+	}
+
+	EmitAddCycles(emitter, cycles);
+	compiler->program_counter = next_program_counter;
+
+	if (is_last_instruction)
+		EmitExit(compiler, compiler->program_counter, cycles);
+	else
+		EmitCheckBudget(compiler, cycles);
+}
+
+ClownZ80_JitFunction ClownZ80_Jit_CompileBlock(ClownZ80_Jit* const jit, const ClownZ80_Block* const block, const ClownZ80_JitFallback fallback)
+{
+	Compiler compiler;
+	ClownZ80_JitFunction function;
+	unsigned char *code;
+	size_t loop_start;
+	cc_u16f i;
+
+	compiler.emitter.buffer = code = &jit->buffer[jit->buffer_used];
+	compiler.emitter.buffer_size = jit->buffer_size - jit->buffer_used;
+	compiler.emitter.position = 0;
+	compiler.emitter.total_epilogue_jumps = 0;
+	compiler.emitter.overflowed = cc_false;
+	compiler.block = block;
+	compiler.fallback = fallback;
+	compiler.program_counter = block->address;
+	compiler.pending_opcode_fetches = 0;
+	compiler.register_mode = block->register_mode;
+
+	EmitPrologue(&compiler.emitter);
+
+	loop_start = compiler.emitter.position;
+
+	for (i = 0; i < block->total_instructions; ++i)
+		EmitInstruction(&compiler, &block->instructions[i], i, loop_start);
+
+	for (i = 0; i < compiler.emitter.total_epilogue_jumps; ++i)
+		PatchJump(&compiler.emitter, compiler.emitter.epilogue_jumps[i], compiler.emitter.position);
+
+	EmitEpilogue(&compiler.emitter);
+
+	if (compiler.emitter.overflowed)
+		return NULL;
+
+	jit->buffer_used += compiler.emitter.position;
+
+	/* Converting a data pointer to a function pointer is not allowed by ISO C, but POSIX guarantees that it works. */
+	memcpy(&function, &code, sizeof(function));
+	return function;
+}
+
+void ClownZ80_Jit_Flush(ClownZ80_Jit* const jit)
+{
+	jit->buffer_used = 0;
+	++jit->generation;
+}
+
+cc_bool ClownZ80_Jit_Initialise(ClownZ80_Jit* const jit, const size_t buffer_size)
+{
+	void *buffer;
+
+	/* The native code assumes that these are all single bytes, apart from 'cycles', 'program_counter', and 'stack_pointer'. */
+	if (sizeof(cc_u8l) != 1 || sizeof(cc_u16l) != 2 || sizeof(cc_bool) != 1 || sizeof(ClownZ80_State) > 0x80)
+		return cc_false;
+
+	buffer = mmap(NULL, buffer_size, PROT_READ | PROT_WRITE | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+	if (buffer == MAP_FAILED)
+		return cc_false;
+
+	jit->buffer = (unsigned char*)buffer;
+	jit->buffer_size = buffer_size;
+	jit->buffer_used = 0;
+	jit->generation = 1;
+
+	return cc_true;
+}
+
+void ClownZ80_Jit_Deinitialise(ClownZ80_Jit* const jit)
+{
+	munmap(jit->buffer, jit->buffer_size);
+}
+
+#else
+
+ClownZ80_JitFunction ClownZ80_Jit_CompileBlock(ClownZ80_Jit* const jit, const ClownZ80_Block* const block, const ClownZ80_JitFallback fallback)
+{
+	(void)jit;
+	(void)block;
+	(void)fallback;
+
+	return NULL;
+}
+
+void ClownZ80_Jit_Flush(ClownZ80_Jit* const jit)
+{
+	(void)jit;
+}
+
+cc_bool ClownZ80_Jit_Initialise(ClownZ80_Jit* const jit, const size_t buffer_size)
+{
+	(void)jit;
+	(void)buffer_size;
+
+	/* There is no backend for this platform. */
+	return cc_false;
+}
+
+void ClownZ80_Jit_Deinitialise(ClownZ80_Jit* const jit)
+{
+	(void)jit;
+}
+
+#endif
@@ -0,0 +1,19 @@
+#ifndef CLOWNZ80_JIT_H
+#define CLOWNZ80_JIT_H
+
+#include "clowncommon/clowncommon.h"
+
+#include "interpreter.h"
+
+/* Executes one of the block's instructions through the interpreter, for instructions that the JIT cannot compile.
+   Returns whether the native code can carry on executing the rest of the block. */
+typedef cc_bool (*ClownZ80_JitFallback)(ClownZ80_State *state, const ClownZ80_ReadAndWriteCallbacks *callbacks, const ClownZ80_Block *block, cc_u16f instruction_index);
+
+/* Executes instructions until either the block is exited or the cycle budget is used up, and returns the number of cycles that were executed. */
+typedef cc_u32f (*ClownZ80_JitFunction)(ClownZ80_State *state, const ClownZ80_ReadAndWriteCallbacks *callbacks, cc_u32f cycle_budget);
+
+/* Returns NULL if the buffer is too full to hold the block. */
+ClownZ80_JitFunction ClownZ80_Jit_CompileBlock(ClownZ80_Jit *jit, const ClownZ80_Block *block, ClownZ80_JitFallback fallback);
+void ClownZ80_Jit_Flush(ClownZ80_Jit *jit);
+
+#endif /* CLOWNZ80_JIT_H */
@@ -0,0 +1,459 @@
+/* Runs a program on two instances of the interpreter side by side: a reference which executes one instruction at a time
+   through the callbacks, and a candidate which uses one of the faster execution modes. They are compared whenever
+   they reach the same point, and execution stops at the first difference, so that bugs in the faster modes are
+   caught at the instruction that causes them rather than long afterwards. */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "clowncommon/clowncommon.h"
+
+#include "disassembler.h"
+#include "engines.h"
+#include "interpreter.h"
+
+/* This page is left unmapped, to act as memory-mapped I/O. Writes to it are compared in the order that they happen. */
+#define IO_PAGE_ADDRESS 0xFF00
+/* The number of writes that are remembered between comparisons. Any more, and all of memory is compared instead. */
+#define MAXIMUM_WRITES 0x400
+/* Memory that the reference did not write to is only compared this often, in comparisons, as doing so is slow. */
+#define FULL_COMPARISON_INTERVAL 0x1000
+/* The number of instructions which are disassembled from before the difference. */
+#define HISTORY_LENGTH 16
+
+typedef struct Write
+{
+	cc_u16l address;
+	cc_u8l value;
+} Write;
+
+typedef struct Machine
+{
+	const char *name;
+	ClownZ80_State state;
+	cc_u8l ram[0x10000];
+	/* The writes which went through the write callback since the last comparison. */
+	Write writes[MAXIMUM_WRITES];
+	unsigned int total_writes;
+	cc_bool writes_overflowed;
+} Machine;
+
+typedef struct DisassemblerState
+{
+	const cc_u8l *ram;
+	cc_u16f address;
+} DisassemblerState;
+
+static Machine reference, candidate;
+
+static cc_u16f ReadCallback(void* const user_data, const cc_u16f address)
+{
+	Machine* const machine = (Machine*)user_data;
+
+	return machine->ram[address];
+}
+
+static void WriteCallback(void* const user_data, const cc_u16f address, const cc_u16f value)
+{
+	Machine* const machine = (Machine*)user_data;
+
+	machine->ram[address] = value;
+
+	if (machine->total_writes == MAXIMUM_WRITES)
+	{
+		machine->writes_overflowed = cc_true;
+	}
+	else
+	{
+		machine->writes[machine->total_writes].address = address;
+		machine->writes[machine->total_writes].value = value;
+		++machine->total_writes;
+	}
+}
+
+static void LogCallback(void* const user_data, const char* const format, ...)
+{
+	(void)user_data;
+	(void)format;
+}
+
+static unsigned char DisassemblerReadCallback(void* const user_data)
+{
+	DisassemblerState* const disassembler_state = (DisassemblerState*)user_data;
+	const unsigned char value = disassembler_state->ram[disassembler_state->address];
+
+	disassembler_state->address = (disassembler_state->address + 1) & 0xFFFF;
+
+	return value;
+}
+
+static void DisassemblerPrintCallback(void* const user_data, const char* const format, ...)
+{
+	va_list args;
+
+	(void)user_data;
+
+	va_start(args, format);
+	vfprintf(stdout, format, args);
+	va_end(args);
+}
+
+static void Disassemble(const cc_u8l* const ram, const cc_u16f address, const unsigned int total_instructions)
+{
+	DisassemblerState disassembler_state;
+
+	disassembler_state.ram = ram;
+	disassembler_state.address = address;
+
+	ClownZ80_Disassemble(address, total_instructions, DisassemblerReadCallback, DisassemblerPrintCallback, &disassembler_state);
+}
+
+static cc_bool LoadProgram(const char* const file_path, const cc_u16f address)
+{
+	cc_bool success = cc_false;
+	FILE* const file = fopen(file_path, "rb");
+
+	if (file == NULL)
+	{
+		fprintf(stderr, "Could not open file '%s'.\n", file_path);
+	}
+	else
+	{
+		const size_t size = fread(&reference.ram[address], 1, 0x10000 - address, file);
+
+		if (size == 0)
+		{
+			fprintf(stderr, "File '%s' is empty.\n", file_path);
+		}
+		else
+		{
+			memcpy(&candidate.ram[address], &reference.ram[address], size);
+			success = cc_true;
+		}
+
+		fclose(file);
+	}
+
+	return success;
+}
+
+static cc_bool CompareValue(const char* const name, const unsigned long reference_value, const unsigned long candidate_value)
+{
+	if (reference_value == candidate_value)
+		return cc_true;
+
+	fprintf(stdout, "%-20s reference %04lX, candidate %04lX\n", name, reference_value, candidate_value);
+	return cc_false;
+}
+
+static cc_bool CompareStates(void)
+{
+	cc_bool match = cc_true;
+
+	/* The cycle count and the lazy flag state are left out, as they may legitimately differ between execution modes. */
+#define COMPARE(FIELD) match &= CompareValue(#FIELD, reference.state.FIELD, candidate.state.FIELD)
+	COMPARE(register_mode);
+	COMPARE(program_counter);
+	COMPARE(stack_pointer);
+	COMPARE(a);
+	COMPARE(f);
+	COMPARE(b);
+	COMPARE(c);
+	COMPARE(d);
+	COMPARE(e);
+	COMPARE(h);
+	COMPARE(l);
+	COMPARE(a_);
+	COMPARE(f_);
+	COMPARE(b_);
+	COMPARE(c_);
+	COMPARE(d_);
+	COMPARE(e_);
+	COMPARE(h_);
+	COMPARE(l_);
+	COMPARE(ixh);
+	COMPARE(ixl);
+	COMPARE(iyh);
+	COMPARE(iyl);
+	COMPARE(r);
+	COMPARE(i);
+	COMPARE(interrupts_enabled);
+	COMPARE(interrupt_pending);
+#undef COMPARE
+
+	return match;
+}
+
+/* Returns the next write to the I/O page, starting at 'index', or 'total_writes' if there are none. */
+static unsigned int FindIOWrite(const Machine* const machine, unsigned int index)
+{
+	while (index < machine->total_writes && machine->writes[index].address < IO_PAGE_ADDRESS)
+		++index;
+
+	return index;
+}
+
+static cc_bool CompareIOWrites(void)
+{
+	unsigned int reference_index = FindIOWrite(&reference, 0);
+	unsigned int candidate_index = FindIOWrite(&candidate, 0);
+
+	/* The writes which did not fit in the log are unknown, so they cannot be compared. */
+	if (reference.writes_overflowed || candidate.writes_overflowed)
+		return cc_true;
+
+	while (reference_index < reference.total_writes && candidate_index < candidate.total_writes)
+	{
+		const Write* const reference_write = &reference.writes[reference_index];
+		const Write* const candidate_write = &candidate.writes[candidate_index];
+
+		if (reference_write->address != candidate_write->address || reference_write->value != candidate_write->value)
+		{
+			fprintf(stdout, "I/O write: reference wrote %02X to %04X, candidate wrote %02X to %04X\n", (unsigned int)reference_write->value, (unsigned int)reference_write->address, (unsigned int)candidate_write->value, (unsigned int)candidate_write->address);
+			return cc_false;
+		}
+
+		reference_index = FindIOWrite(&reference, reference_index + 1);
+		candidate_index = FindIOWrite(&candidate, candidate_index + 1);
+	}
+
+	if (reference_index != reference.total_writes)
+	{
+		fprintf(stdout, "I/O write: reference wrote %02X to %04X, candidate wrote nothing\n", (unsigned int)reference.writes[reference_index].value, (unsigned int)reference.writes[reference_index].address);
+		return cc_false;
+	}
+
+	if (candidate_index != candidate.total_writes)
+	{
+		fprintf(stdout, "I/O write: candidate wrote %02X to %04X, reference wrote nothing\n", (unsigned int)candidate.writes[candidate_index].value, (unsigned int)candidate.writes[candidate_index].address);
+		return cc_false;
+	}
+
+	return cc_true;
+}
+
+static cc_bool CompareMemory(const cc_bool everything)
+{
+	cc_u32f address;
+
+	/* Every write that the reference makes goes through the callback, so usually only those bytes need checking. */
+	if (!everything && !reference.writes_overflowed)
+	{
+		unsigned int i;
+
+		for (i = 0; i < reference.total_writes; ++i)
+		{
+			address = reference.writes[i].address;
+
+			if (reference.ram[address] != candidate.ram[address])
+				break;
+		}
+
+		if (i == reference.total_writes)
+			return cc_true;
+	}
+	else if (memcmp(reference.ram, candidate.ram, sizeof(reference.ram)) == 0)
+	{
+		return cc_true;
+	}
+
+	for (address = 0; address < 0x10000; ++address)
+	{
+		if (reference.ram[address] != candidate.ram[address])
+		{
+			fprintf(stdout, "Memory at %04lX: reference %02X, candidate %02X\n", (unsigned long)address, (unsigned int)reference.ram[address], (unsigned int)candidate.ram[address]);
+			break;
+		}
+	}
+
+	return cc_false;
+}
+
+static void PrintWrites(const Machine* const machine)
+{
+	unsigned int i;
+
+	fprintf(stdout, "Writes made by the %s:", machine->name);
+
+	for (i = 0; i < machine->total_writes; ++i)
+		fprintf(stdout, " %02X->%04X", (unsigned int)machine->writes[i].value, (unsigned int)machine->writes[i].address);
+
+	if (machine->writes_overflowed)
+		fputs(" ...", stdout);
+
+	fputc('\n', stdout);
+}
+
+static void InitialiseMachine(Machine* const machine, const char* const name, ClownZ80_ReadAndWriteCallbacks* const callbacks, const cc_u16f start_address)
+{
+	machine->name = name;
+
+	ClownZ80_State_Initialise(&machine->state);
+	ClownZ80_Reset(&machine->state);
+	machine->state.program_counter = start_address;
+
+	ClownZ80_ReadAndWriteCallbacks_Initialise(callbacks);
+	callbacks->read = ReadCallback;
+	callbacks->write = WriteCallback;
+	callbacks->log = LogCallback;
+	callbacks->user_data = machine;
+}
+
+int main(const int argc, char** const argv)
+{
+	static ClownZ80_EngineResources engine_resources;
+
+	ClownZ80_ReadAndWriteCallbacks reference_callbacks, candidate_callbacks;
+	ClownZ80_Engine engine = CLOWNZ80_ENGINE_JIT;
+	const char *file_path = NULL;
+	unsigned long load_address = 0, start_address, maximum_instructions = 10000000, slice_cycles = 1, interrupt_interval = 0;
+	cc_bool start_address_given = cc_false;
+	unsigned long instructions_done, comparisons_done, cycles_until_interrupt;
+	cc_u16f history[HISTORY_LENGTH];
+	unsigned int history_length;
+	cc_bool match;
+	int argument;
+
+	for (argument = 1; argument < argc; ++argument)
+	{
+		if (strcmp(argv[argument], "--engine") == 0 && argument + 1 < argc)
+		{
+			engine = ClownZ80_Engine_FromName(argv[++argument]);
+		}
+		else if (strcmp(argv[argument], "--load") == 0 && argument + 1 < argc)
+		{
+			load_address = strtoul(argv[++argument], NULL, 16) & 0xFFFF;
+		}
+		else if (strcmp(argv[argument], "--start") == 0 && argument + 1 < argc)
+		{
+			start_address = strtoul(argv[++argument], NULL, 16) & 0xFFFF;
+			start_address_given = cc_true;
+		}
+		else if (strcmp(argv[argument], "--instructions") == 0 && argument + 1 < argc)
+		{
+			maximum_instructions = strtoul(argv[++argument], NULL, 0);
+		}
+		else if (strcmp(argv[argument], "--slice") == 0 && argument + 1 < argc)
+		{
+			slice_cycles = strtoul(argv[++argument], NULL, 0);
+		}
+		else if (strcmp(argv[argument], "--interrupt-interval") == 0 && argument + 1 < argc)
+		{
+			interrupt_interval = strtoul(argv[++argument], NULL, 0);
+		}
+		else
+		{
+			file_path = argv[argument];
+		}
+	}
+
+	if (file_path == NULL || engine == CLOWNZ80_TOTAL_ENGINES || slice_cycles == 0)
+	{
+		fputs("Usage: clownz80-lockstep-test [options] program.bin\n", stderr);
+		fputs("  --engine " CLOWNZ80_ENGINE_NAMES "  The candidate's execution mode. Defaults to 'jit'.\n", stderr);
+		fputs("  --load ADDRESS                           Where to load the program, in hexadecimal. Defaults to 0.\n", stderr);
+		fputs("  --start ADDRESS                          Where to start executing, in hexadecimal. Defaults to the load address.\n", stderr);
+		fputs("  --instructions COUNT                     How many instructions to run for. Defaults to 10000000.\n", stderr);
+		fputs("  --slice CYCLES                           How many cycles the candidate runs between comparisons.\n", stderr);
+		fputs("                                           Defaults to 1, which compares after every instruction.\n", stderr);
+		fputs("  --interrupt-interval CYCLES              Raise an interrupt this often. Defaults to never.\n", stderr);
+		return EXIT_FAILURE;
+	}
+
+	if (!start_address_given)
+		start_address = load_address;
+
+	if (!LoadProgram(file_path, load_address))
+		return EXIT_FAILURE;
+
+	InitialiseMachine(&reference, "reference", &reference_callbacks, start_address);
+	InitialiseMachine(&candidate, "candidate", &candidate_callbacks, start_address);
+
+	if (!ClownZ80_EngineResources_Initialise(&engine_resources, engine, &candidate_callbacks, candidate.ram, IO_PAGE_ADDRESS))
+	{
+		fputs("The JIT is not available on this platform.\n", stderr);
+		return EXIT_FAILURE;
+	}
+
+	instructions_done = 0;
+	comparisons_done = 0;
+	cycles_until_interrupt = interrupt_interval;
+	history_length = 0;
+	match = cc_true;
+
+	while (match && instructions_done < maximum_instructions)
+	{
+		unsigned long reference_cycles, candidate_cycles;
+
+		reference.total_writes = candidate.total_writes = 0;
+		reference.writes_overflowed = candidate.writes_overflowed = cc_false;
+
+		/* Both instances are at the same point, so interrupts can be raised in both without them drifting apart. */
+		if (interrupt_interval != 0 && cycles_until_interrupt == 0)
+		{
+			ClownZ80_Interrupt(&reference.state, cc_true);
+			ClownZ80_Interrupt(&candidate.state, cc_true);
+			cycles_until_interrupt = interrupt_interval;
+		}
+
+		/* A slice of 1 cycle makes every execution mode stop after a single instruction. */
+		if (engine == CLOWNZ80_ENGINE_STEP)
+			candidate_cycles = ClownZ80_DoInstruction(&candidate.state, &candidate_callbacks);
+		else
+			candidate_cycles = ClownZ80_Run(&candidate.state, &candidate_callbacks, interrupt_interval == 0 ? slice_cycles : CC_MIN(slice_cycles, cycles_until_interrupt));
+
+		/* Catch the reference up to the candidate. */
+		reference_cycles = 0;
+
+		do
+		{
+			history[history_length % HISTORY_LENGTH] = reference.state.program_counter;
+			++history_length;
+
+			reference_cycles += ClownZ80_DoInstruction(&reference.state, &reference_callbacks);
+			++instructions_done;
+		} while (reference_cycles < candidate_cycles);
+
+		if (interrupt_interval != 0)
+			cycles_until_interrupt -= CC_MIN(cycles_until_interrupt, candidate_cycles);
+
+		++comparisons_done;
+
+		match = CompareValue("cycles", reference_cycles, candidate_cycles);
+		match &= CompareStates();
+		match &= CompareIOWrites();
+		match &= CompareMemory(comparisons_done % FULL_COMPARISON_INTERVAL == 0);
+	}
+
+	/* Catch writes to memory that the reference never touched. */
+	if (match)
+		match = CompareMemory(cc_true);
+
+	ClownZ80_EngineResources_Deinitialise(&engine_resources);
+
+	if (match)
+	{
+		fprintf(stdout, "No differences in %lu instructions, using the '%s' engine.\n", instructions_done, ClownZ80_Engine_GetName(engine));
+		return EXIT_SUCCESS;
+	}
+	else
+	{
+		const unsigned int first_history_entry = history_length > HISTORY_LENGTH ? history_length - HISTORY_LENGTH : 0;
+		unsigned int i;
+
+		PrintWrites(&reference);
+		PrintWrites(&candidate);
+
+		fprintf(stdout, "\nThe '%s' engine differs from the reference after %lu instructions. The last instructions were:\n", ClownZ80_Engine_GetName(engine), instructions_done);
+
+		for (i = first_history_entry; i < history_length; ++i)
+			Disassemble(reference.ram, history[i % HISTORY_LENGTH], 1);
+
+		fputs("\nThe reference's next instructions are:\n", stdout);
+		Disassemble(reference.ram, reference.state.program_counter, 4);
+
+		return EXIT_FAILURE;
+	}
+}
@@ -0,0 +1,99 @@
+/* Generates 'lookup-tables.h', which holds the interpreter's instruction lookup tables as constant data.
+   The interpreter is built into this program, so that the tables are made by the same code that would otherwise make them at run-time. */
+
+#define CLOWNZ80_GENERATING_LOOKUP_TABLES
+
+/* The same order as 'unity.c', as 'jit.c' must see its feature macros before any system header. */
+#include "jit.c"
+#include "common.c"
+#include "interpreter.c"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Writes the row of 'instruction_lookup' for one instruction mode and register mode. */
+static cc_bool WriteLookupRow(FILE* const file, const ClownZ80_InstructionMode instruction_mode, const ClownZ80_RegisterMode register_mode, const cc_bool last)
+{
+	unsigned int opcode;
+
+	fputs("\t{\r\n", file);
+
+	for (opcode = 0; opcode < 0x100; ++opcode)
+	{
+		ClownZ80_InstructionMetadata metadata;
+		cc_u16f handler_index;
+		cc_u32f packed;
+
+		ClownZ80_DecodeInstructionMetadata(&metadata, instruction_mode, register_mode, opcode);
+		handler_index = SelectHandlerIndex(&metadata);
+
+		/* Make sure that the metadata survives being packed. */
+		if (handler_index > PACKED_METADATA_HANDLER_MASK
+		 || instruction_handlers[handler_index].opcode != metadata.opcode
+		 || metadata.operands[0] > PACKED_METADATA_OPERAND_MASK
+		 || metadata.operands[1] > PACKED_METADATA_OPERAND_MASK
+		 || (metadata.condition != 0 && metadata.embedded_literal != 0))
+		{
+			fprintf(stderr, "Could not pack the metadata of opcode 0x%02X.\n", opcode);
+			return cc_false;
+		}
+
+		packed = (cc_u32f)handler_index << PACKED_METADATA_HANDLER_SHIFT
+		       | (cc_u32f)metadata.operands[0] << PACKED_METADATA_OPERAND_0_SHIFT
+		       | (cc_u32f)metadata.operands[1] << PACKED_METADATA_OPERAND_1_SHIFT
+		       | (cc_u32f)(metadata.condition | metadata.embedded_literal) << PACKED_METADATA_LITERAL_SHIFT
+		       | (cc_u32f)(metadata.has_displacement ? 1 : 0) << PACKED_METADATA_DISPLACEMENT_SHIFT;
+
+		fprintf(file, "%s0x%08lX", opcode % 8 == 0 ? "\t\t" : " ", (unsigned long)packed);
+		fputs(opcode == 0xFF ? "\r\n" : opcode % 8 == 7 ? ",\r\n" : ",", file);
+	}
+
+	fputs(last ? "\t}\r\n" : "\t},\r\n", file);
+
+	return cc_true;
+}
+
+/* In the order of the 'INSTRUCTION_LOOKUP_*' rows. */
+static const struct
+{
+	ClownZ80_InstructionMode instruction_mode;
+	ClownZ80_RegisterMode register_mode;
+} lookup_rows[TOTAL_INSTRUCTION_LOOKUPS] = {
+	{CLOWNZ80_INSTRUCTION_MODE_NORMAL, CLOWNZ80_REGISTER_MODE_HL},
+	{CLOWNZ80_INSTRUCTION_MODE_NORMAL, CLOWNZ80_REGISTER_MODE_IX},
+	{CLOWNZ80_INSTRUCTION_MODE_NORMAL, CLOWNZ80_REGISTER_MODE_IY},
+	{CLOWNZ80_INSTRUCTION_MODE_BITS, CLOWNZ80_REGISTER_MODE_HL},
+	{CLOWNZ80_INSTRUCTION_MODE_BITS, CLOWNZ80_REGISTER_MODE_IX},
+	{CLOWNZ80_INSTRUCTION_MODE_BITS, CLOWNZ80_REGISTER_MODE_IY},
+	{CLOWNZ80_INSTRUCTION_MODE_MISC, CLOWNZ80_REGISTER_MODE_HL}
+};
+
+int main(const int argc, char** const argv)
+{
+	cc_bool success = cc_true;
+	unsigned int i;
+	/* Binary mode, as the line endings are written explicitly, to match the rest of the repository. */
+	FILE* const file = argc < 2 ? stdout : fopen(argv[1], "wb");
+
+	if (file == NULL)
+	{
+		fprintf(stderr, "Could not open file '%s'.\n", argv[1]);
+		return EXIT_FAILURE;
+	}
+
+	fputs("/* Generated by 'lookup-table-generator.c': do not edit. */\r\n\r\n", file);
+	fputs("static const cc_u32l instruction_lookup[TOTAL_INSTRUCTION_LOOKUPS][0x100] = {\r\n", file);
+
+	for (i = 0; i < CC_COUNT_OF(lookup_rows) && success; ++i)
+		success = WriteLookupRow(file, lookup_rows[i].instruction_mode, lookup_rows[i].register_mode, i == CC_COUNT_OF(lookup_rows) - 1);
+
+	fputs("};\r\n", file);
+
+	if (file != stdout && fclose(file) != 0)
+	{
+		fprintf(stderr, "Could not write file '%s'.\n", argv[1]);
+		return EXIT_FAILURE;
+	}
+
+	return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
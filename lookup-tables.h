@@ -0,0 +1,242 @@
+/* Generated by 'lookup-table-generator.c': do not edit. */
+
+static const cc_u32l instruction_lookup[TOTAL_INSTRUCTION_LOOKUPS][0x100] = {
+	{
+		0x00000000, 0x00037605, 0x000502ED, 0x00034008, 0x00008163, 0x0000816E, 0x0000B477, 0x0000000C,
+		0x00000001, 0x0003DA06, 0x00006869, 0x00034009, 0x0000C164, 0x0000C16F, 0x0000F484, 0x0000000D,
+		0x00003402, 0x0003B605, 0x000542ED, 0x00038008, 0x00010165, 0x00010170, 0x00013491, 0x0000000E,
+		0x00003403, 0x0003DC06, 0x00006A69, 0x00038009, 0x00014166, 0x00014171, 0x0001749E, 0x0000000F,
+		0x00003404, 0x0003F605, 0x00065E05, 0x0003C008, 0x00018167, 0x00018172, 0x0001B4AB, 0x00000010,
+		0x00083404, 0x0003DE06, 0x0003F205, 0x0003C009, 0x0001C168, 0x0001C173, 0x0001F4B8, 0x00000011,
+		0x00103404, 0x0004F605, 0x000642ED, 0x0004C008, 0x0005800A, 0x0005800B, 0x0005B4F9, 0x00000012,
+		0x00183404, 0x0003E606, 0x00007269, 0x0004C009, 0x00004162, 0x0000416D, 0x0000746A, 0x00000013,
+		0x0000846C, 0x0000866D, 0x0000886E, 0x00008A6F, 0x00008C70, 0x00008E71, 0x0000AC76, 0x0000826B,
+		0x0000C479, 0x0000C67A, 0x0000C87B, 0x0000CA7C, 0x0000CC7D, 0x0000CE7E, 0x0000EC83, 0x0000C278,
+		0x00010486, 0x00010687, 0x00010888, 0x00010A89, 0x00010C8A, 0x00010E8B, 0x00012C90, 0x00010285,
+		0x00014493, 0x00014694, 0x00014895, 0x00014A96, 0x00014C97, 0x00014E98, 0x00016C9D, 0x00014292,
+		0x000184A0, 0x000186A1, 0x000188A2, 0x00018AA3, 0x00018CA4, 0x00018EA5, 0x0001ACAA, 0x0001829F,
+		0x0001C4AD, 0x0001C6AE, 0x0001C8AF, 0x0001CAB0, 0x0001CCB1, 0x0001CEB2, 0x0001ECB7, 0x0001C2AC,
+		0x000584EE, 0x000586EF, 0x000588F0, 0x00058AF1, 0x00058CF2, 0x00058EF3, 0x00000014, 0x000582ED,
+		0x0000445F, 0x00004660, 0x00004861, 0x00004A62, 0x00004C63, 0x00004E64, 0x00006C69, 0x0000425E,
+		0x000004FB, 0x000006FC, 0x000008FD, 0x00000AFE, 0x00000CFF, 0x00000F00, 0x00002D05, 0x000002FA,
+		0x00000508, 0x00000709, 0x0000090A, 0x00000B0B, 0x00000D0C, 0x00000F0D, 0x00002D12, 0x00000307,
+		0x00000515, 0x00000716, 0x00000917, 0x00000B18, 0x00000D19, 0x00000F1A, 0x00002D1F, 0x00000314,
+		0x00000522, 0x00000723, 0x00000924, 0x00000B25, 0x00000D26, 0x00000F27, 0x00002D2C, 0x00000321,
+		0x0000052F, 0x00000730, 0x00000931, 0x00000B32, 0x00000D33, 0x00000F34, 0x00002D39, 0x0000032E,
+		0x0000053C, 0x0000073D, 0x0000093E, 0x00000B3F, 0x00000D40, 0x00000F41, 0x00002D46, 0x0000033B,
+		0x00000549, 0x0000074A, 0x0000094B, 0x00000B4C, 0x00000D4D, 0x00000F4E, 0x00002D53, 0x00000348,
+		0x00000556, 0x00000757, 0x00000958, 0x00000B59, 0x00000D5A, 0x00000F5B, 0x00002D60, 0x00000355,
+		0x0000001D, 0x0003401E, 0x00003623, 0x00003624, 0x0000362C, 0x00001A2D, 0x00003506, 0x00000032,
+		0x0008001D, 0x0000001F, 0x00083623, 0x00000025, 0x0008362C, 0x0000362E, 0x00003513, 0x00400032,
+		0x0010001D, 0x0003801E, 0x00103623, 0x00003426, 0x0010362C, 0x00001C2D, 0x00003520, 0x00800032,
+		0x0018001D, 0x00000020, 0x00183623, 0x00003427, 0x0018362C, 0x0000002F, 0x0000352D, 0x00C00032,
+		0x0020001D, 0x0003C01E, 0x00203623, 0x0003C028, 0x0020362C, 0x00001E2D, 0x0000353A, 0x01000032,
+		0x0028001D, 0x00001E21, 0x00283623, 0x00000029, 0x0028362C, 0x00000030, 0x00003547, 0x01400032,
+		0x0030001D, 0x0003001E, 0x00303623, 0x0000002A, 0x0030362C, 0x0000182D, 0x00003554, 0x01800032,
+		0x0038001D, 0x00001E22, 0x00383623, 0x0000002B, 0x0038362C, 0x00000031, 0x00003561, 0x01C00032
+	},
+	{
+		0x00000000, 0x00037605, 0x000502ED, 0x00034008, 0x00008163, 0x0000816E, 0x0000B477, 0x0000000C,
+		0x00000001, 0x00041A06, 0x00006869, 0x00034009, 0x0000C164, 0x0000C16F, 0x0000F484, 0x0000000D,
+		0x00003402, 0x0003B605, 0x000542ED, 0x00038008, 0x00010165, 0x00010170, 0x00013491, 0x0000000E,
+		0x00003403, 0x00041C06, 0x00006A69, 0x00038009, 0x00014166, 0x00014171, 0x0001749E, 0x0000000F,
+		0x00003404, 0x00043605, 0x00066005, 0x00040008, 0x00020169, 0x00020174, 0x000234C5, 0x00000010,
+		0x00083404, 0x00042006, 0x00043205, 0x00040009, 0x0002416A, 0x00024175, 0x000274D2, 0x00000011,
+		0x00103404, 0x0004F605, 0x000642ED, 0x0004C008, 0x0805C00A, 0x0805C00B, 0x0805F4F9, 0x00000012,
+		0x00183404, 0x00042606, 0x00007269, 0x0004C009, 0x00004162, 0x0000416D, 0x0000746A, 0x00000013,
+		0x0000846C, 0x0000866D, 0x0000886E, 0x00008A6F, 0x00009072, 0x00009273, 0x0800AE76, 0x0000826B,
+		0x0000C479, 0x0000C67A, 0x0000C87B, 0x0000CA7C, 0x0000D07F, 0x0000D280, 0x0800EE83, 0x0000C278,
+		0x00010486, 0x00010687, 0x00010888, 0x00010A89, 0x0001108C, 0x0001128D, 0x08012E90, 0x00010285,
+		0x00014493, 0x00014694, 0x00014895, 0x00014A96, 0x00015099, 0x0001529A, 0x08016E9D, 0x00014292,
+		0x000204BA, 0x000206BB, 0x000208BC, 0x00020ABD, 0x000210C0, 0x000212C1, 0x0801AEAA, 0x000202B9,
+		0x000244C7, 0x000246C8, 0x000248C9, 0x00024ACA, 0x000250CD, 0x000252CE, 0x0801EEB7, 0x000242C6,
+		0x0805C4EE, 0x0805C6EF, 0x0805C8F0, 0x0805CAF1, 0x0805CCF2, 0x0805CEF3, 0x00000014, 0x0805C2ED,
+		0x0000445F, 0x00004660, 0x00004861, 0x00004A62, 0x00005065, 0x00005266, 0x08006E69, 0x0000425E,
+		0x000004FB, 0x000006FC, 0x000008FD, 0x00000AFE, 0x00001101, 0x00001302, 0x08002F05, 0x000002FA,
+		0x00000508, 0x00000709, 0x0000090A, 0x00000B0B, 0x0000110E, 0x0000130F, 0x08002F12, 0x00000307,
+		0x00000515, 0x00000716, 0x00000917, 0x00000B18, 0x0000111B, 0x0000131C, 0x08002F1F, 0x00000314,
+		0x00000522, 0x00000723, 0x00000924, 0x00000B25, 0x00001128, 0x00001329, 0x08002F2C, 0x00000321,
+		0x0000052F, 0x00000730, 0x00000931, 0x00000B32, 0x00001135, 0x00001336, 0x08002F39, 0x0000032E,
+		0x0000053C, 0x0000073D, 0x0000093E, 0x00000B3F, 0x00001142, 0x00001343, 0x08002F46, 0x0000033B,
+		0x00000549, 0x0000074A, 0x0000094B, 0x00000B4C, 0x0000114F, 0x00001350, 0x08002F53, 0x00000348,
+		0x00000556, 0x00000757, 0x00000958, 0x00000B59, 0x0000115C, 0x0000135D, 0x08002F60, 0x00000355,
+		0x0000001D, 0x0003401E, 0x00003623, 0x00003624, 0x0000362C, 0x00001A2D, 0x00003506, 0x00000032,
+		0x0008001D, 0x0000001F, 0x00083623, 0x08000025, 0x0008362C, 0x0000362E, 0x00003513, 0x00400032,
+		0x0010001D, 0x0003801E, 0x00103623, 0x00003426, 0x0010362C, 0x00001C2D, 0x00003520, 0x00800032,
+		0x0018001D, 0x00000020, 0x00183623, 0x00003427, 0x0018362C, 0x0000002F, 0x0000352D, 0x00C00032,
+		0x0020001D, 0x0004001E, 0x00203623, 0x00040028, 0x0020362C, 0x0000202D, 0x0000353A, 0x01000032,
+		0x0028001D, 0x00002021, 0x00283623, 0x00000029, 0x0028362C, 0x00000030, 0x00003547, 0x01400032,
+		0x0030001D, 0x0003001E, 0x00303623, 0x0000002A, 0x0030362C, 0x0000182D, 0x00003554, 0x01800032,
+		0x0038001D, 0x00002022, 0x00383623, 0x0000002B, 0x0038362C, 0x00000031, 0x00003561, 0x01C00032
+	},
+	{
+		0x00000000, 0x00037605, 0x000502ED, 0x00034008, 0x00008163, 0x0000816E, 0x0000B477, 0x0000000C,
+		0x00000001, 0x00045A06, 0x00006869, 0x00034009, 0x0000C164, 0x0000C16F, 0x0000F484, 0x0000000D,
+		0x00003402, 0x0003B605, 0x000542ED, 0x00038008, 0x00010165, 0x00010170, 0x00013491, 0x0000000E,
+		0x00003403, 0x00045C06, 0x00006A69, 0x00038009, 0x00014166, 0x00014171, 0x0001749E, 0x0000000F,
+		0x00003404, 0x00047605, 0x00066205, 0x00044008, 0x0002816B, 0x00028176, 0x0002B4DF, 0x00000010,
+		0x00083404, 0x00046206, 0x00047205, 0x00044009, 0x0002C16C, 0x0002C177, 0x0002F4EC, 0x00000011,
+		0x00103404, 0x0004F605, 0x000642ED, 0x0004C008, 0x0806000A, 0x0806000B, 0x080634F9, 0x00000012,
+		0x00183404, 0x00046606, 0x00007269, 0x0004C009, 0x00004162, 0x0000416D, 0x0000746A, 0x00000013,
+		0x0000846C, 0x0000866D, 0x0000886E, 0x00008A6F, 0x00009474, 0x00009675, 0x0800B076, 0x0000826B,
+		0x0000C479, 0x0000C67A, 0x0000C87B, 0x0000CA7C, 0x0000D481, 0x0000D682, 0x0800F083, 0x0000C278,
+		0x00010486, 0x00010687, 0x00010888, 0x00010A89, 0x0001148E, 0x0001168F, 0x08013090, 0x00010285,
+		0x00014493, 0x00014694, 0x00014895, 0x00014A96, 0x0001549B, 0x0001569C, 0x0801709D, 0x00014292,
+		0x000284D4, 0x000286D5, 0x000288D6, 0x00028AD7, 0x000294DC, 0x000296DD, 0x0801B0AA, 0x000282D3,
+		0x0002C4E1, 0x0002C6E2, 0x0002C8E3, 0x0002CAE4, 0x0002D4E9, 0x0002D6EA, 0x0801F0B7, 0x0002C2E0,
+		0x080604EE, 0x080606EF, 0x080608F0, 0x08060AF1, 0x08060CF2, 0x08060EF3, 0x00000014, 0x080602ED,
+		0x0000445F, 0x00004660, 0x00004861, 0x00004A62, 0x00005467, 0x00005668, 0x08007069, 0x0000425E,
+		0x000004FB, 0x000006FC, 0x000008FD, 0x00000AFE, 0x00001503, 0x00001704, 0x08003105, 0x000002FA,
+		0x00000508, 0x00000709, 0x0000090A, 0x00000B0B, 0x00001510, 0x00001711, 0x08003112, 0x00000307,
+		0x00000515, 0x00000716, 0x00000917, 0x00000B18, 0x0000151D, 0x0000171E, 0x0800311F, 0x00000314,
+		0x00000522, 0x00000723, 0x00000924, 0x00000B25, 0x0000152A, 0x0000172B, 0x0800312C, 0x00000321,
+		0x0000052F, 0x00000730, 0x00000931, 0x00000B32, 0x00001537, 0x00001738, 0x08003139, 0x0000032E,
+		0x0000053C, 0x0000073D, 0x0000093E, 0x00000B3F, 0x00001544, 0x00001745, 0x08003146, 0x0000033B,
+		0x00000549, 0x0000074A, 0x0000094B, 0x00000B4C, 0x00001551, 0x00001752, 0x08003153, 0x00000348,
+		0x00000556, 0x00000757, 0x00000958, 0x00000B59, 0x0000155E, 0x0000175F, 0x08003160, 0x00000355,
+		0x0000001D, 0x0003401E, 0x00003623, 0x00003624, 0x0000362C, 0x00001A2D, 0x00003506, 0x00000032,
+		0x0008001D, 0x0000001F, 0x00083623, 0x08000025, 0x0008362C, 0x0000362E, 0x00003513, 0x00400032,
+		0x0010001D, 0x0003801E, 0x00103623, 0x00003426, 0x0010362C, 0x00001C2D, 0x00003520, 0x00800032,
+		0x0018001D, 0x00000020, 0x00183623, 0x00003427, 0x0018362C, 0x0000002F, 0x0000352D, 0x00C00032,
+		0x0020001D, 0x0004401E, 0x00203623, 0x00044028, 0x0020362C, 0x0000222D, 0x0000353A, 0x01000032,
+		0x0028001D, 0x00002221, 0x00283623, 0x00000029, 0x0028362C, 0x00000030, 0x00003547, 0x01400032,
+		0x0030001D, 0x0003001E, 0x00303623, 0x0000002A, 0x0030362C, 0x0000182D, 0x00003554, 0x01800032,
+		0x0038001D, 0x00002222, 0x00383623, 0x0000002B, 0x0038362C, 0x00000031, 0x00003561, 0x01C00032
+	},
+	{
+		0x00008033, 0x0000C033, 0x00010033, 0x00014033, 0x00018033, 0x0001C033, 0x00058033, 0x00004033,
+		0x00008034, 0x0000C034, 0x00010034, 0x00014034, 0x00018034, 0x0001C034, 0x00058034, 0x00004034,
+		0x00008035, 0x0000C035, 0x00010035, 0x00014035, 0x00018035, 0x0001C035, 0x00058035, 0x00004035,
+		0x00008036, 0x0000C036, 0x00010036, 0x00014036, 0x00018036, 0x0001C036, 0x00058036, 0x00004036,
+		0x00008037, 0x0000C037, 0x00010037, 0x00014037, 0x00018037, 0x0001C037, 0x00058037, 0x00004037,
+		0x00008038, 0x0000C038, 0x00010038, 0x00014038, 0x00018038, 0x0001C038, 0x00058038, 0x00004038,
+		0x00008039, 0x0000C039, 0x00010039, 0x00014039, 0x00018039, 0x0001C039, 0x00058039, 0x00004039,
+		0x0000803A, 0x0000C03A, 0x0001003A, 0x0001403A, 0x0001803A, 0x0001C03A, 0x0005803A, 0x0000403A,
+		0x0008803B, 0x0008C03B, 0x0009003B, 0x0009403B, 0x0009803B, 0x0009C03B, 0x000D803B, 0x0008403B,
+		0x0010803B, 0x0010C03B, 0x0011003B, 0x0011403B, 0x0011803B, 0x0011C03B, 0x0015803B, 0x0010403B,
+		0x0020803B, 0x0020C03B, 0x0021003B, 0x0021403B, 0x0021803B, 0x0021C03B, 0x0025803B, 0x0020403B,
+		0x0040803B, 0x0040C03B, 0x0041003B, 0x0041403B, 0x0041803B, 0x0041C03B, 0x0045803B, 0x0040403B,
+		0x0080803B, 0x0080C03B, 0x0081003B, 0x0081403B, 0x0081803B, 0x0081C03B, 0x0085803B, 0x0080403B,
+		0x0100803B, 0x0100C03B, 0x0101003B, 0x0101403B, 0x0101803B, 0x0101C03B, 0x0105803B, 0x0100403B,
+		0x0200803B, 0x0200C03B, 0x0201003B, 0x0201403B, 0x0201803B, 0x0201C03B, 0x0205803B, 0x0200403B,
+		0x0400803B, 0x0400C03B, 0x0401003B, 0x0401403B, 0x0401803B, 0x0401C03B, 0x0405803B, 0x0400403B,
+		0x07F0803C, 0x07F0C03C, 0x07F1003C, 0x07F1403C, 0x07F1803C, 0x07F1C03C, 0x07F5803C, 0x07F0403C,
+		0x07E8803C, 0x07E8C03C, 0x07E9003C, 0x07E9403C, 0x07E9803C, 0x07E9C03C, 0x07ED803C, 0x07E8403C,
+		0x07D8803C, 0x07D8C03C, 0x07D9003C, 0x07D9403C, 0x07D9803C, 0x07D9C03C, 0x07DD803C, 0x07D8403C,
+		0x07B8803C, 0x07B8C03C, 0x07B9003C, 0x07B9403C, 0x07B9803C, 0x07B9C03C, 0x07BD803C, 0x07B8403C,
+		0x0778803C, 0x0778C03C, 0x0779003C, 0x0779403C, 0x0779803C, 0x0779C03C, 0x077D803C, 0x0778403C,
+		0x06F8803C, 0x06F8C03C, 0x06F9003C, 0x06F9403C, 0x06F9803C, 0x06F9C03C, 0x06FD803C, 0x06F8403C,
+		0x05F8803C, 0x05F8C03C, 0x05F9003C, 0x05F9403C, 0x05F9803C, 0x05F9C03C, 0x05FD803C, 0x05F8403C,
+		0x03F8803C, 0x03F8C03C, 0x03F9003C, 0x03F9403C, 0x03F9803C, 0x03F9C03C, 0x03FD803C, 0x03F8403C,
+		0x0008803D, 0x0008C03D, 0x0009003D, 0x0009403D, 0x0009803D, 0x0009C03D, 0x000D803D, 0x0008403D,
+		0x0010803D, 0x0010C03D, 0x0011003D, 0x0011403D, 0x0011803D, 0x0011C03D, 0x0015803D, 0x0010403D,
+		0x0020803D, 0x0020C03D, 0x0021003D, 0x0021403D, 0x0021803D, 0x0021C03D, 0x0025803D, 0x0020403D,
+		0x0040803D, 0x0040C03D, 0x0041003D, 0x0041403D, 0x0041803D, 0x0041C03D, 0x0045803D, 0x0040403D,
+		0x0080803D, 0x0080C03D, 0x0081003D, 0x0081403D, 0x0081803D, 0x0081C03D, 0x0085803D, 0x0080403D,
+		0x0100803D, 0x0100C03D, 0x0101003D, 0x0101403D, 0x0101803D, 0x0101C03D, 0x0105803D, 0x0100403D,
+		0x0200803D, 0x0200C03D, 0x0201003D, 0x0201403D, 0x0201803D, 0x0201C03D, 0x0205803D, 0x0200403D,
+		0x0400803D, 0x0400C03D, 0x0401003D, 0x0401403D, 0x0401803D, 0x0401C03D, 0x0405803D, 0x0400403D
+	},
+	{
+		0x00008033, 0x0000C033, 0x00010033, 0x00014033, 0x00020033, 0x00024033, 0x0805C033, 0x00004033,
+		0x00008034, 0x0000C034, 0x00010034, 0x00014034, 0x00020034, 0x00024034, 0x0805C034, 0x00004034,
+		0x00008035, 0x0000C035, 0x00010035, 0x00014035, 0x00020035, 0x00024035, 0x0805C035, 0x00004035,
+		0x00008036, 0x0000C036, 0x00010036, 0x00014036, 0x00020036, 0x00024036, 0x0805C036, 0x00004036,
+		0x00008037, 0x0000C037, 0x00010037, 0x00014037, 0x00020037, 0x00024037, 0x0805C037, 0x00004037,
+		0x00008038, 0x0000C038, 0x00010038, 0x00014038, 0x00020038, 0x00024038, 0x0805C038, 0x00004038,
+		0x00008039, 0x0000C039, 0x00010039, 0x00014039, 0x00020039, 0x00024039, 0x0805C039, 0x00004039,
+		0x0000803A, 0x0000C03A, 0x0001003A, 0x0001403A, 0x0002003A, 0x0002403A, 0x0805C03A, 0x0000403A,
+		0x0008803B, 0x0008C03B, 0x0009003B, 0x0009403B, 0x000A003B, 0x000A403B, 0x080DC03B, 0x0008403B,
+		0x0010803B, 0x0010C03B, 0x0011003B, 0x0011403B, 0x0012003B, 0x0012403B, 0x0815C03B, 0x0010403B,
+		0x0020803B, 0x0020C03B, 0x0021003B, 0x0021403B, 0x0022003B, 0x0022403B, 0x0825C03B, 0x0020403B,
+		0x0040803B, 0x0040C03B, 0x0041003B, 0x0041403B, 0x0042003B, 0x0042403B, 0x0845C03B, 0x0040403B,
+		0x0080803B, 0x0080C03B, 0x0081003B, 0x0081403B, 0x0082003B, 0x0082403B, 0x0885C03B, 0x0080403B,
+		0x0100803B, 0x0100C03B, 0x0101003B, 0x0101403B, 0x0102003B, 0x0102403B, 0x0905C03B, 0x0100403B,
+		0x0200803B, 0x0200C03B, 0x0201003B, 0x0201403B, 0x0202003B, 0x0202403B, 0x0A05C03B, 0x0200403B,
+		0x0400803B, 0x0400C03B, 0x0401003B, 0x0401403B, 0x0402003B, 0x0402403B, 0x0C05C03B, 0x0400403B,
+		0x07F0803C, 0x07F0C03C, 0x07F1003C, 0x07F1403C, 0x07F2003C, 0x07F2403C, 0x0FF5C03C, 0x07F0403C,
+		0x07E8803C, 0x07E8C03C, 0x07E9003C, 0x07E9403C, 0x07EA003C, 0x07EA403C, 0x0FEDC03C, 0x07E8403C,
+		0x07D8803C, 0x07D8C03C, 0x07D9003C, 0x07D9403C, 0x07DA003C, 0x07DA403C, 0x0FDDC03C, 0x07D8403C,
+		0x07B8803C, 0x07B8C03C, 0x07B9003C, 0x07B9403C, 0x07BA003C, 0x07BA403C, 0x0FBDC03C, 0x07B8403C,
+		0x0778803C, 0x0778C03C, 0x0779003C, 0x0779403C, 0x077A003C, 0x077A403C, 0x0F7DC03C, 0x0778403C,
+		0x06F8803C, 0x06F8C03C, 0x06F9003C, 0x06F9403C, 0x06FA003C, 0x06FA403C, 0x0EFDC03C, 0x06F8403C,
+		0x05F8803C, 0x05F8C03C, 0x05F9003C, 0x05F9403C, 0x05FA003C, 0x05FA403C, 0x0DFDC03C, 0x05F8403C,
+		0x03F8803C, 0x03F8C03C, 0x03F9003C, 0x03F9403C, 0x03FA003C, 0x03FA403C, 0x0BFDC03C, 0x03F8403C,
+		0x0008803D, 0x0008C03D, 0x0009003D, 0x0009403D, 0x000A003D, 0x000A403D, 0x080DC03D, 0x0008403D,
+		0x0010803D, 0x0010C03D, 0x0011003D, 0x0011403D, 0x0012003D, 0x0012403D, 0x0815C03D, 0x0010403D,
+		0x0020803D, 0x0020C03D, 0x0021003D, 0x0021403D, 0x0022003D, 0x0022403D, 0x0825C03D, 0x0020403D,
+		0x0040803D, 0x0040C03D, 0x0041003D, 0x0041403D, 0x0042003D, 0x0042403D, 0x0845C03D, 0x0040403D,
+		0x0080803D, 0x0080C03D, 0x0081003D, 0x0081403D, 0x0082003D, 0x0082403D, 0x0885C03D, 0x0080403D,
+		0x0100803D, 0x0100C03D, 0x0101003D, 0x0101403D, 0x0102003D, 0x0102403D, 0x0905C03D, 0x0100403D,
+		0x0200803D, 0x0200C03D, 0x0201003D, 0x0201403D, 0x0202003D, 0x0202403D, 0x0A05C03D, 0x0200403D,
+		0x0400803D, 0x0400C03D, 0x0401003D, 0x0401403D, 0x0402003D, 0x0402403D, 0x0C05C03D, 0x0400403D
+	},
+	{
+		0x00008033, 0x0000C033, 0x00010033, 0x00014033, 0x00028033, 0x0002C033, 0x08060033, 0x00004033,
+		0x00008034, 0x0000C034, 0x00010034, 0x00014034, 0x00028034, 0x0002C034, 0x08060034, 0x00004034,
+		0x00008035, 0x0000C035, 0x00010035, 0x00014035, 0x00028035, 0x0002C035, 0x08060035, 0x00004035,
+		0x00008036, 0x0000C036, 0x00010036, 0x00014036, 0x00028036, 0x0002C036, 0x08060036, 0x00004036,
+		0x00008037, 0x0000C037, 0x00010037, 0x00014037, 0x00028037, 0x0002C037, 0x08060037, 0x00004037,
+		0x00008038, 0x0000C038, 0x00010038, 0x00014038, 0x00028038, 0x0002C038, 0x08060038, 0x00004038,
+		0x00008039, 0x0000C039, 0x00010039, 0x00014039, 0x00028039, 0x0002C039, 0x08060039, 0x00004039,
+		0x0000803A, 0x0000C03A, 0x0001003A, 0x0001403A, 0x0002803A, 0x0002C03A, 0x0806003A, 0x0000403A,
+		0x0008803B, 0x0008C03B, 0x0009003B, 0x0009403B, 0x000A803B, 0x000AC03B, 0x080E003B, 0x0008403B,
+		0x0010803B, 0x0010C03B, 0x0011003B, 0x0011403B, 0x0012803B, 0x0012C03B, 0x0816003B, 0x0010403B,
+		0x0020803B, 0x0020C03B, 0x0021003B, 0x0021403B, 0x0022803B, 0x0022C03B, 0x0826003B, 0x0020403B,
+		0x0040803B, 0x0040C03B, 0x0041003B, 0x0041403B, 0x0042803B, 0x0042C03B, 0x0846003B, 0x0040403B,
+		0x0080803B, 0x0080C03B, 0x0081003B, 0x0081403B, 0x0082803B, 0x0082C03B, 0x0886003B, 0x0080403B,
+		0x0100803B, 0x0100C03B, 0x0101003B, 0x0101403B, 0x0102803B, 0x0102C03B, 0x0906003B, 0x0100403B,
+		0x0200803B, 0x0200C03B, 0x0201003B, 0x0201403B, 0x0202803B, 0x0202C03B, 0x0A06003B, 0x0200403B,
+		0x0400803B, 0x0400C03B, 0x0401003B, 0x0401403B, 0x0402803B, 0x0402C03B, 0x0C06003B, 0x0400403B,
+		0x07F0803C, 0x07F0C03C, 0x07F1003C, 0x07F1403C, 0x07F2803C, 0x07F2C03C, 0x0FF6003C, 0x07F0403C,
+		0x07E8803C, 0x07E8C03C, 0x07E9003C, 0x07E9403C, 0x07EA803C, 0x07EAC03C, 0x0FEE003C, 0x07E8403C,
+		0x07D8803C, 0x07D8C03C, 0x07D9003C, 0x07D9403C, 0x07DA803C, 0x07DAC03C, 0x0FDE003C, 0x07D8403C,
+		0x07B8803C, 0x07B8C03C, 0x07B9003C, 0x07B9403C, 0x07BA803C, 0x07BAC03C, 0x0FBE003C, 0x07B8403C,
+		0x0778803C, 0x0778C03C, 0x0779003C, 0x0779403C, 0x077A803C, 0x077AC03C, 0x0F7E003C, 0x0778403C,
+		0x06F8803C, 0x06F8C03C, 0x06F9003C, 0x06F9403C, 0x06FA803C, 0x06FAC03C, 0x0EFE003C, 0x06F8403C,
+		0x05F8803C, 0x05F8C03C, 0x05F9003C, 0x05F9403C, 0x05FA803C, 0x05FAC03C, 0x0DFE003C, 0x05F8403C,
+		0x03F8803C, 0x03F8C03C, 0x03F9003C, 0x03F9403C, 0x03FA803C, 0x03FAC03C, 0x0BFE003C, 0x03F8403C,
+		0x0008803D, 0x0008C03D, 0x0009003D, 0x0009403D, 0x000A803D, 0x000AC03D, 0x080E003D, 0x0008403D,
+		0x0010803D, 0x0010C03D, 0x0011003D, 0x0011403D, 0x0012803D, 0x0012C03D, 0x0816003D, 0x0010403D,
+		0x0020803D, 0x0020C03D, 0x0021003D, 0x0021403D, 0x0022803D, 0x0022C03D, 0x0826003D, 0x0020403D,
+		0x0040803D, 0x0040C03D, 0x0041003D, 0x0041403D, 0x0042803D, 0x0042C03D, 0x0846003D, 0x0040403D,
+		0x0080803D, 0x0080C03D, 0x0081003D, 0x0081403D, 0x0082803D, 0x0082C03D, 0x0886003D, 0x0080403D,
+		0x0100803D, 0x0100C03D, 0x0101003D, 0x0101403D, 0x0102803D, 0x0102C03D, 0x0906003D, 0x0100403D,
+		0x0200803D, 0x0200C03D, 0x0201003D, 0x0201403D, 0x0202803D, 0x0202C03D, 0x0A06003D, 0x0200403D,
+		0x0400803D, 0x0400C03D, 0x0401003D, 0x0401403D, 0x0402803D, 0x0402C03D, 0x0C06003D, 0x0400403D
+	},
+	{
+		0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+		0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+		0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+		0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+		0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+		0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+		0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+		0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+		0x0000803E, 0x00000440, 0x0003DA42, 0x00065A05, 0x00004244, 0x00000045, 0x00000047, 0x00000048,
+		0x0000C03E, 0x00000640, 0x0003DA43, 0x00037205, 0x00004244, 0x00000046, 0x00000047, 0x00000049,
+		0x0001003E, 0x00000840, 0x0003DC42, 0x00065C05, 0x00004244, 0x00000045, 0x00080047, 0x0000004A,
+		0x0001403E, 0x00000A40, 0x0003DC43, 0x0003B205, 0x00004244, 0x00000045, 0x00100047, 0x0000004B,
+		0x0001803E, 0x00000C40, 0x0003DE42, 0x00065E05, 0x00004244, 0x00000045, 0x00000047, 0x0000004C,
+		0x0001C03E, 0x00000E40, 0x0003DE43, 0x0003F205, 0x00004244, 0x00000045, 0x00000047, 0x0000004D,
+		0x0000003F, 0x00000041, 0x0003E642, 0x00066605, 0x00004244, 0x00000045, 0x00080047, 0x00000000,
+		0x0000403E, 0x00000240, 0x0003E643, 0x0004F205, 0x00004244, 0x00000045, 0x00100047, 0x00000000,
+		0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+		0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+		0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+		0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+		0x0000004E, 0x00000052, 0x00000056, 0x0000005A, 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+		0x0000004F, 0x00000053, 0x00000057, 0x0000005B, 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+		0x00000050, 0x00000054, 0x00000058, 0x0000005C, 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+		0x00000051, 0x00000055, 0x00000059, 0x0000005D, 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+		0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+		0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+		0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+		0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+		0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+		0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+		0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+		0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000
+	}
+};
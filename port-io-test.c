@@ -0,0 +1,410 @@
+/* Runs short programs which use the I/O instructions, and checks the registers, flags, memory, and cycles that they end with,
+   along with every port access that they make and which handler it went to. The instruction exerciser cannot check most of
+   this, as there is no way for a Z80 program to see how many cycles it took, or which of the host's handlers a port went to.
+   Each test is run several times, so that the engines which cache or compile code do so. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "clowncommon/clowncommon.h"
+
+#include "engines.h"
+#include "interpreter.h"
+
+/* Enough for the JIT to compile the programs. */
+#define REPEATS 20
+/* Each test's program is loaded at its own address, so that the caches never need invalidating. */
+#define PROGRAM_ADDRESS(INDEX) (0x1000 + (INDEX) * 0x10)
+#define MEMORY_ADDRESS 0x8000
+#define MAXIMUM_INSTRUCTIONS 0x40
+/* Bits 3 and 5 of the flags are not emulated. */
+#define FLAG_MASK 0xD7
+
+typedef enum Ports
+{
+	PORTS_NONE,     /* No port map, and no catch-all callbacks. */
+	PORTS_MAP,      /* The 8-bit table, with a handler for port 34h, and the catch-all callbacks for the rest. */
+	PORTS_FULL,     /* The 16-bit table, with a handler for port 1234h, and the catch-all callbacks for the rest. */
+	PORTS_MAP_ONLY  /* As 'PORTS_MAP', but without the catch-all callbacks. */
+} Ports;
+
+typedef struct Registers
+{
+	cc_u8l a, f, b, c, d, e, h, l;
+} Registers;
+
+/* 'handler' is 'M' for the port map's handler, or 'C' for the catch-all callbacks. 'direction' is 'R' or 'W'. */
+typedef struct Access
+{
+	char handler;
+	char direction;
+	cc_u16l port;
+	cc_u8l value;
+} Access;
+
+typedef struct TestCase
+{
+	const char *name;
+	Ports ports;
+	unsigned char program[6];
+	size_t program_size;
+	Registers before, after;
+	cc_u8l memory_before[4], memory_after[4];
+	/* Returned by the reads, in order, whichever handler they go to. */
+	cc_u8l inputs[3];
+	unsigned long cycles;
+	Access accesses[3];
+	unsigned int total_accesses;
+} TestCase;
+
+static const TestCase test_cases[] = {
+	/* The upper 8 bits of the port come from 'A'. The flags are left alone. */
+	{"IN A,(n)", PORTS_MAP, {0xDB, 0x34}, 2,
+		{0x12, 0xD7, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+		{0x5A, 0xD7, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+		{0, 0, 0, 0}, {0, 0, 0, 0}, {0x5A}, 11,
+		{{'M', 'R', 0x1234, 0x5A}}, 1},
+	/* Z and P are set, H and N are cleared, and C is kept. */
+	{"IN B,(C) reading 00h", PORTS_MAP, {0xED, 0x40}, 2,
+		{0x00, 0xD7, 0x12, 0x34, 0x00, 0x00, 0x00, 0x00},
+		{0x00, 0x45, 0x00, 0x34, 0x00, 0x00, 0x00, 0x00},
+		{0, 0, 0, 0}, {0, 0, 0, 0}, {0x00}, 12,
+		{{'M', 'R', 0x1234, 0x00}}, 1},
+	{"IN D,(C) reading 80h", PORTS_MAP, {0xED, 0x50}, 2,
+		{0x00, 0x00, 0x12, 0x34, 0x00, 0x00, 0x00, 0x00},
+		{0x00, 0x80, 0x12, 0x34, 0x80, 0x00, 0x00, 0x00},
+		{0, 0, 0, 0}, {0, 0, 0, 0}, {0x80}, 12,
+		{{'M', 'R', 0x1234, 0x80}}, 1},
+	{"IN (C) keeping only the flags", PORTS_MAP, {0xED, 0x70}, 2,
+		{0x00, 0x01, 0x12, 0x34, 0x00, 0x00, 0x00, 0x00},
+		{0x00, 0x05, 0x12, 0x34, 0x00, 0x00, 0x00, 0x00},
+		{0, 0, 0, 0}, {0, 0, 0, 0}, {0x03}, 12,
+		{{'M', 'R', 0x1234, 0x03}}, 1},
+	{"IN A,(C) reading 7Fh", PORTS_MAP, {0xED, 0x78}, 2,
+		{0x00, 0xD6, 0x12, 0x34, 0x00, 0x00, 0x00, 0x00},
+		{0x7F, 0x00, 0x12, 0x34, 0x00, 0x00, 0x00, 0x00},
+		{0, 0, 0, 0}, {0, 0, 0, 0}, {0x7F}, 12,
+		{{'M', 'R', 0x1234, 0x7F}}, 1},
+	{"OUT (n),A", PORTS_MAP, {0xD3, 0x34}, 2,
+		{0x56, 0xD7, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+		{0x56, 0xD7, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+		{0, 0, 0, 0}, {0, 0, 0, 0}, {0}, 11,
+		{{'M', 'W', 0x5634, 0x56}}, 1},
+	{"OUT (C),E", PORTS_MAP, {0xED, 0x59}, 2,
+		{0x00, 0xD7, 0x12, 0x34, 0x00, 0x99, 0x00, 0x00},
+		{0x00, 0xD7, 0x12, 0x34, 0x00, 0x99, 0x00, 0x00},
+		{0, 0, 0, 0}, {0, 0, 0, 0}, {0}, 12,
+		{{'M', 'W', 0x1234, 0x99}}, 1},
+	/* The port uses 'B' from before it is decremented. F0h + (34h + 1) carries, and B reaching 0 sets Z. */
+	{"INI", PORTS_MAP, {0xED, 0xA2}, 2,
+		{0x00, 0x00, 0x01, 0x34, 0x00, 0x00, 0x80, 0x00},
+		{0x00, 0x57, 0x00, 0x34, 0x00, 0x00, 0x80, 0x01},
+		{0, 0, 0, 0}, {0xF0, 0, 0, 0}, {0xF0}, 16,
+		{{'M', 'R', 0x0134, 0xF0}}, 1},
+	/* 7Fh + (00h - 1) carries. */
+	{"IND", PORTS_MAP, {0xED, 0xAA}, 2,
+		{0x00, 0x00, 0x80, 0x00, 0x00, 0x00, 0x80, 0x03},
+		{0x00, 0x11, 0x7F, 0x00, 0x00, 0x00, 0x80, 0x02},
+		{0, 0, 0, 0}, {0, 0, 0, 0x7F}, {0x7F}, 16,
+		{{'C', 'R', 0x8000, 0x7F}}, 1},
+	/* The port uses 'B' from after it is decremented. The carry is worked out from the byte plus 'L' after it is incremented. */
+	{"OUTI", PORTS_MAP, {0xED, 0xA3}, 2,
+		{0x00, 0x00, 0x10, 0x98, 0x00, 0x00, 0x80, 0x02},
+		{0x00, 0x06, 0x0F, 0x98, 0x00, 0x00, 0x80, 0x03},
+		{0, 0, 0xC3, 0}, {0, 0, 0xC3, 0}, {0}, 16,
+		{{'C', 'W', 0x0F98, 0xC3}}, 1},
+	/* FEh + 02h carries. */
+	{"OUTD", PORTS_MAP, {0xED, 0xAB}, 2,
+		{0x00, 0x00, 0x01, 0x10, 0x00, 0x00, 0x80, 0x03},
+		{0x00, 0x57, 0x00, 0x10, 0x00, 0x00, 0x80, 0x02},
+		{0, 0, 0, 0xFE}, {0, 0, 0, 0xFE}, {0}, 16,
+		{{'C', 'W', 0x0010, 0xFE}}, 1},
+	/* 21 cycles for every repeat, and 16 for the last one. */
+	{"INIR", PORTS_MAP, {0xED, 0xB2}, 2,
+		{0x00, 0x00, 0x03, 0x34, 0x00, 0x00, 0x80, 0x00},
+		{0x00, 0x44, 0x00, 0x34, 0x00, 0x00, 0x80, 0x03},
+		{0, 0, 0, 0}, {0x11, 0x22, 0x33, 0}, {0x11, 0x22, 0x33}, 21 * 2 + 16,
+		{{'M', 'R', 0x0334, 0x11}, {'M', 'R', 0x0234, 0x22}, {'M', 'R', 0x0134, 0x33}}, 3},
+	{"OTIR", PORTS_MAP, {0xED, 0xB3}, 2,
+		{0x00, 0x00, 0x02, 0x30, 0x00, 0x00, 0x80, 0x00},
+		{0x00, 0x44, 0x00, 0x30, 0x00, 0x00, 0x80, 0x02},
+		{0x80, 0x01, 0, 0}, {0x80, 0x01, 0, 0}, {0}, 21 + 16,
+		{{'C', 'W', 0x0130, 0x80}, {'C', 'W', 0x0030, 0x01}}, 2},
+	/* IN A,(C), LD B,ABh, OUT (C),A: the 8-bit table sends both ports to the same handler, but the 16-bit table does not. */
+	{"8-bit dispatch", PORTS_MAP, {0xED, 0x78, 0x06, 0xAB, 0xED, 0x79}, 6,
+		{0x00, 0x00, 0x12, 0x34, 0x00, 0x00, 0x00, 0x00},
+		{0x9C, 0x84, 0xAB, 0x34, 0x00, 0x00, 0x00, 0x00},
+		{0, 0, 0, 0}, {0, 0, 0, 0}, {0x9C}, 12 + 7 + 12,
+		{{'M', 'R', 0x1234, 0x9C}, {'M', 'W', 0xAB34, 0x9C}}, 2},
+	{"16-bit dispatch", PORTS_FULL, {0xED, 0x78, 0x06, 0xAB, 0xED, 0x79}, 6,
+		{0x00, 0x00, 0x12, 0x34, 0x00, 0x00, 0x00, 0x00},
+		{0x9C, 0x84, 0xAB, 0x34, 0x00, 0x00, 0x00, 0x00},
+		{0, 0, 0, 0}, {0, 0, 0, 0}, {0x9C}, 12 + 7 + 12,
+		{{'M', 'R', 0x1234, 0x9C}, {'C', 'W', 0xAB34, 0x9C}}, 2},
+	/* IN A,(n), IN B,(C), OUT (C),A: reads return FFh, as nothing is driving the data bus, and writes go nowhere. */
+	{"Nothing mapped", PORTS_NONE, {0xDB, 0x34, 0xED, 0x40, 0xED, 0x79}, 6,
+		{0x12, 0x01, 0x00, 0x34, 0x00, 0x00, 0x00, 0x00},
+		{0xFF, 0x85, 0xFF, 0x34, 0x00, 0x00, 0x00, 0x00},
+		{0, 0, 0, 0}, {0, 0, 0, 0}, {0}, 11 + 12 + 12,
+		{{0}}, 0},
+	/* IN A,(n), OUT (n),A: the port map's handler is still given the whole port. */
+	{"No handler for the port", PORTS_MAP_ONLY, {0xDB, 0x35, 0xD3, 0x34}, 4,
+		{0x12, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+		{0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+		{0, 0, 0, 0}, {0, 0, 0, 0}, {0}, 11 + 11,
+		{{'M', 'W', 0xFF34, 0xFF}}, 1}
+};
+
+static cc_u8l ram[0x10000];
+static ClownZ80_PortMap port_map;
+static ClownZ80_PortHandler full_handlers[0x10000];
+static const char port_map_handler = 'M';
+static const char catch_all_handler = 'C';
+
+static const cc_u8l *inputs;
+static unsigned int total_inputs;
+static Access accesses[MAXIMUM_INSTRUCTIONS];
+static unsigned int total_accesses;
+
+static cc_u16f ReadCallback(void* const user_data, const cc_u16f address)
+{
+	(void)user_data;
+
+	return ram[address];
+}
+
+static void WriteCallback(void* const user_data, const cc_u16f address, const cc_u16f value)
+{
+	(void)user_data;
+
+	ram[address] = value;
+}
+
+static void LogCallback(void* const user_data, const char* const format, ...)
+{
+	(void)user_data;
+	(void)format;
+}
+
+static void LogAccess(const void* const user_data, const char direction, const cc_u16f port, const cc_u16f value)
+{
+	if (total_accesses != CC_COUNT_OF(accesses))
+	{
+		Access* const access = &accesses[total_accesses];
+
+		access->handler = *(const char*)user_data;
+		access->direction = direction;
+		access->port = port;
+		access->value = value;
+	}
+
+	++total_accesses;
+}
+
+static cc_u16f PortReadCallback(void* const user_data, const cc_u16f port)
+{
+	const cc_u16f value = inputs[total_inputs++ % 3];
+
+	LogAccess(user_data, 'R', port, value);
+
+	return value;
+}
+
+static void PortWriteCallback(void* const user_data, const cc_u16f port, const cc_u16f value)
+{
+	LogAccess(user_data, 'W', port, value);
+}
+
+static void SetUpPorts(ClownZ80_ReadAndWriteCallbacks* const callbacks, const Ports ports)
+{
+	callbacks->port_map = NULL;
+	callbacks->port_read = NULL;
+	callbacks->port_write = NULL;
+
+	switch (ports)
+	{
+		case PORTS_NONE:
+			break;
+
+		case PORTS_MAP:
+		case PORTS_MAP_ONLY:
+			ClownZ80_PortMap_Initialise(&port_map, NULL);
+			ClownZ80_PortMap_SetPorts(&port_map, 0x34, 1, PortReadCallback, PortWriteCallback, &port_map_handler);
+			callbacks->port_map = &port_map;
+			break;
+
+		case PORTS_FULL:
+			ClownZ80_PortMap_Initialise(&port_map, full_handlers);
+			ClownZ80_PortMap_SetPorts(&port_map, 0x1234, 1, PortReadCallback, PortWriteCallback, &port_map_handler);
+			callbacks->port_map = &port_map;
+			break;
+	}
+
+	if (ports == PORTS_MAP || ports == PORTS_FULL)
+	{
+		callbacks->port_read = PortReadCallback;
+		callbacks->port_write = PortWriteCallback;
+	}
+}
+
+static cc_bool CompareValue(const TestCase* const test_case, const char* const name, const unsigned long expected, const unsigned long got)
+{
+	if (expected == got)
+		return cc_true;
+
+	fprintf(stdout, "%s: %-10s expected %02lX, got %02lX\n", test_case->name, name, expected, got);
+	return cc_false;
+}
+
+static cc_bool RunTestCase(const unsigned int index, const ClownZ80_Engine engine, ClownZ80_ReadAndWriteCallbacks* const callbacks)
+{
+	const TestCase* const test_case = &test_cases[index];
+	const cc_u16f end_address = PROGRAM_ADDRESS(index) + test_case->program_size;
+	ClownZ80_State state;
+	unsigned long cycles;
+	unsigned int i;
+	cc_bool match;
+
+	memset(&state, 0, sizeof(state));
+	ClownZ80_State_Initialise(&state);
+	state.program_counter = PROGRAM_ADDRESS(index);
+	state.a = test_case->before.a;
+	state.f = test_case->before.f;
+	state.b = test_case->before.b;
+	state.c = test_case->before.c;
+	state.d = test_case->before.d;
+	state.e = test_case->before.e;
+	state.h = test_case->before.h;
+	state.l = test_case->before.l;
+
+	memcpy(&ram[MEMORY_ADDRESS], test_case->memory_before, sizeof(test_case->memory_before));
+
+	SetUpPorts(callbacks, test_case->ports);
+	inputs = test_case->inputs;
+	total_inputs = 0;
+	total_accesses = 0;
+
+	/* A budget of 1 cycle makes every engine stop after each instruction, or each repeat of a block instruction. */
+	cycles = 0;
+
+	for (i = 0; i < MAXIMUM_INSTRUCTIONS && state.program_counter != end_address; ++i)
+	{
+		if (engine == CLOWNZ80_ENGINE_STEP)
+			cycles += ClownZ80_DoInstruction(&state, callbacks);
+		else
+			cycles += ClownZ80_Run(&state, callbacks, 1);
+	}
+
+	match = CompareValue(test_case, "PC", end_address, state.program_counter);
+	match &= CompareValue(test_case, "cycles", test_case->cycles, cycles);
+
+#define COMPARE(FIELD) match &= CompareValue(test_case, #FIELD, test_case->after.FIELD, state.FIELD)
+	COMPARE(a);
+	COMPARE(b);
+	COMPARE(c);
+	COMPARE(d);
+	COMPARE(e);
+	COMPARE(h);
+	COMPARE(l);
+#undef COMPARE
+
+	match &= CompareValue(test_case, "f", test_case->after.f & FLAG_MASK, state.f & FLAG_MASK);
+
+	for (i = 0; i < CC_COUNT_OF(test_case->memory_after); ++i)
+		match &= CompareValue(test_case, "memory", test_case->memory_after[i], ram[MEMORY_ADDRESS + i]);
+
+	if (total_accesses != test_case->total_accesses)
+	{
+		fprintf(stdout, "%s: expected %u port accesses, got %u\n", test_case->name, test_case->total_accesses, total_accesses);
+		match = cc_false;
+	}
+	else
+	{
+		for (i = 0; i < total_accesses; ++i)
+		{
+			const Access* const expected = &test_case->accesses[i];
+			const Access* const got = &accesses[i];
+
+			if (expected->handler != got->handler || expected->direction != got->direction || expected->port != got->port || expected->value != got->value)
+			{
+				fprintf(stdout, "%s: port access %u: expected %c %c %04X %02X, got %c %c %04X %02X\n", test_case->name, i,
+					expected->handler, expected->direction, (unsigned int)expected->port, (unsigned int)expected->value,
+					got->handler, got->direction, (unsigned int)got->port, (unsigned int)got->value);
+				match = cc_false;
+			}
+		}
+	}
+
+	return match;
+}
+
+int main(const int argc, char** const argv)
+{
+	static ClownZ80_EngineResources engine_resources;
+
+	ClownZ80_ReadAndWriteCallbacks callbacks;
+	ClownZ80_Engine engine = CLOWNZ80_ENGINE_STEP;
+	unsigned int total_failed, i;
+	int argument;
+
+	for (argument = 1; argument < argc; ++argument)
+	{
+		if (strcmp(argv[argument], "--engine") == 0 && argument + 1 < argc)
+		{
+			engine = ClownZ80_Engine_FromName(argv[++argument]);
+		}
+		else
+		{
+			engine = CLOWNZ80_TOTAL_ENGINES;
+			break;
+		}
+	}
+
+	if (engine == CLOWNZ80_TOTAL_ENGINES)
+	{
+		fputs("Usage: clownz80-port-io-test [--engine " CLOWNZ80_ENGINE_NAMES "]\n", stderr);
+		fputs("  Defaults to 'step'.\n", stderr);
+		return EXIT_FAILURE;
+	}
+
+	for (i = 0; i < CC_COUNT_OF(test_cases); ++i)
+		memcpy(&ram[PROGRAM_ADDRESS(i)], test_cases[i].program, test_cases[i].program_size);
+
+	ClownZ80_ReadAndWriteCallbacks_Initialise(&callbacks);
+	callbacks.read = ReadCallback;
+	callbacks.write = WriteCallback;
+	callbacks.log = LogCallback;
+	/* Given to the catch-all callbacks. */
+	callbacks.user_data = &catch_all_handler;
+
+	if (!ClownZ80_EngineResources_Initialise(&engine_resources, engine, &callbacks, ram, 0x10000))
+	{
+		fputs("The JIT is not available on this platform.\n", stderr);
+		return EXIT_FAILURE;
+	}
+
+	total_failed = 0;
+
+	for (i = 0; i < CC_COUNT_OF(test_cases); ++i)
+	{
+		unsigned int repeat;
+
+		/* Only the first failure of each test is reported. */
+		for (repeat = 0; repeat < REPEATS; ++repeat)
+		{
+			if (!RunTestCase(i, engine, &callbacks))
+			{
+				fprintf(stdout, "%s: failed on run %u.\n", test_cases[i].name, repeat + 1);
+				++total_failed;
+				break;
+			}
+		}
+	}
+
+	ClownZ80_EngineResources_Deinitialise(&engine_resources);
+
+	fprintf(stdout, "%u tests run, %u failed, using the '%s' engine.\n", (unsigned int)CC_COUNT_OF(test_cases), total_failed, ClownZ80_Engine_GetName(engine));
+
+	return total_failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,94 @@
+#include "profiler-report.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "clowncommon/clowncommon.h"
+
+#include "disassembler.h"
+
+typedef struct Report
+{
+	cc_u16f (*read_callback)(void *user_data, cc_u16f address);
+	void *user_data;
+	cc_u16f address;
+	/* The disassembler prints a line in pieces, which are gathered here so that they can be passed on in one go. */
+	char line[0x100];
+	size_t line_length;
+} Report;
+
+static unsigned char DisassemblerReadCallback(void* const user_data)
+{
+	Report* const report = (Report*)user_data;
+	const unsigned char value = report->read_callback(report->user_data, report->address) & 0xFF;
+
+	report->address = (report->address + 1) & 0xFFFF;
+
+	return value;
+}
+
+static void DisassemblerPrintCallback(void* const user_data, const char* const format, ...)
+{
+	Report* const report = (Report*)user_data;
+	char buffer[0x80];
+	size_t length;
+	va_list args;
+
+	/* The pieces are short: the longest is an address, printed as 8 digits. */
+	va_start(args, format);
+	vsprintf(buffer, format, args);
+	va_end(args);
+
+	for (length = 0; buffer[length] != '\0' && buffer[length] != '\n'; ++length);
+
+	length = CC_MIN(length, sizeof(report->line) - 1 - report->line_length);
+	memcpy(&report->line[report->line_length], buffer, length);
+	report->line_length += length;
+}
+
+cc_bool ClownZ80_Profiler_PrintHotSpots(const ClownZ80_Profiler* const profiler, const size_t maximum_blocks, cc_u16f (* const read_callback)(void *user_data, cc_u16f address), const ClownZ80_Profiler_PrintCallback print_callback, const void* const user_data)
+{
+	ClownZ80_ProfilerBlock* const blocks = (ClownZ80_ProfilerBlock*)malloc(sizeof(*blocks) * CC_MAX(maximum_blocks, 1));
+	Report report;
+	double total_cycles;
+	size_t total_blocks, i;
+
+	if (blocks == NULL)
+		return cc_false;
+
+	report.read_callback = read_callback;
+	report.user_data = (void*)user_data;
+
+	total_blocks = ClownZ80_Profiler_GetHotBlocks(profiler, blocks, maximum_blocks, &total_cycles);
+
+	for (i = 0; i < total_blocks; ++i)
+	{
+		const ClownZ80_ProfilerBlock* const block = &blocks[i];
+		cc_u32f address;
+
+		print_callback((void*)user_data, "%sBlock %lu: %04lX-%04lX, %.2f%% of cycles (%.0f cycles, executed %.0f times)\n",
+			i == 0 ? "" : "\n", (unsigned long)i + 1, (unsigned long)block->address, (unsigned long)(block->address + block->length - 1) & 0xFFFF,
+			total_cycles == 0.0 ? 0.0 : block->cycles / total_cycles * 100.0, block->cycles, block->executions);
+		print_callback((void*)user_data, "      Executions          Cycles  Cycles%%  Instruction\n");
+
+		for (address = block->address; address < block->address + block->length; address += profiler->address_lengths[address])
+		{
+			report.address = address;
+			report.line_length = 0;
+
+			ClownZ80_Disassemble(address, 1, DisassemblerReadCallback, DisassemblerPrintCallback, &report);
+
+			report.line[report.line_length] = '\0';
+
+			print_callback((void*)user_data, "  %14.0f  %14.0f  %6.2f%%  %s\n", profiler->address_executions[address], profiler->address_cycles[address],
+				total_cycles == 0.0 ? 0.0 : profiler->address_cycles[address] / total_cycles * 100.0, report.line);
+		}
+	}
+
+	free(blocks);
+
+	return cc_true;
+}
+
@@ -0,0 +1,18 @@
+#ifndef CLOWNZ80_PROFILER_REPORT_H
+#define CLOWNZ80_PROFILER_REPORT_H
+
+#include <stddef.h>
+
+#include "clowncommon/clowncommon.h"
+
+#include "interpreter.h"
+
+#ifdef CLOWNZ80_PROFILER
+
+/* Prints up to 'maximum_blocks' of the blocks which took the most cycles, most first, with each of their instructions disassembled.
+   'read_callback' is used to read the instructions, so it should be free of side-effects. Returns cc_false if memory ran out. */
+cc_bool ClownZ80_Profiler_PrintHotSpots(const ClownZ80_Profiler *profiler, size_t maximum_blocks, cc_u16f (*read_callback)(void *user_data, cc_u16f address), ClownZ80_Profiler_PrintCallback print_callback, const void *user_data);
+
+#endif
+
+#endif /* CLOWNZ80_PROFILER_REPORT_H */
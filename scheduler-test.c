@@ -0,0 +1,302 @@
+/* Runs many instances through the scheduler at once, each with its own memory and engine resources, and checks that every one
+   of them ends up exactly where a reference which executes one instruction at a time on this thread does. As the scheduler
+   carries the cycles that a slice overshot by over to the next one, an instance should stop at the first instruction which
+   takes it to or past its budget, no matter how the budget was sliced up or which thread ran each slice. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "clowncommon/clowncommon.h"
+
+#include "engines.h"
+#include "interpreter.h"
+#include "scheduler.h"
+
+#define TOTAL_JOBS 24
+#define TOTAL_THREADS 4
+/* Fewer than the number of jobs, so that submitting has to be held off until some jobs are collected. */
+#define MAXIMUM_JOBS 6
+/* Not a multiple of any instruction's length, so that slices end part-way through instructions. */
+#define SLICE_CYCLES 10007UL
+/* Every job is given a different budget, so that they finish at different times and in different places. */
+#define BASE_CYCLES 1000000UL
+#define EXTRA_CYCLES_PER_JOB 12347UL
+
+typedef struct Job
+{
+	ClownZ80_SchedulerJob scheduler_job;
+	ClownZ80_Instance instance;
+	ClownZ80_EngineResources engine_resources;
+	unsigned int index;
+	unsigned long budget;
+	unsigned long total_slices;
+	cc_u8l ram[0x10000];
+} Job;
+
+typedef struct Reference
+{
+	ClownZ80_State state;
+	cc_u8l ram[0x10000];
+} Reference;
+
+/* A mix of arithmetic, memory accesses, block copies, and subroutine calls, which runs forever. */
+static const unsigned char program[] = {
+	0x31, 0x00, 0xF0,       /* 0000: LD SP,F000h */
+	0x21, 0x00, 0x40,       /* 0003: LD HL,4000h */
+	0x06, 0x00,             /* 0006: LD B,0 */
+	0xA8,                   /* 0008: XOR B */
+	0x07,                   /* 0009: RLCA */
+	0xAE,                   /* 000A: XOR (HL) */
+	0x77,                   /* 000B: LD (HL),A */
+	0x23,                   /* 000C: INC HL */
+	0x10, 0xF9,             /* 000D: DJNZ 0008h */
+	0xF5,                   /* 000F: PUSH AF */
+	0x21, 0x00, 0x40,       /* 0010: LD HL,4000h */
+	0x11, 0x00, 0x41,       /* 0013: LD DE,4100h */
+	0x01, 0x00, 0x01,       /* 0016: LD BC,0100h */
+	0xED, 0xB0,             /* 0019: LDIR */
+	0xF1,                   /* 001B: POP AF */
+	0xCD, 0x22, 0x00,       /* 001C: CALL 0022h */
+	0x18, 0xE2,             /* 001F: JR 0003h */
+	0xDD, 0x21, 0x00, 0x41, /* 0022: LD IX,4100h */
+	0xDD, 0x86, 0x07,       /* 0026: ADD A,(IX+7) */
+	0xC9                    /* 0029: RET */
+};
+
+static Reference reference;
+
+static cc_u16f ReadCallback(void* const user_data, const cc_u16f address)
+{
+	cc_u8l* const ram = (cc_u8l*)user_data;
+
+	return ram[address];
+}
+
+static void WriteCallback(void* const user_data, const cc_u16f address, const cc_u16f value)
+{
+	cc_u8l* const ram = (cc_u8l*)user_data;
+
+	ram[address] = value;
+}
+
+static void LogCallback(void* const user_data, const char* const format, ...)
+{
+	(void)user_data;
+	(void)format;
+}
+
+static cc_bool SliceCallback(ClownZ80_SchedulerJob* const scheduler_job)
+{
+	Job* const job = (Job*)scheduler_job->user_data;
+
+	++job->total_slices;
+
+	return cc_true;
+}
+
+static void InitialiseState(ClownZ80_State* const state, cc_u8l* const ram, const unsigned int index)
+{
+	/* The registers are left as they are by a reset, like on a real Z80, so clear them so that the reference starts off the same. */
+	memset(state, 0, sizeof(*state));
+	ClownZ80_State_Initialise(state);
+	/* Give each job a different seed. */
+	state->a = (index * 0x25) & 0xFF;
+
+	memset(ram, 0, 0x10000);
+	memcpy(ram, program, sizeof(program));
+}
+
+static Job* CreateJob(const ClownZ80_Engine engine, const unsigned int index)
+{
+	Job* const job = (Job*)malloc(sizeof(Job));
+
+	if (job != NULL)
+	{
+		ClownZ80_ReadAndWriteCallbacks callbacks;
+
+		ClownZ80_ReadAndWriteCallbacks_Initialise(&callbacks);
+		callbacks.read = ReadCallback;
+		callbacks.write = WriteCallback;
+		callbacks.log = LogCallback;
+		callbacks.user_data = job->ram;
+
+		if (!ClownZ80_EngineResources_Initialise(&job->engine_resources, engine, &callbacks, job->ram, 0x10000))
+		{
+			free(job);
+			return NULL;
+		}
+
+		ClownZ80_Instance_Initialise(&job->instance, &callbacks);
+		InitialiseState(&job->instance.state, job->ram, index);
+
+		job->index = index;
+		job->budget = BASE_CYCLES + index * EXTRA_CYCLES_PER_JOB;
+		job->total_slices = 0;
+
+		job->scheduler_job.instance = &job->instance;
+		job->scheduler_job.cycles_remaining = job->budget;
+		job->scheduler_job.slice_callback = SliceCallback;
+		job->scheduler_job.user_data = job;
+	}
+
+	return job;
+}
+
+static void DestroyJob(Job* const job)
+{
+	ClownZ80_EngineResources_Deinitialise(&job->engine_resources);
+	free(job);
+}
+
+static void RunReference(const unsigned int index, const unsigned long budget)
+{
+	ClownZ80_ReadAndWriteCallbacks callbacks;
+
+	ClownZ80_ReadAndWriteCallbacks_Initialise(&callbacks);
+	callbacks.read = ReadCallback;
+	callbacks.write = WriteCallback;
+	callbacks.log = LogCallback;
+	callbacks.user_data = reference.ram;
+
+	InitialiseState(&reference.state, reference.ram, index);
+
+	while (reference.state.total_cycles < budget)
+		ClownZ80_DoInstruction(&reference.state, &callbacks);
+}
+
+static cc_bool CompareValue(const Job* const job, const char* const name, const unsigned long reference_value, const unsigned long job_value)
+{
+	if (reference_value == job_value)
+		return cc_true;
+
+	fprintf(stdout, "Job %u: %-20s reference %lX, job %lX\n", job->index, name, reference_value, job_value);
+	return cc_false;
+}
+
+static cc_bool CheckJob(const Job* const job)
+{
+	const ClownZ80_State* const state = &job->instance.state;
+	/* The callback is not called after the last slice, as the job has already finished by then. */
+	const unsigned long expected_slices = (job->budget + SLICE_CYCLES - 1) / SLICE_CYCLES - 1;
+	cc_bool match = cc_true;
+
+	RunReference(job->index, job->budget);
+
+	match &= CompareValue(job, "cycles_remaining", 0, job->scheduler_job.cycles_remaining);
+	match &= CompareValue(job, "slice callbacks", expected_slices, job->total_slices);
+	match &= CompareValue(job, "total_cycles", (unsigned long)reference.state.total_cycles, (unsigned long)state->total_cycles);
+
+#define COMPARE(FIELD) match &= CompareValue(job, #FIELD, reference.state.FIELD, state->FIELD)
+	COMPARE(program_counter);
+	COMPARE(stack_pointer);
+	COMPARE(a);
+	COMPARE(f);
+	COMPARE(b);
+	COMPARE(c);
+	COMPARE(d);
+	COMPARE(e);
+	COMPARE(h);
+	COMPARE(l);
+	COMPARE(ixh);
+	COMPARE(ixl);
+	COMPARE(r);
+#undef COMPARE
+
+	if (memcmp(reference.ram, job->ram, sizeof(reference.ram)) != 0)
+	{
+		fprintf(stdout, "Job %u: memory differs from the reference\n", job->index);
+		match = cc_false;
+	}
+
+	return match;
+}
+
+int main(const int argc, char** const argv)
+{
+	static Job *jobs[TOTAL_JOBS];
+
+	ClownZ80_Scheduler scheduler;
+	ClownZ80_Engine engine = CLOWNZ80_ENGINE_JIT;
+	unsigned int total_submitted, total_collected, total_failed, i;
+	int argument;
+
+	for (argument = 1; argument < argc; ++argument)
+	{
+		if (strcmp(argv[argument], "--engine") == 0 && argument + 1 < argc)
+		{
+			engine = ClownZ80_Engine_FromName(argv[++argument]);
+		}
+		else
+		{
+			engine = CLOWNZ80_TOTAL_ENGINES;
+			break;
+		}
+	}
+
+	if (engine == CLOWNZ80_TOTAL_ENGINES)
+	{
+		fputs("Usage: clownz80-scheduler-test [--engine " CLOWNZ80_ENGINE_NAMES "]\n", stderr);
+		fputs("  The scheduler always uses 'ClownZ80_Run', so 'step' is the same as 'run'. Defaults to 'jit'.\n", stderr);
+		return EXIT_FAILURE;
+	}
+
+	for (i = 0; i < TOTAL_JOBS; ++i)
+	{
+		jobs[i] = CreateJob(engine, i);
+
+		if (jobs[i] == NULL)
+		{
+			fputs("Could not create the jobs.\n", stderr);
+
+			while (i-- != 0)
+				DestroyJob(jobs[i]);
+
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (!ClownZ80_Scheduler_Initialise(&scheduler, TOTAL_THREADS, SLICE_CYCLES, MAXIMUM_JOBS))
+	{
+		fputs("Could not initialise the scheduler.\n", stderr);
+
+		for (i = 0; i < TOTAL_JOBS; ++i)
+			DestroyJob(jobs[i]);
+
+		return EXIT_FAILURE;
+	}
+
+	total_submitted = total_collected = total_failed = 0;
+
+	while (total_collected < TOTAL_JOBS)
+	{
+		ClownZ80_SchedulerJob *scheduler_job;
+
+		/* Submit as many jobs as the scheduler will take, without waiting, and then wait for one to finish to make room. */
+		while (total_submitted < TOTAL_JOBS && ClownZ80_Scheduler_Submit(&scheduler, &jobs[total_submitted]->scheduler_job, cc_false))
+			++total_submitted;
+
+		scheduler_job = ClownZ80_Scheduler_Collect(&scheduler, cc_true);
+
+		if (scheduler_job == NULL)
+		{
+			fputs("A job was lost by the scheduler.\n", stdout);
+			++total_failed;
+			break;
+		}
+
+		if (!CheckJob((Job*)scheduler_job->user_data))
+			++total_failed;
+
+		++total_collected;
+	}
+
+	ClownZ80_Scheduler_Deinitialise(&scheduler);
+
+	for (i = 0; i < TOTAL_JOBS; ++i)
+		DestroyJob(jobs[i]);
+
+	fprintf(stdout, "%u jobs collected, %u failed, using the '%s' engine.\n", total_collected, total_failed, ClownZ80_Engine_GetName(engine));
+
+	return total_failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,303 @@
+#define _POSIX_C_SOURCE 200112L
+
+#include "scheduler.h"
+
+#include <stdlib.h>
+
+#include <unistd.h>
+
+#include "clowncommon/clowncommon.h"
+
+static void PushJob(ClownZ80_SchedulerQueue* const queue, ClownZ80_SchedulerJob* const job)
+{
+	job->next = NULL;
+
+	if (queue->tail == NULL)
+		queue->head = job;
+	else
+		queue->tail->next = job;
+
+	queue->tail = job;
+}
+
+static ClownZ80_SchedulerJob* PopJob(ClownZ80_SchedulerQueue* const queue)
+{
+	ClownZ80_SchedulerJob* const job = queue->head;
+
+	if (job != NULL)
+	{
+		queue->head = job->next;
+
+		if (queue->head == NULL)
+			queue->tail = NULL;
+	}
+
+	return job;
+}
+
+static void QueueJob(ClownZ80_Scheduler* const scheduler, ClownZ80_SchedulerWorker* const worker, ClownZ80_SchedulerJob* const job)
+{
+	pthread_mutex_lock(&worker->queue.mutex);
+	PushJob(&worker->queue, job);
+	pthread_mutex_unlock(&worker->queue.mutex);
+
+	pthread_mutex_lock(&scheduler->mutex);
+	++scheduler->queued_jobs;
+	pthread_cond_signal(&scheduler->work_available);
+	pthread_mutex_unlock(&scheduler->mutex);
+}
+
+/* Takes a job from the worker's own queue, or else steals one from another worker's. Returns NULL if the scheduler is quitting. */
+static ClownZ80_SchedulerJob* TakeJob(ClownZ80_Scheduler* const scheduler, ClownZ80_SchedulerWorker* const worker)
+{
+	const unsigned int worker_index = (unsigned int)(worker - scheduler->workers);
+
+	for (;;)
+	{
+		cc_bool quitting;
+		unsigned int i;
+
+		pthread_mutex_lock(&scheduler->mutex);
+
+		while (scheduler->queued_jobs == 0 && !scheduler->quitting)
+			pthread_cond_wait(&scheduler->work_available, &scheduler->mutex);
+
+		quitting = scheduler->quitting;
+
+		pthread_mutex_unlock(&scheduler->mutex);
+
+		if (quitting)
+			return NULL;
+
+		for (i = 0; i < scheduler->total_workers; ++i)
+		{
+			ClownZ80_SchedulerQueue* const queue = &scheduler->workers[(worker_index + i) % scheduler->total_workers].queue;
+			ClownZ80_SchedulerJob *job;
+
+			pthread_mutex_lock(&queue->mutex);
+			job = PopJob(queue);
+			pthread_mutex_unlock(&queue->mutex);
+
+			if (job != NULL)
+			{
+				pthread_mutex_lock(&scheduler->mutex);
+				--scheduler->queued_jobs;
+				pthread_mutex_unlock(&scheduler->mutex);
+
+				return job;
+			}
+		}
+
+		/* Another worker got to the job first, so go back to waiting. */
+	}
+}
+
+static void FinishJob(ClownZ80_Scheduler* const scheduler, ClownZ80_SchedulerJob* const job)
+{
+	pthread_mutex_lock(&scheduler->mutex);
+	PushJob(&scheduler->finished_jobs, job);
+	pthread_cond_signal(&scheduler->job_finished);
+	pthread_mutex_unlock(&scheduler->mutex);
+}
+
+static void* WorkerThread(void* const user_data)
+{
+	ClownZ80_SchedulerWorker* const worker = (ClownZ80_SchedulerWorker*)user_data;
+	ClownZ80_Scheduler* const scheduler = worker->scheduler;
+	ClownZ80_SchedulerJob *job = NULL;
+
+	for (;;)
+	{
+		cc_u32f slice_cycles;
+		cc_bool carry_on, quitting;
+
+		if (job == NULL)
+		{
+			job = TakeJob(scheduler, worker);
+
+			if (job == NULL)
+				break;
+		}
+
+		slice_cycles = CC_MIN(scheduler->slice_cycles, job->cycles_remaining);
+
+		ClownZ80_RunInstances(job->instance, 1, slice_cycles);
+		job->cycles_remaining -= slice_cycles;
+
+		carry_on = job->cycles_remaining != 0 && (job->slice_callback == NULL || job->slice_callback(job));
+
+		if (!carry_on)
+		{
+			FinishJob(scheduler, job);
+			job = NULL;
+		}
+		else
+		{
+			cc_bool others_waiting;
+
+			pthread_mutex_lock(&worker->queue.mutex);
+			others_waiting = worker->queue.head != NULL;
+			pthread_mutex_unlock(&worker->queue.mutex);
+
+			/* Let the other jobs in the queue have a turn. */
+			if (others_waiting)
+			{
+				QueueJob(scheduler, worker, job);
+				job = NULL;
+			}
+		}
+
+		pthread_mutex_lock(&scheduler->mutex);
+		quitting = scheduler->quitting;
+		pthread_mutex_unlock(&scheduler->mutex);
+
+		if (quitting)
+			break;
+	}
+
+	return NULL;
+}
+
+static cc_bool InitialiseQueue(ClownZ80_SchedulerQueue* const queue)
+{
+	queue->head = queue->tail = NULL;
+
+	return pthread_mutex_init(&queue->mutex, NULL) == 0;
+}
+
+cc_bool ClownZ80_Scheduler_Initialise(ClownZ80_Scheduler* const scheduler, unsigned int total_threads, const cc_u32f slice_cycles, const size_t maximum_jobs)
+{
+	unsigned int i;
+
+	if (total_threads == 0)
+	{
+		const long total_cores = sysconf(_SC_NPROCESSORS_ONLN);
+
+		total_threads = total_cores < 1 ? 1 : (unsigned int)total_cores;
+	}
+
+	scheduler->workers = (ClownZ80_SchedulerWorker*)malloc(sizeof(*scheduler->workers) * total_threads);
+
+	if (scheduler->workers == NULL)
+		return cc_false;
+
+	scheduler->total_workers = 0;
+	scheduler->slice_cycles = slice_cycles;
+	scheduler->maximum_jobs = maximum_jobs;
+	scheduler->queued_jobs = 0;
+	scheduler->unfinished_jobs = 0;
+	scheduler->next_worker = 0;
+	scheduler->quitting = cc_false;
+	scheduler->finished_jobs.head = scheduler->finished_jobs.tail = NULL;
+
+	pthread_mutex_init(&scheduler->mutex, NULL);
+	pthread_cond_init(&scheduler->work_available, NULL);
+	pthread_cond_init(&scheduler->job_finished, NULL);
+	pthread_cond_init(&scheduler->space_available, NULL);
+
+	for (i = 0; i < total_threads; ++i)
+	{
+		ClownZ80_SchedulerWorker* const worker = &scheduler->workers[i];
+
+		worker->scheduler = scheduler;
+
+		if (!InitialiseQueue(&worker->queue))
+			break;
+
+		if (pthread_create(&worker->thread, NULL, WorkerThread, worker) != 0)
+		{
+			pthread_mutex_destroy(&worker->queue.mutex);
+			break;
+		}
+
+		++scheduler->total_workers;
+	}
+
+	/* Make do with however many threads could be created. */
+	if (scheduler->total_workers == 0)
+	{
+		ClownZ80_Scheduler_Deinitialise(scheduler);
+		return cc_false;
+	}
+
+	return cc_true;
+}
+
+void ClownZ80_Scheduler_Deinitialise(ClownZ80_Scheduler* const scheduler)
+{
+	unsigned int i;
+
+	pthread_mutex_lock(&scheduler->mutex);
+	scheduler->quitting = cc_true;
+	pthread_cond_broadcast(&scheduler->work_available);
+	pthread_mutex_unlock(&scheduler->mutex);
+
+	for (i = 0; i < scheduler->total_workers; ++i)
+	{
+		pthread_join(scheduler->workers[i].thread, NULL);
+		pthread_mutex_destroy(&scheduler->workers[i].queue.mutex);
+	}
+
+	pthread_cond_destroy(&scheduler->space_available);
+	pthread_cond_destroy(&scheduler->job_finished);
+	pthread_cond_destroy(&scheduler->work_available);
+	pthread_mutex_destroy(&scheduler->mutex);
+
+	free(scheduler->workers);
+}
+
+cc_bool ClownZ80_Scheduler_Submit(ClownZ80_Scheduler* const scheduler, ClownZ80_SchedulerJob* const job, const cc_bool wait)
+{
+	ClownZ80_SchedulerWorker *worker;
+
+	pthread_mutex_lock(&scheduler->mutex);
+
+	while (scheduler->unfinished_jobs >= scheduler->maximum_jobs)
+	{
+		if (!wait)
+		{
+			pthread_mutex_unlock(&scheduler->mutex);
+			return cc_false;
+		}
+
+		pthread_cond_wait(&scheduler->space_available, &scheduler->mutex);
+	}
+
+	++scheduler->unfinished_jobs;
+
+	/* Spread the jobs out evenly to begin with: stealing evens things out if some finish sooner than others. */
+	worker = &scheduler->workers[scheduler->next_worker];
+	scheduler->next_worker = (scheduler->next_worker + 1) % scheduler->total_workers;
+
+	pthread_mutex_unlock(&scheduler->mutex);
+
+	/* Jobs with nothing to do are finished straight away. */
+	if (job->cycles_remaining == 0)
+		FinishJob(scheduler, job);
+	else
+		QueueJob(scheduler, worker, job);
+
+	return cc_true;
+}
+
+ClownZ80_SchedulerJob* ClownZ80_Scheduler_Collect(ClownZ80_Scheduler* const scheduler, const cc_bool wait)
+{
+	ClownZ80_SchedulerJob *job;
+
+	pthread_mutex_lock(&scheduler->mutex);
+
+	while (wait && scheduler->finished_jobs.head == NULL && scheduler->unfinished_jobs != 0)
+		pthread_cond_wait(&scheduler->job_finished, &scheduler->mutex);
+
+	job = PopJob(&scheduler->finished_jobs);
+
+	if (job != NULL)
+	{
+		--scheduler->unfinished_jobs;
+		pthread_cond_signal(&scheduler->space_available);
+	}
+
+	pthread_mutex_unlock(&scheduler->mutex);
+
+	return job;
+}
@@ -0,0 +1,67 @@
+#ifndef CLOWNZ80_SCHEDULER_H
+#define CLOWNZ80_SCHEDULER_H
+
+#include <stddef.h>
+
+#include <pthread.h>
+
+#include "clowncommon/clowncommon.h"
+
+#include "interpreter.h"
+
+/* An instance to be run for a number of cycles. Jobs are owned by the scheduler from when they are submitted until they are collected. */
+typedef struct ClownZ80_SchedulerJob
+{
+	ClownZ80_Instance *instance;
+	/* How many cycles are left to run for. The job is finished when this reaches 0. */
+	cc_u32l cycles_remaining;
+	/* Optional: called by a worker thread after every slice, such as to capture output. Returning cc_false finishes the job early. May be NULL. */
+	cc_bool (*slice_callback)(struct ClownZ80_SchedulerJob *job);
+	void *user_data;
+	/* Private. */
+	struct ClownZ80_SchedulerJob *next;
+} ClownZ80_SchedulerJob;
+
+typedef struct ClownZ80_SchedulerQueue
+{
+	pthread_mutex_t mutex;
+	ClownZ80_SchedulerJob *head, *tail;
+} ClownZ80_SchedulerQueue;
+
+typedef struct ClownZ80_SchedulerWorker
+{
+	struct ClownZ80_Scheduler *scheduler;
+	pthread_t thread;
+	/* Jobs waiting to be run by this worker. Workers with nothing to do steal from the others. */
+	ClownZ80_SchedulerQueue queue;
+} ClownZ80_SchedulerWorker;
+
+/* Runs independent instances on a pool of threads. Instances are run a slice at a time, so that many of them can share a thread.
+   A JIT must not be shared between instances which are run by the same scheduler, as they may be run at the same time. */
+typedef struct ClownZ80_Scheduler
+{
+	ClownZ80_SchedulerWorker *workers;
+	unsigned int total_workers;
+	cc_u32l slice_cycles;
+	size_t maximum_jobs;
+
+	/* Protects everything below. */
+	pthread_mutex_t mutex;
+	pthread_cond_t work_available, job_finished, space_available;
+	size_t queued_jobs;      /* Jobs in the workers' queues. */
+	size_t unfinished_jobs;  /* Jobs which have been submitted but not yet collected, for limiting how many can be in flight. */
+	unsigned int next_worker;
+	ClownZ80_SchedulerQueue finished_jobs;
+	cc_bool quitting;
+} ClownZ80_Scheduler;
+
+/* A 'total_threads' of 0 creates one thread per core. At most 'maximum_jobs' can be in flight at once, which must be at least 1. */
+cc_bool ClownZ80_Scheduler_Initialise(ClownZ80_Scheduler *scheduler, unsigned int total_threads, cc_u32f slice_cycles, size_t maximum_jobs);
+/* Any jobs that have not finished are abandoned. */
+void ClownZ80_Scheduler_Deinitialise(ClownZ80_Scheduler *scheduler);
+/* If 'wait' is cc_false and there are already 'maximum_jobs' in flight, then cc_false is returned instead of waiting for one to be collected. */
+cc_bool ClownZ80_Scheduler_Submit(ClownZ80_Scheduler *scheduler, ClownZ80_SchedulerJob *job, cc_bool wait);
+/* Returns a finished job, or NULL if there are none. If 'wait' is cc_true, then this waits for a job to finish, unless none are in flight. */
+ClownZ80_SchedulerJob* ClownZ80_Scheduler_Collect(ClownZ80_Scheduler *scheduler, cc_bool wait);
+
+#endif /* CLOWNZ80_SCHEDULER_H */
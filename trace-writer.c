@@ -0,0 +1,197 @@
+#define _POSIX_C_SOURCE 200112L
+
+#include "trace-writer.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "clowncommon/clowncommon.h"
+
+#ifdef CLOWNZ80_TRACER
+
+/* How long to wait before checking again, when there is nothing to write or nowhere to put a buffer. */
+#define POLL_NANOSECONDS 1000000
+
+/* The thread which writes a variable must store to it with 'StoreRelease', so that everything that it wrote beforehand
+   can be seen by the thread which loads it with 'LoadAcquire'. */
+static size_t LoadAcquire(ClownZ80_TraceWriter* const writer, const size_t* const variable)
+{
+#ifdef __GNUC__
+	(void)writer;
+
+	return __atomic_load_n(variable, __ATOMIC_ACQUIRE);
+#else
+	size_t value;
+
+	pthread_mutex_lock(&writer->mutex);
+	value = *variable;
+	pthread_mutex_unlock(&writer->mutex);
+
+	return value;
+#endif
+}
+
+static void StoreRelease(ClownZ80_TraceWriter* const writer, size_t* const variable, const size_t value)
+{
+#ifdef __GNUC__
+	(void)writer;
+
+	__atomic_store_n(variable, value, __ATOMIC_RELEASE);
+#else
+	pthread_mutex_lock(&writer->mutex);
+	*variable = value;
+	pthread_mutex_unlock(&writer->mutex);
+#endif
+}
+
+static cc_bool LoadAcquireBool(ClownZ80_TraceWriter* const writer, const cc_bool* const variable)
+{
+#ifdef __GNUC__
+	(void)writer;
+
+	return __atomic_load_n(variable, __ATOMIC_ACQUIRE);
+#else
+	cc_bool value;
+
+	pthread_mutex_lock(&writer->mutex);
+	value = *variable;
+	pthread_mutex_unlock(&writer->mutex);
+
+	return value;
+#endif
+}
+
+static void StoreReleaseBool(ClownZ80_TraceWriter* const writer, cc_bool* const variable, const cc_bool value)
+{
+#ifdef __GNUC__
+	(void)writer;
+
+	__atomic_store_n(variable, value, __ATOMIC_RELEASE);
+#else
+	pthread_mutex_lock(&writer->mutex);
+	*variable = value;
+	pthread_mutex_unlock(&writer->mutex);
+#endif
+}
+
+static void Wait(void)
+{
+	struct timespec duration;
+
+	duration.tv_sec = 0;
+	duration.tv_nsec = POLL_NANOSECONDS;
+
+	nanosleep(&duration, NULL);
+}
+
+static void* WriterThread(void* const user_data)
+{
+	ClownZ80_TraceWriter* const writer = (ClownZ80_TraceWriter*)user_data;
+	size_t tail = writer->tail;
+
+	for (;;)
+	{
+		if (LoadAcquire(writer, &writer->head) == tail)
+		{
+			/* The head must be checked again after seeing that the writer is closing, as a final buffer could have been added in between. */
+			if (LoadAcquireBool(writer, &writer->closing) && LoadAcquire(writer, &writer->head) == tail)
+				break;
+
+			Wait();
+		}
+		else
+		{
+			const size_t index = tail % writer->total_buffers;
+
+			if (fwrite(writer->buffers[index], 1, writer->buffer_sizes[index], writer->file) != writer->buffer_sizes[index])
+				writer->failed = cc_true;
+
+			++tail;
+			StoreRelease(writer, &writer->tail, tail);
+		}
+	}
+
+	return NULL;
+}
+
+cc_bool ClownZ80_TraceWriter_Open(ClownZ80_TraceWriter* const writer, const char* const file_path, const size_t total_buffers)
+{
+	writer->buffers = (unsigned char(*)[CLOWNZ80_TRACER_BUFFER_SIZE])malloc(sizeof(*writer->buffers) * total_buffers);
+	writer->buffer_sizes = (size_t*)malloc(sizeof(*writer->buffer_sizes) * total_buffers);
+	writer->total_buffers = total_buffers;
+	writer->head = writer->tail = 0;
+	writer->closing = writer->failed = cc_false;
+	writer->file = NULL;
+
+	if (writer->buffers != NULL && writer->buffer_sizes != NULL)
+	{
+		writer->file = fopen(file_path, "wb");
+
+		if (writer->file != NULL)
+		{
+			if (fwrite(CLOWNZ80_TRACE_FILE_SIGNATURE, 1, sizeof(CLOWNZ80_TRACE_FILE_SIGNATURE) - 1, writer->file) == sizeof(CLOWNZ80_TRACE_FILE_SIGNATURE) - 1)
+			{
+			#ifndef __GNUC__
+				if (pthread_mutex_init(&writer->mutex, NULL) == 0)
+			#endif
+				{
+					if (pthread_create(&writer->thread, NULL, WriterThread, writer) == 0)
+						return cc_true;
+
+				#ifndef __GNUC__
+					pthread_mutex_destroy(&writer->mutex);
+				#endif
+				}
+			}
+
+			fclose(writer->file);
+		}
+	}
+
+	free(writer->buffer_sizes);
+	free(writer->buffers);
+
+	return cc_false;
+}
+
+cc_bool ClownZ80_TraceWriter_Close(ClownZ80_TraceWriter* const writer)
+{
+	cc_bool success;
+
+	StoreReleaseBool(writer, &writer->closing, cc_true);
+	pthread_join(writer->thread, NULL);
+
+#ifndef __GNUC__
+	pthread_mutex_destroy(&writer->mutex);
+#endif
+
+	success = !writer->failed;
+
+	if (fclose(writer->file) != 0)
+		success = cc_false;
+
+	free(writer->buffer_sizes);
+	free(writer->buffers);
+
+	return success;
+}
+
+void ClownZ80_TraceWriter_Write(void* const user_data, const unsigned char* const data, const size_t size)
+{
+	ClownZ80_TraceWriter* const writer = (ClownZ80_TraceWriter*)user_data;
+	const size_t head = writer->head;
+	const size_t index = head % writer->total_buffers;
+
+	/* Wait for the writer's thread to make room, if it has fallen behind. */
+	while (head - LoadAcquire(writer, &writer->tail) == writer->total_buffers)
+		Wait();
+
+	memcpy(writer->buffers[index], data, size);
+	writer->buffer_sizes[index] = size;
+
+	StoreRelease(writer, &writer->head, head + 1);
+}
+
+#endif
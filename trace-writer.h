@@ -0,0 +1,48 @@
+#ifndef CLOWNZ80_TRACE_WRITER_H
+#define CLOWNZ80_TRACE_WRITER_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+#include <pthread.h>
+
+#include "clowncommon/clowncommon.h"
+
+#include "interpreter.h"
+
+#ifdef CLOWNZ80_TRACER
+
+/* Trace files begin with this, followed by the tracer's records. */
+#define CLOWNZ80_TRACE_FILE_SIGNATURE "ClownZ80 trace 1"
+
+/* Writes a tracer's records to a file on a thread of its own, so that the Z80 is not held up by the file.
+   The records are passed through a ring of buffers, which the tracer's thread fills and the writer's thread empties.
+   As there is only ever one of each, neither has to take a lock. */
+typedef struct ClownZ80_TraceWriter
+{
+	/* Private. */
+	FILE *file;
+	pthread_t thread;
+	unsigned char (*buffers)[CLOWNZ80_TRACER_BUFFER_SIZE];
+	size_t *buffer_sizes;
+	size_t total_buffers;
+	/* These only ever increase, wrapping around. 'head' is the next buffer to fill, and 'tail' is the next one to empty. */
+	size_t head, tail;
+	cc_bool closing, failed;
+#ifndef __GNUC__
+	pthread_mutex_t mutex; /* Stands in for atomic operations. */
+#endif
+} ClownZ80_TraceWriter;
+
+/* Creates the file and starts the thread. 'total_buffers' must be at least 1: more of them lets the writer fall further behind before
+   the Z80 has to wait for it. Returns cc_false if either could not be done. */
+cc_bool ClownZ80_TraceWriter_Open(ClownZ80_TraceWriter *writer, const char *file_path, size_t total_buffers);
+/* Waits for all of the records to be written, and closes the file. Returns cc_false if any of them could not be written.
+   The tracer should be flushed before this is called. */
+cc_bool ClownZ80_TraceWriter_Close(ClownZ80_TraceWriter *writer);
+/* Suitable for use as the tracer's flush callback, with the writer as the user data. */
+void ClownZ80_TraceWriter_Write(void *user_data, const unsigned char *data, size_t size);
+
+#endif
+
+#endif /* CLOWNZ80_TRACE_WRITER_H */
@@ -1,2 +1,3 @@
+#include "jit.c"
 #include "common.c"
 #include "interpreter.c"